@@ -33,6 +33,7 @@
 #include <protomol/analysis/AnalysisCollection.h>
 
 #include <protomol/parallel/Parallel.h>
+#include <protomol/parallel/ReplicaExchange.h>
 
 #include <iomanip>
 #ifdef HAVE_PACKAGE_H
@@ -51,7 +52,7 @@ using namespace ProtoMol::Constant;
 
 ProtoMolApp::ProtoMolApp(ModuleManager *modManager) :
   modManager(modManager), SCPISMParameters(0), cmdLine(&config), outputs(0),
-  integrator(0), topology(0) {
+  integrator(0), topology(0), replicaExchange(0) {
 
   TimerStatistic::timer[TimerStatistic::WALL].start();
 
@@ -307,9 +308,21 @@ void ProtoMolApp::build() {
       topology->forceFieldFlag = GROMACS;
     }
 
-    // Build the topology
-    buildTopology(topology, psf, par, config[InputDihedralMultPSF::keyword],
-                  SCPISMParameters);
+    // Build the topology, or restore it from the cache
+    if (topologyCache.isValid()) {
+      if (!topologyCache.read(topology))
+        THROWS("Corrupt topology cache '" << topologyCache.getFilename()
+               << "', remove it to rebuild.");
+
+      report << plain << "Topology restored from cache '"
+             << topologyCache.getFilename() << "'." << endr;
+
+    } else {
+      buildTopology(topology, psf, par, config[InputDihedralMultPSF::keyword],
+                    SCPISMParameters);
+
+      if (topologyCache.isEnabled()) topologyCache.write(topology);
+    }
 
   } else {
     //TPR/GROMACS if here
@@ -406,20 +419,47 @@ void ProtoMolApp::build() {
         analysis = new AnalysisCollection;
 	}else{
 		if (config[InputOutput::keyword]){
-			outputs = outputFactory.makeCollection(&config);
+			outputs = makeOutputs(Parallel::getGroup());
+		}else{
+			outputs = new OutputCollection;
 		}
 
         if (config[InputAnalysis::keyword]){
-            analysis = analysisFactory.makeCollection(&config);
+            analysis = makeAnalysis(Parallel::getGroup());
+        }else{
+            analysis = new AnalysisCollection;
         }
 	}
 
+  // All replicas start from the input, before the post build processing
+  const unsigned int numReplicas =
+    (int)config[InputSequentialReplicas::keyword];
+  Vector3DBlock initialPositions, initialVelocities;
+  if (numReplicas > 1) {
+    initialPositions = positions;
+    initialVelocities = velocities;
+  }
+
   // Post build processing
   modManager->postBuild(this);
 
   report << plain << "Actual start temperature : "
          << temperature(topology, &velocities) << "K" << endr;
 
+  // Replica exchange sets the temperature of the replica of this group
+  if (config.valid(InputReplicaExchangeTemperatures::keyword)) {
+    vector<Real> temperatures;
+    config[InputReplicaExchangeTemperatures::keyword].get(temperatures);
+    replicaExchange =
+      new ReplicaExchange(temperatures,
+                          config[InputReplicaExchangeFrequency::keyword],
+                          (int)config[InputSeed::keyword]);
+    replicaExchange->initialize(this);
+  }
+
+  if (numReplicas > 1 && replicaExchange)
+    THROW("Sequential replicas can not be combined with replica exchange.");
+
 
   // Add Integrator Modifiers
   modManager->addModifiers(this);
@@ -445,6 +485,16 @@ void ProtoMolApp::build() {
   // Initialize Analysis
   analysis->initialize(this);
 
+  // Build the other replicas while the factories are still available
+  if (numReplicas > 1) {
+    replicas.resize(numReplicas - 1);
+    for (unsigned int r = 1; r < numReplicas; r++)
+      buildReplica(r, initialPositions, initialVelocities);
+    updateReplica();
+
+    report << plain << "Sequential replicas : " << numReplicas << endr;
+  }
+
   // Print Factories
   if ((int)config[InputDebug::keyword] >= 5 && (int)config[InputDebugLimit::keyword] <= 5)
     cout
@@ -488,6 +538,13 @@ bool ProtoMolApp::step(long inc) {
 
   if (!inc) inc = outputs->getNext() - currentStep;
 
+  // Stop where the analysis takes its snapshots
+  inc = std::min(inc, analysis->getNext(currentStep) - currentStep);
+
+  // Stop at the next replica exchange
+  if (replicaExchange)
+    inc = std::min(inc, replicaExchange->getNext(currentStep) - currentStep);
+
   //fix inc so do not overrun
   if( lastStep != -1 ){
     inc = std::min(lastStep, currentStep + inc) - currentStep;
@@ -497,6 +554,19 @@ bool ProtoMolApp::step(long inc) {
 
   const long completed = integrator->run(inc);
 
+  // Step the other replicas by the same number of steps
+  bool stop = false;
+  for (unsigned int r = 1; r <= replicas.size(); r++) {
+    swapReplica(r);
+    updateReplica();
+    outputs->run(currentStep);
+    analysis->run(currentStep);
+    integrator->run(completed);
+    stop |= analysis->shouldStop();
+    swapReplica(r);
+  }
+  if (!replicas.empty()) updateReplica();
+
   TimerStatistic::timer[TimerStatistic::INTEGRATOR].stop();
 
   // moved here so that current step is valid in integrator
@@ -505,7 +575,9 @@ bool ProtoMolApp::step(long inc) {
   }
   currentStep += completed;
 
-  if( analysis->shouldStop() ) lastStep = currentStep;
+  if (replicaExchange) replicaExchange->run(currentStep);
+
+  if( analysis->shouldStop() || stop ) lastStep = currentStep;
 
   TimerStatistic::timer[TimerStatistic::RUN].stop();
 
@@ -524,7 +596,22 @@ void ProtoMolApp::finalize() {
   outputs->finalize(currentStep);
   analysis->finalize(currentStep);
 
+  for (unsigned int r = 1; r <= replicas.size(); r++) {
+    swapReplica(r);
+    updateReplica();
+    outputs->finalize(currentStep);
+    analysis->finalize(currentStep);
+    swapReplica(r);
+
+    zap(replicas[r - 1].integrator);
+    zap(replicas[r - 1].outputs);
+    zap(replicas[r - 1].analysis);
+  }
+  replicas.clear();
+
   // Clean up
+  if (replicaExchange) replicaExchange->finalize();
+  zap(replicaExchange);
   zap(topology);
   zap(integrator);
   zap(outputs);
@@ -541,8 +628,122 @@ void ProtoMolApp::finalize() {
 }
 
 
+//____ replicaFilename
+static string replicaFilename(const string &filename, unsigned int r) {
+  // Insert the replica before the extension, e.g., out.dcd -> out.r1.dcd
+  string::size_type dot = filename.rfind('.');
+  string::size_type slash = filename.rfind('/');
+  if (dot == string::npos || (slash != string::npos && dot < slash))
+    dot = filename.size();
+
+  return filename.substr(0, dot) + ".r" + toString(r) + filename.substr(dot);
+}
+
+
+OutputCollection *ProtoMolApp::makeOutputs(unsigned int r) {
+  if (r == 0) return outputFactory.makeCollection(&config);
+
+  // Outputs write to their own files, the screen shows replica 0 only
+  const Configuration &original = config;
+  Configuration replicaConfig(config);
+
+  for (Configuration::const_iterator i = original.begin();
+       i != original.end(); ++i)
+    if (i->second.valid() && outputFactory.find(i->first)) {
+      if (i->second.getType() == ValueType::STRING)
+        replicaConfig.set(i->first, replicaFilename(i->second.getString(), r));
+      else replicaConfig[i->first].clear();
+    }
+
+  return outputFactory.makeCollection(&replicaConfig);
+}
+
+
+AnalysisCollection *ProtoMolApp::makeAnalysis(unsigned int r) {
+  if (r == 0) return analysisFactory.makeCollection(&config);
+
+  // Analyses writing files write to their own
+  const Configuration &original = config;
+  Configuration replicaConfig(config);
+
+  for (Configuration::const_iterator i = original.begin();
+       i != original.end(); ++i)
+    if (i->second.valid() && analysisFactory.find(i->first) &&
+        i->second.getType() == ValueType::STRING)
+      replicaConfig.set(i->first, replicaFilename(i->second.getString(), r));
+
+  return analysisFactory.makeCollection(&replicaConfig);
+}
+
+
+void ProtoMolApp::buildReplica(unsigned int r,
+                               const Vector3DBlock &initialPositions,
+                               const Vector3DBlock &initialVelocities) {
+  Replica &replica = replicas[r - 1];
+
+  replica.positions = initialPositions;
+  replica.velocities = initialVelocities;
+
+  replica.energies.molecularVirial(energies.molecularVirial());
+  replica.energies.virial(energies.virial());
+  replica.time = topology->time;
+
+  replica.integrator =
+    integratorFactory.make(config[InputIntegrator::keyword], &forceFactory);
+
+  if (Parallel::iAmMaster() && (bool)config[InputOutput::keyword])
+    replica.outputs = makeOutputs(r);
+  else replica.outputs = new OutputCollection;
+
+  if (Parallel::iAmMaster() && (bool)config[InputAnalysis::keyword])
+    replica.analysis = makeAnalysis(r);
+  else replica.analysis = new AnalysisCollection;
+
+  swapReplica(r);
+
+  // Post build processing of a run with seed + r, the random velocities
+  // included, the generator restarts as in MainModule::configure()
+  const int seed = config[InputSeed::keyword];
+  config[InputSeed::keyword] = seed + (int)r;
+  reseedRandomNumber();
+  randomNumber(seed + r, config[InputRandomType::keyword]);
+  modManager->postBuild(this);
+  config[InputSeed::keyword] = seed;
+
+  updateReplica();
+  modManager->addModifiers(this);
+  integrator->initialize(this);
+  outputs->initialize(this);
+  analysis->initialize(this);
+  swapReplica(r);
+}
+
+
+void ProtoMolApp::swapReplica(unsigned int r) {
+  Replica &replica = replicas[r - 1];
+
+  positions.swap(replica.positions);
+  velocities.swap(replica.velocities);
+  swap(energies, replica.energies);
+  swap(topology->time, replica.time);
+  swap(outputs, replica.outputs);
+  swap(analysis, replica.analysis);
+  swap(integrator, replica.integrator);
+}
+
+
+void ProtoMolApp::updateReplica() {
+  // Everything the topology derives from the positions
+  topology->uncacheCellList();
+  buildMolecularCenterOfMass(&positions, topology);
+  buildMolecularMomentum(&velocities, topology);
+  outputCache.uncache();
+  outputCache.invalidateObservables();
+}
+
+
 void ProtoMolApp::print(ostream &stream) {
-	if( Parallel::iAmMaster() ){
+	if( Parallel::iAmMaster() && Parallel::getGroup() == 0 ){
 		// Output
 		stream << headerRow("Outputs") << endl;
 
@@ -16,8 +16,10 @@
 #include <protomol/type/PAR.h>
 #include <protomol/type/ScalarStructure.h>
 #include <protomol/topology/CoulombSCPISMParameterTable.h>
+#include <protomol/topology/TopologyCache.h>
 
 #include <ostream>
+#include <vector>
 
 namespace ProtoMol {
   class OutputCollection;
@@ -25,9 +27,21 @@ namespace ProtoMol {
   class Integrator;
   class GenericTopology;
   class ModuleManager;
+  class ReplicaExchange;
 
   class ProtoMolApp {
   public:
+    /// State of one replica of the system, see InputSequentialReplicas
+    struct Replica {
+      Vector3DBlock positions;
+      Vector3DBlock velocities;
+      ScalarStructure energies;
+      Real time;
+      OutputCollection *outputs;
+      AnalysisCollection *analysis;
+      Integrator *integrator;
+    };
+
     ModuleManager *modManager;
 
     // Data
@@ -36,6 +50,7 @@ namespace ProtoMol {
     EigenvectorInfo eigenInfo;
     PSF psf;
     PAR par;
+    TopologyCache topologyCache;
     ScalarStructure energies;
     CoulombSCPISMParameterTable *SCPISMParameters;
 
@@ -54,6 +69,9 @@ namespace ProtoMol {
     AnalysisCollection *analysis;
     Integrator *integrator;
     GenericTopology *topology;
+    /// Replicas 1, 2, ... sharing the topology, replica 0 is the state above
+    std::vector<Replica> replicas;
+    ReplicaExchange *replicaExchange;
 
     // Run
     long currentStep;
@@ -75,6 +93,19 @@ namespace ProtoMol {
     void print(std::ostream &stream);
     bool step(long inc = 0);
     void finalize();
+
+  private:
+    /// Outputs of replica r, file names get the suffix .r<r>
+    OutputCollection *makeOutputs(unsigned int r);
+    /// Analyses of replica r, file names get the suffix .r<r>
+    AnalysisCollection *makeAnalysis(unsigned int r);
+    void buildReplica(unsigned int r, const Vector3DBlock &initialPositions,
+                      const Vector3DBlock &initialVelocities);
+    /// Exchanges the state above with the one of replica r > 0
+    void swapReplica(unsigned int r);
+    /// Rebuilds what the topology and the output cache derive from the
+    /// positions and velocities, O(N), once a replica is swapped in
+    void updateReplica();
   };
 }
 
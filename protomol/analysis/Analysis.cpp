@@ -4,6 +4,7 @@
 #include <protomol/type/ScalarStructure.h>
 #include <protomol/module/MainModule.h>
 #include <protomol/ProtoMolApp.h>
+#include <protomol/base/PMConstants.h>
 
 using namespace std;
 using namespace ProtoMol;
@@ -32,6 +33,10 @@ void Analysis::finalize(long step) {
 	doFinalize(step);
 }
 
+long Analysis::getNext(long /*step*/) const {
+	return Constant::MAX_LONG;
+}
+
 Analysis *Analysis::make(const vector<Value> &values) const {
 	assertParameters(values);
 	return adjustAlias(doMake(values));
@@ -33,6 +33,10 @@ namespace ProtoMol {
 			// / step, if needed.
 			virtual void finalize (long step);
 
+			// / Next step after step at which the analysis needs the positions,
+			// / the integrator stops there.  Never by default.
+			virtual long getNext(long step) const;
+
 			// / Factory method to create a complete output object from its prototy
 			virtual Analysis *make (const std::vector<Value> &values) const;
 
@@ -10,6 +10,9 @@
 #include <protomol/topology/TopologyUtilities.h>
 #include <protomol/ProtoMolApp.h>
 #include <protomol/base/Exception.h>
+#include <protomol/base/PMConstants.h>
+
+#include <algorithm>
 
 using namespace ProtoMol;
 
@@ -48,6 +51,16 @@ bool AnalysisCollection::shouldStop() {
 	return false;
 }
 
+long AnalysisCollection::getNext(long step) const {
+	long next = Constant::MAX_LONG;
+	for( const_iterator i = begin(); i != end(); ++i ) {
+		if( ( *i )->isOnOutput() ) {
+			next = std::min(next, ( *i )->getNext(step));
+		}
+	}
+	return next;
+}
+
 void AnalysisCollection::finalize(long step) {
 	app->outputCache.uncache();
 	for( iterator i = begin(); i != end(); i++ ) {
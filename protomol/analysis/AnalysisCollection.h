@@ -29,6 +29,9 @@ namespace ProtoMol {
 
 			bool shouldStop ();
 
+			// / Next step after step at which an Analysis needs the positions
+			long getNext (long step) const;
+
 			// / Finalize all Outout object
 			void finalize (long step);
 
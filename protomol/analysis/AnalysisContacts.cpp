@@ -0,0 +1,96 @@
+#include <protomol/analysis/AnalysisContacts.h>
+
+#include <protomol/topology/GenericTopology.h>
+#include <protomol/ProtoMolApp.h>
+
+#include <stdlib.h>
+
+using namespace std;
+using namespace ProtoMol;
+
+const string AnalysisContacts::keyword("AnalyzeContacts");
+
+AnalysisContacts::AnalysisContacts()
+	: AnalysisStream("", 1, "CA"), mCutoff(8.0), mNumNative(0), mFrames(0) {}
+
+AnalysisContacts::AnalysisContacts(const std::string &filename, int frequency, const std::string &atoms, Real cutoff)
+	: AnalysisStream(filename, frequency, atoms), mCutoff(cutoff), mNumNative(0), mFrames(0) {}
+
+AnalysisContacts::~AnalysisContacts() {
+	join();
+}
+
+void AnalysisContacts::doStart(const Vector3DBlock &positions, std::ostream &file) {
+	const unsigned int n = positions.size();
+
+	mResidue.resize(n);
+	for( unsigned int i = 0; i < n; i++ ) {
+		mResidue[i] = app->topology->atoms[mSelection[i]].residue_seq;
+	}
+
+	const Real cutoff2 = mCutoff * mCutoff;
+	mNative.assign(n * n, false);
+	mFrequency.assign(n * n, 0);
+	mNumNative = 0;
+	mFrames = 0;
+	for( unsigned int i = 0; i < n; i++ ) {
+		for( unsigned int j = i + 1; j < n; j++ ) {
+			if( abs(mResidue[i] - mResidue[j]) >= 3 && app->topology->minimalDifference(positions[i], positions[j]).normSquared() < cutoff2 ) {
+				mNative[i * n + j] = true;
+				mNumNative++;
+			}
+		}
+	}
+
+	file << "# step contacts native Q" << endl;
+}
+
+void AnalysisContacts::doAnalyze(long step, Real /*volume*/, const Vector3DBlock &positions, std::ostream &file) {
+	const unsigned int n = positions.size();
+	const Real cutoff2 = mCutoff * mCutoff;
+
+	int contacts = 0, native = 0;
+	for( unsigned int i = 0; i < n; i++ ) {
+		for( unsigned int j = i + 1; j < n; j++ ) {
+			if( abs(mResidue[i] - mResidue[j]) >= 3 && app->topology->minimalDifference(positions[i], positions[j]).normSquared() < cutoff2 ) {
+				contacts++;
+				mFrequency[i * n + j]++;
+				if( mNative[i * n + j] ) { native++; }
+			}
+		}
+	}
+	mFrames++;
+
+	file << step << " " << contacts << " " << native << " " << ( mNumNative > 0 ? (Real)native / mNumNative : 0.0 ) << endl;
+}
+
+void AnalysisContacts::doWrite(std::ostream &file) {
+	if( mFrames == 0 ) { return; }
+
+	const unsigned int n = mSelection.size();
+	file << endl << endl << "# atom atom frequency" << endl;
+	for( unsigned int i = 0; i < n; i++ ) {
+		for( unsigned int j = i + 1; j < n; j++ ) {
+			if( mFrequency[i * n + j] > 0 ) {
+				file << mSelection[i] + 1 << " " << mSelection[j] + 1 << " " << (Real)mFrequency[i * n + j] / mFrames << endl;
+			}
+		}
+	}
+}
+
+Analysis *AnalysisContacts::doMake(const vector<Value> &values) const {
+	string filename, atoms;
+	int frequency = 1;
+	Real cutoff = 8.0;
+	values[0].get(filename);
+	values[1].get(frequency);
+	values[2].get(atoms);
+	values[3].get(cutoff);
+
+	return new AnalysisContacts(filename, frequency, atoms, cutoff);
+}
+
+void AnalysisContacts::getParameters(vector<Parameter> &parameter) const {
+	AnalysisStream::getParameters(parameter);
+	parameter.push_back( Parameter( getId() + "Cutoff", Value( mCutoff, ConstraintValueType::Positive() ), 8.0, Text("contact distance") ) );
+}
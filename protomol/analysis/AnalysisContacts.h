@@ -0,0 +1,46 @@
+#ifndef PROTOMOL_ANALYSIS_CONTACTS_H
+#define PROTOMOL_ANALYSIS_CONTACTS_H
+
+#include <protomol/analysis/AnalysisStream.h>
+
+namespace ProtoMol {
+	/**
+	 * Contacts between the selected atoms, C-alpha by default, closer than
+	 * AnalyzeContactsCutoff and at least three residues apart.  One line
+	 * "step contacts native Q" per snapshot, Q is the fraction of the
+	 * contacts of the initial structure which are present.  At the end the
+	 * contact map is appended as "atom atom frequency" of all pairs ever
+	 * in contact.
+	 */
+	class AnalysisContacts : public AnalysisStream {
+		public:
+			static const std::string keyword;
+
+		private:
+			Real mCutoff;
+
+			std::vector<int> mResidue;
+			// / Pair (i, j), i < j, of selected atoms at i * size + j
+			std::vector<bool> mNative;
+			std::vector<int> mFrequency;
+			int mNumNative;
+			long mFrames;
+
+		public:
+			AnalysisContacts();
+			AnalysisContacts(const std::string &filename, int frequency, const std::string &atoms, Real cutoff);
+			virtual ~AnalysisContacts();
+
+		private:
+			Analysis *doMake (const std::vector<Value> &values) const;
+			void doStart (const Vector3DBlock &positions, std::ostream &file);
+			void doAnalyze (long step, Real volume, const Vector3DBlock &positions, std::ostream &file);
+			void doWrite (std::ostream &file);
+
+		public:
+			std::string getIdNoAlias() const { return keyword; }
+			void getParameters (std::vector<Parameter> &parameter) const;
+	};
+}
+
+#endif	// PROTOMOL_ANALYSIS_CONTACTS_H
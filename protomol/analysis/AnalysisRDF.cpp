@@ -0,0 +1,188 @@
+#include <protomol/analysis/AnalysisRDF.h>
+
+#include <protomol/topology/GenericTopology.h>
+#include <protomol/ProtoMolApp.h>
+
+#include <protomol/base/PMConstants.h>
+#include <protomol/base/Report.h>
+
+#include <algorithm>
+#include <math.h>
+
+using namespace std;
+using namespace ProtoMol::Report;
+using namespace ProtoMol;
+
+const string AnalysisRDF::keyword("AnalyzeRDF");
+
+AnalysisRDF::AnalysisRDF()
+	: AnalysisStream(), mCutoff(10.0), mBins(100), mFrames(0), mVolume(0.0) {}
+
+AnalysisRDF::AnalysisRDF(const std::string &filename, int frequency, const std::string &atoms, Real cutoff, int bins)
+	: AnalysisStream(filename, frequency, atoms), mCutoff(cutoff), mBins(bins), mFrames(0), mVolume(0.0) {}
+
+AnalysisRDF::~AnalysisRDF() {
+	join();
+}
+
+void AnalysisRDF::doStart(const Vector3DBlock &/*positions*/, std::ostream &/*file*/) {
+	mHistogram.assign(mBins, 0.0);
+	mFrames = 0;
+	mVolume = 0.0;
+
+	// Beyond half the box the pairs are not counted completely
+	if( app->topology->getVolume() < Constant::MAXREAL && app->topology->isOrthogonal() ) {
+		Vector3D min, max;
+		app->topology->getBoundaryConditionsBox(min, max);
+		const Vector3D width(max - min);
+		const Real half = 0.5 * std::min(width.c[0], std::min(width.c[1], width.c[2]));
+		if( mCutoff > half ) {
+			report << warning << "[" << getId() << "] Cutoff " << mCutoff << " reduced to half the box " << half << "." << endr;
+			mCutoff = half;
+		}
+	}
+}
+
+void AnalysisRDF::doAnalyze(long /*step*/, Real volume, const Vector3DBlock &positions, std::ostream &/*file*/) {
+	const GenericTopology *topo = app->topology;
+	const bool periodic = volume < Constant::MAXREAL;
+	const unsigned int n = positions.size();
+
+	mFrames++;
+	mVolume += volume;
+
+	// Cells of at least the cutoff, periodic grids need three per
+	// dimension not to see a neighbor twice
+	Vector3D min, max;
+	if( periodic ) {
+		if( !topo->isOrthogonal() ) {
+			countAllPairs(positions);
+			return;
+		}
+		topo->getBoundaryConditionsBox(min, max);
+	} else {
+		positions.boundingbox(min, max);
+	}
+
+	int dim[3];
+	for( int d = 0; d < 3; d++ ) {
+		dim[d] = std::max(1, std::min(128, (int)floor(( max.c[d] - min.c[d] ) / mCutoff)));
+		if( periodic && dim[d] < 3 ) {
+			countAllPairs(positions);
+			return;
+		}
+	}
+
+	// Link the atoms into their cells
+	vector<Vector3D> p(n);
+	mHead.assign(dim[0] * dim[1] * dim[2], -1);
+	mNext.resize(n);
+	for( unsigned int i = 0; i < n; i++ ) {
+		p[i] = periodic ? topo->minimalPosition(positions[i]) : Vector3D(positions[i]);
+
+		int c[3];
+		for( int d = 0; d < 3; d++ ) {
+			const Real width = max.c[d] - min.c[d];
+			c[d] = width > 0.0 ? (int)floor(( p[i].c[d] - min.c[d] ) / width * dim[d]) : 0;
+			c[d] = std::max(0, std::min(dim[d] - 1, c[d]));
+		}
+		const int cell = ( c[0] * dim[1] + c[1] ) * dim[2] + c[2];
+		mNext[i] = mHead[cell];
+		mHead[cell] = i;
+	}
+
+	// Each pair is found from both cells, count it from the lower index
+	const Real cutoff2 = mCutoff * mCutoff;
+	for( int cx = 0; cx < dim[0]; cx++ ) {
+		for( int cy = 0; cy < dim[1]; cy++ ) {
+			for( int cz = 0; cz < dim[2]; cz++ ) {
+				const int cell = ( cx * dim[1] + cy ) * dim[2] + cz;
+				if( mHead[cell] < 0 ) { continue; }
+
+				for( int nx = cx - 1; nx <= cx + 1; nx++ ) {
+					for( int ny = cy - 1; ny <= cy + 1; ny++ ) {
+						for( int nz = cz - 1; nz <= cz + 1; nz++ ) {
+							int k[3] = {nx, ny, nz};
+							bool inside = true;
+							for( int d = 0; d < 3; d++ ) {
+								if( periodic ) {
+									k[d] = ( k[d] + dim[d] ) % dim[d];
+								} else if( k[d] < 0 || k[d] >= dim[d] ) {
+									inside = false;
+								}
+							}
+							if( !inside ) { continue; }
+
+							const int neighbor = ( k[0] * dim[1] + k[1] ) * dim[2] + k[2];
+							for( int i = mHead[cell]; i >= 0; i = mNext[i] ) {
+								for( int j = mHead[neighbor]; j >= 0; j = mNext[j] ) {
+									if( j <= i ) { continue; }
+
+									const Vector3D d = periodic ? topo->minimalDifference(p[i], p[j]) : p[j] - p[i];
+									const Real r2 = d.normSquared();
+									if( r2 < cutoff2 ) {
+										mHistogram[std::min(mBins - 1, (int)( sqrt(r2) / mCutoff * mBins ))] += 1.0;
+									}
+								}
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+void AnalysisRDF::countAllPairs(const Vector3DBlock &positions) {
+	const Real cutoff2 = mCutoff * mCutoff;
+	for( unsigned int i = 0; i < positions.size(); i++ ) {
+		for( unsigned int j = i + 1; j < positions.size(); j++ ) {
+			const Real r2 = app->topology->minimalDifference(positions[i], positions[j]).normSquared();
+			if( r2 < cutoff2 ) {
+				mHistogram[std::min(mBins - 1, (int)( sqrt(r2) / mCutoff * mBins ))] += 1.0;
+			}
+		}
+	}
+}
+
+void AnalysisRDF::doWrite(std::ostream &file) {
+	if( mFrames == 0 ) { return; }
+
+	const Real n = mSelection.size();
+	const Real volume = mVolume / mFrames;
+	const bool periodic = volume < Constant::MAXREAL;
+	const Real dr = mCutoff / mBins;
+
+	file << ( periodic ? "# r g(r) pairs" : "# r pairs" ) << endl;
+	for( int k = 0; k < mBins; k++ ) {
+		const Real r = ( k + 0.5 ) * dr;
+		const Real pairs = mHistogram[k] / mFrames;
+		file << r;
+		if( periodic ) {
+			// Pairs of an ideal gas of the same density in the shell
+			const Real shell = 4.0 / 3.0 * M_PI * ( pow(( k + 1 ) * dr, 3) - pow(k * dr, 3));
+			const Real ideal = 0.5 * n * ( n - 1.0 ) / volume * shell;
+			file << " " << pairs / ideal;
+		}
+		file << " " << pairs << endl;
+	}
+}
+
+Analysis *AnalysisRDF::doMake(const vector<Value> &values) const {
+	string filename, atoms;
+	int frequency = 1, bins = 100;
+	Real cutoff = 10.0;
+	values[0].get(filename);
+	values[1].get(frequency);
+	values[2].get(atoms);
+	values[3].get(cutoff);
+	values[4].get(bins);
+
+	return new AnalysisRDF(filename, frequency, atoms, cutoff, bins);
+}
+
+void AnalysisRDF::getParameters(vector<Parameter> &parameter) const {
+	AnalysisStream::getParameters(parameter);
+	parameter.push_back( Parameter( getId() + "Cutoff", Value( mCutoff, ConstraintValueType::Positive() ), 10.0, Text("largest distance") ) );
+	parameter.push_back( Parameter( getId() + "Bins", Value( mBins, ConstraintValueType::Positive() ), 100, Text("number of bins") ) );
+}
@@ -0,0 +1,48 @@
+#ifndef PROTOMOL_ANALYSIS_RDF_H
+#define PROTOMOL_ANALYSIS_RDF_H
+
+#include <protomol/analysis/AnalysisStream.h>
+
+namespace ProtoMol {
+	/**
+	 * Radial distribution function g(r) of the selected atoms up to
+	 * AnalyzeRDFCutoff in AnalyzeRDFBins bins.  The pairs are found on a
+	 * linked cell grid with cells of the size of the cutoff, periodic for
+	 * rectangular boxes.  Skewed boxes fall back to all pairs.  In vacuum
+	 * there is no density, only the pair histogram per snapshot is written.
+	 */
+	class AnalysisRDF : public AnalysisStream {
+		public:
+			static const std::string keyword;
+
+		private:
+			Real mCutoff;
+			int mBins;
+
+			std::vector<Real> mHistogram;
+			long mFrames;
+			Real mVolume;
+
+			// / Linked cells of the worker, first atom and next atom
+			std::vector<int> mHead, mNext;
+
+		public:
+			AnalysisRDF();
+			AnalysisRDF(const std::string &filename, int frequency, const std::string &atoms, Real cutoff, int bins);
+			virtual ~AnalysisRDF();
+
+		private:
+			Analysis *doMake (const std::vector<Value> &values) const;
+			void doStart (const Vector3DBlock &positions, std::ostream &file);
+			void doAnalyze (long step, Real volume, const Vector3DBlock &positions, std::ostream &file);
+			void doWrite (std::ostream &file);
+
+			void countAllPairs (const Vector3DBlock &positions);
+
+		public:
+			std::string getIdNoAlias() const { return keyword; }
+			void getParameters (std::vector<Parameter> &parameter) const;
+	};
+}
+
+#endif	// PROTOMOL_ANALYSIS_RDF_H
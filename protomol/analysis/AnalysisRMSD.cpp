@@ -0,0 +1,49 @@
+#include <protomol/analysis/AnalysisRMSD.h>
+#include <protomol/analysis/Superposition.h>
+
+#include <math.h>
+
+using namespace std;
+using namespace ProtoMol;
+
+const string AnalysisRMSD::keyword("AnalyzeRMSD");
+
+AnalysisRMSD::AnalysisRMSD()
+	: AnalysisStream() {}
+
+AnalysisRMSD::AnalysisRMSD(const std::string &filename, int frequency, const std::string &atoms)
+	: AnalysisStream(filename, frequency, atoms) {}
+
+AnalysisRMSD::~AnalysisRMSD() {
+	join();
+}
+
+void AnalysisRMSD::doStart(const Vector3DBlock &positions, std::ostream &file) {
+	mReference = positions;
+	centerPositions(mReference);
+
+	file << "# step RMSD Rg" << endl;
+}
+
+void AnalysisRMSD::doAnalyze(long step, Real /*volume*/, const Vector3DBlock &positions, std::ostream &file) {
+	Vector3DBlock x(positions);
+	centerPositions(x);
+
+	Real gyration = 0.0;
+	for( unsigned int i = 0; i < x.size(); i++ ) {
+		gyration += x[i].normSquared();
+	}
+	gyration = sqrt(gyration / x.size());
+
+	file << step << " " << qcpSuperpose(mReference, x) << " " << gyration << endl;
+}
+
+Analysis *AnalysisRMSD::doMake(const vector<Value> &values) const {
+	string filename, atoms;
+	int frequency = 1;
+	values[0].get(filename);
+	values[1].get(frequency);
+	values[2].get(atoms);
+
+	return new AnalysisRMSD(filename, frequency, atoms);
+}
@@ -0,0 +1,35 @@
+#ifndef PROTOMOL_ANALYSIS_RMSD_H
+#define PROTOMOL_ANALYSIS_RMSD_H
+
+#include <protomol/analysis/AnalysisStream.h>
+
+namespace ProtoMol {
+	/**
+	 * RMSD of the selected atoms from the initial structure after optimal
+	 * superposition by QCP and their radius of gyration, one line
+	 * "step RMSD Rg" per snapshot.
+	 */
+	class AnalysisRMSD : public AnalysisStream {
+		public:
+			static const std::string keyword;
+
+		private:
+			// / Initial structure, centered
+			Vector3DBlock mReference;
+
+		public:
+			AnalysisRMSD();
+			AnalysisRMSD(const std::string &filename, int frequency, const std::string &atoms);
+			virtual ~AnalysisRMSD();
+
+		private:
+			Analysis *doMake (const std::vector<Value> &values) const;
+			void doStart (const Vector3DBlock &positions, std::ostream &file);
+			void doAnalyze (long step, Real volume, const Vector3DBlock &positions, std::ostream &file);
+
+		public:
+			std::string getIdNoAlias() const { return keyword; }
+	};
+}
+
+#endif	// PROTOMOL_ANALYSIS_RMSD_H
@@ -0,0 +1,69 @@
+#include <protomol/analysis/AnalysisRMSF.h>
+#include <protomol/analysis/Superposition.h>
+
+#include <protomol/topology/GenericTopology.h>
+#include <protomol/ProtoMolApp.h>
+
+#include <math.h>
+
+using namespace std;
+using namespace ProtoMol;
+
+const string AnalysisRMSF::keyword("AnalyzeRMSF");
+
+AnalysisRMSF::AnalysisRMSF()
+	: AnalysisStream(), mFrames(0) {}
+
+AnalysisRMSF::AnalysisRMSF(const std::string &filename, int frequency, const std::string &atoms)
+	: AnalysisStream(filename, frequency, atoms), mFrames(0) {}
+
+AnalysisRMSF::~AnalysisRMSF() {
+	join();
+}
+
+void AnalysisRMSF::doStart(const Vector3DBlock &positions, std::ostream &/*file*/) {
+	mReference = positions;
+	centerPositions(mReference);
+
+	mSum.assign(positions.size(), Vector3D(0.0, 0.0, 0.0));
+	mSumSquared.assign(positions.size(), 0.0);
+	mFrames = 0;
+}
+
+void AnalysisRMSF::doAnalyze(long /*step*/, Real /*volume*/, const Vector3DBlock &positions, std::ostream &/*file*/) {
+	Vector3DBlock x(positions);
+	centerPositions(x);
+
+	Matrix3By3 rotation;
+	qcpSuperpose(mReference, x, &rotation);
+
+	for( unsigned int i = 0; i < x.size(); i++ ) {
+		const Vector3D y(rotation * x[i]);
+		mSum[i] += y;
+		mSumSquared[i] += y.normSquared();
+	}
+	mFrames++;
+}
+
+void AnalysisRMSF::doWrite(std::ostream &file) {
+	if( mFrames == 0 ) { return; }
+
+	file << "# atom residue name RMSF" << endl;
+	for( unsigned int i = 0; i < mSelection.size(); i++ ) {
+		const Vector3D mean(mSum[i] / mFrames);
+		const Real msf = mSumSquared[i] / mFrames - mean.normSquared();
+		const Atom &atom = app->topology->atoms[mSelection[i]];
+
+		file << mSelection[i] + 1 << " " << atom.residue_seq << " " << atom.name << " " << ( msf > 0.0 ? sqrt(msf) : 0.0 ) << endl;
+	}
+}
+
+Analysis *AnalysisRMSF::doMake(const vector<Value> &values) const {
+	string filename, atoms;
+	int frequency = 1;
+	values[0].get(filename);
+	values[1].get(frequency);
+	values[2].get(atoms);
+
+	return new AnalysisRMSF(filename, frequency, atoms);
+}
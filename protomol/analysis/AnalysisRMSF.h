@@ -0,0 +1,40 @@
+#ifndef PROTOMOL_ANALYSIS_RMSF_H
+#define PROTOMOL_ANALYSIS_RMSF_H
+
+#include <protomol/analysis/AnalysisStream.h>
+
+namespace ProtoMol {
+	/**
+	 * Root mean square fluctuation of each selected atom about its mean
+	 * position.  The snapshots are superposed on the initial structure by
+	 * QCP, only the sums of the positions and of their squares are kept.
+	 * Written at the end as "atom residue name RMSF".
+	 */
+	class AnalysisRMSF : public AnalysisStream {
+		public:
+			static const std::string keyword;
+
+		private:
+			// / Initial structure, centered
+			Vector3DBlock mReference;
+			std::vector<Vector3D> mSum;
+			std::vector<Real> mSumSquared;
+			long mFrames;
+
+		public:
+			AnalysisRMSF();
+			AnalysisRMSF(const std::string &filename, int frequency, const std::string &atoms);
+			virtual ~AnalysisRMSF();
+
+		private:
+			Analysis *doMake (const std::vector<Value> &values) const;
+			void doStart (const Vector3DBlock &positions, std::ostream &file);
+			void doAnalyze (long step, Real volume, const Vector3DBlock &positions, std::ostream &file);
+			void doWrite (std::ostream &file);
+
+		public:
+			std::string getIdNoAlias() const { return keyword; }
+	};
+}
+
+#endif	// PROTOMOL_ANALYSIS_RMSF_H
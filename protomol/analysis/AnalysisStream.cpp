@@ -0,0 +1,189 @@
+#include <protomol/analysis/AnalysisStream.h>
+
+#include <protomol/config/Configuration.h>
+#include <protomol/topology/GenericTopology.h>
+#include <protomol/module/MainModule.h>
+#include <protomol/ProtoMolApp.h>
+
+#include <protomol/base/Exception.h>
+#include <protomol/base/Report.h>
+#include <protomol/base/StringUtilities.h>
+
+#include <algorithm>
+
+using namespace std;
+using namespace ProtoMol::Report;
+using namespace ProtoMol;
+
+AnalysisStream::AnalysisStream()
+	: Analysis(true), mFrequency(1), mLastStep(-1), mSnapshots(0), mRunning(false) {}
+
+AnalysisStream::AnalysisStream(const std::string &filename, int frequency, const std::string &atoms)
+	: Analysis(true), mFilename(filename), mFrequency(frequency), mAtoms(atoms), mLastStep(-1), mSnapshots(0), mRunning(false) {}
+
+AnalysisStream::~AnalysisStream() {}
+
+long AnalysisStream::getNext(long step) const {
+	return ( step / mFrequency + 1 ) * mFrequency;
+}
+
+void AnalysisStream::doInitialize() {
+	// Atom names separated by blanks or commas, wildcards allowed
+	string atoms(mAtoms);
+	replace(atoms.begin(), atoms.end(), ',', ' ');
+	const vector<string> names = splitString(atoms);
+
+	mSelection.clear();
+	for( unsigned int i = 0; i < app->topology->atoms.size(); i++ ) {
+		bool selected = names.empty();
+		for( unsigned int j = 0; j < names.size() && !selected; j++ ) {
+			selected = equalWildcard(names[j], app->topology->atoms[i].name) != 0;
+		}
+		if( selected ) {
+			mSelection.push_back(i);
+		}
+	}
+
+	if( mSelection.empty() ) {
+		THROWS("[" << getId() << "] No atoms named '" << mAtoms << "'.");
+	}
+
+	mFile.open(mFilename.c_str(), ios::out | ios::trunc);
+	if( !mFile ) {
+		THROWS("[" << getId() << "] Can not open '" << mFilename << "'.");
+	}
+
+	Vector3DBlock positions(mSelection.size());
+	for( unsigned int i = 0; i < mSelection.size(); i++ ) {
+		positions[i] = Vector3D(app->positions[mSelection[i]]);
+	}
+	doStart(positions, mFile);
+
+	report << plain << "[" << getId() << "] " << mSelection.size() << " atoms every " << mFrequency << " steps to " << mFilename << "." << endr;
+
+	mLastStep = -1;
+	mSnapshots = 0;
+	mRunning = true;
+#ifndef _WIN32
+	pthread_mutex_init(&mMutex, 0);
+	pthread_cond_init(&mCondition, 0);
+	if( pthread_create(&mThread, 0, worker, this) != 0 ) {
+		THROWS("[" << getId() << "] Could not start the worker thread.");
+	}
+#endif
+}
+
+void AnalysisStream::doRun(long step) {
+	if( step % mFrequency == 0 && step != mLastStep ) {
+		snapshot(step);
+	}
+}
+
+void AnalysisStream::doFinalize(long step) {
+	// The last step is not run through doRun()
+	doRun(step);
+	join();
+
+	doWrite(mFile);
+	mFile.close();
+
+	report << plain << "[" << getId() << "] " << mSnapshots << " snapshots reduced to " << mFilename << "." << endr;
+}
+
+void AnalysisStream::snapshot(long step) {
+	mLastStep = step;
+	mSnapshots++;
+
+	Vector3DBlock positions(mSelection.size());
+	for( unsigned int i = 0; i < mSelection.size(); i++ ) {
+		positions[i] = Vector3D(app->positions[mSelection[i]]);
+	}
+	const Real volume = app->topology->getVolume();
+
+#ifdef _WIN32
+	doAnalyze(step, volume, positions, mFile);
+#else
+	pthread_mutex_lock(&mMutex);
+	while( mQueue.size() >= MAX_PENDING ) {
+		pthread_cond_wait(&mCondition, &mMutex);
+	}
+	mQueue.push_back(Snapshot());
+	mQueue.back().step = step;
+	mQueue.back().volume = volume;
+	mQueue.back().positions.swap(positions);
+	pthread_cond_broadcast(&mCondition);
+	pthread_mutex_unlock(&mMutex);
+#endif
+}
+
+void AnalysisStream::join() {
+	if( !mRunning ) {
+		return;
+	}
+
+#ifndef _WIN32
+	pthread_mutex_lock(&mMutex);
+	mRunning = false;
+	pthread_cond_broadcast(&mCondition);
+	pthread_mutex_unlock(&mMutex);
+
+	pthread_join(mThread, 0);
+	pthread_cond_destroy(&mCondition);
+	pthread_mutex_destroy(&mMutex);
+#endif
+	mRunning = false;
+}
+
+#ifndef _WIN32
+void *AnalysisStream::worker(void *stream) {
+	static_cast<AnalysisStream *>( stream )->work();
+	return 0;
+}
+#endif
+
+void AnalysisStream::work() {
+#ifndef _WIN32
+	pthread_mutex_lock(&mMutex);
+	while( true ) {
+		while( mQueue.empty() && mRunning ) {
+			pthread_cond_wait(&mCondition, &mMutex);
+		}
+		if( mQueue.empty() ) {
+			break;
+		}
+
+		// The snapshot stays queued while it is analyzed, push_back() does
+		// not move it
+		const Snapshot &snapshot = mQueue.front();
+		pthread_mutex_unlock(&mMutex);
+
+		doAnalyze(snapshot.step, snapshot.volume, snapshot.positions, mFile);
+
+		pthread_mutex_lock(&mMutex);
+		mQueue.pop_front();
+		pthread_cond_broadcast(&mCondition);
+	}
+	pthread_mutex_unlock(&mMutex);
+#endif
+}
+
+void AnalysisStream::getParameters(vector<Parameter> &parameter) const {
+	parameter.push_back( Parameter( getId(), Value( mFilename, ConstraintValueType::NotEmpty() ) ) );
+	parameter.push_back( Parameter( getId() + "Frequency", Value( mFrequency, ConstraintValueType::Positive() ), Text("analysis frequency, outputfreq by default") ) );
+	parameter.push_back( Parameter( getId() + "Atoms", Value( mAtoms, ConstraintValueType::NoConstraints() ), mAtoms, Text("names of the analyzed atoms, all if empty") ) );
+}
+
+bool AnalysisStream::adjustWithDefaultParameters(vector<Value> &values, const Configuration *config) const {
+	if( !checkParameterTypes(values)) { return false; }
+
+	if( !values[1].valid() ) {
+		if( config->valid(InputOutputfreq::keyword) ) {
+			values[1] = ( *config )[InputOutputfreq::keyword];
+		} else {
+			values[1] = 1;
+		}
+	}
+	if( !values[2].valid()) { values[2] = mAtoms; }
+
+	return checkParameters(values);
+}
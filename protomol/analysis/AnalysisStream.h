@@ -0,0 +1,95 @@
+#ifndef PROTOMOL_ANALYSIS_STREAM_H
+#define PROTOMOL_ANALYSIS_STREAM_H
+
+#include <protomol/analysis/Analysis.h>
+#include <protomol/type/Vector3DBlock.h>
+
+#include <deque>
+#include <fstream>
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+namespace ProtoMol {
+	class Configuration;
+
+	/**
+	 * Base of the in-situ analyzers, which reduce the trajectory while it is
+	 * generated instead of writing it to disk.  Every <id>Frequency steps
+	 * the positions of the atoms named in <id>Atoms, all atoms by default,
+	 * are copied into a snapshot.  The snapshots are reduced by doAnalyze()
+	 * on a worker thread while the integrator carries on; if the worker
+	 * falls behind by more than MAX_PENDING snapshots the simulation waits.
+	 * At the end doWrite() appends the reductions to the file <id>.
+	 *
+	 * The worker calls the methods of the derived class, so finalize or the
+	 * destructor of the derived class must stop it with join().
+	 */
+	class AnalysisStream : public Analysis {
+		private:
+			struct Snapshot {
+				long step;
+				Real volume;
+				Vector3DBlock positions;
+			};
+
+			enum {MAX_PENDING = 2};
+
+		public:
+			AnalysisStream();
+			AnalysisStream(const std::string &filename, int frequency, const std::string &atoms);
+			virtual ~AnalysisStream();
+
+		public:
+			long getNext (long step) const;
+
+		protected:
+			// / Waits for the pending snapshots and stops the worker
+			void join ();
+
+		private:
+			void doInitialize ();
+			void doRun (long step);
+			void doFinalize (long step);
+
+			// / Called on the main thread before the worker starts, positions
+			// / holds the selected atoms, file is open
+			virtual void doStart (const Vector3DBlock &positions, std::ostream &file) = 0;
+			// / Reduces a snapshot of the selected atoms, called on the worker
+			virtual void doAnalyze (long step, Real volume, const Vector3DBlock &positions, std::ostream &file) = 0;
+			// / Writes the reductions after the last snapshot
+			virtual void doWrite (std::ostream &/*file*/) {}
+
+			void snapshot (long step);
+			void work ();
+#ifndef _WIN32
+			static void *worker (void *stream);
+#endif
+
+		public:
+			void getParameters (std::vector<Parameter> &parameter) const;
+			bool adjustWithDefaultParameters (std::vector<Value> &values, const Configuration *config) const;
+
+		protected:
+			std::string mFilename;
+			int mFrequency;
+			std::string mAtoms;
+			// / Atoms of the snapshots
+			std::vector<int> mSelection;
+
+		private:
+			std::ofstream mFile;
+			long mLastStep;
+			long mSnapshots;
+			std::deque<Snapshot> mQueue;
+			bool mRunning;
+#ifndef _WIN32
+			pthread_t mThread;
+			pthread_mutex_t mMutex;
+			pthread_cond_t mCondition;
+#endif
+	};
+}
+
+#endif	// PROTOMOL_ANALYSIS_STREAM_H
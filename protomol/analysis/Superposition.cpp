@@ -0,0 +1,142 @@
+#include <protomol/analysis/Superposition.h>
+
+#include <math.h>
+
+using namespace ProtoMol;
+
+//____ det3
+static Real det3(Real a00, Real a01, Real a02,
+		 Real a10, Real a11, Real a12,
+		 Real a20, Real a21, Real a22) {
+	return a00 * ( a11 * a22 - a12 * a21 ) - a01 * ( a10 * a22 - a12 * a20 ) + a02 * ( a10 * a21 - a11 * a20 );
+}
+
+//____ cofactor, entry (r, c) of the adjugate transposed
+static Real cofactor(const Real a[4][4], int r, int c) {
+	int row[3], col[3];
+	for( int i = 0, k = 0; i < 4; i++ ) {
+		if( i != r ) { row[k++] = i; }
+	}
+	for( int i = 0, k = 0; i < 4; i++ ) {
+		if( i != c ) { col[k++] = i; }
+	}
+
+	const Real d = det3(a[row[0]][col[0]], a[row[0]][col[1]], a[row[0]][col[2]],
+			    a[row[1]][col[0]], a[row[1]][col[1]], a[row[1]][col[2]],
+			    a[row[2]][col[0]], a[row[2]][col[1]], a[row[2]][col[2]]);
+	return ( r + c ) % 2 == 0 ? d : -d;
+}
+
+namespace ProtoMol {
+	void centerPositions(Vector3DBlock &positions) {
+		if( positions.size() == 0 ) { return; }
+
+		Vector3D sum(0.0, 0.0, 0.0);
+		for( unsigned int i = 0; i < positions.size(); i++ ) {
+			sum += positions[i];
+		}
+		sum /= positions.size();
+		for( unsigned int i = 0; i < positions.size(); i++ ) {
+			positions[i] -= sum;
+		}
+	}
+
+	Real qcpSuperpose(const Vector3DBlock &reference, const Vector3DBlock &positions, Matrix3By3 *rotation) {
+		const unsigned int n = reference.size();
+
+		// Inner product matrix S = sum_i x_i r_i^T and the norms
+		Real s[3][3] = {{0.0, 0.0, 0.0}, {0.0, 0.0, 0.0}, {0.0, 0.0, 0.0}};
+		Real g = 0.0;
+		for( unsigned int i = 0; i < n; i++ ) {
+			const Vector3D &r = reference[i];
+			const Vector3D &x = positions[i];
+			g += r.normSquared() + x.normSquared();
+			for( int a = 0; a < 3; a++ ) {
+				for( int b = 0; b < 3; b++ ) {
+					s[a][b] += x.c[a] * r.c[b];
+				}
+			}
+		}
+		const Real e0 = 0.5 * g;
+
+		const Real sxx = s[0][0], sxy = s[0][1], sxz = s[0][2];
+		const Real syx = s[1][0], syy = s[1][1], syz = s[1][2];
+		const Real szx = s[2][0], szy = s[2][1], szz = s[2][2];
+
+		Real k[4][4] = {
+			{sxx + syy + szz, syz - szy, szx - sxz, sxy - syx},
+			{syz - szy, sxx - syy - szz, sxy + syx, szx + sxz},
+			{szx - sxz, sxy + syx, -sxx + syy - szz, syz + szy},
+			{sxy - syx, szx + sxz, syz + szy, -sxx - syy + szz}
+		};
+
+		// Characteristic polynomial l^4 + c2 l^2 + c1 l + c0, the key
+		// matrix is traceless
+		Real c2 = 0.0;
+		for( int a = 0; a < 3; a++ ) {
+			for( int b = 0; b < 3; b++ ) {
+				c2 += s[a][b] * s[a][b];
+			}
+		}
+		c2 *= -2.0;
+		const Real c1 = -8.0 * det3(sxx, sxy, sxz, syx, syy, syz, szx, szy, szz);
+		Real c0 = 0.0;
+		for( int c = 0; c < 4; c++ ) {
+			c0 += k[0][c] * cofactor(k, 0, c);
+		}
+
+		// Newton from the upper bound e0 converges to the largest root
+		Real lambda = e0;
+		for( int i = 0; i < 50; i++ ) {
+			const Real l2 = lambda * lambda;
+			const Real b = ( l2 + c2 ) * lambda;
+			const Real a = b + c1;
+			const Real p = a * lambda + c0;
+			const Real dp = 2.0 * l2 * lambda + b + a;
+			if( dp == 0.0 ) { break; }
+
+			const Real delta = p / dp;
+			lambda -= delta;
+			if( fabs(delta) <= 1e-11 * fabs(lambda) ) { break; }
+		}
+
+		if( rotation ) {
+			for( int a = 0; a < 4; a++ ) {
+				k[a][a] -= lambda;
+			}
+
+			// Any row of the adjugate of the singular K - lambda is a
+			// multiple of the eigenvector, take the largest one
+			Real q[4] = {1.0, 0.0, 0.0, 0.0};
+			Real best = 0.0;
+			for( int r = 0; r < 4; r++ ) {
+				Real v[4], norm = 0.0;
+				for( int c = 0; c < 4; c++ ) {
+					v[c] = cofactor(k, r, c);
+					norm += v[c] * v[c];
+				}
+				if( norm > best ) {
+					best = norm;
+					for( int c = 0; c < 4; c++ ) { q[c] = v[c]; }
+				}
+			}
+
+			// Degenerate, e.g., identical or collinear sets
+			if( best <= 1e-24 * e0 * e0 * e0 * e0 * e0 * e0 ) {
+				q[0] = 1.0; q[1] = q[2] = q[3] = 0.0;
+				best = 1.0;
+			}
+
+			const Real norm = 1.0 / sqrt(best);
+			const Real w = q[0] * norm, x = q[1] * norm, y = q[2] * norm, z = q[3] * norm;
+
+			*rotation = Matrix3By3(w * w + x * x - y * y - z * z, 2.0 * ( x * y - w * z ), 2.0 * ( x * z + w * y ),
+					       2.0 * ( x * y + w * z ), w * w - x * x + y * y - z * z, 2.0 * ( y * z - w * x ),
+					       2.0 * ( x * z - w * y ), 2.0 * ( y * z + w * x ), w * w - x * x - y * y + z * z);
+		}
+
+		if( n == 0 ) { return 0.0; }
+		const Real msd = 2.0 * ( e0 - lambda ) / n;
+		return msd > 0.0 ? sqrt(msd) : 0.0;
+	}
+}
@@ -0,0 +1,24 @@
+#ifndef PROTOMOL_ANALYSIS_SUPERPOSITION_H
+#define PROTOMOL_ANALYSIS_SUPERPOSITION_H
+
+#include <protomol/type/Matrix3By3.h>
+#include <protomol/type/Vector3DBlock.h>
+
+namespace ProtoMol {
+	// / Moves the geometric center of positions to the origin
+	void centerPositions (Vector3DBlock &positions);
+
+	/**
+	 * Minimal RMSD of the centered sets reference and positions over all
+	 * rotations by the quaternion characteristic polynomial (QCP) of
+	 * Theobald, Acta Cryst. A61, 478 (2005): the largest eigenvalue of the
+	 * 4x4 key matrix is found by Newton's method on its characteristic
+	 * polynomial, no eigensolver or SVD is needed.  If rotation is given it
+	 * is set to the optimal rotation, rotation * positions[i] is superposed
+	 * on reference[i], computed from the eigenvector as the adjugate of the
+	 * shifted key matrix as in Liu et al., J. Comput. Chem. 31, 1561 (2010).
+	 */
+	Real qcpSuperpose (const Vector3DBlock &reference, const Vector3DBlock &positions, Matrix3By3 *rotation = 0);
+}
+
+#endif	// PROTOMOL_ANALYSIS_SUPERPOSITION_H
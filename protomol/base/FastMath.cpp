@@ -0,0 +1,275 @@
+#include <protomol/base/FastMath.h>
+
+#if defined(__SSE2__) && !defined(USE_REAL_IS_FLOAT)
+#define FASTMATH_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace ProtoMol;
+
+//____FastMath
+
+// 2^(j/64)
+const double Private::EXP2_TABLE[EXP2_TABLE_SIZE] = {
+  1.00000000000000000e+00, 1.01088928605170048e+00, 1.02189714865411663e+00,
+  1.03302487902122841e+00, 1.04427378242741375e+00, 1.05564517836055716e+00,
+  1.06714040067682370e+00, 1.07876079775711986e+00, 1.09050773266525769e+00,
+  1.10238258330784089e+00, 1.11438674259589243e+00, 1.12652161860824185e+00,
+  1.13878863475669156e+00, 1.15118922995298267e+00, 1.16372485877757748e+00,
+  1.17639699165028122e+00, 1.18920711500272103e+00, 1.20215673145270308e+00,
+  1.21524735998046896e+00, 1.22848053610687002e+00, 1.24185781207348400e+00,
+  1.25538075702469110e+00, 1.26905095719173322e+00, 1.28287001607877826e+00,
+  1.29683955465100964e+00, 1.31096121152476441e+00, 1.32523664315974132e+00,
+  1.33966752405330292e+00, 1.35425554693689265e+00, 1.36900242297459052e+00,
+  1.38390988196383202e+00, 1.39897967253831124e+00, 1.41421356237309515e+00,
+  1.42961333839197002e+00, 1.44518080697704665e+00, 1.46091779418064704e+00,
+  1.47682614593949935e+00, 1.49290772829126484e+00, 1.50916442759342284e+00,
+  1.52559815074453842e+00, 1.54221082540794074e+00, 1.55900440023783693e+00,
+  1.57598084510788650e+00, 1.59314215134226700e+00, 1.61049033194925428e+00,
+  1.62802742185734783e+00, 1.64575547815396495e+00, 1.66367658032673638e+00,
+  1.68179283050742900e+00, 1.70010635371852348e+00, 1.71861929812247793e+00,
+  1.73733383527370622e+00, 1.75625216037329945e+00, 1.77537649252652119e+00,
+  1.79470907500310717e+00, 1.81425217550039886e+00, 1.83400808640934243e+00,
+  1.85397912508338547e+00, 1.87416763411029996e+00, 1.89457598158696561e+00,
+  1.91520656139714740e+00, 1.93606179349229435e+00, 1.95714412417540018e+00,
+  1.97845602638795093e+00
+};
+
+// Power series in v in [-1, 1] of erfc(x) exp(x^2) / t on the interval
+// t in [j / 16, (j + 1) / 16], t = 2 / (2 + x)
+const double Private::ERFC_TABLE[ERFC_INTERVALS][ERFC_DEGREE + 1] = {
+  {2.91156762025160387e-01, 9.31401791202553925e-03,
+   2.57666453627927304e-04, 5.69757503537567823e-06,
+   7.83631821518141619e-08, -4.81143726519590139e-10,
+   -6.37093361284072759e-11, -1.52225088244516290e-12,
+   1.19823132897304650e-14},
+  {3.10862278409585635e-01, 1.04155108577616475e-02,
+   2.93677842485232782e-04, 6.29421758234682045e-06,
+   6.93225349612822022e-08, -1.36476186818682010e-09,
+   -8.24478848426537789e-11, -1.04231264822877522e-12,
+   4.98904544220400885e-14},
+  {3.32919425327173057e-01, 1.16678457360814749e-02,
+   3.32977316323664996e-04, 6.78053045901482835e-06,
+   5.04994222752529151e-08, -2.41543637237632968e-09,
+   -9.01010470901063427e-11, 5.03324234143084010e-14,
+   8.41690721749740055e-14},
+  {3.57641995266942236e-01, 1.30825269244872703e-02,
+   3.74657814405453585e-04, 7.07367590714802630e-06,
+   2.10510421286213256e-08, -3.45284998285652146e-09,
+   -7.93764657590808196e-11, 1.50398472611075929e-12,
+   9.16243354335636719e-14},
+  {3.85362491241913852e-01, 1.46664252244527414e-02,
+   4.17310988529235954e-04, 7.09227259202738156e-06,
+   -1.77196120961994885e-08, -4.23986978367642699e-09,
+   -4.87847906362039034e-11, 2.78017154051488384e-12,
+   6.23652364318950754e-14},
+  {4.16420901884924310e-01, 1.64198621714357063e-02,
+   4.59090426919494220e-04, 6.77477281436051054e-06,
+   -6.22063082903182665e-08, -4.56878724383332743e-09,
+   -4.64864711153935123e-12, 3.36991565054302161e-12,
+   9.56218129368993403e-15},
+  {4.51150044751298496e-01, 1.83351656706074104e-02,
+   4.97881765506156876e-04, 6.09551848151422432e-06,
+   -1.07229303488148159e-07, -4.34279034401261502e-09,
+   4.16646698816407965e-11, 3.09666509256000150e-12,
+   -4.14625895345860965e-14},
+  {4.89858815715926155e-01, 2.03960695347602215e-02,
+   5.31545948924263840e-04, 5.07228946143564123e-06,
+   -1.47344077233587825e-07, -3.60513353347467613e-09,
+   7.90640347366693970e-11, 2.15780730475037237e-12,
+   -7.16828217154722859e-14},
+  {5.32815249345052089e-01, 2.25781334553001346e-02,
+   5.58175311614288682e-04, 3.76305851951252990e-06,
+   -1.78130131871408193e-07, -2.50845916419916358e-09,
+   1.00855358015689623e-10, 9.41361379279569275e-13,
+   -7.65442878833708460e-14},
+  {5.80231398173225887e-01, 2.48501102712609806e-02,
+   5.76302565046335241e-04, 2.25420795860355906e-06,
+   -1.96983838401326097e-07, -1.25244546495061826e-09,
+   1.05828137726847613e-10, -1.89934102396489075e-13,
+   -6.26277579179262364e-14},
+  {6.32251677552903235e-01, 2.71759875199010237e-02,
+   5.85025167647896735e-04, 6.44958188235132976e-07,
+   -2.03277943798454291e-07, -2.43712183439616230e-11,
+   9.69171643016513702e-11, -1.01725206190660263e-12,
+   -4.01825563563681027e-14},
+  {6.88945665764383874e-01, 2.95173389579279841e-02,
+   5.84036805148297118e-04, -9.67369694056700823e-07,
+   -1.98032022771452154e-07, 1.03755007811618771e-09,
+   7.90010323748541747e-11, -1.47644840026778854e-12,
+   -1.77115266897232004e-14},
+  {7.50305621495371056e-01, 3.18356382116670444e-02,
+   5.73580762354279823e-04, -2.49833764667704979e-06,
+   -1.83345957977256437e-07, 1.85558894576028233e-09,
+   5.70320141421751527e-11, -1.61025186240504325e-12,
+   7.13164095679353959e-18},
+  {8.16248363554618939e-01, 3.40942728156470101e-02,
+   5.54351488685109000e-04, -3.88265516986646686e-06,
+   -1.61816431391597413e-07, 2.40607296432394779e-09,
+   3.49541042329562233e-11, -1.51034046380615905e-12,
+   1.14603542705143327e-14},
+  {8.86620743877520323e-01, 3.62601073152929373e-02,
+   5.27371845113746131e-04, -5.07617452000910190e-06,
+   -1.36067085577372876e-07, 2.70453392301071994e-09,
+   1.53447908315026035e-11, -1.27426772837206203e-12,
+   1.72265751046612411e-14},
+  {9.61207746787531070e-01, 3.83045452106738418e-02,
+   4.93868408462588685e-04, -6.05475676998390185e-06,
+   -1.08438058969320993e-07, 2.78960702926708536e-09,
+   -4.81894809550236707e-13, -9.82434427020272137e-13,
+   1.87007045651357538e-14}
+};
+
+//____ Lanes
+
+#ifdef FASTMATH_SSE2
+namespace {
+  const double SQRT2 = 1.41421356237309515e+00;
+
+  inline __m128d splat(double x) {
+    return _mm_set1_pd(x);
+  }
+
+  inline __m128i splat64(Private::uint64 i) {
+    return _mm_set_epi32(static_cast<int>(i >> 32), static_cast<int>(i),
+                         static_cast<int>(i >> 32), static_cast<int>(i));
+  }
+
+  // a where mask is set, else b
+  inline __m128d select(__m128d mask, __m128d a, __m128d b) {
+    return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+  }
+
+  // 2^n for integer n + ROUND_SHIFT in k, |n| <= 1022
+  inline __m128d pow2(__m128d k) {
+    // n + 2^51 are the low bits of k, adding 1023 - 2^51 leaves the biased
+    // exponent there, above it the exponent of k is shifted out
+    const __m128i bias =
+      splat64((static_cast<Private::uint64>(1) << 51) - 1023);
+    return _mm_castsi128_pd(_mm_slli_epi64(_mm_sub_epi64(_mm_castpd_si128(k),
+                                                         bias), 52));
+  }
+
+  // exp(x) on two lanes, x = n ln2 + r, |r| <= ln2 / 2, Taylor series to
+  // r^13 and 2^n = 2^n1 2^n2 such that n = 1024 does not overflow
+  inline __m128d expLanes(__m128d x) {
+    using namespace Private;
+    __m128d y = _mm_min_pd(_mm_max_pd(x, splat(EXP_MIN)), splat(EXP_MAX));
+    __m128d k = _mm_add_pd(_mm_mul_pd(y, splat(LOG2E)), splat(ROUND_SHIFT));
+    __m128d n = _mm_sub_pd(k, splat(ROUND_SHIFT));
+    __m128d r = _mm_sub_pd(_mm_sub_pd(y, _mm_mul_pd(n, splat(LN2_HI))),
+                           _mm_mul_pd(n, splat(LN2_LO)));
+
+    __m128d p = splat(1.0 / 6227020800.0);
+    const double c[] = {1.0 / 479001600.0, 1.0 / 39916800.0,
+                        1.0 / 3628800.0, 1.0 / 362880.0, 1.0 / 40320.0,
+                        1.0 / 5040.0, 1.0 / 720.0, 1.0 / 120.0, 1.0 / 24.0,
+                        1.0 / 6.0, 0.5, 1.0, 1.0};
+    for (unsigned int i = 0; i < sizeof(c) / sizeof(c[0]); i++)
+      p = _mm_add_pd(_mm_mul_pd(p, r), splat(c[i]));
+
+    __m128d n1 = _mm_sub_pd(_mm_add_pd(_mm_mul_pd(n, splat(0.5)),
+                                       splat(ROUND_SHIFT)),
+                            splat(ROUND_SHIFT));
+    __m128d n2 = _mm_sub_pd(n, n1);
+    p = _mm_mul_pd(_mm_mul_pd(p, pow2(_mm_add_pd(n1, splat(ROUND_SHIFT)))),
+                   pow2(_mm_add_pd(n2, splat(ROUND_SHIFT))));
+
+    p = _mm_andnot_pd(_mm_cmplt_pd(x, splat(EXP_MIN)), p);
+    return select(_mm_cmpgt_pd(x, splat(EXP_MAX)), splat(HUGE_VAL), p);
+  }
+
+  // erfc(x) exp(x^2) on two lanes, as Private::scaledErfc
+  inline __m128d scaledErfcLanes(__m128d x) {
+    using namespace Private;
+    __m128d t = _mm_div_pd(splat(2.0), _mm_add_pd(splat(2.0), x));
+    // j <= 16 for t <= 1, the 16 bit minimum is the one of the int32
+    __m128i j = _mm_cvttpd_epi32(_mm_mul_pd(t, splat(ERFC_INTERVALS)));
+    j = _mm_min_epi16(j, _mm_set1_epi32(ERFC_INTERVALS - 1));
+    __m128d v = _mm_sub_pd(_mm_mul_pd(t, splat(2.0 * ERFC_INTERVALS)),
+                           _mm_add_pd(_mm_cvtepi32_pd(_mm_add_epi32(j, j)),
+                                      splat(1.0)));
+
+    const double *a0 = ERFC_TABLE[_mm_cvtsi128_si32(j)];
+    const double *a1 = ERFC_TABLE[_mm_cvtsi128_si32(_mm_srli_si128(j, 4))];
+    __m128d g = _mm_set_pd(a1[ERFC_DEGREE], a0[ERFC_DEGREE]);
+    for (int i = ERFC_DEGREE - 1; i >= 0; --i)
+      g = _mm_add_pd(_mm_mul_pd(g, v), _mm_set_pd(a1[i], a0[i]));
+
+    return _mm_mul_pd(t, g);
+  }
+
+  // log(x) on two lanes, x = 2^e m, m in [sqrt(1/2), sqrt(2)), and
+  // log(m) = 2 atanh(s), s = (m - 1) / (m + 1), as a series to s^21
+  inline __m128d logLanes(__m128d x) {
+    using namespace Private;
+    const __m128i bits = _mm_castpd_si128(x);
+    const __m128d one = splat(1.0);
+
+    // The biased exponent as a double, by adding it into 2^52
+    __m128d e = _mm_sub_pd(_mm_castsi128_pd(
+                             _mm_or_si128(_mm_srli_epi64(bits, 52),
+                                          _mm_castpd_si128(splat(4503599627370496.0)))),
+                           splat(4503599627370496.0 + 1023.0));
+    __m128d m = _mm_castsi128_pd(_mm_or_si128(
+                                   _mm_and_si128(bits, splat64(MANTISSA_MASK)),
+                                   _mm_castpd_si128(one)));
+    __m128d large = _mm_cmpgt_pd(m, splat(SQRT2));
+    m = select(large, _mm_mul_pd(m, splat(0.5)), m);
+    e = _mm_add_pd(e, _mm_and_pd(large, one));
+
+    __m128d s = _mm_div_pd(_mm_sub_pd(m, one), _mm_add_pd(m, one));
+    __m128d z = _mm_mul_pd(s, s);
+    __m128d q = splat(2.0 / 21.0);
+    for (int i = 19; i >= 3; i -= 2)
+      q = _mm_add_pd(_mm_mul_pd(q, z), splat(2.0 / i));
+    // log(m) = 2 s + s z q, the exponent part split as ln2 for expSum
+    __m128d lo = _mm_add_pd(_mm_mul_pd(e, splat(LN2_LO)),
+                            _mm_mul_pd(_mm_mul_pd(s, z), q));
+    return _mm_add_pd(_mm_add_pd(_mm_mul_pd(e, splat(LN2_HI)),
+                                 _mm_add_pd(s, s)), lo);
+  }
+}
+#endif
+
+void ProtoMol::fastExp(unsigned int n, const Real *x, Real *y) {
+  unsigned int i = 0;
+#ifdef FASTMATH_SSE2
+  for (; i + 1 < n; i += 2)
+    _mm_storeu_pd(y + i, expLanes(_mm_loadu_pd(x + i)));
+#endif
+  for (; i < n; i++) y[i] = fastExp(x[i]);
+}
+
+void ProtoMol::fastErfcExp(unsigned int n, const Real *x, Real *erfc,
+                           Real *expNegX2) {
+  unsigned int i = 0;
+#ifdef FASTMATH_SSE2
+  for (; i + 1 < n; i += 2) {
+    __m128d xi = _mm_loadu_pd(x + i);
+    __m128d e = expLanes(_mm_sub_pd(_mm_setzero_pd(), _mm_mul_pd(xi, xi)));
+    _mm_storeu_pd(expNegX2 + i, e);
+    _mm_storeu_pd(erfc + i, _mm_mul_pd(scaledErfcLanes(xi), e));
+  }
+#endif
+  for (; i < n; i++) erfc[i] = fastErfcExp(x[i], expNegX2[i]);
+}
+
+void ProtoMol::fastLog(unsigned int n, const Real *x, Real *y) {
+  unsigned int i = 0;
+#ifdef FASTMATH_SSE2
+  for (; i + 1 < n; i += 2)
+    _mm_storeu_pd(y + i, logLanes(_mm_loadu_pd(x + i)));
+#endif
+  for (; i < n; i++) y[i] = log(x[i]);
+}
+
+void ProtoMol::fastRsqrt(unsigned int n, const Real *x, Real *y) {
+  unsigned int i = 0;
+#ifdef FASTMATH_SSE2
+  for (; i + 1 < n; i += 2)
+    _mm_storeu_pd(y + i, _mm_div_pd(_mm_set1_pd(1.0),
+                                    _mm_sqrt_pd(_mm_loadu_pd(x + i))));
+#endif
+  for (; i < n; i++) y[i] = 1.0 / sqrt(x[i]);
+}
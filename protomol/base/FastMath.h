@@ -0,0 +1,152 @@
+/*  -*- c++ -*-  */
+#ifndef FASTMATH_H
+#define FASTMATH_H
+
+#include <protomol/type/Real.h>
+#include <protomol/type/TypeSelection.h>
+
+#include <cmath>
+#include <cstring>
+
+namespace ProtoMol {
+  /**
+   * Replacements of exp, erfc, log and 1 / sqrt for the inner loops of the
+   * pair kernels. They do not call into libm. The scalar functions are
+   * inline and branch free apart from small table lookups. The lane
+   * functions take n arguments at a time, which they evaluate on two SSE2
+   * lanes where available, else with the scalar functions.
+   *
+   * Maximal errors measured against glibc over their ranges, checked by
+   * test/unit/FastMathTest.cpp:
+   *   fastExp      1 ulp, 2 ulp on lanes, x in [-708, 709.78], 0 below,
+   *                inf above
+   *   fastErfcExp  20 ulp for erfc, from the rounding of x^2, and exp as
+   *                fastExp, x in [0, 6], 1e-13 relative for erfc up to 26
+   *   fastLog      2 ulp on lanes, normal x > 0
+   *   fastRsqrt    1 ulp on lanes, x > 0
+   */
+  namespace Private {
+    typedef TypeSelection::Int<8>::type int64;
+    typedef TypeSelection::UInt<8>::type uint64;
+
+    // Mask of the mantissa of a double
+    const uint64 MANTISSA_MASK = static_cast<uint64>(0x000fffffUL) << 32 |
+      0xffffffffUL;
+
+    enum {EXP2_TABLE_SIZE = 64};
+    enum {ERFC_INTERVALS = 16};
+    enum {ERFC_DEGREE = 8};
+
+    /// 2^(j / 64)
+    extern const double EXP2_TABLE[EXP2_TABLE_SIZE];
+    /// Power series of erfc(x) exp(x^2) / t, t = 2 / (2 + x), over the
+    /// intervals [j / 16, (j + 1) / 16] of t, mapped to [-1, 1]
+    extern const double ERFC_TABLE[ERFC_INTERVALS][ERFC_DEGREE + 1];
+
+    inline uint64 realBits(double x) {
+      uint64 i;
+      memcpy(&i, &x, sizeof(i));
+      return i;
+    }
+
+    inline double bitsReal(uint64 i) {
+      double x;
+      memcpy(&x, &i, sizeof(x));
+      return x;
+    }
+
+    // ln(2) split for Cody-Waite reduction, the high part has 32 bits
+    const double LN2_HI = 6.93147180369123816490e-01;
+    const double LN2_LO = 1.90821492927058770002e-10;
+    const double LOG2E = 1.44269504088896338700e+00;
+    const double EXP_MAX = 7.09782712893383973096e+02;
+    const double EXP_MIN = -708.0;
+    // 1.5 * 2^52, adding it rounds to an integer kept in the low bits
+    const double ROUND_SHIFT = 6755399441055744.0;
+
+    // exp(hi + lo), |lo| much smaller than |hi|
+    inline double expSum(double hi, double lo) {
+      double y = hi + lo;
+      bool clamp = y < EXP_MIN || y > EXP_MAX;
+      hi = clamp ? (y < EXP_MIN ? EXP_MIN : EXP_MAX) : hi;
+      lo = clamp ? 0.0 : lo;
+
+      // x = n ln2 / 64 + r, |r| <= ln2 / 128, hi - n ln2_hi / 64 is exact
+      double k = (hi + lo) * (LOG2E * EXP2_TABLE_SIZE) + ROUND_SHIFT;
+      double n = k - ROUND_SHIFT;
+      double r = (hi - n * (LN2_HI / EXP2_TABLE_SIZE)) +
+        (lo - n * (LN2_LO / EXP2_TABLE_SIZE));
+
+      // Taylor series to r^6, truncation below 2^-60
+      double p = 1.0 / 720.0;
+      p = p * r + 1.0 / 120.0;
+      p = p * r + 1.0 / 24.0;
+      p = p * r + 1.0 / 6.0;
+      p = p * r + 0.5;
+      p = p * r * r + r;
+
+      // 2^(n / 64) = 2^m 2^(j / 64), n + 2^51 is in the low bits of k,
+      // 2^m is added to the exponent of the result
+      int64 ni = static_cast<int64>(realBits(k) & MANTISSA_MASK) -
+        (static_cast<int64>(1) << 51);
+      double t = EXP2_TABLE[ni & (EXP2_TABLE_SIZE - 1)];
+      double res = bitsReal(realBits(t + t * p) +
+                            (static_cast<uint64>(ni >> 6) << 52));
+
+      return y < EXP_MIN ? 0.0 : (y > EXP_MAX ? HUGE_VAL : res);
+    }
+  }
+
+  //____ fastExp
+  inline Real fastExp(Real x) {
+    return Private::expSum(x, 0.0);
+  }
+
+  //____ fastRint
+  /// Nearest integer as rint(), for |x| < 2^51 in the default rounding mode,
+  /// without a library call.
+  inline Real fastRint(Real x) {
+    return (x + Private::ROUND_SHIFT) - Private::ROUND_SHIFT;
+  }
+
+  namespace Private {
+    // erfc(x) exp(x^2) for x >= 0
+    inline double scaledErfc(double x) {
+      double t = 2.0 / (2.0 + x);
+      int j = static_cast<int>(t * ERFC_INTERVALS);
+      j = j < ERFC_INTERVALS ? j : ERFC_INTERVALS - 1;
+      double v = 2.0 * ERFC_INTERVALS * t - (2 * j + 1);
+
+      const double *a = ERFC_TABLE[j];
+      double g = a[ERFC_DEGREE];
+      for (int i = ERFC_DEGREE - 1; i >= 0; --i)
+        g = g * v + a[i];
+
+      return t * g;
+    }
+  }
+
+  //____ fastErfcExp
+  /**
+   * erfc(x) for x >= 0 together with expNegX2 = exp(-x^2), as needed by
+   * the real space Ewald term, for the cost of one exp. The error of erfc
+   * grows with the rounding of x^2, as the one of exp(-x^2).
+   */
+  inline Real fastErfcExp(Real x, Real &expNegX2) {
+    expNegX2 = fastExp(-x * x);
+    return Private::scaledErfc(x) * expNegX2;
+  }
+
+  //____ Lane functions
+  /// y[i] = exp(x[i]) for i < n, as fastExp
+  void fastExp(unsigned int n, const Real *x, Real *y);
+  /// erfc[i] = erfc(x[i]), expNegX2[i] = exp(-x[i]^2) for i < n and
+  /// x[i] >= 0, as fastErfcExp
+  void fastErfcExp(unsigned int n, const Real *x, Real *erfc,
+                   Real *expNegX2);
+  /// y[i] = log(x[i]) for i < n and normal x[i] > 0
+  void fastLog(unsigned int n, const Real *x, Real *y);
+  /// y[i] = 1 / sqrt(x[i]) for i < n and x[i] > 0
+  void fastRsqrt(unsigned int n, const Real *x, Real *y);
+}
+#endif /* FASTMATH_H */
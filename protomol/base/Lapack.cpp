@@ -1,7 +1,10 @@
 #include "Lapack.h"
 
+#include <protomol/base/LapackBuiltin.h>
 #include <protomol/base/Exception.h>
 
+#include <string>
+
 #if defined(HAVE_LAPACK)
 #include <protomol/integrator/hessian/LapackProtomol.h>
 #elif defined(HAVE_SIMTK_LAPACK)
@@ -45,7 +48,7 @@ void ProtoMol::Lapack::dgemv(char *transA, int *m, int *n, double *alpha,
 #elif defined(HAVE_MKL_LAPACK)
   DGEMV(transA, m, n, alpha, A, lda, x, incx, beta, Y, incY);
 #else
-  THROW(__func__ " not supported");
+  LapackBuiltin::dgemv(transA, m, n, alpha, A, lda, x, incx, beta, Y, incY);
 #endif
 }
 
@@ -61,7 +64,7 @@ void ProtoMol::Lapack::dsyev(char *jobz, char *uplo, int *n, double *a,
 #elif defined(HAVE_MKL_LAPACK)
   DSYEV(jobz, uplo, n, a, lda, w, work, lwork, info);
 #else
-  THROW(__func__ " not supported");
+  LapackBuiltin::dsyev(jobz, uplo, n, a, lda, w, work, lwork, info);
 #endif
 }
 
@@ -83,7 +86,8 @@ void ProtoMol::Lapack::dsyevr(char *jobz, char *range, char *uplo, int *n,
   DSYEVR(jobz, range, uplo, n, a, lda, vl, vu, il, iu, abstol, m, w, z, ldz,
          isuppz, work, lwork, iwork, liwork, info);
 #else
-  THROW(__func__ " not supported");
+  LapackBuiltin::dsyevr(jobz, range, uplo, n, a, lda, vl, vu, il, iu, abstol, m,
+                        w, z, ldz, isuppz, work, lwork, iwork, liwork, info);
 #endif
 }
 
@@ -97,7 +101,7 @@ double ProtoMol::Lapack::dlamch(char *cmach) {
 #elif defined(HAVE_MKL_LAPACK)
   return DLAMCH(cmach);
 #else
-  THROW(__func__ " not supported");
+  return LapackBuiltin::dlamch(cmach);
 #endif
 }
 
@@ -113,7 +117,8 @@ void ProtoMol::Lapack::dgemm(char *transA, char *transB, int *m, int *n, int *k,
 #elif defined(HAVE_MKL_LAPACK)
   DGEMM(transA, transB, m, n, k, alpha, A, lda, B, ldb, beta, C, l);
 #else
-  THROW(__func__ " not supported");
+  LapackBuiltin::dgemm(transA, transB, m, n, k, alpha, A, lda, B, ldb, beta, C,
+                       l);
 #endif
 }
 
@@ -128,7 +133,7 @@ double ProtoMol::Lapack::ddot(int *n, double *x, int *incx, double *y,
 #elif defined(HAVE_MKL_LAPACK)
   return DDOT(n, x, incx, y, incy);
 #else
-  THROW(__func__ " not supported");
+  return LapackBuiltin::ddot(n, x, incx, y, incy);
 #endif
 }
 
@@ -142,7 +147,7 @@ double ProtoMol::Lapack::dnrm2(int *n, double *x, int *incx) {
 #elif defined(HAVE_MKL_LAPACK)
   return DNRM2(n, x, incx);
 #else
-  THROW(__func__ " not supported");
+  return LapackBuiltin::dnrm2(n, x, incx);
 #endif
 }
 
@@ -155,7 +160,9 @@ void ProtoMol::Lapack::dpotri(char *transA, int *n, double *A, int *lda,
 #elif defined(HAVE_MKL_LAPACK)
   DPOTRI(transA, n, A, lda, info);
 #else
-  THROW(__func__ " not supported");
+  // The arguments are unused without a library, here and below
+  (void)transA; (void)n; (void)A; (void)lda; (void)info;
+  THROW(std::string(__func__) + " not supported");
 #endif
 }
 
@@ -168,7 +175,8 @@ void ProtoMol::Lapack::dpotrf(char *transA, int *n, double *A, int *lda,
 #elif defined(HAVE_MKL_LAPACK)
   DPOTRF(transA, n, A, lda, info);
 #else
-  THROW(__func__ " not supported");
+  (void)transA; (void)n; (void)A; (void)lda; (void)info;
+  THROW(std::string(__func__) + " not supported");
 #endif
 }
 
@@ -181,7 +189,9 @@ void ProtoMol::Lapack::dposv(char *transA, int *n, int *nrhs, double *a,
 #elif defined(HAVE_MKL_LAPACK)
   DPOSV(transA, n, nrhs, a, lda, b, ldb, info);
 #else
-  THROW(__func__ " not supported");
+  (void)transA; (void)n; (void)nrhs; (void)a; (void)lda; (void)b;
+  (void)ldb; (void)info;
+  THROW(std::string(__func__) + " not supported");
 #endif
 }
 
@@ -195,7 +205,9 @@ void ProtoMol::Lapack::dtrmm(char *sideA, char *ulA, char *transA, char *diagA,
 #elif defined(HAVE_MKL_LAPACK)
   DTRMM(sideA, ulA, transA, diagA, m, n, alpha, A, lda, B, ldb);
 #else
-  THROW(__func__ " not supported");
+  (void)sideA; (void)ulA; (void)transA; (void)diagA; (void)m; (void)n;
+  (void)alpha; (void)A; (void)lda; (void)B; (void)ldb;
+  THROW(std::string(__func__) + " not supported");
 #endif
 }
 
@@ -209,6 +221,8 @@ void ProtoMol::Lapack::dtrsm(char *sideA, char *ulA, char *transA, char *diagA,
 #elif defined(HAVE_MKL_LAPACK)
   DTRSM(sideA, ulA, transA, diagA, m, n, alpha, A, lda, B, ldb);
 #else
-  THROW(__func__ " not supported");
+  (void)sideA; (void)ulA; (void)transA; (void)diagA; (void)m; (void)n;
+  (void)alpha; (void)A; (void)lda; (void)B; (void)ldb;
+  THROW(std::string(__func__) + " not supported");
 #endif
 }
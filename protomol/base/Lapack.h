@@ -2,7 +2,13 @@
 #define PROTOMOL_LAPACK_H
 
 namespace ProtoMol {
+  /**
+   * Facade of the BLAS and LAPACK routines. Without a LAPACK library
+   * dgemv, dgemm, ddot, dnrm2, dlamch, dsyev and dsyevr run on the built-in
+   * kernels of LapackBuiltin, the Cholesky and triangular routines throw.
+   */
   namespace Lapack {
+    /// True if built against a LAPACK library
     bool isEnabled();
     void dgemv(char *transA, int *m, int *n, double *alpha, double *A,
                int *lda, double *x, int *incx, double *beta, double *Y,
@@ -0,0 +1,461 @@
+#include <protomol/base/LapackBuiltin.h>
+
+#include <algorithm>
+#include <vector>
+#include <cctype>
+#include <cfloat>
+#include <cmath>
+
+using namespace std;
+using namespace ProtoMol;
+
+//____ dgemm packs a KC x NC block of op(B) and a MC x KC block of op(A),
+//____ both in slivers of NR columns and MR rows, and runs the MR x NR
+//____ kernel over them
+enum {MR = 4, NR = 4, MC = 128, KC = 256, NC = 512};
+
+//____ Partial sums of the dot products
+enum {LANES = 8};
+
+static bool option(const char *c, char value) {
+  return toupper(*c) == value;
+}
+
+static bool transposed(const char *trans) {
+  return option(trans, 'T') || option(trans, 'C');
+}
+
+// First element of a strided BLAS vector
+static int first(int n, int inc) {
+  return inc > 0 ? 0 : (1 - n) * inc;
+}
+
+static double dot(int n, const double *x, const double *y) {
+  double lane[LANES] = {0.0};
+  int i = 0;
+  for (; i + LANES <= n; i += LANES)
+    for (int l = 0; l < LANES; l++) lane[l] += x[i + l] * y[i + l];
+
+  double sum = 0.0;
+  for (int l = 0; l < LANES; l++) sum += lane[l];
+  for (; i < n; i++) sum += x[i] * y[i];
+
+  return sum;
+}
+
+// sqrt(a^2 + b^2) without overflow
+static double pythag(double a, double b) {
+  const double x = fabs(a), y = fabs(b);
+  if (x > y) return x * sqrt(1.0 + (y / x) * (y / x));
+  if (y == 0.0) return 0.0;
+  return y * sqrt(1.0 + (x / y) * (x / y));
+}
+
+//____ MR x NR block of C of a sliver of packed A and B
+static void kernel(int kc, const double *a, const double *b,
+                   double c[NR][MR]) {
+  for (int j = 0; j < NR; j++)
+    for (int i = 0; i < MR; i++) c[j][i] = 0.0;
+
+  for (int p = 0; p < kc; p++, a += MR, b += NR)
+    for (int j = 0; j < NR; j++) {
+      const double bj = b[j];
+      for (int i = 0; i < MR; i++) c[j][i] += a[i] * bj;
+    }
+}
+
+//____ Eigenvalues of the symmetric matrix in the uplo triangle of a in
+//____ ascending order, with vectors the eigenvectors as the columns of z,
+//____ n x n. Returns 0 or the index + 1 of an eigenvalue that did not
+//____ converge, like info of the reference routines.
+static int symmetricEigen(bool vectors, bool upper, int n, const double *a,
+                          int lda, double *w, vector<double> &z) {
+  // Copy of the lower triangle, the reduction only works on that
+  vector<double> h(n * n);
+  for (int j = 0; j < n; j++)
+    for (int i = j; i < n; i++)
+      h[i + j * n] = upper ? a[j + i * lda] : a[i + j * lda];
+
+  // Householder reduction to tridiagonal, step k reflects rows and
+  // columns k + 1 to n - 1 such that column k becomes (d_k, e_k, 0, ...).
+  // The reflection vector v is kept in column k below e_k.
+  vector<double> d(n), e(n), tau(n, 0.0), p(n), q(n);
+  for (int k = 0; k + 2 < n; k++) {
+    const int len = n - k - 1;
+    double *v = &h[k * n + k + 1];
+    d[k] = h[k * n + k];
+
+    const double norm = sqrt(dot(len, v, v));
+    if (norm == 0.0) {
+      e[k] = 0.0;
+      continue;
+    }
+
+    const double alpha = v[0] > 0.0 ? -norm : norm;
+    v[0] -= alpha;
+    const double t = 2.0 / dot(len, v, v);
+    tau[k] = t;
+    e[k] = alpha;
+
+    // p = t B v of the trailing block B, from the lower triangle column j
+    // adds B_jj v_j and B_ij v_i to p_j and B_ij v_j to p_i below
+    for (int i = 0; i < len; i++) p[i] = 0.0;
+    for (int j = 0; j < len; j++) {
+      const double *b = &h[(k + 1 + j) * n + k + 1];
+      const double vj = t * v[j];
+      p[j] += t * dot(len - j, b + j, v + j);
+      for (int i = j + 1; i < len; i++) p[i] += b[i] * vj;
+    }
+
+    // B = B - v q^T - q v^T, q = p - (t / 2 v^T p) v, lower triangle
+    const double kv = 0.5 * t * dot(len, v, &p[0]);
+    for (int i = 0; i < len; i++) q[i] = p[i] - kv * v[i];
+    for (int j = 0; j < len; j++) {
+      double *b = &h[(k + 1 + j) * n + k + 1];
+      const double vj = v[j], qj = q[j];
+      for (int i = j; i < len; i++) b[i] -= v[i] * qj + q[i] * vj;
+    }
+  }
+  if (n > 1) {
+    d[n - 2] = h[(n - 2) * n + n - 2];
+    e[n - 2] = h[(n - 2) * n + n - 1];
+  }
+  d[n - 1] = h[(n - 1) * n + n - 1];
+  e[n - 1] = 0.0;
+
+  // Product of the reflections, applied backwards to the identity, step k
+  // only changes the trailing block from k + 1
+  if (vectors) {
+    z.assign(n * n, 0.0);
+    for (int i = 0; i < n; i++) z[i * n + i] = 1.0;
+    for (int k = n - 3; k >= 0; k--) {
+      if (tau[k] == 0.0) continue;
+      const int len = n - k - 1;
+      const double *v = &h[k * n + k + 1];
+      for (int j = k + 1; j < n; j++) {
+        double *c = &z[j * n + k + 1];
+        const double s = tau[k] * dot(len, v, c);
+        for (int i = 0; i < len; i++) c[i] -= s * v[i];
+      }
+    }
+  }
+
+  // Implicit QL with Wilkinson shifts on (d, e), e_i couples d_i and
+  // d_i+1, the rotations act on neighboring columns of z
+  const double eps = DBL_EPSILON;
+  double f = 0.0, tst1 = 0.0;
+  for (int l = 0; l < n; l++) {
+    tst1 = max(tst1, fabs(d[l]) + fabs(e[l]));
+    int m = l;
+    while (m < n - 1 && fabs(e[m]) > eps * tst1) m++;
+
+    if (m > l) {
+      int iter = 0;
+      do {
+        if (++iter > 30) return l + 1;
+
+        double g = d[l];
+        double pl = (d[l + 1] - g) / (2.0 * e[l]);
+        double r = pythag(pl, 1.0);
+        if (pl < 0.0) r = -r;
+        d[l] = e[l] / (pl + r);
+        d[l + 1] = e[l] * (pl + r);
+        const double dl1 = d[l + 1];
+        double hl = g - d[l];
+        for (int i = l + 2; i < n; i++) d[i] -= hl;
+        f += hl;
+
+        pl = d[m];
+        double c = 1.0, c2 = 1.0, c3 = 1.0, s = 0.0, s2 = 0.0;
+        const double el1 = e[l + 1];
+        for (int i = m - 1; i >= l; i--) {
+          c3 = c2;
+          c2 = c;
+          s2 = s;
+          g = c * e[i];
+          hl = c * pl;
+          r = pythag(pl, e[i]);
+          e[i + 1] = s * r;
+          s = e[i] / r;
+          c = pl / r;
+          pl = c * d[i] - s * g;
+          d[i + 1] = hl + s * (c * g + s * d[i]);
+
+          if (vectors) {
+            double *zi = &z[i * n], *zi1 = &z[(i + 1) * n];
+            for (int k = 0; k < n; k++) {
+              const double zk = zi1[k];
+              zi1[k] = s * zi[k] + c * zk;
+              zi[k] = c * zi[k] - s * zk;
+            }
+          }
+        }
+        pl = -s * s2 * c3 * el1 * e[l] / dl1;
+        e[l] = s * pl;
+        d[l] = c * pl;
+      } while (fabs(e[l]) > eps * tst1);
+    }
+    d[l] += f;
+    e[l] = 0.0;
+  }
+
+  // Ascending order
+  for (int i = 0; i < n; i++) {
+    int k = i;
+    for (int j = i + 1; j < n; j++)
+      if (d[j] < d[k]) k = j;
+    if (k == i) continue;
+
+    swap(d[i], d[k]);
+    if (vectors)
+      swap_ranges(z.begin() + i * n, z.begin() + (i + 1) * n,
+                  z.begin() + k * n);
+  }
+
+  copy(d.begin(), d.end(), w);
+  return 0;
+}
+
+//____ LapackBuiltin
+
+void LapackBuiltin::dgemv(char *transA, int *m, int *n, double *alpha,
+                          double *A, int *lda, double *x, int *incx,
+                          double *beta, double *Y, int *incY) {
+  if (*m <= 0 || *n <= 0) return;
+
+  const bool trans = transposed(transA);
+  const int lenX = trans ? *m : *n;
+  const int lenY = trans ? *n : *m;
+  const int fx = first(lenX, *incx), fy = first(lenY, *incY);
+
+  // Contiguous copies of the strided vectors, alpha applied to x
+  vector<double> xs(lenX), ys(lenY);
+  for (int i = 0; i < lenX; i++) xs[i] = *alpha * x[fx + i * *incx];
+  for (int i = 0; i < lenY; i++)
+    ys[i] = *beta == 0.0 ? 0.0 : *beta * Y[fy + i * *incY];
+
+  if (*alpha != 0.0) {
+    if (trans)
+      for (int j = 0; j < *n; j++)
+        ys[j] += dot(*m, A + j * *lda, &xs[0]);
+
+    else {
+      // Four columns at a time, one pass over y for four updates
+      int j = 0;
+      for (; j + 4 <= *n; j += 4) {
+        const double *a0 = A + j * *lda, *a1 = a0 + *lda, *a2 = a1 + *lda,
+          *a3 = a2 + *lda;
+        const double x0 = xs[j], x1 = xs[j + 1], x2 = xs[j + 2],
+          x3 = xs[j + 3];
+        for (int i = 0; i < *m; i++)
+          ys[i] += a0[i] * x0 + a1[i] * x1 + a2[i] * x2 + a3[i] * x3;
+      }
+      for (; j < *n; j++) {
+        const double *a = A + j * *lda;
+        for (int i = 0; i < *m; i++) ys[i] += a[i] * xs[j];
+      }
+    }
+  }
+
+  for (int i = 0; i < lenY; i++) Y[fy + i * *incY] = ys[i];
+}
+
+
+void LapackBuiltin::dgemm(char *transA, char *transB, int *m, int *n, int *k,
+                          double *alpha, double *A, int *lda, double *B,
+                          int *ldb, double *beta, double *C, int *l) {
+  const int M = *m, N = *n, K = *k, ldc = *l;
+  if (M <= 0 || N <= 0) return;
+
+  // C = beta C, C is not read for beta 0
+  for (int j = 0; j < N; j++) {
+    double *c = C + j * ldc;
+    if (*beta == 0.0) fill(c, c + M, 0.0);
+    else if (*beta != 1.0)
+      for (int i = 0; i < M; i++) c[i] *= *beta;
+  }
+  if (*alpha == 0.0 || K <= 0) return;
+
+  const bool ta = transposed(transA), tb = transposed(transB);
+  const int strideA = ta ? 1 : *lda, stepA = ta ? *lda : 1;
+  const int strideB = tb ? *ldb : 1, stepB = tb ? 1 : *ldb;
+
+  vector<double> packA(((MC + MR - 1) / MR) * MR * KC);
+  vector<double> packB(((NC + NR - 1) / NR) * NR * KC);
+  double c[NR][MR];
+
+  for (int jc = 0; jc < N; jc += NC) {
+    const int nc = min((int)NC, N - jc);
+
+    for (int pc = 0; pc < K; pc += KC) {
+      const int kc = min((int)KC, K - pc);
+
+      // op(B)(p, j) = B[p * strideB + j * stepB], padded with zeros
+      for (int jr = 0; jr < nc; jr += NR) {
+        double *b = &packB[jr * kc];
+        for (int p = 0; p < kc; p++)
+          for (int j = 0; j < NR; j++)
+            *b++ = jr + j < nc ?
+              B[(pc + p) * strideB + (jc + jr + j) * stepB] : 0.0;
+      }
+
+      for (int ic = 0; ic < M; ic += MC) {
+        const int mc = min((int)MC, M - ic);
+
+        // op(A)(i, p) = A[i * stepA + p * strideA], padded with zeros
+        for (int ir = 0; ir < mc; ir += MR) {
+          double *a = &packA[ir * kc];
+          for (int p = 0; p < kc; p++)
+            for (int i = 0; i < MR; i++)
+              *a++ = ir + i < mc ?
+                A[(ic + ir + i) * stepA + (pc + p) * strideA] : 0.0;
+        }
+
+        for (int jr = 0; jr < nc; jr += NR)
+          for (int ir = 0; ir < mc; ir += MR) {
+            kernel(kc, &packA[ir * kc], &packB[jr * kc], c);
+
+            const int nr = min((int)NR, nc - jr), mr = min((int)MR, mc - ir);
+            for (int j = 0; j < nr; j++) {
+              double *cj = C + (ic + ir) + (jc + jr + j) * ldc;
+              for (int i = 0; i < mr; i++) cj[i] += *alpha * c[j][i];
+            }
+          }
+      }
+    }
+  }
+}
+
+
+double LapackBuiltin::ddot(int *n, double *x, int *incx, double *y,
+                           int *incy) {
+  if (*n <= 0) return 0.0;
+  if (*incx == 1 && *incy == 1) return dot(*n, x, y);
+
+  const int fx = first(*n, *incx), fy = first(*n, *incy);
+  double sum = 0.0;
+  for (int i = 0; i < *n; i++)
+    sum += x[fx + i * *incx] * y[fy + i * *incy];
+
+  return sum;
+}
+
+
+double LapackBuiltin::dnrm2(int *n, double *x, int *incx) {
+  if (*n <= 0 || *incx <= 0) return 0.0;
+
+  // Scaled sum of squares, scale * sqrt(ssq)
+  double scale = 0.0, ssq = 1.0;
+  for (int i = 0; i < *n; i++) {
+    const double a = fabs(x[i * *incx]);
+    if (a == 0.0) continue;
+
+    if (scale < a) {
+      ssq = 1.0 + ssq * (scale / a) * (scale / a);
+      scale = a;
+    } else ssq += (a / scale) * (a / scale);
+  }
+
+  return scale * sqrt(ssq);
+}
+
+
+double LapackBuiltin::dlamch(char *cmach) {
+  // Rounding arithmetic, eps is half the distance from 1 to the next number
+  const double eps = 0.5 * DBL_EPSILON;
+
+  switch (toupper(*cmach)) {
+  case 'E': return eps;
+  case 'S': {
+    const double small = 1.0 / DBL_MAX;
+    return small >= DBL_MIN ? small * (1.0 + eps) : DBL_MIN;
+  }
+  case 'B': return FLT_RADIX;
+  case 'P': return eps * FLT_RADIX;
+  case 'N': return DBL_MANT_DIG;
+  case 'R': return 1.0;
+  case 'M': return DBL_MIN_EXP;
+  case 'U': return DBL_MIN;
+  case 'L': return DBL_MAX_EXP;
+  case 'O': return DBL_MAX;
+  }
+
+  return 0.0;
+}
+
+
+void LapackBuiltin::dsyev(char *jobz, char *uplo, int *n, double *a,
+                          int *lda, double *w, double *work, int *lwork,
+                          int *info) {
+  *info = 0;
+  if (*n < 0) {
+    *info = -3;
+    return;
+  }
+
+  // Size query, the minimal size of the reference routine
+  if (*lwork == -1) {
+    work[0] = max(1, 3 * *n - 1);
+    return;
+  }
+  if (*n == 0) return;
+
+  const bool vectors = option(jobz, 'V');
+  vector<double> z;
+  *info = symmetricEigen(vectors, option(uplo, 'U'), *n, a, *lda, w, z);
+
+  if (vectors && *info == 0)
+    for (int j = 0; j < *n; j++)
+      copy(z.begin() + j * *n, z.begin() + (j + 1) * *n, a + j * *lda);
+}
+
+
+void LapackBuiltin::dsyevr(char *jobz, char *range, char *uplo, int *n,
+                           double *a, int *lda, double *vl, double *vu,
+                           int *il, int *iu, double *, int *m,
+                           double *w, double *z,  int *ldz, int *isuppz,
+                           double *work, int *lwork, int *iwork, int *liwork,
+                           int *info) {
+  *info = 0;
+  *m = 0;
+  if (*n < 0) {
+    *info = -4;
+    return;
+  }
+
+  // Size query, the minimal sizes of the reference routine
+  if (*lwork == -1 || *liwork == -1) {
+    work[0] = 26 * max(1, *n);
+    iwork[0] = 10 * max(1, *n);
+    return;
+  }
+  if (*n == 0) return;
+
+  const bool vectors = option(jobz, 'V');
+  vector<double> values(*n), vecs;
+  *info = symmetricEigen(vectors, option(uplo, 'U'), *n, a, *lda,
+                         &values[0], vecs);
+  if (*info != 0) return;
+
+  // Selected range, all, by index il to iu or by value in (vl, vu]
+  int lo = 0, hi = *n;
+  if (option(range, 'I')) {
+    lo = *il - 1;
+    hi = *iu;
+  } else if (option(range, 'V')) {
+    while (lo < *n && values[lo] <= *vl) lo++;
+    hi = lo;
+    while (hi < *n && values[hi] <= *vu) hi++;
+  }
+
+  *m = max(0, hi - lo);
+  for (int j = 0; j < *m; j++) {
+    w[j] = values[lo + j];
+    if (vectors) {
+      copy(vecs.begin() + (lo + j) * *n, vecs.begin() + (lo + j + 1) * *n,
+           z + j * *ldz);
+      isuppz[2 * j] = 1;
+      isuppz[2 * j + 1] = *n;
+    }
+  }
+}
@@ -0,0 +1,37 @@
+#ifndef PROTOMOL_LAPACK_BUILTIN_H
+#define PROTOMOL_LAPACK_BUILTIN_H
+
+namespace ProtoMol {
+  /**
+   * Built-in replacements of the BLAS and LAPACK routines the Hessian and
+   * normal mode code needs, used by the Lapack facade when ProtoMol is
+   * built without a LAPACK library. Arguments and results follow the
+   * reference routines, column major storage.
+   *
+   * dgemm works on packed blocks of A and B that stay in cache, with a 4x4
+   * register block of C in the inner kernel. dsyev and dsyevr reduce the
+   * matrix to tridiagonal form by Householder reflections and diagonalize
+   * that with the implicit QL method; abstol is ignored and the work
+   * arrays are only used for the size queries.
+   */
+  namespace LapackBuiltin {
+    void dgemv(char *transA, int *m, int *n, double *alpha, double *A,
+               int *lda, double *x, int *incx, double *beta, double *Y,
+               int *incY);
+    void dgemm(char *transA, char *transB, int *m, int *n, int *k,
+               double *alpha, double *A, int *lda, double *B, int *ldb,
+               double *beta, double *C, int *l);
+    double ddot(int *n, double *x, int *incx, double *y, int *incy);
+    double dnrm2(int *n, double *x, int *incx);
+    double dlamch(char *cmach);
+    void dsyev(char *jobz, char *uplo, int *n, double *a, int *lda,
+               double *w, double *work, int *lwork, int *info);
+    void dsyevr(char *jobz, char *range, char *uplo, int *n, double *a,
+                int *lda, double *vl, double *vu, int *il, int *iu,
+                double *abstol, int *m, double *w, double *z,  int *ldz,
+                int *isuppz, double *work, int *lwork, int *iwork,
+                int *liwork, int *info);
+  }
+}
+
+#endif // PROTOMOL_LAPACK_BUILTIN_H
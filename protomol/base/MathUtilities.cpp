@@ -6,6 +6,7 @@ using namespace std;
 namespace ProtoMol {
   namespace Rand{
     bool isSeeded = false;
+    bool hasGaussian = false;
   }
 
 //____ erf
@@ -185,6 +186,12 @@ namespace ProtoMol {
     }
   }
 
+//____ reseedRandomNumber()
+  void reseedRandomNumber() {
+    Rand::isSeeded = false;
+    Rand::hasGaussian = false;
+  }
+
 //____ randomGaussian()
 //____  This section generates a Gaussian random
 //____  deviate of 0.0 mean and standard deviation RFD for
@@ -204,8 +211,6 @@ namespace ProtoMol {
 
 //____ randomGaussianNumber()
   Real randomGaussianNumber(unsigned int seed) {
-    static bool iset = false;
-
     static Real gset = 0;
 
     Real fac = 0.,
@@ -213,7 +218,7 @@ namespace ProtoMol {
          v1 = 0.,
          v2 = 0.;
 
-    if (!iset) { // we do not have an extra result ready,
+    if (!Rand::hasGaussian) { // we do not have an extra result ready,
       while (r >= 1.0 || r < 1.523e-8) { // make sure we are within unit circle
         v1 = 2.0 * randomNumber(seed) - 1.0;
 
@@ -228,11 +233,11 @@ namespace ProtoMol {
       // distributed random numbers. Save one and return the other.
       gset = v1 * fac;
 
-      iset = true;
+      Rand::hasGaussian = true;
 
       return v2 * fac;
     } else { // use previously computed value
-      iset = false;
+      Rand::hasGaussian = false;
 
       return gset;
     }
@@ -200,6 +200,10 @@ namespace ProtoMol {
   //_____________________________________________________________ randomNumber()
   Real randomNumber(unsigned int seed = 1234);
   Real randomNumber(unsigned int seed, unsigned int randomtype);
+  //_______________________________________________________ reseedRandomNumber()
+  /// The next randomNumber() seeds the generator with its argument again and
+  /// randomGaussianNumber() drops its spare deviate, as at the start of a run
+  void reseedRandomNumber();
   //___________________________________________________________ randomGaussian()
   Real randomGaussian(Real sdv, unsigned int seed = 1234);
   //_____________________________________________________ randomGaussianNumber()
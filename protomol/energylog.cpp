@@ -0,0 +1,58 @@
+#include <protomol/io/EnergyLogReader.h>
+#include <protomol/base/StringUtilities.h>
+#include <protomol/base/Exception.h>
+
+#include <iostream>
+#include <iomanip>
+#include <limits>
+
+using namespace std;
+using namespace ProtoMol;
+
+//____ Prints an energyLogFile as text, optionally only a range of steps
+int main(int argc, char *argv[]) {
+  long first = numeric_limits<long>::min();
+  long last = numeric_limits<long>::max();
+
+  if (argc < 2 || argc > 4 || (argc > 2 && !toLong(argv[2], first)) ||
+      (argc > 3 && !toLong(argv[3], last))) {
+    cerr << "Usage: " << argv[0] << " <energy log> [<first step> "
+         << "[<last step>]]" << endl;
+    return 1;
+  }
+
+  try {
+    EnergyLogReader reader(argv[1]);
+    if (!reader.readHeader())
+      THROWS("Can not read energy log '" << argv[1] << "'");
+
+    const vector<string> &columns = reader.getColumns();
+
+    // Step as an integer, the values with the 17 digits that read back as
+    // the same doubles
+    cout << setw(12) << columns[0];
+    for (unsigned int j = 1; j < columns.size(); j++)
+      cout << " " << setw(24) << columns[j];
+    cout << "\n" << setprecision(17);
+
+    while (reader.read(first, last))
+      for (unsigned int i = 0; i < reader.getRows(); i++) {
+        const long step = (long)reader.getValue(i, 0);
+        if (step < first || step > last) continue;
+
+        cout << setw(12) << step;
+        for (unsigned int j = 1; j < columns.size(); j++)
+          cout << " " << setw(24) << reader.getValue(i, j);
+        cout << "\n";
+      }
+
+    cout << flush;
+
+    return 0;
+
+  } catch (const Exception &e) {
+    cerr << "ERROR: " << e << endl;
+  }
+
+  return 1;
+}
@@ -4,6 +4,7 @@
 #include <protomol/type/SimpleTypes.h>
 #include <protomol/force/CompareForce.h>
 #include <protomol/force/TimeForce.h>
+#include <protomol/force/system/SystemAutoForce.h>
 #include <protomol/parallel/Parallel.h>
 #include <algorithm>
 #include <sstream>
@@ -21,6 +22,16 @@ ForceFactory::~ForceFactory() {}
 Force *ForceFactory::make(const string &idInput, vector<Value> values) const {
   // Just try .. and see if we can find it directly
   string id = normalizeString(idInput);
+
+  // -algorithm Auto, time and compare are resolved on the actual force
+  if (!equalStartNocase(CompareForce::keyword, id) &&
+      !equalStartNocase(TimeForce::keyword, id)) {
+    vector<string> splitId(splitForceString(id));
+    for (unsigned int i = 1; i < splitId.size(); ++i)
+      if (equalNocase(splitId[i], "-algorithm " + SystemAutoForce::keyword))
+        return makeAuto(id);
+  }
+
   const Force *prototype = getPrototype(id);
   
   // Check that paramter size matches values
@@ -241,6 +252,110 @@ Force *ForceFactory::make(const string &idInput, vector<Value> values) const {
   return newObj;
 }
 
+Force *ForceFactory::makeAuto(const string &id) const {
+  if (!cache) updateCache();
+
+  vector<string> splitId(splitForceString(id));
+
+  // Find the force keyword(s) as make() does
+  string keyword = splitId[0];
+  forceTypes_t::const_iterator itr = forceTypes.find(keyword);
+  if (itr == forceTypes.end()) {
+    vector<string> tmp(splitString(keyword));
+    sort(tmp.begin(), tmp.end(), ltstrNocaseOp);
+    if (forceTypesSorted.find(mergeString(tmp)) != forceTypesSorted.end())
+      itr = forceTypes.find(forceTypesSorted[mergeString(tmp)]);
+  }
+  if (itr == forceTypes.end())
+    THROW(" Could not find any match for \'" + id + "\' in " +
+          Force::scope + "Factory.");
+  keyword = itr->first;
+
+  // Everything but the algorithm and the tolerance is passed on
+  string rest;
+  Real tolerance = SystemAutoForce::defaultTolerance;
+  bool blockSize = false;
+  for (unsigned int i = 1; i < splitId.size(); ++i) {
+    vector<string> tmp(splitString(splitId[i]));
+    if (equalNocase(tmp[0], "-algorithm"))
+      continue;
+    if (equalNocase(tmp[0], "-tolerance")) {
+      if (tmp.size() != 2 || !toReal(tmp[1], tolerance) || tolerance < 0.0)
+        THROW(keyword + " -algorithm " + SystemAutoForce::keyword +
+              ": 0 <= tolerance (=" + splitId[i] + ").");
+      continue;
+    }
+    if (equalNocase(tmp[0], "-blocksize"))
+      blockSize = true;
+    rest += " " + splitId[i];
+  }
+
+  // All algorithms accepting the policies and parameters, the most complete
+  // one first as reference
+  const string reference[] = {"FullEwald", "NonbondedFull",
+                              "NonbondedSimpleFull"};
+  const unsigned int numReferences = 3;
+  vector<vector<SystemForce *> > ranked(numReferences + 1);
+  for (policy_t::const_iterator j = itr->second.policy.begin();
+       j != itr->second.policy.end(); ++j) {
+    vector<string> tmp(splitString(*j));
+    if (tmp.size() != 2 || !equalNocase(tmp[0], "-algorithm") ||
+        equalNocase(tmp[1], "NonbondedIntermittentFull"))
+      continue;
+
+    unsigned int rank = 0;
+    while (rank < numReferences && !equalNocase(tmp[1], reference[rank]))
+      ++rank;
+
+    const string algorithm = keyword + " " + *j + rest;
+    vector<string> ids(1, algorithm);
+    for (unsigned int k = 0; k < ids.size(); ++k) {
+      Force *force = NULL;
+      try {
+        force = make(ids[k]);
+      } catch (Exception &) {
+        continue;
+      }
+
+      SystemForce *systemForce = dynamic_cast<SystemForce *>(force);
+      if (systemForce == NULL) {
+        delete force;
+        continue;
+      }
+      ranked[rank].push_back(systemForce);
+
+      // Block size variants if none was given
+      vector<Parameter> parameters;
+      if (k == 0 && !blockSize) force->getParameters(parameters);
+      for (unsigned int l = 0; l < parameters.size(); ++l) {
+        int current = 0;
+        if (!equalNocase(parameters[l].keyword, "-blocksize") ||
+            !parameters[l].value.get(current))
+          continue;
+        for (int size = 16; size <= 256; size *= 2)
+          if (size != current)
+            ids.push_back(algorithm + " -blocksize " + toString(size));
+      }
+    }
+  }
+
+  vector<SystemForce *> candidates;
+  for (unsigned int i = 0; i < ranked.size(); ++i)
+    candidates.insert(candidates.end(), ranked[i].begin(), ranked[i].end());
+
+  if (candidates.empty())
+    THROW(" Could not find any algorithm of force \'" + keyword +
+          "\' for \'" + id + "\' in " + Force::scope + "Factory.");
+
+  if (candidates.size() == 1) {
+    report << hint << "Using \'" << candidates[0]->getId() << "\' for \'"
+           << id << "\'." << endr;
+    return candidates[0];
+  }
+
+  return new SystemAutoForce(id, candidates, tolerance);
+}
+
 ostream &ForceFactory::print(ostream &stream) const {
   if (!cache) updateCache();
 
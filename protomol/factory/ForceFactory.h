@@ -51,6 +51,8 @@ namespace ProtoMol {
     splitForceStringSorted(const std::string &id) const;
     std::string sortForceString(const std::string &id) const;
     std::string uniqueForceString(const std::string &id) const;
+    /// Makes the candidates of -algorithm Auto
+    Force *makeAuto(const std::string &id) const;
   };
 }
 #endif /* FORCE_FACTORY_H */
@@ -89,35 +89,9 @@ void CompareForce::postprocess(const GenericTopology *topo,
 
   } else if (!Parallel::isParallel()) {
        // Compute the error of your choice.
-    const ScalarStructure *comparedEnergies = myCompareForce->getEnergies();
-    const Vector3DBlock *comparedForces = myCompareForce->getForces();
-    Real difftotal = 0.0;
-    Real total = 0.0;
-    Real errmax = 0.0;
-    Real abserrmax = 0.0;
-    for (unsigned int i = 0; i < forces->size(); i++) {
-      Real rm = 1.0 / topo->atoms[i].scaledMass;
-      Real diff = ((*myForces)[i] - (*comparedForces)[i]).normSquared();
-      Real errfmag = sqrt(diff * rm);
-      Real fmag = sqrt((*myForces)[i].normSquared() * rm);
-      if (errfmag > errmax)
-        errmax = errfmag;
-      difftotal += errfmag;
-      total += fmag;
-      if (diff > abserrmax)
-        abserrmax = diff;
-    }
-
-    CompareError theError(sqrt(abserrmax),
-                          (total != 0.0 ? difftotal / total : 0.0),
-                          (total != 0.0 ? forces->size() * errmax /
-                           total : 0.0),
-                          (myEnergies->potentialEnergy() != 0.0 ?
-                           fabs(
-                             (comparedEnergies->potentialEnergy() -
-                              myEnergies->potentialEnergy()) /
-                             myEnergies->potentialEnergy()) :
-                           0.0));
+    CompareError theError = compare(topo, *myForces, *myEnergies,
+                                    *myCompareForce->getForces(),
+                                    *myCompareForce->getEnergies());
 
     myErrors.push_back(theError);
 
@@ -131,6 +105,37 @@ void CompareForce::postprocess(const GenericTopology *topo,
   }
 }
 
+CompareForce::CompareError
+CompareForce::compare(const GenericTopology *topo, const Vector3DBlock &forces,
+                      const ScalarStructure &energies,
+                      const Vector3DBlock &comparedForces,
+                      const ScalarStructure &comparedEnergies) {
+  Real difftotal = 0.0;
+  Real total = 0.0;
+  Real errmax = 0.0;
+  Real abserrmax = 0.0;
+  for (unsigned int i = 0; i < forces.size(); i++) {
+    Real rm = 1.0 / topo->atoms[i].scaledMass;
+    Real diff = (forces[i] - comparedForces[i]).normSquared();
+    Real errfmag = sqrt(diff * rm);
+    Real fmag = sqrt(forces[i].normSquared() * rm);
+    if (errfmag > errmax)
+      errmax = errfmag;
+    difftotal += errfmag;
+    total += fmag;
+    if (diff > abserrmax)
+      abserrmax = diff;
+  }
+
+  return CompareError(sqrt(abserrmax),
+                      (total != 0.0 ? difftotal / total : 0.0),
+                      (total != 0.0 ? forces.size() * errmax / total : 0.0),
+                      (energies.potentialEnergy() != 0.0 ?
+                       fabs((comparedEnergies.potentialEnergy() -
+                             energies.potentialEnergy()) /
+                            energies.potentialEnergy()) : 0.0));
+}
+
 void CompareForce::getParameters(vector<Parameter> &parameters) const {
   myActualForce->getParameters(parameters);
 }
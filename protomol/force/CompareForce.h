@@ -11,6 +11,8 @@ namespace ProtoMol {
   class CompareForce : virtual public Force {
     // This class contains the definition of one force
 
+  public:
+    /// Absolute and relative errors of forces and potential energy
     struct CompareError {
       CompareError() : absF2(0.0), rFavg(0.0), rFmax(0.0), rPE(0.0) {}
       CompareError(Real a, Real b, Real c,
@@ -18,6 +20,8 @@ namespace ProtoMol {
       Real absF2, rFavg, rFmax, rPE;
     };
 
+  private:
+
     //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
     // Constructors, destructors, assignment
     //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -32,6 +36,14 @@ namespace ProtoMol {
     const ScalarStructure *getEnergies() const {return myEnergies;}
     Force *getForceObject() const {return myActualForce;}
     unsigned int getIdNumber() const {return myIdNumber;}
+
+    /// Error of comparedForces and comparedEnergies relative to forces and
+    /// energies, forces are weighted by the inverse mass
+    static CompareError compare(const GenericTopology *topo,
+                                const Vector3DBlock &forces,
+                                const ScalarStructure &energies,
+                                const Vector3DBlock &comparedForces,
+                                const ScalarStructure &comparedEnergies);
   protected:
     void preprocess(unsigned int numAtoms);
     void postprocess(const GenericTopology *topo,
@@ -6,6 +6,7 @@
 #include <protomol/type/ScalarStructure.h>
 #include <protomol/topology/ExclusionTable.h>
 #include <protomol/config/Parameter.h>
+#include <protomol/force/MixedPrecision.h>
 #include <string>
 
 namespace ProtoMol {
@@ -30,8 +31,8 @@ namespace ProtoMol {
                     Real rDistSquared, const Vector3D &,
                     const GenericTopology *topo, int atom1, int atom2,
                     ExclusionClass excl) const {
-      energy = topo->atoms[atom1].scaledCharge *
-               topo->atoms[atom2].scaledCharge *
+      energy = topo->atomCharge[atom1] *
+               topo->atomCharge[atom2] *
                sqrt(rDistSquared);
       if (excl == EXCLUSION_MODIFIED)
         energy *= topo->coulombScalingFactor;
@@ -39,6 +40,18 @@ namespace ProtoMol {
       force = energy * rDistSquared;
     }
 
+    /// Same as operator() in single precision
+    void singlePrecision(float &energy, float &force, float /*distSquared*/,
+                         float rDistSquared, const GenericTopology *topo,
+                         int atom1, int atom2, ExclusionClass excl) const {
+      energy = topo->singleCharge[atom1] * topo->singleCharge[atom2] *
+               sqrtf(rDistSquared);
+      if (excl == EXCLUSION_MODIFIED)
+        energy *= static_cast<float>(topo->coulombScalingFactor);
+
+      force = energy * rDistSquared;
+    }
+
     static void accumulateEnergy(ScalarStructure *energies, Real energy) {
       (*energies)[ScalarStructure::COULOMB] += energy;
     }
@@ -77,5 +90,10 @@ namespace ProtoMol {
     static const std::string keyword;
   private:
   };
+
+  template<>
+  struct MixedPrecision<CoulombForce> {
+    enum {SUPPORTED = 1};
+  };
 }
 #endif /* COULOMBFORCE_H */
@@ -1,6 +1,7 @@
 #include <protomol/force/GB/GBBornRadii.h>
 
 #include <protomol/base/Report.h>
+#include <protomol/base/FastMath.h>
 #include <protomol/parallel/Parallel.h>
 
 using namespace ProtoMol;
@@ -84,13 +85,6 @@ void GBBornRadii::operator()(Real &energy, Real &force,
   Real invLij2 = invLij*invLij;
   Real invUij2 = invUij*invUij;
   
-  Real ratio_i = log(Lij/Uij);
-  
-  
-  //add this to the burial term for atom i (atom1) (see Equation (5) in the writeup)
-  Real term_i = (invLij - invUij) + (dist/four)*(invUij2 - invLij2) + (one/(two*dist))*(Real)ratio_i + ((S_j*S_j*offsetRadius_j*offsetRadius_j)/(four*dist))*(invLij2 - invUij2) + Cij;
-  topo->atoms[atom1].myGBSA_T->burialTerm += term_i;
-  
   // These are required for jith term. Note that Lij not necessary equal to Lji. Same is true for Uij and Cij.
   // These quantities may not be symmetric. I need these for calculating R_j.
   Real Lji, Uji, Cji;
@@ -120,7 +114,15 @@ void GBBornRadii::operator()(Real &energy, Real &force,
   Real invLji2 = invLji*invLji;
   Real invUji2 = invUji*invUji;
   
-  Real ratio_j = log(Lji/Uji);
+  // log(Lij/Uij) and log(Lji/Uji) on the two lanes of fastLog
+  Real ratio[2] = {Lij/Uij, Lji/Uji};
+  fastLog(2, ratio, ratio);
+  Real ratio_i = ratio[0];
+  Real ratio_j = ratio[1];
+  
+  //add this to the burial term for atom i (atom1) (see Equation (5) in the writeup)
+  Real term_i = (invLij - invUij) + (dist/four)*(invUij2 - invLij2) + (one/(two*dist))*(Real)ratio_i + ((S_j*S_j*offsetRadius_j*offsetRadius_j)/(four*dist))*(invLij2 - invUij2) + Cij;
+  topo->atoms[atom1].myGBSA_T->burialTerm += term_i;
   
   //add this to the burial term for atom j (atom2) (see Equation (5) in the writeup)
   Real term_j = (invLji - invUji) + (dist/four)*(invUji2 - invLji2) + (one/(two*dist))*(Real)ratio_j + ((S_i*S_i*offsetRadius_i*offsetRadius_i)/(four*dist))*(invLji2 - invUji2) + Cji;
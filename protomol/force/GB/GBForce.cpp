@@ -1,8 +1,11 @@
 #include <protomol/force/GB/GBForce.h>
 
 #include <protomol/base/Report.h>
+#include <protomol/base/FastMath.h>
 #include <protomol/parallel/Parallel.h>
 
+#include <algorithm>
+
 using namespace ProtoMol;
 using namespace ProtoMol::Report;
 
@@ -134,10 +137,14 @@ void GBForce::operator()(Real &energy, Real &force, Real distSquared,
   Real S_j_term = (S_j*offsetRadius_j)/dist;
   
   
-  Real dBTidrij = -0.5*dLijdrij*(1/(Lij*Lij)) + 0.5*dUijdrij*(1/(Uij*Uij)) + 0.125*((1/(Uij*Uij)) - (1/(Lij*Lij))) + 0.125*dist*((2/(Lij*Lij*Lij))*dLijdrij - (2/(Uij*Uij*Uij))*dUijdrij) - 0.25*(1/(dist*dist))*log(Lij/Uij) + (Uij/(4*dist*Lij))*((1/Uij)*dLijdrij - (Lij/(Uij*Uij))*dUijdrij) - 0.125*power(S_j_term,2)*((1/(Lij*Lij)) - (1/(Uij*Uij))) + 0.25*((S_j*S_j*offsetRadius_j*offsetRadius_j)/(dist*Uij*Uij*Uij))*dUijdrij - 0.25*((S_j*S_j*offsetRadius_j*offsetRadius_j)/(dist*Lij*Lij*Lij))*dLijdrij + dCijdrij;
+  // log(Lij/Uij) and log(Lji/Uji) on the two lanes of fastLog
+  Real ratio[2] = {Lij/Uij, Lji/Uji};
+  fastLog(2, ratio, ratio);
+  
+  Real dBTidrij = -0.5*dLijdrij*(1/(Lij*Lij)) + 0.5*dUijdrij*(1/(Uij*Uij)) + 0.125*((1/(Uij*Uij)) - (1/(Lij*Lij))) + 0.125*dist*((2/(Lij*Lij*Lij))*dLijdrij - (2/(Uij*Uij*Uij))*dUijdrij) - 0.25*(1/(dist*dist))*ratio[0] + (Uij/(4*dist*Lij))*((1/Uij)*dLijdrij - (Lij/(Uij*Uij))*dUijdrij) - 0.125*power(S_j_term,2)*((1/(Lij*Lij)) - (1/(Uij*Uij))) + 0.25*((S_j*S_j*offsetRadius_j*offsetRadius_j)/(dist*Uij*Uij*Uij))*dUijdrij - 0.25*((S_j*S_j*offsetRadius_j*offsetRadius_j)/(dist*Lij*Lij*Lij))*dLijdrij + dCijdrij;
   Real dRidrij = power(bornRad_i,2)*offsetRadius_i*(1-tanh_i*tanh_i)*tanhparam_derv_i*(1/radius_i)*dBTidrij;
   
-  Real dBTjdrji = -0.5*dLjidrij*(1/(Lji*Lji)) + 0.5*dUjidrij*(1/(Uji*Uji)) + 0.125*((1/(Uji*Uji)) - (1/(Lji*Lji))) + 0.125*dist*((2/(Lji*Lji*Lji))*dLjidrij - (2/(Uji*Uji*Uji))*dUjidrij) - 0.25*(1/(dist*dist))*log(Lji/Uji) + (Uji/(4*dist*Lji))*((1/Uji)*dLjidrij - (Lji/(Uji*Uji))*dUjidrij) - 0.125*power(S_i_term,2)*((1/(Lji*Lji)) - (1/(Uji*Uji))) + 0.25*((S_i*S_i*offsetRadius_i*offsetRadius_i)/(dist*Uji*Uji*Uji))*dUjidrij - 0.25*((S_i*S_i*offsetRadius_i*offsetRadius_i)/(dist*Lji*Lji*Lji))*dLjidrij + dCjidrij;
+  Real dBTjdrji = -0.5*dLjidrij*(1/(Lji*Lji)) + 0.5*dUjidrij*(1/(Uji*Uji)) + 0.125*((1/(Uji*Uji)) - (1/(Lji*Lji))) + 0.125*dist*((2/(Lji*Lji*Lji))*dLjidrij - (2/(Uji*Uji*Uji))*dUjidrij) - 0.25*(1/(dist*dist))*ratio[1] + (Uji/(4*dist*Lji))*((1/Uji)*dLjidrij - (Lji/(Uji*Uji))*dUjidrij) - 0.125*power(S_i_term,2)*((1/(Lji*Lji)) - (1/(Uji*Uji))) + 0.25*((S_i*S_i*offsetRadius_i*offsetRadius_i)/(dist*Uji*Uji*Uji))*dUjidrij - 0.25*((S_i*S_i*offsetRadius_i*offsetRadius_i)/(dist*Lji*Lji*Lji))*dLjidrij + dCjidrij;
   
   Real dRjdrji = power(bornRad_j,2)*offsetRadius_j*(1-tanh_j*tanh_j)*tanhparam_derv_j*(1/radius_j)*dBTjdrji;
   
@@ -181,18 +188,36 @@ Real GBForce::Force_i_term(const GenericTopology *topo, int atom1) const{
   Real bornRad_i = topo->atoms[atom1].myGBSA_T->bornRad;
   Real scaledCharge_i = topo->atoms[atom1].scaledCharge;
   
+  // exp and 1/sqrt of a block of atoms l at a time on the lanes of FastMath
+  const unsigned int atoms = topo->atoms.size();
+  const unsigned int block = 64;
+  Real bornRad[block], rilSquared[block], arg[block], expterm[block];
+  Real invFilGB[block];
+  
   Real force = 0;
-  for (unsigned int l = 0; l < topo->atoms.size(); l++) {
-    if( l != (unsigned int) atom1 ){
-      Real ril = topo->atoms[atom1].myGBSA_T->distij[l];
+  for (unsigned int first = 0; first < atoms; first += block) {
+    const unsigned int n = std::min(atoms - first, block);
     
-      Real bornRad_l = topo->atoms[l].myGBSA_T->bornRad;
-      Real scaledCharge_l = topo->atoms[l].scaledCharge;
+    for (unsigned int k = 0; k < n; k++) {
+      Real ril = topo->atoms[atom1].myGBSA_T->distij[first + k];
+      bornRad[k] = topo->atoms[first + k].myGBSA_T->bornRad;
+      rilSquared[k] = ril*ril;
+      arg[k] = -rilSquared[k]/(4.0*bornRad_i*bornRad[k]);
+    }
+    fastExp(n, arg, expterm);
+    
+    for (unsigned int k = 0; k < n; k++)
+      arg[k] = rilSquared[k] + bornRad_i*bornRad[k]*expterm[k];
+    fastRsqrt(n, arg, invFilGB);
     
-      Real expterm = std::exp( -(ril*ril)/(4.0*bornRad_i*bornRad_l) );
-      Real filGB = sqrt(ril*ril + bornRad_i*bornRad_l*expterm);
+    for (unsigned int k = 0; k < n; k++) {
+      const unsigned int l = first + k;
+      if( l == (unsigned int) atom1 ) continue;
+      
+      Real scaledCharge_l = topo->atoms[l].scaledCharge;
+      Real invFilGB3 = invFilGB[k]*invFilGB[k]*invFilGB[k];
       
-      force += scaledCharge_i*scaledCharge_l*(1/(filGB*filGB))*0.5*(1/filGB)*expterm*(bornRad_l + (ril*ril)/(4.0*bornRad_i));
+      force += scaledCharge_i*scaledCharge_l*invFilGB3*0.5*expterm[k]*(bornRad[k] + rilSquared[k]/(4.0*bornRad_i));
     }
   }
   
@@ -212,7 +237,7 @@ Real GBForce::Force_i_j_term(const GenericTopology *topo, const int atom1, const
   const Real bornRad_l = topo->atoms[atom2].myGBSA_T->bornRad;
   const Real scaledCharge_l = topo->atoms[atom2].scaledCharge;
   
-  const Real expterm = std::exp( -(ril*ril)/(4.0*bornRad_i*bornRad_l) );
+  const Real expterm = fastExp( -(ril*ril)/(4.0*bornRad_i*bornRad_l) );
   const Real filGB = sqrt(ril*ril + bornRad_i*bornRad_l*expterm);
   
   return scaledCharge_i*scaledCharge_l*(1/(filGB*filGB))*0.5*(1/filGB)*expterm*(bornRad_l + (ril*ril)/(4.0*bornRad_i));
@@ -1,6 +1,7 @@
 #include <protomol/force/GB/GBPartialSum.h>
 
 #include <protomol/parallel/Parallel.h>
+#include <protomol/base/FastMath.h>
 
 using namespace ProtoMol;
 
@@ -21,7 +22,7 @@ void GBPartialSum::operator()(Real &energy, Real &force,
   
   Real ril = std::sqrt(distSquared);
   
-  Real expterm = std::exp( -(ril*ril)/(4.0*bornRad_i*bornRad_l) );
+  Real expterm = fastExp( -(ril*ril)/(4.0*bornRad_i*bornRad_l) );
   topo->atoms[atom1].myGBSA_T->expTerm[atom2] = expterm;
   topo->atoms[atom2].myGBSA_T->expTerm[atom1] = expterm;
   
@@ -7,6 +7,7 @@
 #include <protomol/type/ScalarStructure.h>
 #include <protomol/topology/ExclusionTable.h>
 #include <protomol/config/Parameter.h>
+#include <protomol/force/MixedPrecision.h>
 #include <string>
 #include <protomol/base/Report.h>
 using namespace ProtoMol::Report;
@@ -37,8 +38,8 @@ namespace ProtoMol {
         sqrt(1.0 / rDistSquared) << ")." << endr;
 #endif
       const LennardJonesParameters &
-      params = topo->lennardJonesParameters(topo->atoms[atom1].type,
-                                            topo->atoms[atom2].type);
+      params = topo->lennardJonesParameters(topo->atomTypeIndex[atom1],
+                                            topo->atomTypeIndex[atom2]);
 
       Real A, B;
       if (excl != EXCLUSION_MODIFIED) {
@@ -59,6 +60,30 @@ namespace ProtoMol {
       force = 12.0 * r12A * rDistSquared - 6.0 * r6B * rDistSquared;
     }
 
+    /// Same as operator() in single precision
+    void singlePrecision(float &energy, float &force, float /*distSquared*/,
+                         float rDistSquared, const GenericTopology *topo,
+                         int atom1, int atom2, ExclusionClass excl) const {
+      const LennardJonesParameters &
+      params = topo->lennardJonesParameters(topo->atomTypeIndex[atom1],
+                                            topo->atomTypeIndex[atom2]);
+
+      float A, B;
+      if (excl != EXCLUSION_MODIFIED) {
+        A = static_cast<float>(params.A);
+        B = static_cast<float>(params.B);
+      } else {
+        A = static_cast<float>(params.A14);
+        B = static_cast<float>(params.B14);
+      }
+
+      float r6 = rDistSquared * rDistSquared * rDistSquared;
+      float r6B = B * r6;
+      float r12A = A * r6 * r6;
+      energy = r12A - r6B;
+      force = (12.0f * r12A - 6.0f * r6B) * rDistSquared;
+    }
+
     static void accumulateEnergy(ScalarStructure *energies, Real energy) {
       (*energies)[ScalarStructure::LENNARDJONES] += energy;
     }
@@ -100,6 +125,11 @@ namespace ProtoMol {
     static const std::string keyword;
   private:
   };
+
+  template<>
+  struct MixedPrecision<LennardJonesForce> {
+    enum {SUPPORTED = 1};
+  };
   //____ INLINES
 }
 
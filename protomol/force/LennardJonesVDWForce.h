@@ -83,8 +83,8 @@ namespace ProtoMol {
         
       //get params
       const LennardJonesParameters &
-      params = topo->lennardJonesParameters(topo->atoms[atom1].type,
-                                            topo->atoms[atom2].type);
+      params = topo->lennardJonesParameters(topo->atomTypeIndex[atom1],
+                                            topo->atomTypeIndex[atom2]);
 
       Real A, B;
       if (excl != EXCLUSION_MODIFIED) {
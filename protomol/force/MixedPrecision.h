@@ -0,0 +1,50 @@
+/* -*- c++ -*- */
+#ifndef MIXEDPRECISION_H
+#define MIXEDPRECISION_H
+
+#include <protomol/topology/ExclusionTable.h>
+
+namespace ProtoMol {
+  //____ MixedPrecision
+
+  /**
+   * Tells if a pair force, a switching function or a pair kernel has a
+   * single precision version. Specialized next to the class, forces and
+   * switching functions then provide singlePrecision() with the arguments
+   * of operator() in float, pair kernels doOneAtomPairSingle(), which reads
+   * the float positions and charges of GenericTopology.
+   *
+   * Only the NonbondedCutoff and NonbondedSimpleFull pair loops select the
+   * single precision kernel if GenericTopology::mixedPrecision is set, the
+   * Ewald real-space, GB and all other loops run in Real.
+   */
+  template<typename T>
+  struct MixedPrecision {
+    enum {SUPPORTED = 0};
+  };
+
+  //____ MixedPrecisionKernel
+
+  /**
+   * Calls the Real or the single precision kernel of a pair, the pair loops
+   * are instantiated for both and pick one once per evaluation.
+   */
+  template<bool SINGLE>
+  struct MixedPrecisionKernel {
+    template<typename TOneAtomPair>
+    static void doOneAtomPair(TOneAtomPair &pair, int i, int j,
+                              ExclusionClass excl) {
+      pair.doOneAtomPair(i, j, excl);
+    }
+  };
+
+  template<>
+  struct MixedPrecisionKernel<true> {
+    template<typename TOneAtomPair>
+    static void doOneAtomPair(TOneAtomPair &pair, int i, int j,
+                              ExclusionClass excl) {
+      pair.doOneAtomPairSingle(i, j, excl);
+    }
+  };
+}
+#endif /* MIXEDPRECISION_H */
@@ -71,8 +71,8 @@ namespace ProtoMol {
   struct SameMoleculeConstraint {
     enum {PRE_CHECK = 1, POST_CHECK = 0};
     static bool check(const GenericTopology *topo, int i,
-                      int j) {return topo->atoms[i].molecule ==
-                                     topo->atoms[j].molecule;}
+                      int j) {return topo->atomMolecule[i] ==
+                                     topo->atomMolecule[j];}
 
     static std::string getPrefixId() {return "";}
 
@@ -89,8 +89,8 @@ namespace ProtoMol {
   struct NotSameMoleculeConstraint {
     enum {PRE_CHECK = 1, POST_CHECK = 0};
     static bool check(const GenericTopology *topo, int i,
-                      int j) {return topo->atoms[i].molecule !=
-                                     topo->atoms[j].molecule;}
+                      int j) {return topo->atomMolecule[i] !=
+                                     topo->atomMolecule[j];}
 
     static std::string getPrefixId() {return "";}
 
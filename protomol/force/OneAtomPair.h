@@ -6,6 +6,7 @@
 #include <protomol/config/Parameter.h>
 #include <protomol/type/ScalarStructure.h>
 #include <protomol/force/OneAtomContraints.h>
+#include <protomol/force/MixedPrecision.h>
 
 namespace ProtoMol {
   //____ OneAtomPair
@@ -21,7 +22,10 @@ namespace ProtoMol {
     public:
       typedef Boundary BoundaryConditions;
       typedef SemiGenericTopology<Boundary> TopologyType;
-    
+      /// Excluded pairs are left out of the pair loops and modified pairs
+      /// are evaluated from ExclusionTable::getModified()
+      enum {EXCLUDE = 1};
+
     public:
       OneAtomPair() : SwitchFunction(), ForceFunction() {};
       OneAtomPair(Force nF, Switch sF) :
@@ -45,6 +49,17 @@ namespace ProtoMol {
 
       // Computes the force and energy for atom i and j.
       virtual void doOneAtomPair(const int i, const int j) {
+        doOneAtomPair(i, j, realTopo->atomMolecule[i] ==
+                      realTopo->atomMolecule[j] ?
+                      realTopo->exclusions.check(i, j) : EXCLUSION_NONE);
+      }
+
+      // Computes the force and energy for atom i and j with the exclusion
+      // class of the pair, as found by the ExclusionRow of a pair loop.
+      void doOneAtomPair(const int i, const int j, ExclusionClass excl) {
+        if (excl == EXCLUSION_FULL)
+          return;
+
         if (Constraint::PRE_CHECK)
           if (!Constraint::check(realTopo, i, j))
             return;
@@ -60,14 +75,6 @@ namespace ProtoMol {
         if (Switch::USE || Force::CUTOFF)
           if (distSquared > mySquaredCutoff)
             return;
-        // Check for an exclusion.
-        int mi = realTopo->atoms[i].molecule;
-        int mj = realTopo->atoms[j].molecule;
-        bool same = (mi == mj);
-        ExclusionClass excl =
-          (same ? realTopo->exclusions.check(i, j) : EXCLUSION_NONE);
-        if (excl == EXCLUSION_FULL)
-          return;
 
         // Calculate the force and energy.
         Real energy = 0, force = 0;
@@ -85,6 +92,48 @@ namespace ProtoMol {
           energy = energy * switchingValue;
         }
 
+        addPair(i, j, diff, energy, force);
+      }
+
+      // Computes the force and energy for atom i and j as doOneAtomPair(),
+      // but the distance, the potential and the switching in float from the
+      // single precision positions and charges of the topology.
+      void doOneAtomPairSingle(const int i, const int j, ExclusionClass excl) {
+        if (excl == EXCLUSION_FULL)
+          return;
+
+        if (Constraint::PRE_CHECK)
+          if (!Constraint::check(realTopo, i, j))
+            return;
+
+        float dx = realTopo->singleX[j] - realTopo->singleX[i];
+        float dy = realTopo->singleY[j] - realTopo->singleY[i];
+        float dz = realTopo->singleZ[j] - realTopo->singleZ[i];
+        float distSquared =
+          realTopo->boundaryConditions.minimalDifference(dx, dy, dz);
+        if (Switch::USE || Force::CUTOFF)
+          if (distSquared > mySquaredCutoff)
+            return;
+
+        float rDistSquared = (Force::DIST_R2 ? 1.0f / distSquared : 1.0f);
+        float energy = 0, force = 0;
+        ForceFunction.singlePrecision(energy, force, distSquared,
+                                      rDistSquared, realTopo, i, j, excl);
+        if (Switch::MODIFY) {
+          float switchingValue, switchingDeriv;
+          SwitchFunction.singlePrecision(switchingValue, switchingDeriv,
+                                         distSquared);
+          force = force * switchingValue - energy * switchingDeriv;
+          energy = energy * switchingValue;
+        }
+
+        addPair(i, j, Vector3D(dx, dy, dz), energy, force);
+      }
+
+    protected:
+      // Adds the energy, the forces and the virial of the pair i, j.
+      void addPair(const int i, const int j, const Vector3D &diff,
+                   Real energy, Real force) {
         // Add this energy into the total system energy.
         ForceFunction.accumulateEnergy(energies, energy);
         // Add this force into the atom forces.
@@ -93,7 +142,9 @@ namespace ProtoMol {
         (*forces)[j] += fij;
 
         // compute the vector between molecular centers of mass
-        if (!same && energies->molecularVirial())
+        int mi = realTopo->atomMolecule[i];
+        int mj = realTopo->atomMolecule[j];
+        if (mi != mj && energies->molecularVirial())
           // Add to the atomic and molecular virials
           energies->
             addVirial(fij, diff, realTopo->boundaryConditions.
@@ -106,6 +157,7 @@ namespace ProtoMol {
           Constraint::check(realTopo, i, j, diff, energy, fij);
       }
 
+    public:
       virtual void getParameters(std::vector<Parameter> &parameters) const {
         ForceFunction.getParameters(parameters);
         SwitchFunction.getParameters(parameters);
@@ -150,5 +202,12 @@ namespace ProtoMol {
       Force ForceFunction;
       Real mySquaredCutoff;
   };
+
+  template<typename Boundary, typename Switch, typename Force,
+           typename Constraint>
+  struct MixedPrecision<OneAtomPair<Boundary, Switch, Force, Constraint> > {
+    enum {SUPPORTED = MixedPrecision<Switch>::SUPPORTED &&
+                      MixedPrecision<Force>::SUPPORTED};
+  };
 }
 #endif /* ONEATOMPAIR_H */
@@ -85,8 +85,8 @@ namespace ProtoMol {
             (*this->forces)[j] -= fij;
 
             // compute the vector between molecular centers of mass
-            int mi = this->realTopo->atoms[i].molecule;
-            int mj = this->realTopo->atoms[j].molecule;
+            int mi = this->realTopo->atomMolecule[i];
+            int mj = this->realTopo->atomMolecule[j];
             if (mi != mj) {
               Vector3D molDiff =
                 this->realTopo->boundaryConditions.minimalDifference
@@ -141,8 +141,8 @@ namespace ProtoMol {
             (*this->forces)[j] -= fij;
 
             // compute the vector between molecular centers of mass
-            int mi = this->realTopo->atoms[i].molecule;
-            int mj = this->realTopo->atoms[j].molecule;
+            int mi = this->realTopo->atomMolecule[i];
+            int mj = this->realTopo->atomMolecule[j];
             if (mi != mj) {
               Vector3D molDiff =
                 this->realTopo->boundaryConditions.minimalDifference
@@ -12,7 +12,11 @@ namespace ProtoMol {
   template<typename Boundary, typename Switch, typename Force, typename Constraint = NoConstraint>
   class OneAtomPairNoExclusion : public OneAtomPair<Boundary,Switch,Force,Constraint> {
     typedef OneAtomPair<Boundary,Switch,Force,Constraint> Base;
-    
+
+    public:
+      /// Excluded and modified pairs stay in the pair loops
+      enum {EXCLUDE = 0};
+
     public:
       OneAtomPairNoExclusion() : Base() {
         
@@ -23,6 +27,13 @@ namespace ProtoMol {
       }
     
       void doOneAtomPair(const int i, const int j) {
+        doOneAtomPair(i, j, Base::realTopo->atomMolecule[i] ==
+                      Base::realTopo->atomMolecule[j] ?
+                      Base::realTopo->exclusions.check(i, j) :
+                      EXCLUSION_NONE);
+      }
+
+      void doOneAtomPair(const int i, const int j, ExclusionClass excl) {
         if (Constraint::PRE_CHECK){
           if (!Constraint::check(Base::realTopo, i, j)) return;
         }
@@ -39,12 +50,10 @@ namespace ProtoMol {
           if (distSquared > Base::mySquaredCutoff) return;
         }
         
-        // Don't Check for an exclusion.
-        int mi = Base::realTopo->atoms[i].molecule;
-        int mj = Base::realTopo->atoms[j].molecule;
+        // Don't skip an exclusion, the force gets its class.
+        int mi = Base::realTopo->atomMolecule[i];
+        int mj = Base::realTopo->atomMolecule[j];
         bool same = (mi == mj);
-        ExclusionClass excl =
-          (same ? Base::realTopo->exclusions.check(i, j) : EXCLUSION_NONE);
 
         // Calculate the force and energy.
         Real energy = 0, force = 0;
@@ -0,0 +1,138 @@
+/* -*- c++ -*- */
+#ifndef ONEATOMPAIRTABLE_H
+#define ONEATOMPAIRTABLE_H
+
+#include <protomol/topology/Topology.h>
+#include <protomol/config/Parameter.h>
+#include <protomol/type/ScalarStructure.h>
+#include <protomol/force/OneAtomContraints.h>
+
+namespace ProtoMol {
+  //____ OneAtomPairTable
+
+  /**
+   * Computes the interaction of two potentials tabulated together, e.g.
+   * LennardJonesCoulombTableForce, with one table look up per pair. The
+   * force returns both energies, which are accumulated separately as by
+   * OneAtomPairTwo. The switching functions are part of the table.
+   */
+  template<typename Boundary, typename Force,
+           typename Constraint = NoConstraint>
+  class OneAtomPairTable {
+  public:
+    typedef Boundary BoundaryConditions;
+    typedef SemiGenericTopology<Boundary> TopologyType;
+    enum {EXCLUDE = 1};
+
+  public:
+    OneAtomPairTable() : ForceFunction() {}
+    OneAtomPairTable(Force nF) :
+      ForceFunction(nF), mySquaredCutoff(nF.cutoffSquared()) {}
+    virtual ~OneAtomPairTable() {}
+
+  public:
+    void initialize(const TopologyType *topo, const Vector3DBlock *pos,
+                    Vector3DBlock *f, ScalarStructure *e) {
+      realTopo = (TopologyType *)topo;
+      positions = pos;
+      forces = f;
+      energies = e;
+    }
+
+    void initialize(TopologyType *topo, const Vector3DBlock *pos,
+                    Vector3DBlock *f, ScalarStructure *e) {
+      initialize(static_cast<const TopologyType *>(topo), pos, f, e);
+    }
+
+    // Computes the force and energy for atom i and j.
+    void doOneAtomPair(const int i, const int j) {
+      doOneAtomPair(i, j, realTopo->atomMolecule[i] ==
+                    realTopo->atomMolecule[j] ?
+                    realTopo->exclusions.check(i, j) : EXCLUSION_NONE);
+    }
+
+    // Computes the force and energy for atom i and j of exclusion class excl
+    void doOneAtomPair(const int i, const int j, ExclusionClass excl) {
+      if (excl == EXCLUSION_FULL)
+        return;
+
+      if (Constraint::PRE_CHECK)
+        if (!Constraint::check(realTopo, i, j))
+          return;
+
+      // Get atom distance.
+      Real distSquared;
+      Vector3D diff(realTopo->boundaryConditions.
+                    minimalDifference((*positions)[i], (*positions)[j],
+                                      distSquared));
+      if (distSquared > mySquaredCutoff)
+        return;
+
+      int mi = realTopo->atomMolecule[i];
+      int mj = realTopo->atomMolecule[j];
+      bool same = (mi == mj);
+
+      // Calculate the switched force and energies.
+      Real energy1, energy2, force;
+      ForceFunction(energy1, energy2, force, distSquared, realTopo, i, j,
+                    excl);
+
+      // Add this energy into the total system energy.
+      ForceFunction.accumulateEnergy(energies, energy1, energy2);
+
+      // Add this force into the atom forces.
+      Vector3D fij(diff * force);
+      (*forces)[i] -= fij;
+      (*forces)[j] += fij;
+
+      // compute the vector between molecular centers of mass
+      if (!same && energies->molecularVirial())
+        // Add to the atomic and molecular virials
+        energies->
+          addVirial(fij, diff, realTopo->boundaryConditions.
+                    minimalDifference(realTopo->molecules[mi].position,
+                                      realTopo->molecules[mj].position));
+      else if (energies->virial())
+        energies->addVirial(fij, diff);
+
+      // End of force computation.
+      if (Constraint::POST_CHECK)
+        Constraint::check(realTopo, i, j, diff, energy1 + energy2, fij);
+    }
+
+    void getParameters(std::vector<Parameter> &parameters) const {
+      ForceFunction.getParameters(parameters);
+    }
+
+    void preProcess(const GenericTopology *, const Vector3DBlock *) {}
+
+    void postProcess(const GenericTopology *, ScalarStructure *,
+                     Vector3DBlock *) {}
+
+    void parallelPostProcess(const GenericTopology *, ScalarStructure *) {}
+
+    bool doParallelPostProcess() {return false;}
+
+    static unsigned int getParameterSize() {
+      return Force::getParameterSize();
+    }
+
+    static OneAtomPairTable make(std::vector<Value> values) {
+      return OneAtomPairTable(Force::make(values));
+    }
+
+    static std::string getId() {
+      return Constraint::getPrefixId() + Force::getId() +
+        Constraint::getPostfixId();
+    }
+
+  protected:
+    mutable TopologyType *realTopo;
+    const Vector3DBlock *positions;
+    Vector3DBlock *forces;
+    ScalarStructure *energies;
+    Force ForceFunction;
+    Real mySquaredCutoff;
+  };
+}
+#endif /* ONEATOMPAIRTABLE_H */
@@ -34,6 +34,15 @@ namespace ProtoMol {
     }
   
     void doOneAtomPair(const int i, const int j) {
+      doOneAtomPair(i, j, Base::realTopo->atomMolecule[i] ==
+                    Base::realTopo->atomMolecule[j] ?
+                    Base::realTopo->exclusions.check(i, j) : EXCLUSION_NONE);
+    }
+
+    void doOneAtomPair(const int i, const int j, ExclusionClass excl) {
+      if (excl == EXCLUSION_FULL)
+        return;
+
       if (Constraint::PRE_CHECK)
         if (!Constraint::check(Base::realTopo, i, j))
           return;
@@ -49,14 +58,9 @@ namespace ProtoMol {
            && distSquared > Base::mySquaredCutoff)
         return;
 
-      // Check for an exclusion.
-      int mi = Base::realTopo->atoms[i].molecule;
-      int mj = Base::realTopo->atoms[j].molecule;
+      int mi = Base::realTopo->atomMolecule[i];
+      int mj = Base::realTopo->atomMolecule[j];
       bool same = (mi == mj);
-      ExclusionClass excl =
-        (same ? Base::realTopo->exclusions.check(i, j) : EXCLUSION_NONE);
-      if (excl == EXCLUSION_FULL)
-        return;
 
       // Calculate the force and energy.
       Real rDistSquared =
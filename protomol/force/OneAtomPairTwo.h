@@ -28,6 +28,15 @@ namespace ProtoMol {
     }
     
     void doOneAtomPair(const int i, const int j) {
+      doOneAtomPair(i, j, Base::realTopo->atomMolecule[i] ==
+                    Base::realTopo->atomMolecule[j] ?
+                    Base::realTopo->exclusions.check(i, j) : EXCLUSION_NONE);
+    }
+
+    void doOneAtomPair(const int i, const int j, ExclusionClass excl) {
+      if (excl == EXCLUSION_FULL)
+        return;
+
       if (Constraint::PRE_CHECK)
         if (!Constraint::check(Base::realTopo, i, j))
           return;
@@ -43,25 +52,16 @@ namespace ProtoMol {
            ForceB::CUTOFF) && distSquared > Base::mySquaredCutoff)
         return;
 
-      // Check for an exclusion.
-      int mi = Base::realTopo->atoms[i].molecule;
-      int mj = Base::realTopo->atoms[j].molecule;
-      bool same = (mi == mj);
-      ExclusionClass excl =
-        (same ? Base::realTopo->exclusions.check(i, j) : EXCLUSION_NONE);
-      if (excl == EXCLUSION_FULL)
-        return;
-
       // Calculate the force and energy.
       Real rDistSquared =
         ((ForceA::DIST_R2 ||
           ForceB::DIST_R2) ? 1.0 / distSquared : 1.0);
-      Real energy1, force1, energy2 = 0, force2 = 0;
+      Real energy1 = 0, force1 = 0, energy2 = 0, force2 = 0;
       Base::ForceFunction(energy1, force1, distSquared, rDistSquared,
                                   diff, Base::realTopo, i, j, excl);
       ForceFunctionB(energy2, force2, distSquared, rDistSquared,
                                    diff, Base::realTopo, i, j, excl);
-      
+
       // Calculate the switched force and energy.
       if (SwitchA::MODIFY || SwitchB::MODIFY) {
         Real switchingValue, switchingDeriv;
@@ -75,17 +75,72 @@ namespace ProtoMol {
         energy2 = energy2 * switchingValue;
       }
 
+      addPair(i, j, diff, energy1, energy2, force1 + force2);
+    }
+
+    // The single precision kernel, see OneAtomPair::doOneAtomPairSingle().
+    void doOneAtomPairSingle(const int i, const int j, ExclusionClass excl) {
+      if (excl == EXCLUSION_FULL)
+        return;
+
+      if (Constraint::PRE_CHECK)
+        if (!Constraint::check(Base::realTopo, i, j))
+          return;
+
+      float dx = Base::realTopo->singleX[j] - Base::realTopo->singleX[i];
+      float dy = Base::realTopo->singleY[j] - Base::realTopo->singleY[i];
+      float dz = Base::realTopo->singleZ[j] - Base::realTopo->singleZ[i];
+      float distSquared =
+        Base::realTopo->boundaryConditions.minimalDifference(dx, dy, dz);
+      if ((SwitchA::USE || SwitchB::USE ||
+           ForceA::CUTOFF ||
+           ForceB::CUTOFF) && distSquared > Base::mySquaredCutoff)
+        return;
+
+      float rDistSquared =
+        ((ForceA::DIST_R2 ||
+          ForceB::DIST_R2) ? 1.0f / distSquared : 1.0f);
+      float energy1 = 0, force1 = 0, energy2 = 0, force2 = 0;
+      Base::ForceFunction.singlePrecision(energy1, force1, distSquared,
+                                          rDistSquared, Base::realTopo, i, j,
+                                          excl);
+      ForceFunctionB.singlePrecision(energy2, force2, distSquared,
+                                     rDistSquared, Base::realTopo, i, j, excl);
+
+      if (SwitchA::MODIFY || SwitchB::MODIFY) {
+        float switchingValue, switchingDeriv;
+
+        Base::SwitchFunction.singlePrecision(switchingValue, switchingDeriv,
+                                             distSquared);
+        force1 = force1 * switchingValue - energy1 * switchingDeriv;
+        energy1 = energy1 * switchingValue;
+
+        SwitchFunctionB.singlePrecision(switchingValue, switchingDeriv,
+                                        distSquared);
+        force2 = force2 * switchingValue - energy2 * switchingDeriv;
+        energy2 = energy2 * switchingValue;
+      }
+
+      addPair(i, j, Vector3D(dx, dy, dz), energy1, energy2, force1 + force2);
+    }
+
+  private:
+    // Adds the energies, the forces and the virial of the pair i, j.
+    void addPair(const int i, const int j, const Vector3D &diff,
+                 Real energy1, Real energy2, Real force) {
       // Add this energy into the total system energy.
       Base::ForceFunction.accumulateEnergy(Base::energies, energy1);
       ForceFunctionB.accumulateEnergy(Base::energies, energy2);
       
       // Add this force into the atom forces.
-      Vector3D fij(diff * (force1 + force2));
+      Vector3D fij(diff * force);
       (*Base::forces)[i] -= fij;
       (*Base::forces)[j] += fij;
 
       // compute the vector between molecular centers of mass
-      if (!same && Base::energies->molecularVirial())
+      int mi = Base::realTopo->atomMolecule[i];
+      int mj = Base::realTopo->atomMolecule[j];
+      if (mi != mj && Base::energies->molecularVirial())
         // Add to the atomic and molecular virials
         Base::energies->
           addVirial(fij, diff, Base::realTopo->boundaryConditions.
@@ -99,6 +154,7 @@ namespace ProtoMol {
         Constraint::check(Base::realTopo, i, j, diff, energy1 + energy2, fij);
     }
 
+  public:
     void getParameters(std::vector<Parameter> &parameters) const {
       Base::ForceFunction.getParameters(parameters);
       Base::SwitchFunction.getParameters(parameters);
@@ -163,6 +219,16 @@ namespace ProtoMol {
     SwitchB SwitchFunctionB;
     ForceB ForceFunctionB;
   };
+
+  template<typename Boundary, typename SwitchA, typename ForceA,
+           typename SwitchB, typename ForceB, typename Constraint>
+  struct MixedPrecision<OneAtomPairTwo<Boundary, SwitchA, ForceA, SwitchB,
+                                       ForceB, Constraint> > {
+    enum {SUPPORTED = MixedPrecision<SwitchA>::SUPPORTED &&
+                      MixedPrecision<ForceA>::SUPPORTED &&
+                      MixedPrecision<SwitchB>::SUPPORTED &&
+                      MixedPrecision<ForceB>::SUPPORTED};
+  };
 }
 
 #endif /* ONEATOMPAIRTWO_H */
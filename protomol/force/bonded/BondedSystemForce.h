@@ -0,0 +1,724 @@
+/* -*- c++ -*- */
+#ifndef BONDEDSYSTEMFORCE_H
+#define BONDEDSYSTEMFORCE_H
+
+#include <protomol/force/system/SystemForce.h>
+#include <protomol/topology/SemiGenericTopology.h>
+#include <protomol/type/ScalarStructure.h>
+#include <protomol/type/Vector3DBlock.h>
+#include <protomol/parallel/Parallel.h>
+
+#include <vector>
+#include <string>
+#include <cmath>
+
+namespace ProtoMol {
+  //____ BondedSystemForce
+
+  /**
+   * All bonded terms (bonds, angles, dihedrals, impropers and RB dihedrals)
+   * in one force, same energies and forces as Bond, Angle, Dihedral,
+   * Improper and RBDihedral together.
+   *
+   * The term parameters are copied once into structure of arrays. Each
+   * chunk of terms is evaluated in three passes: the minimal differences
+   * are gathered, the forces are computed in a loop over plain arrays
+   * without any indirection, which the compiler can vectorize for bonds
+   * and angles, and finally the forces are scattered to the atoms in term
+   * order.
+   */
+  template<class TBoundaryConditions>
+  class BondedSystemForce : public SystemForce {
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // Typedef & const
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  private:
+    /// Terms per pass, such that the work arrays stay in the L1 cache
+    enum {CHUNK = 128};
+
+    /// Dihedrals or impropers, the multiplicity terms of torsion i are
+    /// [first[i], first[i + 1])
+    struct TorsionTerms {
+      std::vector<int> a1, a2, a3, a4, first, periodicity;
+      std::vector<Real> forceConstant, phaseShift;
+    };
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // Constructors, destructors, assignment
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    BondedSystemForce() : myTopo(0), myD(9 * CHUNK), myF(9 * CHUNK) {}
+    virtual ~BondedSystemForce() {}
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // From class SystemForce
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    using SystemForce::evaluate; // Avoid compiler warning/error
+    virtual void evaluate(const GenericTopology *topo,
+                          const Vector3DBlock *positions, Vector3DBlock *forces,
+                          ScalarStructure *energies) {
+      doEvaluate(topo, positions, forces, energies, 0, 1);
+    }
+
+    virtual void parallelEvaluate(const GenericTopology *topo,
+                                  const Vector3DBlock *positions,
+                                  Vector3DBlock *forces,
+                                  ScalarStructure *energies) {
+      unsigned int count = numberOfBlocks(topo, positions);
+
+      for (unsigned int i = 0; i < count; i++)
+        if (Parallel::next())
+          doEvaluate(topo, positions, forces, energies, i, count);
+    }
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // From class Force
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    virtual std::string getKeyword() const {return "Bonded";}
+
+    virtual unsigned int numberOfBlocks(const GenericTopology *topo,
+                                        const Vector3DBlock *) {
+      int n = topo->bonds.size() + topo->angles.size() +
+        topo->dihedrals.size() + topo->impropers.size() +
+        topo->rb_dihedrals.size();
+      return std::max(1, std::min(Parallel::getAvailableNum(), n));
+    }
+
+    virtual void uncache() {myTopo = 0;}
+
+  private:
+    virtual Force *doMake(const std::vector<Value> &) const {
+      return new BondedSystemForce();
+    }
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // From class Makeable
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    virtual std::string getIdNoAlias() const {return getKeyword();}
+    virtual void getParameters(std::vector<Parameter> &) const {}
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // New methods of class BondedSystemForce
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  private:
+    void doEvaluate(const GenericTopology *topo, const Vector3DBlock *positions,
+                    Vector3DBlock *forces, ScalarStructure *energies,
+                    unsigned int block, unsigned int count);
+
+    /// Copies the term parameters if the topology changed
+    void update(const GenericTopology *topo);
+    static void copyTorsions(const std::vector<Torsion> &torsions,
+                             TorsionTerms &terms);
+
+    void bonds(const TBoundaryConditions &boundary, const Vector3DBlock *pos,
+               Vector3DBlock *forces, ScalarStructure *energies,
+               unsigned int from, unsigned int to);
+    void angles(const TBoundaryConditions &boundary, const Vector3DBlock *pos,
+                Vector3DBlock *forces, ScalarStructure *energies,
+                unsigned int from, unsigned int to);
+    void torsions(const TBoundaryConditions &boundary,
+                  const TorsionTerms &terms, const Vector3DBlock *pos,
+                  Vector3DBlock *forces, ScalarStructure *energies,
+                  Real &energy, unsigned int from, unsigned int to);
+    void rbTorsions(const TBoundaryConditions &boundary,
+                    const Vector3DBlock *pos, Vector3DBlock *forces,
+                    ScalarStructure *energies, unsigned int from,
+                    unsigned int to);
+
+    /// Gathers the three differences of term i of a chain a1-a2-a3-a4 into
+    /// the work array
+    void gatherChain(const TBoundaryConditions &boundary,
+                     const Vector3DBlock *pos, unsigned int i, int a1, int a2,
+                     int a3, int a4);
+    /// Torsion forces f1, f2, f3 from the chain i and dV/dphi, stored in
+    /// the work array
+    void torsionForce(unsigned int i, const Vector3D &r12, const Vector3D &r23,
+                      const Vector3D &r34, const Vector3D &a,
+                      const Vector3D &b, const Vector3D &c, Real ra, Real rb,
+                      Real rc, Real cosPhi, Real sinPhi, Real dpotdphi);
+    /// Adds the torsion forces of terms [0, n) of the work array
+    void scatterChains(Vector3DBlock *forces, ScalarStructure *energies,
+                       unsigned int n, const int *a1, const int *a2,
+                       const int *a3, const int *a4);
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // My data members
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  private:
+    const GenericTopology *myTopo;
+    unsigned int mySizes[5];
+
+    // Bonds
+    std::vector<int> myBondA1, myBondA2;
+    std::vector<Real> myBondK, myBondR0;
+
+    // Angles
+    std::vector<int> myAngleA1, myAngleA2, myAngleA3;
+    std::vector<Real> myAngleK, myAngleTheta0, myAngleUBK, myAngleUBR0;
+
+    TorsionTerms myDihedrals, myImpropers;
+
+    // RB dihedrals, C0, ..., C5 of term i at 6 * i
+    std::vector<int> myRBA1, myRBA2, myRBA3, myRBA4;
+    std::vector<Real> myRBC;
+
+    /// Work arrays, differences and forces, component k of term i at
+    /// k * CHUNK + i
+    std::vector<Real> myD, myF;
+  };
+
+  //____ INLINES
+
+  template<class TBoundaryConditions>
+  inline void BondedSystemForce<TBoundaryConditions>::doEvaluate(
+    const GenericTopology *topo, const Vector3DBlock *positions,
+    Vector3DBlock *forces, ScalarStructure *energies, unsigned int block,
+    unsigned int count) {
+    const TBoundaryConditions &boundary =
+      ((SemiGenericTopology<TBoundaryConditions> &)(*topo)).
+        boundaryConditions;
+
+    update(topo);
+
+    // Same order as Bond, Angle, Dihedral, Improper, RBDihedral
+    unsigned int n = mySizes[0];
+    bonds(boundary, positions, forces, energies,
+          (n * block) / count, (n * (block + 1)) / count);
+
+    n = mySizes[1];
+    angles(boundary, positions, forces, energies,
+           (n * block) / count, (n * (block + 1)) / count);
+
+    n = mySizes[2];
+    torsions(boundary, myDihedrals, positions, forces, energies,
+             (*energies)[ScalarStructure::DIHEDRAL],
+             (n * block) / count, (n * (block + 1)) / count);
+
+    n = mySizes[3];
+    torsions(boundary, myImpropers, positions, forces, energies,
+             (*energies)[ScalarStructure::IMPROPER],
+             (n * block) / count, (n * (block + 1)) / count);
+
+    n = mySizes[4];
+    rbTorsions(boundary, positions, forces, energies,
+               (n * block) / count, (n * (block + 1)) / count);
+  }
+
+  template<class TBoundaryConditions>
+  inline void BondedSystemForce<TBoundaryConditions>::update(
+    const GenericTopology *topo) {
+    if (myTopo == topo && mySizes[0] == topo->bonds.size() &&
+        mySizes[1] == topo->angles.size() &&
+        mySizes[2] == topo->dihedrals.size() &&
+        mySizes[3] == topo->impropers.size() &&
+        mySizes[4] == topo->rb_dihedrals.size())
+      return;
+
+    myTopo = topo;
+    mySizes[0] = topo->bonds.size();
+    mySizes[1] = topo->angles.size();
+    mySizes[2] = topo->dihedrals.size();
+    mySizes[3] = topo->impropers.size();
+    mySizes[4] = topo->rb_dihedrals.size();
+
+    const std::vector<Bond> &bonds = topo->bonds;
+    myBondA1.resize(bonds.size());
+    myBondA2.resize(bonds.size());
+    myBondK.resize(bonds.size());
+    myBondR0.resize(bonds.size());
+    for (unsigned int i = 0; i < bonds.size(); i++) {
+      myBondA1[i] = bonds[i].atom1;
+      myBondA2[i] = bonds[i].atom2;
+      myBondK[i] = bonds[i].springConstant;
+      myBondR0[i] = bonds[i].restLength;
+    }
+
+    const std::vector<Angle> &angles = topo->angles;
+    myAngleA1.resize(angles.size());
+    myAngleA2.resize(angles.size());
+    myAngleA3.resize(angles.size());
+    myAngleK.resize(angles.size());
+    myAngleTheta0.resize(angles.size());
+    myAngleUBK.resize(angles.size());
+    myAngleUBR0.resize(angles.size());
+    for (unsigned int i = 0; i < angles.size(); i++) {
+      myAngleA1[i] = angles[i].atom1;
+      myAngleA2[i] = angles[i].atom2;
+      myAngleA3[i] = angles[i].atom3;
+      myAngleK[i] = angles[i].forceConstant;
+      myAngleTheta0[i] = angles[i].restAngle;
+      myAngleUBK[i] = angles[i].ureyBradleyConstant;
+      myAngleUBR0[i] = angles[i].ureyBradleyRestLength;
+    }
+
+    copyTorsions(topo->dihedrals, myDihedrals);
+    copyTorsions(topo->impropers, myImpropers);
+
+    const std::vector<RBTorsion> &rb = topo->rb_dihedrals;
+    myRBA1.resize(rb.size());
+    myRBA2.resize(rb.size());
+    myRBA3.resize(rb.size());
+    myRBA4.resize(rb.size());
+    myRBC.resize(6 * rb.size());
+    for (unsigned int i = 0; i < rb.size(); i++) {
+      myRBA1[i] = rb[i].atom1;
+      myRBA2[i] = rb[i].atom2;
+      myRBA3[i] = rb[i].atom3;
+      myRBA4[i] = rb[i].atom4;
+      myRBC[6 * i] = rb[i].C0;
+      myRBC[6 * i + 1] = rb[i].C1;
+      myRBC[6 * i + 2] = rb[i].C2;
+      myRBC[6 * i + 3] = rb[i].C3;
+      myRBC[6 * i + 4] = rb[i].C4;
+      myRBC[6 * i + 5] = rb[i].C5;
+    }
+  }
+
+  template<class TBoundaryConditions>
+  inline void BondedSystemForce<TBoundaryConditions>::copyTorsions(
+    const std::vector<Torsion> &torsions, TorsionTerms &terms) {
+    const unsigned int n = torsions.size();
+    terms.a1.resize(n);
+    terms.a2.resize(n);
+    terms.a3.resize(n);
+    terms.a4.resize(n);
+    terms.first.resize(n + 1);
+    terms.periodicity.clear();
+    terms.forceConstant.clear();
+    terms.phaseShift.clear();
+
+    terms.first[0] = 0;
+    for (unsigned int i = 0; i < n; i++) {
+      const Torsion &t = torsions[i];
+      terms.a1[i] = t.atom1;
+      terms.a2[i] = t.atom2;
+      terms.a3[i] = t.atom3;
+      terms.a4[i] = t.atom4;
+      for (int j = 0; j < t.multiplicity; j++) {
+        terms.periodicity.push_back(t.periodicity[j]);
+        terms.forceConstant.push_back(t.forceConstant[j]);
+        terms.phaseShift.push_back(t.phaseShift[j]);
+      }
+      terms.first[i + 1] = terms.periodicity.size();
+    }
+  }
+
+  template<class TBoundaryConditions>
+  inline void BondedSystemForce<TBoundaryConditions>::bonds(
+    const TBoundaryConditions &boundary, const Vector3DBlock *pos,
+    Vector3DBlock *forces, ScalarStructure *energies, unsigned int from,
+    unsigned int to) {
+    Real *dx = &myD[0], *dy = dx + CHUNK, *dz = dy + CHUNK;
+    Real *fx = &myF[0], *fy = fx + CHUNK, *fz = fy + CHUNK;
+    const bool virial = energies->virial();
+
+    for (unsigned int start = from; start < to; start += CHUNK) {
+      const unsigned int n = std::min<unsigned int>(CHUNK, to - start);
+      const int *a1 = &myBondA1[start], *a2 = &myBondA2[start];
+      const Real *k = &myBondK[start], *r0 = &myBondR0[start];
+
+      // Gather, vector from atom 1 to atom 2
+      for (unsigned int i = 0; i < n; i++) {
+        Vector3D r12(boundary.minimalDifference((*pos)[a2[i]], (*pos)[a1[i]]));
+        dx[i] = r12.c[0];
+        dy[i] = r12.c[1];
+        dz[i] = r12.c[2];
+      }
+
+      // Compute
+      Real energy = 0;
+      for (unsigned int i = 0; i < n; i++) {
+        Real r = sqrt(dx[i] * dx[i] + dy[i] * dy[i] + dz[i] * dz[i]);
+        Real dr = r - r0[i];
+        Real s = -(2.0 * k[i] * dr) / r;
+        fx[i] = dx[i] * s;
+        fy[i] = dy[i] * s;
+        fz[i] = dz[i] * s;
+        energy += k[i] * dr * dr;
+      }
+      (*energies)[ScalarStructure::BOND] += energy;
+
+      // Scatter
+      for (unsigned int i = 0; i < n; i++) {
+        Vector3D force1(fx[i], fy[i], fz[i]);
+        (*forces)[a1[i]] += force1;
+        (*forces)[a2[i]] -= force1;
+        if (virial)
+          energies->addVirial(force1, Vector3D(dx[i], dy[i], dz[i]));
+      }
+    }
+  }
+
+  template<class TBoundaryConditions>
+  inline void BondedSystemForce<TBoundaryConditions>::angles(
+    const TBoundaryConditions &boundary, const Vector3DBlock *pos,
+    Vector3DBlock *forces, ScalarStructure *energies, unsigned int from,
+    unsigned int to) {
+    Real *d[9], *f[6];
+    for (unsigned int j = 0; j < 9; j++) d[j] = &myD[j * CHUNK];
+    for (unsigned int j = 0; j < 6; j++) f[j] = &myF[j * CHUNK];
+    const bool virial = energies->virial();
+
+    for (unsigned int start = from; start < to; start += CHUNK) {
+      const unsigned int n = std::min<unsigned int>(CHUNK, to - start);
+      const int *a1 = &myAngleA1[start], *a2 = &myAngleA2[start],
+        *a3 = &myAngleA3[start];
+      const Real *k = &myAngleK[start], *theta0 = &myAngleTheta0[start],
+        *kUB = &myAngleUBK[start], *r0UB = &myAngleUBR0[start];
+
+      // Gather r12, r32 and r13
+      for (unsigned int i = 0; i < n; i++) {
+        const Vector3D &atom1 = (*pos)[a1[i]];
+        const Vector3D &atom2 = (*pos)[a2[i]];
+        const Vector3D &atom3 = (*pos)[a3[i]];
+        Vector3D r12(boundary.minimalDifference(atom2, atom1));
+        Vector3D r32(boundary.minimalDifference(atom2, atom3));
+        Vector3D r13(boundary.minimalDifference(atom3, atom1));
+        for (unsigned int j = 0; j < 3; j++) {
+          d[j][i] = r12.c[j];
+          d[3 + j][i] = r32.c[j];
+          d[6 + j][i] = r13.c[j];
+        }
+      }
+
+      // Compute the forces on atom 1 and 3
+      Real energy = 0;
+      for (unsigned int i = 0; i < n; i++) {
+        const Real x12 = d[0][i], y12 = d[1][i], z12 = d[2][i];
+        const Real x32 = d[3][i], y32 = d[4][i], z32 = d[5][i];
+        const Real x13 = d[6][i], y13 = d[7][i], z13 = d[8][i];
+
+        Real d12 = sqrt(x12 * x12 + y12 * y12 + z12 * z12);
+        Real d32 = sqrt(x32 * x32 + y32 * y32 + z32 * z32);
+        Real d13 = sqrt(x13 * x13 + y13 * y13 + z13 * z13);
+
+        Real cx = y12 * z32 - z12 * y32;
+        Real cy = z12 * x32 - x12 * z32;
+        Real cz = x12 * y32 - y12 * x32;
+        Real theta = atan2(sqrt(cx * cx + cy * cy + cz * cz),
+                           x12 * x32 + y12 * y32 + z12 * z32);
+        Real sinTheta = sin(theta);
+        Real cosTheta = cos(theta);
+
+        Real dpotdtheta = 2.0 * k[i] * (theta - theta0[i]);
+
+        // Unit vectors and dtheta/dx of atom 1 and 3
+        Real ux12 = x12 / d12, uy12 = y12 / d12, uz12 = z12 / d12;
+        Real ux32 = x32 / d32, uy32 = y32 / d32, uz32 = z32 / d32;
+        Real s1 = sinTheta * d12, s3 = sinTheta * d32;
+
+        // Urey Bradley
+        Real ub = 2.0 * kUB[i] * (d13 - r0UB[i]);
+        Real ubx = x13 / d13 * ub, uby = y13 / d13 * ub, ubz = z13 / d13 * ub;
+
+        f[0][i] = -((ux12 * cosTheta - ux32) / s1) * dpotdtheta - ubx;
+        f[1][i] = -((uy12 * cosTheta - uy32) / s1) * dpotdtheta - uby;
+        f[2][i] = -((uz12 * cosTheta - uz32) / s1) * dpotdtheta - ubz;
+        f[3][i] = -((ux32 * cosTheta - ux12) / s3) * dpotdtheta + ubx;
+        f[4][i] = -((uy32 * cosTheta - uy12) / s3) * dpotdtheta + uby;
+        f[5][i] = -((uz32 * cosTheta - uz12) / s3) * dpotdtheta + ubz;
+
+        energy += k[i] * (theta - theta0[i]) * (theta - theta0[i]) +
+          kUB[i] * (d13 - r0UB[i]) * (d13 - r0UB[i]);
+      }
+      (*energies)[ScalarStructure::ANGLE] += energy;
+
+      // Scatter
+      for (unsigned int i = 0; i < n; i++) {
+        Vector3D force1(f[0][i], f[1][i], f[2][i]);
+        Vector3D force3(f[3][i], f[4][i], f[5][i]);
+        (*forces)[a1[i]] += force1;
+        (*forces)[a2[i]] += -force1 - force3;
+        (*forces)[a3[i]] += force3;
+
+        if (virial) {
+          Real xy = f[0][i] * d[1][i] + f[3][i] * d[4][i];
+          Real xz = f[0][i] * d[2][i] + f[3][i] * d[5][i];
+          Real yz = f[1][i] * d[2][i] + f[4][i] * d[5][i];
+          (*energies)[ScalarStructure::VIRIALXX] +=
+            f[0][i] * d[0][i] + f[3][i] * d[3][i];
+          (*energies)[ScalarStructure::VIRIALXY] += xy;
+          (*energies)[ScalarStructure::VIRIALXZ] += xz;
+          (*energies)[ScalarStructure::VIRIALYX] += xy;
+          (*energies)[ScalarStructure::VIRIALYY] +=
+            f[1][i] * d[1][i] + f[4][i] * d[4][i];
+          (*energies)[ScalarStructure::VIRIALYZ] += yz;
+          (*energies)[ScalarStructure::VIRIALZX] += xz;
+          (*energies)[ScalarStructure::VIRIALZY] += yz;
+          (*energies)[ScalarStructure::VIRIALZZ] +=
+            f[2][i] * d[2][i] + f[5][i] * d[5][i];
+        }
+      }
+    }
+  }
+
+  template<class TBoundaryConditions>
+  inline void BondedSystemForce<TBoundaryConditions>::gatherChain(
+    const TBoundaryConditions &boundary, const Vector3DBlock *pos,
+    unsigned int i, int a1, int a2, int a3, int a4) {
+    Vector3D r12(boundary.minimalDifference((*pos)[a2], (*pos)[a1]));
+    Vector3D r23(boundary.minimalDifference((*pos)[a3], (*pos)[a2]));
+    Vector3D r34(boundary.minimalDifference((*pos)[a4], (*pos)[a3]));
+    for (unsigned int j = 0; j < 3; j++) {
+      myD[j * CHUNK + i] = r12.c[j];
+      myD[(3 + j) * CHUNK + i] = r23.c[j];
+      myD[(6 + j) * CHUNK + i] = r34.c[j];
+    }
+  }
+
+  template<class TBoundaryConditions>
+  inline void BondedSystemForce<TBoundaryConditions>::torsions(
+    const TBoundaryConditions &boundary, const TorsionTerms &terms,
+    const Vector3DBlock *pos, Vector3DBlock *forces,
+    ScalarStructure *energies, Real &energy, unsigned int from,
+    unsigned int to) {
+    const Real *d = &myD[0];
+
+    for (unsigned int start = from; start < to; start += CHUNK) {
+      const unsigned int n = std::min<unsigned int>(CHUNK, to - start);
+
+      for (unsigned int i = 0; i < n; i++)
+        gatherChain(boundary, pos, i, terms.a1[start + i],
+                    terms.a2[start + i], terms.a3[start + i],
+                    terms.a4[start + i]);
+
+      for (unsigned int i = 0; i < n; i++) {
+        Vector3D r12(d[i], d[CHUNK + i], d[2 * CHUNK + i]);
+        Vector3D r23(d[3 * CHUNK + i], d[4 * CHUNK + i], d[5 * CHUNK + i]);
+        Vector3D r34(d[6 * CHUNK + i], d[7 * CHUNK + i], d[8 * CHUNK + i]);
+
+        Vector3D a(r12.cross(r23));
+        Vector3D b(r23.cross(r34));
+        Vector3D c(r23.cross(a));
+
+        Real ra = 1.0 / a.norm();
+        Real rb = 1.0 / b.norm();
+        Real rc = 1.0 / c.norm();
+
+        a *= ra;
+        b *= rb;
+        c *= rc;
+
+        Real cosPhi = a.dot(b);
+        Real sinPhi = c.dot(b);
+        Real phi = -atan2(sinPhi, cosPhi);
+
+        Real dpotdphi = 0.;
+        for (int j = terms.first[start + i]; j < terms.first[start + i + 1];
+             j++) {
+          const int periodicity = terms.periodicity[j];
+          const Real forceConstant = terms.forceConstant[j];
+          const Real phaseShift = terms.phaseShift[j];
+
+          if (periodicity > 0) {
+            dpotdphi -= periodicity * forceConstant *
+              sin(periodicity * phi + phaseShift);
+            energy += forceConstant *
+              (1.0 + cos(periodicity * phi + phaseShift));
+          } else {
+            Real diff = phi - phaseShift;
+
+            if (diff < -M_PI)
+              diff += 2 * M_PI;
+            else if (diff > M_PI)
+              diff -= 2 * M_PI;
+
+            dpotdphi += 2.0 * forceConstant * diff;
+            energy += forceConstant * diff * diff;
+          }
+        }
+
+        torsionForce(i, r12, r23, r34, a, b, c, ra, rb, rc, cosPhi, sinPhi,
+                     dpotdphi);
+      }
+
+      scatterChains(forces, energies, n, &terms.a1[start],
+                    &terms.a2[start], &terms.a3[start], &terms.a4[start]);
+    }
+  }
+
+  template<class TBoundaryConditions>
+  inline void BondedSystemForce<TBoundaryConditions>::rbTorsions(
+    const TBoundaryConditions &boundary, const Vector3DBlock *pos,
+    Vector3DBlock *forces, ScalarStructure *energies, unsigned int from,
+    unsigned int to) {
+    const Real *d = &myD[0];
+    Real &energy = (*energies)[ScalarStructure::DIHEDRAL];
+
+    for (unsigned int start = from; start < to; start += CHUNK) {
+      const unsigned int n = std::min<unsigned int>(CHUNK, to - start);
+
+      for (unsigned int i = 0; i < n; i++)
+        gatherChain(boundary, pos, i, myRBA1[start + i], myRBA2[start + i],
+                    myRBA3[start + i], myRBA4[start + i]);
+
+      for (unsigned int i = 0; i < n; i++) {
+        Vector3D r12(d[i], d[CHUNK + i], d[2 * CHUNK + i]);
+        Vector3D r23(d[3 * CHUNK + i], d[4 * CHUNK + i], d[5 * CHUNK + i]);
+        Vector3D r34(d[6 * CHUNK + i], d[7 * CHUNK + i], d[8 * CHUNK + i]);
+
+        Vector3D a(r12.cross(r23));
+        Vector3D b(r23.cross(r34));
+        Vector3D c(r23.cross(a));
+
+        Real ra = 1.0 / a.norm();
+        Real rb = 1.0 / b.norm();
+        Real rc = 1.0 / c.norm();
+
+        a *= ra;
+        b *= rb;
+        c *= rc;
+
+        Real cosPhi = a.dot(b);
+        Real sinPhi = c.dot(b);
+        Real phi = -atan2(sinPhi, cosPhi);
+
+        const Real *Cn = &myRBC[6 * (start + i)];
+        Real cosPsi = cos(phi - M_PI);
+        Real sinPsi = sin(phi - M_PI);
+        Real cosNm1 = 1.;
+        Real dpotdphi = 0.;
+
+        energy += Cn[0];
+        for (int j = 1; j < 6; j++) {
+          dpotdphi -= (Real)j * Cn[j] * sinPsi * cosNm1;
+          cosNm1 *= cosPsi;
+          energy += Cn[j] * cosNm1;
+        }
+
+        torsionForce(i, r12, r23, r34, a, b, c, ra, rb, rc, cosPhi, sinPhi,
+                     dpotdphi);
+      }
+
+      scatterChains(forces, energies, n, &myRBA1[start],
+                    &myRBA2[start], &myRBA3[start], &myRBA4[start]);
+    }
+  }
+
+  template<class TBoundaryConditions>
+  inline void BondedSystemForce<TBoundaryConditions>::torsionForce(
+    unsigned int i, const Vector3D &r12, const Vector3D &r23,
+    const Vector3D &r34, const Vector3D &a, const Vector3D &b,
+    const Vector3D &c, Real ra, Real rb, Real rc, Real cosPhi, Real sinPhi,
+    Real dpotdphi) {
+    Vector3D f1, f2, f3;
+
+    // To prevent potential singularities, if abs(sinPhi) <= 0.1, then
+    // use another method of calculating the gradient.
+    if (fabs(sinPhi) > 0.1) {
+      //  use the sin version to avoid 1/cos terms
+      Vector3D dcosdA((a * cosPhi - b) * ra);
+      Vector3D dcosdB((b * cosPhi - a) * rb);
+
+      Real k1 = dpotdphi / sinPhi;
+
+      f1.c[0] = k1 * (r23.c[1] * dcosdA.c[2] - r23.c[2] * dcosdA.c[1]);
+      f1.c[1] = k1 * (r23.c[2] * dcosdA.c[0] - r23.c[0] * dcosdA.c[2]);
+      f1.c[2] = k1 * (r23.c[0] * dcosdA.c[1] - r23.c[1] * dcosdA.c[0]);
+
+      f3.c[0] = k1 * (r23.c[2] * dcosdB.c[1] - r23.c[1] * dcosdB.c[2]);
+      f3.c[1] = k1 * (r23.c[0] * dcosdB.c[2] - r23.c[2] * dcosdB.c[0]);
+      f3.c[2] = k1 * (r23.c[1] * dcosdB.c[0] - r23.c[0] * dcosdB.c[1]);
+
+      f2.c[0] = k1 *
+        (r12.c[2] * dcosdA.c[1] - r12.c[1] * dcosdA.c[2] +
+         r34.c[1] * dcosdB.c[2] - r34.c[2] * dcosdB.c[1]);
+      f2.c[1] = k1 *
+        (r12.c[0] * dcosdA.c[2] - r12.c[2] * dcosdA.c[0] +
+         r34.c[2] * dcosdB.c[0] - r34.c[0] * dcosdB.c[2]);
+      f2.c[2] = k1 *
+        (r12.c[1] * dcosdA.c[0] - r12.c[0] * dcosdA.c[1] +
+         r34.c[0] * dcosdB.c[1] - r34.c[1] * dcosdB.c[0]);
+    } else {
+      //  This angle is closer to 0 or 180 than it is to
+      //  90, so use the cos version to avoid 1/sin terms
+      Vector3D dsindC((c * sinPhi - b) * rc);
+      Vector3D dsindB((b * sinPhi - c) * rb);
+
+      Real k1 = -dpotdphi / cosPhi;
+
+      f1.c[0] = k1 *
+        ((r23.c[1] * r23.c[1] + r23.c[2] * r23.c[2]) * dsindC.c[0] -
+         r23.c[0] * r23.c[1] * dsindC.c[1] -
+         r23.c[0] * r23.c[2] * dsindC.c[2]);
+      f1.c[1] = k1 *
+        ((r23.c[2] * r23.c[2] + r23.c[0] * r23.c[0]) * dsindC.c[1] -
+         r23.c[1] * r23.c[2] * dsindC.c[2] -
+         r23.c[1] * r23.c[0] * dsindC.c[0]);
+      f1.c[2] = k1 *
+        ((r23.c[0] * r23.c[0] + r23.c[1] * r23.c[1]) * dsindC.c[2] -
+         r23.c[2] * r23.c[0] * dsindC.c[0] -
+         r23.c[2] * r23.c[1] * dsindC.c[1]);
+
+      f3 = dsindB.cross(r23) * k1;
+
+      f2.c[0] = k1 *
+        (-(r23.c[1] * r12.c[1] + r23.c[2] * r12.c[2]) * dsindC.c[0] +
+         (2.0 * r23.c[0] * r12.c[1] - r12.c[0] * r23.c[1]) * dsindC.c[1] +
+         (2.0 * r23.c[0] * r12.c[2] - r12.c[0] * r23.c[2]) * dsindC.c[2] +
+         dsindB.c[2] * r34.c[1] - dsindB.c[1] * r34.c[2]);
+      f2.c[1] = k1 *
+        (-(r23.c[2] * r12.c[2] + r23.c[0] * r12.c[0]) * dsindC.c[1] +
+         (2.0 * r23.c[1] * r12.c[2] - r12.c[1] * r23.c[2]) * dsindC.c[2] +
+         (2.0 * r23.c[1] * r12.c[0] - r12.c[1] * r23.c[0]) * dsindC.c[0] +
+         dsindB.c[0] * r34.c[2] - dsindB.c[2] * r34.c[0]);
+      f2.c[2] = k1 *
+        (-(r23.c[0] * r12.c[0] + r23.c[1] * r12.c[1]) * dsindC.c[2] +
+         (2.0 * r23.c[2] * r12.c[0] - r12.c[2] * r23.c[0]) * dsindC.c[0] +
+         (2.0 * r23.c[2] * r12.c[1] - r12.c[2] * r23.c[1]) * dsindC.c[1] +
+         dsindB.c[1] * r34.c[0] - dsindB.c[0] * r34.c[1]);
+    }
+
+    for (unsigned int j = 0; j < 3; j++) {
+      myF[j * CHUNK + i] = f1.c[j];
+      myF[(3 + j) * CHUNK + i] = f2.c[j];
+      myF[(6 + j) * CHUNK + i] = f3.c[j];
+    }
+  }
+
+  template<class TBoundaryConditions>
+  inline void BondedSystemForce<TBoundaryConditions>::scatterChains(
+    Vector3DBlock *forces, ScalarStructure *energies, unsigned int n,
+    const int *a1, const int *a2, const int *a3, const int *a4) {
+    const Real *d = &myD[0], *f = &myF[0];
+    const bool virial = energies->virial();
+
+    for (unsigned int i = 0; i < n; i++) {
+      Vector3D f1(f[i], f[CHUNK + i], f[2 * CHUNK + i]);
+      Vector3D f2(f[3 * CHUNK + i], f[4 * CHUNK + i], f[5 * CHUNK + i]);
+      Vector3D f3(f[6 * CHUNK + i], f[7 * CHUNK + i], f[8 * CHUNK + i]);
+
+      (*forces)[a1[i]] += f1;
+      (*forces)[a2[i]] += f2 - f1;
+      (*forces)[a3[i]] += f3 - f2;
+      (*forces)[a4[i]] -= f3;
+
+      if (virial) {
+        Vector3D r12(d[i], d[CHUNK + i], d[2 * CHUNK + i]);
+        Vector3D r23(d[3 * CHUNK + i], d[4 * CHUNK + i], d[5 * CHUNK + i]);
+        Vector3D r34(d[6 * CHUNK + i], d[7 * CHUNK + i], d[8 * CHUNK + i]);
+
+        Real xy = f1.c[0] * r12.c[1] + f2.c[0] * r23.c[1] + f3.c[0] * r34.c[1];
+        Real xz = f1.c[0] * r12.c[2] + f2.c[0] * r23.c[2] + f3.c[0] * r34.c[2];
+        Real yz = f1.c[1] * r12.c[2] + f2.c[1] * r23.c[2] + f3.c[1] * r34.c[2];
+
+        (*energies)[ScalarStructure::VIRIALXX] +=
+          f1.c[0] * r12.c[0] + f2.c[0] * r23.c[0] + f3.c[0] * r34.c[0];
+        (*energies)[ScalarStructure::VIRIALXY] += xy;
+        (*energies)[ScalarStructure::VIRIALXZ] += xz;
+        (*energies)[ScalarStructure::VIRIALYX] += xy;
+        (*energies)[ScalarStructure::VIRIALYY] +=
+          f1.c[1] * r12.c[1] + f2.c[1] * r23.c[1] + f3.c[1] * r34.c[1];
+        (*energies)[ScalarStructure::VIRIALYZ] += yz;
+        (*energies)[ScalarStructure::VIRIALZX] += xz;
+        (*energies)[ScalarStructure::VIRIALZY] += yz;
+        (*energies)[ScalarStructure::VIRIALZZ] +=
+          f1.c[2] * r12.c[2] + f2.c[2] * r23.c[2] + f3.c[2] * r34.c[2];
+      }
+    }
+  }
+}
+#endif /* BONDEDSYSTEMFORCE_H */
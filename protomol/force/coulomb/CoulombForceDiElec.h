@@ -58,8 +58,8 @@ namespace ProtoMol {
       Real rDiElecP1 = DiElecCom * (S * S * Dist * Dist + 2 * S * Dist + 2);
       Real rDiElec = 1.0 / (D - (rDiElecP1 * rDiElecEXP));
 
-      energy = topo->atoms[atom1].scaledCharge *
-               topo->atoms[atom2].scaledCharge *
+      energy = topo->atomCharge[atom1] *
+               topo->atomCharge[atom2] *
                rDist * rDiElec;
 
       if (excl == EXCLUSION_MODIFIED)
@@ -7,6 +7,7 @@
 #include <protomol/topology/ExclusionTable.h>
 #include <protomol/config/Parameter.h>
 #include <protomol/base/PMConstants.h>
+#include <protomol/base/FastMath.h>
 #include <protomol/base/Report.h>
 #include <string>
 #include <math.h>
@@ -47,8 +48,8 @@ namespace ProtoMol {
       // If either molecule belongs to a water, do nothing.
       // Won't happen in most simulations, but could in the 
       // case of comparing forces.
-      if (topo->molecules[topo->atoms[atom1].molecule].water ||
-	      topo->molecules[topo->atoms[atom2].molecule].water)
+      if (topo->molecules[topo->atomMolecule[atom1]].water ||
+	      topo->molecules[topo->atomMolecule[atom2]].water)
 	        return;
 
       //std::cout << "EPS: " << EPS << std::endl;
@@ -65,12 +66,12 @@ namespace ProtoMol {
       Real rDp1 = 1.0 / Dp1;
       Real Dm1 = D - 1.0;
       Real k = Dm1 * 0.5;
-      Real rDiElecEXP = k * exp(-alpha_ij * Dist);
+      Real rDiElecEXP = k * fastExp(-alpha_ij * Dist);
       Real DiElec = Dp1 / (1.0 + rDiElecEXP) - 1.0;
       Real rDiElec = 1.0 / DiElec;
 
-      energy = topo->atoms[atom1].scaledCharge *
-               topo->atoms[atom2].scaledCharge *
+      energy = topo->atomCharge[atom1] *
+               topo->atomCharge[atom2] *
                rDist * rDiElec *
                (excl == EXCLUSION_MODIFIED ? topo->coulombScalingFactor : 1);
 
@@ -5,6 +5,7 @@
 #include <protomol/force/Force.h>
 #include <protomol/parallel/Parallel.h>
 #include <protomol/topology/Topology.h>
+#include <protomol/force/MixedPrecision.h>
 
 namespace ProtoMol {
   //____ NonbondedCutoffForce
@@ -34,7 +35,27 @@ namespace ProtoMol {
     // New methods of class NonbondedCutoffForce
     //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
   protected:
+    /// Runs the single precision pair kernel if mixedPrecision is set and
+    /// TOneAtomPair has one, the single positions of the topology have to be
+    /// refreshed before.
     void doEvaluate(const GenericTopology *topo, unsigned int n) {
+      if (topo->mixedPrecision)
+        doEvaluatePairs<MixedPrecision<TOneAtomPair>::SUPPORTED>(topo, n);
+      else
+        doEvaluatePairs<false>(topo, n);
+    }
+
+    /// The modified pairs, left out of the pair loop
+    void doEvaluateModified(const GenericTopology *topo) {
+      if (topo->mixedPrecision)
+        doEvaluateModifiedPairs<MixedPrecision<TOneAtomPair>::SUPPORTED>(topo);
+      else
+        doEvaluateModifiedPairs<false>(topo);
+    }
+
+  private:
+    template<bool SINGLE>
+    void doEvaluatePairs(const GenericTopology *topo, unsigned int n) {
       CellPairType thisPair;
       unsigned int count = 0;
       for (; !enumerator.done(); enumerator.next()) {
@@ -45,14 +66,33 @@ namespace ProtoMol {
           count++;
           if (count > n) break;
         }
-        for (int i = thisPair.first; i != -1; i = topo->atoms[i].cellListNext)
-          for (int j =
-                 (notSameCell ? thisPair.second : topo->atoms[i].cellListNext);
-               j != -1; j = topo->atoms[j].cellListNext)
-            myOneAtomPair.doOneAtomPair(i, j);
+        // The atoms of a cell are linked in increasing order, so the
+        // exclusions of i are merged in with its row
+        for (int i = thisPair.first; i != -1; i = topo->cellListNext[i]) {
+          const int first =
+            (notSameCell ? thisPair.second : topo->cellListNext[i]);
+          ExclusionRow row = topo->exclusions.getRow(i, first);
+          for (int j = first; j != -1; j = topo->cellListNext[j]) {
+            const ExclusionClass excl = row.next(j);
+            if (excl == EXCLUSION_NONE || !TOneAtomPair::EXCLUDE)
+              MixedPrecisionKernel<SINGLE>::doOneAtomPair(myOneAtomPair,
+                                                          i, j, excl);
+          }
+        }
       }
     }
 
+    template<bool SINGLE>
+    void doEvaluateModifiedPairs(const GenericTopology *topo) {
+      if (!TOneAtomPair::EXCLUDE) return;
+
+      const std::vector<PairInt> &modified = topo->exclusions.getModified();
+      for (unsigned int k = 0; k < modified.size(); k++)
+        MixedPrecisionKernel<SINGLE>::
+          doOneAtomPair(myOneAtomPair, modified[k].first, modified[k].second,
+                        EXCLUSION_MODIFIED);
+    }
+
     //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
     // From class Force
     //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -50,8 +50,11 @@ namespace ProtoMol {
       //  dynamic_cast<const RealTopologyType *>(topo);
       this->myOneAtomPair.initialize(realTopo, positions, forces, energies);
       realTopo->updateCellLists(positions);
+      if (topo->mixedPrecision && MixedPrecision<TOneAtomPair>::SUPPORTED)
+        realTopo->updateSinglePrecision(positions);
       this->enumerator.initialize(realTopo, this->myCutoff);
       this->doEvaluate(topo, realTopo->cellLists.size());
+      this->doEvaluateModified(topo);
     }
 
     virtual void parallelEvaluate(const GenericTopology *topo,
@@ -63,6 +66,8 @@ namespace ProtoMol {
       
       this->myOneAtomPair.initialize(realTopo, positions, forces, energies);
       realTopo->updateCellLists(positions);
+      if (topo->mixedPrecision && MixedPrecision<TOneAtomPair>::SUPPORTED)
+        realTopo->updateSinglePrecision(positions);
       this->enumerator.initialize(realTopo, this->myCutoff);
       
       unsigned int n = realTopo->cellLists.size();
@@ -71,8 +76,10 @@ namespace ProtoMol {
       for (unsigned int i = 0; i < count; i++) {
         unsigned int l = (n * (i + 1)) / count - (n * i) / count;
 
-        if (Parallel::next()) this->doEvaluate(topo, l);
-        else this->enumerator.nextNewPair(l);
+        if (Parallel::next()) {
+          this->doEvaluate(topo, l);
+          if (i == 0) this->doEvaluateModified(topo);
+        } else this->enumerator.nextNewPair(l);
       }
     }
                                                              
@@ -10,6 +10,7 @@
 #include <protomol/force/CoulombForce.h>
 #include <protomol/base/Timer.h>
 #include <protomol/base/MathUtilities.h>
+#include <protomol/base/FastMath.h>
 #include <protomol/base/PMConstants.h>
 #include <protomol/topology/Topology.h>
 #include <protomol/topology/PeriodicBoundaryConditions.h>
@@ -73,6 +74,12 @@ namespace ProtoMol {
 		  Real& realEnergy,
 		  unsigned int n);
 
+    void realTermBlock(const RealTopologyType* realTopo,
+		       Vector3DBlock* forces, 
+		       ScalarStructure* energies,
+		       Real& realEnergy,
+		       int mi, Vector3D& fi, unsigned int n);
+
     void reciprocalTerm(const RealTopologyType* realTopo,
 			const Vector3DBlock* positions, 
 			Vector3DBlock* forces, 
@@ -200,6 +207,17 @@ namespace ProtoMol {
     TSwitchingFunction switchingFunction;
     EnumeratorType enumerator;
     std::vector<Vector3D> myLattice;
+    // Pairs of one atom in the real term, evaluated a block at a time by
+    // the lane functions of FastMath
+    enum {REAL_BLOCK = 64};
+    int myBlockJ[REAL_BLOCK];
+    Vector3D myBlockRij[REAL_BLOCK];
+    Real myBlockRSquared[REAL_BLOCK];
+    Real myBlockQQ[REAL_BLOCK];
+    Real myBlockRr[REAL_BLOCK];
+    Real myBlockAr[REAL_BLOCK];
+    Real myBlockErfc[REAL_BLOCK];
+    Real myBlockExp[REAL_BLOCK];
     unsigned int myOldAtomCount; // Keep track of old values and hope
     int myOldHKLmax;             // we do not need to reallocate memory ...
 #if defined(DEBUG_EWALD_TIMING)
@@ -695,7 +713,7 @@ namespace ProtoMol {
     if(correction){
       Real q = 0.0;
       for(unsigned int i=0;i<atomCount;i++){
-	q += realTopo->atoms[i].scaledCharge*realTopo->atoms[i].scaledCharge;
+	q += realTopo->atomCharge[i]*realTopo->atomCharge[i];
       }
       myPointSelfEnergy = -q*myAlpha/sqrt(M_PI);
     }
@@ -707,7 +725,7 @@ namespace ProtoMol {
     if(correction){
       Real q = 0.0;
       for(unsigned int i=0;i<atomCount;i++){
-	q += realTopo->atoms[i].scaledCharge;
+	q += realTopo->atomCharge[i];
       }
       if(fabs(q * 0.00268283) > 1.0e-5)
 	myChargedSystemEnergy = -M_PI/(2.0*myV*myAlphaSquared)*q*q;
@@ -767,8 +785,6 @@ namespace ProtoMol {
 
     // Real-space term
     CellPairType thisPair;
-    bool doVirial = energies->virial();
-    bool doMolVirial = energies->molecularVirial();
     unsigned int count = 0;
     for (; !enumerator.done(); enumerator.next()) {
       enumerator.get(thisPair);
@@ -780,14 +796,15 @@ namespace ProtoMol {
 	  break;
       }
 
-      for(int i=thisPair.first; i!=-1; i=realTopo->atoms[i].cellListNext){
-	Real qi  = realTopo->atoms[i].scaledCharge;
+      for(int i=thisPair.first; i!=-1; i=realTopo->cellListNext[i]){
+	Real qi  = realTopo->atomCharge[i];
 	Vector3D ri((*positions)[i]),fi;
-	int mi = realTopo->atoms[i].molecule;
-	for(int j=(notSameCell ? thisPair.second:i); j!=-1; j=realTopo->atoms[j].cellListNext){
+	int mi = realTopo->atomMolecule[i];
+	unsigned int pairs = 0;
+	for(int j=(notSameCell ? thisPair.second:i); j!=-1; j=realTopo->cellListNext[j]){
 	  Vector3D rijMinimal(boundaryConditions.minimalDifference(ri,(*positions)[j]));
-	  int mj = realTopo->atoms[j].molecule;
-	  Real qj = realTopo->atoms[j].scaledCharge;
+	  int mj = realTopo->atomMolecule[j];
+	  Real qj = realTopo->atomCharge[j];
 	  bool same = (mi==mj);
 	  ExclusionClass excl = (same?realTopo->exclusions.check(i,j):EXCLUSION_NONE);
 	  if(i == j)
@@ -805,50 +822,23 @@ namespace ProtoMol {
 	    if (rSquared>myRcSquared)
 	      continue;
         
-        
-	    // Energy
-	    Real r = sqrt(rSquared);
 	    Real qq = qi*qj;
 	    if (excl == EXCLUSION_MODIFIED) 
 	      qq *= realTopo->coulombScalingFactor;
-	    // Approximation Abramowitz & Stegun p299.
-	    // Energy
-#ifndef USE_EWALD_EXACT_ERF
-	    Real rr = 1.0/r;
-	    Real ar = myAlpha*r;
-	    Real e = qq*exp(-ar*ar);
-	    Real energy = poly5(ar)*e*rr;
-	    Real force = ((energy+my2AlphaPI*e)*rr*rr);
-#else	  
-	    Real a = erfc(myAlpha*r)/r;
-	    Real energy = qq*a;
-	    Real force = qq*(a+my2AlphaPI*exp(-myAlphaSquared*rSquared))/rSquared;
-#endif
-	    // Calculate the switched force and energy.
-	    Real switchingValue, switchingDeriv;
-	    switchingFunction(switchingValue, switchingDeriv, rSquared);
-	    // This has a - sign because the force is the negative of the 
-	    // derivative of the energy (divided by the distance between the atoms).
-	    force = force * switchingValue - energy * switchingDeriv;
-	    energy = energy * switchingValue;
-	    // Force, F_ij
-	    realEnergy += energy; 
-	    Vector3D fij(rij*force);
-	    fi -= fij;
-	    (*forces)[j] += fij;
-
-	    // compute the vector between molecular centers of mass
-	    if(!same && doMolVirial){
-	      // Add to the atomic and molecular virials
-	      energies->addVirial(fij,rij,realTopo->boundaryConditions.minimalDifference(realTopo->molecules[mi].position,
-											  realTopo->molecules[mj].position));
-	    }
-	    else if(doVirial) {
-	      energies->addVirial(fij,rij);
+
+	    // Energy and force of the pairs within the cutoff a block at a time
+	    myBlockJ[pairs] = j;
+	    myBlockRij[pairs] = rij;
+	    myBlockRSquared[pairs] = rSquared;
+	    myBlockQQ[pairs] = qq;
+	    if (++pairs == REAL_BLOCK) {
+	      realTermBlock(realTopo,forces,energies,realEnergy,mi,fi,pairs);
+	      pairs = 0;
 	    }
 	    excl = EXCLUSION_NONE;
 	  }
 	}
+	realTermBlock(realTopo,forces,energies,realEnergy,mi,fi,pairs);
 	(*forces)[i] += fi;
       }
     }
@@ -858,6 +848,72 @@ namespace ProtoMol {
   }
 
 
+  template <class TBoundaryConditions, 
+	    class TCellManager,
+	    bool  real,
+	    bool  reciprocal,
+	    bool  correction,
+	    class TSwitchingFunction>
+  void NonbondedFullEwaldSystemForce<TBoundaryConditions,
+				     TCellManager,
+				     real,
+				     reciprocal,
+				     correction,
+				     TSwitchingFunction>::realTermBlock(const RealTopologyType* realTopo,
+									Vector3DBlock* forces, 
+									ScalarStructure* energies,
+									Real& realEnergy,
+									int mi, Vector3D& fi,
+									unsigned int n) {
+    bool doVirial = energies->virial();
+    bool doMolVirial = energies->molecularVirial();
+
+    // 1/r, erfc(alpha r) and exp(-alpha^2 r^2) of the block on lanes
+    fastRsqrt(n,myBlockRSquared,myBlockRr);
+    for(unsigned int k=0;k<n;k++)
+      myBlockAr[k] = myAlpha*myBlockRSquared[k]*myBlockRr[k];
+#ifndef USE_EWALD_EXACT_ERF
+    fastErfcExp(n,myBlockAr,myBlockErfc,myBlockExp);
+#else
+    for(unsigned int k=0;k<n;k++){
+      myBlockErfc[k] = erfc(myBlockAr[k]);
+      myBlockExp[k] = exp(-myBlockAr[k]*myBlockAr[k]);
+    }
+#endif
+
+    for(unsigned int k=0;k<n;k++){
+      int j = myBlockJ[k];
+      Real rr = myBlockRr[k];
+      Real a = myBlockErfc[k]*rr;
+      Real energy = myBlockQQ[k]*a;
+      Real force = myBlockQQ[k]*(a+my2AlphaPI*myBlockExp[k])*rr*rr;
+      // Calculate the switched force and energy.
+      Real switchingValue, switchingDeriv;
+      switchingFunction(switchingValue, switchingDeriv, myBlockRSquared[k]);
+      // This has a - sign because the force is the negative of the 
+      // derivative of the energy (divided by the distance between the atoms).
+      force = force * switchingValue - energy * switchingDeriv;
+      energy = energy * switchingValue;
+      // Force, F_ij
+      realEnergy += energy; 
+      Vector3D fij(myBlockRij[k]*force);
+      fi -= fij;
+      (*forces)[j] += fij;
+
+      // compute the vector between molecular centers of mass
+      int mj = realTopo->atomMolecule[j];
+      if(mi != mj && doMolVirial){
+	// Add to the atomic and molecular virials
+	energies->addVirial(fij,myBlockRij[k],realTopo->boundaryConditions.minimalDifference(realTopo->molecules[mi].position,
+											      realTopo->molecules[mj].position));
+      }
+      else if(doVirial) {
+	energies->addVirial(fij,myBlockRij[k]);
+      }
+    }
+  }
+
+
 
   template <class TBoundaryConditions, 
 	    class TCellManager,
@@ -891,7 +947,7 @@ namespace ProtoMol {
       Vector3D r(boundaryConditions.minimalPosition((*positions)[j]));
       // Multiply charge only with x-coord of each particle
       // since we use the add theorem 
-      Real qi = realTopo->atoms[j].scaledCharge;
+      Real qi = realTopo->atomCharge[j];
       Real x = r.c[0]*2.0*M_PI*myLXr;
       Real y = r.c[1]*2.0*M_PI*myLYr;
       Real z = r.c[2]*2.0*M_PI*myLZr;
@@ -986,7 +1042,7 @@ namespace ProtoMol {
 #endif    
       for(unsigned int i=0;i<atomCount;i++){
 #ifdef USE_EWALD_NO_SINCOS_TABLE
-	Real qi = realTopo->atoms[i].scaledCharge;
+	Real qi = realTopo->atomCharge[i];
 	// It does not matter if coordinates are not in the minimal image since
 	// they are multiplied by 2PI/l, which is a shift of 2PI of a. 
 	Real a = k.dot(boundaryConditions.minimalPosition((*positions)[i]));
@@ -1037,7 +1093,7 @@ namespace ProtoMol {
 	// this expression is taken from Alejandre, Tildesley, and Chapela, J. Chem. Phys. 102 (11), 4574.
 	if(doMolVirial){
 	  // get the ID# of the molecule to which this atom belongs
-	  int Mi = realTopo->atoms[i].molecule;
+	  int Mi = realTopo->atomMolecule[i];
 	  
 	  // compute the vector from atom i to the center of mass of the molecule
 	  Vector3D ria(boundaryConditions.minimalPosition((*positions)[i]));
@@ -1110,16 +1166,22 @@ namespace ProtoMol {
       ExclusionPair excl = exclusions[i];
       Real rSquared;
       Vector3D rij(realTopo->boundaryConditions.minimalDifference((*positions)[excl.a1],(*positions)[excl.a2],rSquared));
-      Real qq = realTopo->atoms[excl.a1].scaledCharge*realTopo->atoms[excl.a2].scaledCharge;
+      Real qq = realTopo->atomCharge[excl.a1]*realTopo->atomCharge[excl.a2];
       if (excl.excl == EXCLUSION_MODIFIED)
 	qq *= 1-realTopo->coulombScalingFactor;
       Real r  = sqrt(rSquared);
       Real rr = 1/r;
+#ifndef USE_EWALD_EXACT_ERF
+      Real expTerm;
+      Real e = (1.0-fastErfcExp(myAlpha*r,expTerm))*rr;
+#else
+      Real expTerm = exp(-myAlphaSquared*rSquared);
       Real e = erf(myAlpha*r)*rr;
+#endif
       // Intra-molecular selv energy
       intraMolecularEnergy -= qq*e;
       // Intra-molecular selv force
-      Vector3D fij(rij*(qq*(my2AlphaPI*exp(-myAlphaSquared*rSquared)-e)*rr*rr));
+      Vector3D fij(rij*(qq*(my2AlphaPI*expTerm-e)*rr*rr));
       (*forces)[excl.a1] -= fij;
       (*forces)[excl.a2] += fij;
       if(doVirial)
@@ -1153,7 +1215,7 @@ namespace ProtoMol {
     const unsigned int atomCount = realTopo->atoms.size();
     Vector3D sum(0,0,0);
     for(unsigned int i=0;i<atomCount;i++)
-      sum += boundaryConditions.minimalPosition((*positions)[i])*realTopo->atoms[i].scaledCharge;
+      sum += boundaryConditions.minimalPosition((*positions)[i])*realTopo->atomCharge[i];
     // Energy
     surfaceDipoleEnergy = 2.0/3.0*M_PI*myVr*sum.normSquared();
   
@@ -1168,7 +1230,7 @@ namespace ProtoMol {
     // Force, F_i and virial_i (not confirmed)
     sum *= 2.0/3.0*M_PI*myVr;
     for(unsigned int i=0;i<atomCount;i++){
-      Vector3D force(sum*realTopo->atoms[i].scaledCharge);
+      Vector3D force(sum*realTopo->atomCharge[i]);
       Vector3D ri(boundaryConditions.minimalPosition((*positions)[i]));
       (*forces)[i] += force;
       if(doVirial){
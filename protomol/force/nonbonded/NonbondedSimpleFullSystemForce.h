@@ -6,6 +6,7 @@
 #include <protomol/parallel/Parallel.h>
 #include <protomol/base/MathUtilities.h>
 #include <protomol/base/Exception.h>
+#include <protomol/force/MixedPrecision.h>
 
 namespace ProtoMol {
   //____ NonbondedSimpleFullSystemForce
@@ -40,7 +41,9 @@ namespace ProtoMol {
     virtual void evaluate(const GenericTopology *topo, const Vector3DBlock *pos,
                           Vector3DBlock *f, ScalarStructure *e) {
       myCached = true;
+      updateSinglePrecision(topo, pos);
       doEvaluate(topo, pos, f, e, 0, topo->atoms.size(), 0, topo->atoms.size());
+      doEvaluateModified(topo);
     }
 
     virtual void parallelEvaluate(const GenericTopology *topo,
@@ -50,12 +53,15 @@ namespace ProtoMol {
         splitRangeArea(static_cast<unsigned int>(Parallel::getAvailableNum()),
                        0, topo->atoms.size(), myFromRange, myToRange);
       myCached = true;
+      updateSinglePrecision(topo, pos);
 
       for (int i = 0; i < Parallel::getAvailableNum(); i++)
-        if (Parallel::next())
+        if (Parallel::next()) {
           doEvaluate(topo, pos, f, e, myFromRange[i].first,
                      myFromRange[i].second, myToRange[i].first,
                      myToRange[i].second);
+          if (i == 0) doEvaluateModified(topo);
+        }
     }
     
     virtual void preProcess(const GenericTopology *apptopo, const Vector3DBlock *positions) {
@@ -122,9 +128,30 @@ namespace ProtoMol {
     // New methods of class NonbondedSimpleFullSystemForce
     //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
   private:
+    // Refreshes the single positions of the topology if the pair loop runs
+    // the single precision kernel
+    void updateSinglePrecision(const GenericTopology *topo,
+                               const Vector3DBlock *positions) {
+      if (topo->mixedPrecision && MixedPrecision<TOneAtomPair>::SUPPORTED)
+        topo->updateSinglePrecision(positions);
+    }
+
     void doEvaluate(const GenericTopology *topo, const Vector3DBlock *positions,
                     Vector3DBlock *forces, ScalarStructure *energies, int i0,
                     int i1, int j0, int j1) {
+      if (topo->mixedPrecision)
+        doEvaluatePairs<MixedPrecision<TOneAtomPair>::SUPPORTED>
+          (topo, positions, forces, energies, i0, i1, j0, j1);
+      else
+        doEvaluatePairs<false>(topo, positions, forces, energies, i0, i1, j0,
+                               j1);
+    }
+
+    template<bool SINGLE>
+    void doEvaluatePairs(const GenericTopology *topo,
+                         const Vector3DBlock *positions,
+                         Vector3DBlock *forces, ScalarStructure *energies,
+                         int i0, int i1, int j0, int j1) {
       const RealTopologyType *realTopo =
         (const RealTopologyType *)(topo);
       
@@ -142,13 +169,37 @@ namespace ProtoMol {
             if (jstart <= i) jstart = i + 1;
             int jend = blockj + myBlockSize;
             if (jend > j1) jend = j1;
-            for (int j = jstart; j < jend; j++)
-              myOneAtomPair.doOneAtomPair(i, j);
+            ExclusionRow row = topo->exclusions.getRow(i, jstart);
+            for (int j = jstart; j < jend; j++) {
+              const ExclusionClass excl = row.next(j);
+              if (excl == EXCLUSION_NONE || !TOneAtomPair::EXCLUDE)
+                MixedPrecisionKernel<SINGLE>::doOneAtomPair(myOneAtomPair,
+                                                            i, j, excl);
+            }
           }
         }
       }
     }
 
+    // The modified pairs, left out of the pair loop
+    void doEvaluateModified(const GenericTopology *topo) {
+      if (topo->mixedPrecision)
+        doEvaluateModifiedPairs<MixedPrecision<TOneAtomPair>::SUPPORTED>(topo);
+      else
+        doEvaluateModifiedPairs<false>(topo);
+    }
+
+    template<bool SINGLE>
+    void doEvaluateModifiedPairs(const GenericTopology *topo) {
+      if (!TOneAtomPair::EXCLUDE) return;
+
+      const std::vector<PairInt> &modified = topo->exclusions.getModified();
+      for (unsigned int k = 0; k < modified.size(); k++)
+        MixedPrecisionKernel<SINGLE>::
+          doOneAtomPair(myOneAtomPair, modified[k].first, modified[k].second,
+                        EXCLUSION_MODIFIED);
+    }
+
     //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
     // My data members
     //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -0,0 +1,418 @@
+#include <protomol/force/nonbonded/NonbondedTreecodeSystemForce.h>
+
+#include <protomol/force/CoulombForce.h>
+#include <protomol/topology/GenericTopology.h>
+#include <protomol/type/ScalarStructure.h>
+#include <protomol/type/Vector3DBlock.h>
+#include <protomol/parallel/Parallel.h>
+#include <protomol/base/Exception.h>
+#include <protomol/base/StringUtilities.h>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+using namespace ProtoMol;
+
+//____NonbondedTreecodeSystemForce
+
+const string NonbondedTreecodeSystemForce::keyword("Treecode");
+
+// Maximal depth of the tree, such that atoms at (nearly) the same position
+// do not recurse forever
+static const int MAX_DEPTH = 64;
+
+NonbondedTreecodeSystemForce::NonbondedTreecodeSystemForce() :
+  SystemForce(), myTheta(0.5), myOrder(4), myLeafSize(16), myTopo(0),
+  myNumMoments(0) {
+  buildTerms();
+}
+
+NonbondedTreecodeSystemForce::
+NonbondedTreecodeSystemForce(Real theta, unsigned int order,
+                             unsigned int leafSize) :
+  SystemForce(), myTheta(theta), myOrder(order), myLeafSize(leafSize),
+  myTopo(0), myNumMoments(0) {
+  buildTerms();
+}
+
+void NonbondedTreecodeSystemForce::evaluate(const GenericTopology *topo,
+                                            const Vector3DBlock *positions,
+                                            Vector3DBlock *forces,
+                                            ScalarStructure *energies) {
+  update(topo);
+  buildTree(positions);
+  computeMoments(positions, topo->atomCharge);
+  doEvaluate(topo, positions, forces, energies, 0, 1);
+}
+
+void NonbondedTreecodeSystemForce::
+parallelEvaluate(const GenericTopology *topo, const Vector3DBlock *positions,
+                 Vector3DBlock *forces, ScalarStructure *energies) {
+  update(topo);
+  unsigned int count = numberOfBlocks(topo, positions);
+
+  // The tree is built once, and only if this node evaluates a block
+  bool built = false;
+  for (unsigned int i = 0; i < count; i++)
+    if (Parallel::next()) {
+      if (!built) {
+        buildTree(positions);
+        computeMoments(positions, topo->atomCharge);
+        built = true;
+      }
+      doEvaluate(topo, positions, forces, energies, i, count);
+    }
+}
+
+unsigned int NonbondedTreecodeSystemForce::
+numberOfBlocks(const GenericTopology *topo, const Vector3DBlock *) {
+  return std::max(1, std::min(Parallel::getAvailableNum(),
+                              static_cast<int>(topo->atoms.size())));
+}
+
+Force *NonbondedTreecodeSystemForce::doMake(const vector<Value> &values)
+const {
+  Real theta;
+  unsigned int order, leafSize;
+  values[0].get(theta);
+  values[1].get(order);
+  values[2].get(leafSize);
+
+  string err;
+  if (!values[0].valid() || theta <= 0.0 || theta >= 1.0)
+    err += " 0 < theta < 1 (=" + values[0].getString() + ").";
+  if (!values[1].valid())
+    err += " order (=" + values[1].getString() + ") not valid.";
+  if (!values[2].valid() || leafSize == 0)
+    err += " 0 < leafsize (=" + values[2].getString() + ").";
+  if (!err.empty())
+    THROW(keyword + " algorithm:" + err);
+
+  return new NonbondedTreecodeSystemForce(theta, order, leafSize);
+}
+
+string NonbondedTreecodeSystemForce::getIdNoAlias() const {
+  return CoulombForce::keyword + " -algorithm " + keyword;
+}
+
+void NonbondedTreecodeSystemForce::
+getParameters(vector<Parameter> &parameters) const {
+  parameters.push_back
+    (Parameter("-theta", Value(myTheta, ConstraintValueType::Positive()),
+               0.5, Text("opening angle, node radius over distance")));
+  parameters.push_back
+    (Parameter("-order", Value(myOrder),
+               4, Text("order of the multipole expansion")));
+  parameters.push_back
+    (Parameter("-leafsize", Value(myLeafSize, ConstraintValueType::Positive()),
+               16, Text("maximal number of atoms in a leaf")));
+}
+
+void NonbondedTreecodeSystemForce::doEvaluate(const GenericTopology *topo,
+                                              const Vector3DBlock *positions,
+                                              Vector3DBlock *forces,
+                                              ScalarStructure *energies,
+                                              unsigned int block,
+                                              unsigned int count) {
+  const vector<Real> &charges = topo->atomCharge;
+  unsigned int numAtoms = topo->atoms.size();
+  int from = static_cast<int>(static_cast<long>(numAtoms) * block / count);
+  int to = static_cast<int>(static_cast<long>(numAtoms) * (block + 1) / count);
+  bool virial = energies->virial();
+
+  // Every pair is seen from both atoms, half of the potential energy
+  // belongs to each
+  Real energy = 0.0;
+  for (int i = from; i < to; i++) {
+    if (charges[i] == 0.0)
+      continue;
+
+    Real phi = 0.0;
+    Vector3D field(0.0, 0.0, 0.0);
+    potential(positions, charges, i, phi, field);
+
+    energy += 0.5 * charges[i] * phi;
+    Vector3D f(field * charges[i]);
+    (*forces)[i] += f;
+    if (virial)
+      energies->addVirial(f, (*positions)[i]);
+  }
+
+  // Remove the excluded pairs and scale the modified ones, the tree
+  // includes them with full weight
+  for (unsigned int k = 0; k < myExclusions.size(); k++) {
+    const Exclusion &ex = myExclusions[k];
+    if (ex.a1 < from || ex.a1 >= to)
+      continue;
+
+    Real qq = charges[ex.a1] * charges[ex.a2];
+    if (ex.excl == EXCLUSION_MODIFIED)
+      qq *= 1.0 - topo->coulombScalingFactor;
+    if (qq == 0.0)
+      continue;
+
+    Vector3D diff((*positions)[ex.a2] - (*positions)[ex.a1]);
+    Real rDistSquared = 1.0 / diff.normSquared();
+    Real e = qq * sqrt(rDistSquared);
+    energy -= e;
+
+    Vector3D fij(diff * (e * rDistSquared));
+    (*forces)[ex.a1] += fij;
+    (*forces)[ex.a2] -= fij;
+    if (virial)
+      energies->addVirial(-fij, diff);
+  }
+
+  (*energies)[ScalarStructure::COULOMB] += energy;
+}
+
+void NonbondedTreecodeSystemForce::update(const GenericTopology *topo) {
+  if (myTopo == topo)
+    return;
+  myTopo = topo;
+
+  // The table may hold a pair more than once, check() reports the class
+  // in effect
+  vector<pair<int, int> > pairs;
+  const vector<ExclusionPair> &table = topo->exclusions.getTable();
+  for (unsigned int i = 0; i < table.size(); i++)
+    pairs.push_back(make_pair(std::min(table[i].a1, table[i].a2),
+                              std::max(table[i].a1, table[i].a2)));
+  sort(pairs.begin(), pairs.end());
+  pairs.erase(unique(pairs.begin(), pairs.end()), pairs.end());
+
+  myExclusions.clear();
+  for (unsigned int i = 0; i < pairs.size(); i++) {
+    Exclusion ex;
+    ex.a1 = pairs[i].first;
+    ex.a2 = pairs[i].second;
+    ex.excl = topo->exclusions.check(ex.a1, ex.a2);
+    if (ex.excl == EXCLUSION_FULL || ex.excl == EXCLUSION_MODIFIED)
+      myExclusions.push_back(ex);
+  }
+}
+
+void NonbondedTreecodeSystemForce::buildTerms() {
+  int p = myOrder + 1;
+  int n = p + 1;
+  vector<int> index(n * n * n, -1);
+
+  myTerms.clear();
+  for (int degree = 0; degree <= p; degree++)
+    for (int k1 = degree; k1 >= 0; k1--)
+      for (int k2 = degree - k1; k2 >= 0; k2--) {
+        Term t;
+        t.k[0] = k1;
+        t.k[1] = k2;
+        t.k[2] = degree - k1 - k2;
+        t.degree = degree;
+        index[(t.k[0] * n + t.k[1]) * n + t.k[2]] = myTerms.size();
+        myTerms.push_back(t);
+      }
+
+  for (unsigned int i = 0; i < myTerms.size(); i++) {
+    Term &t = myTerms[i];
+    for (int d = 0; d < 3; d++) {
+      int k[3] = {t.k[0], t.k[1], t.k[2]};
+      k[d] -= 1;
+      t.minus1[d] = (k[d] < 0 ? -1 : index[(k[0] * n + k[1]) * n + k[2]]);
+      k[d] -= 1;
+      t.minus2[d] = (k[d] < 0 ? -1 : index[(k[0] * n + k[1]) * n + k[2]]);
+      k[d] += 3;
+      t.plus1[d] = (t.degree == p ? -1 : index[(k[0] * n + k[1]) * n + k[2]]);
+    }
+  }
+
+  myNumMoments = (myOrder + 1) * (myOrder + 2) * (myOrder + 3) / 6;
+  myCoeff.resize(myTerms.size());
+}
+
+void NonbondedTreecodeSystemForce::buildTree(const Vector3DBlock *positions) {
+  int numAtoms = positions->size();
+  myIndex.resize(numAtoms);
+  for (int i = 0; i < numAtoms; i++)
+    myIndex[i] = i;
+
+  myNodes.clear();
+  Node root;
+  root.begin = 0;
+  root.end = numAtoms;
+  myNodes.push_back(root);
+  split(positions, 0, 0);
+}
+
+void NonbondedTreecodeSystemForce::split(const Vector3DBlock *positions,
+                                         int n, int depth) {
+  int begin = myNodes[n].begin;
+  int end = myNodes[n].end;
+
+  // Center of the bounding box and radius of the atoms about it
+  Vector3D lo((*positions)[myIndex[begin]]), hi(lo);
+  for (int i = begin + 1; i < end; i++) {
+    const Vector3D &x = (*positions)[myIndex[i]];
+    for (int d = 0; d < 3; d++) {
+      lo.c[d] = std::min(lo.c[d], x.c[d]);
+      hi.c[d] = std::max(hi.c[d], x.c[d]);
+    }
+  }
+  Vector3D center((lo + hi) * 0.5);
+  Real radius2 = 0.0;
+  for (int i = begin; i < end; i++)
+    radius2 = std::max(radius2,
+                       ((*positions)[myIndex[i]] - center).normSquared());
+
+  myNodes[n].center = center;
+  myNodes[n].radius = sqrt(radius2);
+  myNodes[n].firstChild = 0;
+  myNodes[n].numChildren = 0;
+
+  if (end - begin <= static_cast<int>(myLeafSize) || radius2 == 0.0 ||
+      depth >= MAX_DEPTH)
+    return;
+
+  // Sort the atoms by octant
+  int count[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+  vector<int> octant(end - begin);
+  for (int i = begin; i < end; i++) {
+    const Vector3D &x = (*positions)[myIndex[i]];
+    int o = (x.c[0] > center.c[0] ? 1 : 0) + (x.c[1] > center.c[1] ? 2 : 0) +
+      (x.c[2] > center.c[2] ? 4 : 0);
+    octant[i - begin] = o;
+    count[o]++;
+  }
+
+  int start[8];
+  start[0] = begin;
+  for (int o = 1; o < 8; o++)
+    start[o] = start[o - 1] + count[o - 1];
+
+  vector<int> sorted(end - begin);
+  int next[8];
+  std::copy(start, start + 8, next);
+  for (int i = begin; i < end; i++)
+    sorted[next[octant[i - begin]]++ - begin] = myIndex[i];
+  std::copy(sorted.begin(), sorted.end(), myIndex.begin() + begin);
+
+  // Children are stored next to each other
+  int firstChild = myNodes.size();
+  for (int o = 0; o < 8; o++)
+    if (count[o] > 0) {
+      Node child;
+      child.begin = start[o];
+      child.end = start[o] + count[o];
+      myNodes.push_back(child);
+    }
+
+  int numChildren = myNodes.size() - firstChild;
+  myNodes[n].firstChild = firstChild;
+  myNodes[n].numChildren = numChildren;
+
+  for (int c = firstChild; c < firstChild + numChildren; c++)
+    split(positions, c, depth + 1);
+}
+
+void NonbondedTreecodeSystemForce::
+computeMoments(const Vector3DBlock *positions, const vector<Real> &charges) {
+  myMoments.assign(myNodes.size() * myNumMoments, 0.0);
+  vector<Real> power(3 * (myOrder + 1));
+
+  for (unsigned int n = 0; n < myNodes.size(); n++) {
+    const Node &node = myNodes[n];
+    Real *moments = &myMoments[n * myNumMoments];
+
+    for (int i = node.begin; i < node.end; i++) {
+      int a = myIndex[i];
+      Real q = charges[a];
+      if (q == 0.0)
+        continue;
+
+      Vector3D d((*positions)[a] - node.center);
+      for (int c = 0; c < 3; c++) {
+        power[c * (myOrder + 1)] = 1.0;
+        for (unsigned int k = 1; k <= myOrder; k++)
+          power[c * (myOrder + 1) + k] =
+            power[c * (myOrder + 1) + k - 1] * d.c[c];
+      }
+
+      for (unsigned int t = 0; t < myNumMoments; t++) {
+        const Term &term = myTerms[t];
+        moments[t] += q * power[term.k[0]] *
+          power[(myOrder + 1) + term.k[1]] *
+          power[2 * (myOrder + 1) + term.k[2]];
+      }
+    }
+  }
+}
+
+void NonbondedTreecodeSystemForce::potential(const Vector3DBlock *positions,
+                                             const vector<Real> &charges,
+                                             int i, Real &phi,
+                                             Vector3D &field) {
+  const Vector3D &x = (*positions)[i];
+  Real theta2 = myTheta * myTheta;
+
+  myStack.clear();
+  myStack.push_back(0);
+  while (!myStack.empty()) {
+    int n = myStack.back();
+    const Node &node = myNodes[n];
+    myStack.pop_back();
+
+    Vector3D r(x - node.center);
+    Real r2 = r.normSquared();
+
+    // The expansion only pays off if it has fewer terms than atoms
+    if (node.radius * node.radius < theta2 * r2 &&
+        node.end - node.begin > static_cast<int>(myNumMoments)) {
+      expansion(n, r, phi, field);
+
+    } else if (node.numChildren == 0) {
+      for (int k = node.begin; k < node.end; k++) {
+        int j = myIndex[k];
+        if (j == i || charges[j] == 0.0)
+          continue;
+
+        Vector3D diff(x - (*positions)[j]);
+        Real rDistSquared = 1.0 / diff.normSquared();
+        Real e = charges[j] * sqrt(rDistSquared);
+        phi += e;
+        field += diff * (e * rDistSquared);
+      }
+
+    } else
+      for (int c = 0; c < node.numChildren; c++)
+        myStack.push_back(node.firstChild + c);
+  }
+}
+
+void NonbondedTreecodeSystemForce::expansion(int n, const Vector3D &r,
+                                             Real &phi, Vector3D &field) {
+  // Taylor coefficients a_k = 1/k! d^k/dy^k 1/|x - y| at the center by the
+  // recurrence |k| r^2 a_k - (2|k| - 1) sum r_i a_{k-e_i}
+  // + (|k| - 1) sum a_{k-2e_i} = 0
+  Real rr2 = 1.0 / r.normSquared();
+  myCoeff[0] = sqrt(rr2);
+  for (unsigned int t = 1; t < myTerms.size(); t++) {
+    const Term &term = myTerms[t];
+    Real s1 = 0.0, s2 = 0.0;
+    for (int d = 0; d < 3; d++) {
+      if (term.minus1[d] >= 0)
+        s1 += r.c[d] * myCoeff[term.minus1[d]];
+      if (term.minus2[d] >= 0)
+        s2 += myCoeff[term.minus2[d]];
+    }
+    myCoeff[t] = ((2 * term.degree - 1) * s1 - (term.degree - 1) * s2) *
+      rr2 / term.degree;
+  }
+
+  // phi = sum a_k M_k, E = -grad phi = sum (k_i + 1) a_{k+e_i} M_k
+  const Real *moments = &myMoments[n * myNumMoments];
+  for (unsigned int t = 0; t < myNumMoments; t++) {
+    const Term &term = myTerms[t];
+    Real m = moments[t];
+    phi += myCoeff[t] * m;
+    for (int d = 0; d < 3; d++)
+      field.c[d] += (term.k[d] + 1) * myCoeff[term.plus1[d]] * m;
+  }
+}
@@ -0,0 +1,153 @@
+/* -*- c++ -*- */
+#ifndef NONBONDEDTREECODESYSTEMFORCE_H
+#define NONBONDEDTREECODESYSTEMFORCE_H
+
+#include <protomol/force/system/SystemForce.h>
+#include <protomol/type/Vector3D.h>
+#include <protomol/topology/ExclusionTable.h>
+
+#include <vector>
+#include <string>
+
+namespace ProtoMol {
+  //____ NonbondedTreecodeSystemForce
+
+  /**
+   * Full Coulomb electrostatics in vacuum by a Barnes-Hut treecode in
+   * O(N log N), same energy and forces as Coulomb with NonbondedSimpleFull
+   * up to the truncation error of the expansion.
+   *
+   * An octree is built on the positions, leaves hold at most leafsize
+   * atoms. Each node keeps the Cartesian multipole moments of its charges
+   * about its center up to order. An atom interacts with a node through
+   * the Taylor expansion of 1/r if the node radius over the distance to
+   * its center is below theta and the node is large enough for the
+   * expansion to pay off, otherwise with its children or, for a leaf,
+   * directly with its atoms. Excluded and modified 1-4 pairs are corrected
+   * exactly afterwards. The error decreases with smaller theta and larger
+   * order, compare against NonbondedSimpleFull with force Compare.
+   */
+  class NonbondedTreecodeSystemForce : public SystemForce {
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // Typedef & const
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  private:
+    struct Node {
+      Vector3D center;
+      Real radius;
+      /// atoms myIndex[begin, end)
+      int begin, end;
+      /// children myNodes[firstChild, firstChild + numChildren)
+      int firstChild, numChildren;
+    };
+
+    /// Multi-index k = (k1, k2, k3) of a Taylor term and the terms
+    /// k - e_i, k - 2 e_i and k + e_i, -1 if not a term
+    struct Term {
+      int k[3];
+      int degree;
+      int minus1[3], minus2[3], plus1[3];
+    };
+
+    /// Exclusion pair with the class reported by ExclusionTable::check()
+    struct Exclusion {
+      int a1, a2;
+      ExclusionClass excl;
+    };
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // Constructors, destructors, assignment
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    NonbondedTreecodeSystemForce();
+    NonbondedTreecodeSystemForce(Real theta, unsigned int order,
+                                 unsigned int leafSize);
+    virtual ~NonbondedTreecodeSystemForce() {}
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // From class SystemForce
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    using SystemForce::evaluate; // Avoid compiler warning/error
+    virtual void evaluate(const GenericTopology *topo,
+                          const Vector3DBlock *positions, Vector3DBlock *forces,
+                          ScalarStructure *energies);
+    virtual void parallelEvaluate(const GenericTopology *topo,
+                                  const Vector3DBlock *positions,
+                                  Vector3DBlock *forces,
+                                  ScalarStructure *energies);
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // From class Force
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    virtual std::string getKeyword() const {return keyword;}
+    virtual unsigned int numberOfBlocks(const GenericTopology *topo,
+                                        const Vector3DBlock *positions);
+    virtual void uncache() {myTopo = 0;}
+
+  private:
+    virtual Force *doMake(const std::vector<Value> &values) const;
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // From class Makeable
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    virtual std::string getIdNoAlias() const;
+    virtual void getParameters(std::vector<Parameter> &parameters) const;
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // New methods of class NonbondedTreecodeSystemForce
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  private:
+    /// Evaluates the targets of block out of count on the built tree
+    void doEvaluate(const GenericTopology *topo, const Vector3DBlock *positions,
+                    Vector3DBlock *forces, ScalarStructure *energies,
+                    unsigned int block, unsigned int count);
+
+    /// Collects the exclusion pairs if the topology changed
+    void update(const GenericTopology *topo);
+    void buildTerms();
+
+    void buildTree(const Vector3DBlock *positions);
+    /// Splits node n into octants and recurses into the children
+    void split(const Vector3DBlock *positions, int n, int depth);
+    void computeMoments(const Vector3DBlock *positions,
+                        const std::vector<Real> &charges);
+
+    /// Potential and field at atom i from all other atoms
+    void potential(const Vector3DBlock *positions,
+                   const std::vector<Real> &charges, int i, Real &phi,
+                   Vector3D &field);
+    /// Adds the expansion of node n at the distance r from its center
+    void expansion(int n, const Vector3D &r, Real &phi, Vector3D &field);
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // My data members
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    static const std::string keyword;
+
+  private:
+    Real myTheta;
+    unsigned int myOrder;
+    unsigned int myLeafSize;
+
+    const GenericTopology *myTopo;
+    std::vector<Exclusion> myExclusions;
+
+    std::vector<Node> myNodes;
+    std::vector<int> myIndex;
+    /// Moments of node n at myMoments[n * myNumMoments]
+    std::vector<Real> myMoments;
+    unsigned int myNumMoments;
+
+    /// Terms of total degree <= myOrder + 1 ordered by degree, the first
+    /// myNumMoments are the ones of the moments
+    std::vector<Term> myTerms;
+    /// Taylor coefficients of 1/r, work array of potential()
+    std::vector<Real> myCoeff;
+    std::vector<int> myStack;
+  };
+}
+#endif /* NONBONDEDTREECODESYSTEMFORCE_H */
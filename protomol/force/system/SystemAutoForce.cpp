@@ -0,0 +1,243 @@
+#include <protomol/force/system/SystemAutoForce.h>
+#include <protomol/force/CompareForce.h>
+#include <protomol/type/ScalarStructure.h>
+#include <protomol/type/Vector3DBlock.h>
+#include <protomol/topology/GenericTopology.h>
+#include <protomol/parallel/Parallel.h>
+#include <protomol/base/StringUtilities.h>
+#include <protomol/base/PMConstants.h>
+#include <protomol/base/Report.h>
+#include <protomol/base/Timer.h>
+
+#include <math.h>
+
+using namespace std;
+using namespace ProtoMol::Report;
+using namespace ProtoMol;
+
+//____ label, the id with the tuned settings
+static string label(const SystemForce *force, Real cellSize) {
+  string res = force->getId();
+  if (force->getKeyword() == "NonbondedCutoff")
+    res += " (cellsize " + toString(cellSize) + ")";
+
+  vector<Parameter> parameters;
+  force->getParameters(parameters);
+  for (unsigned int i = 0; i < parameters.size(); ++i)
+    if (equalNocase(parameters[i].keyword, "-blocksize"))
+      res += " (blocksize " + parameters[i].value.getString() + ")";
+
+  return res;
+}
+
+//____ SystemAutoForce
+
+const string SystemAutoForce::keyword("Auto");
+const Real SystemAutoForce::defaultTolerance = 0.001;
+
+SystemAutoForce::SystemAutoForce(const string &id,
+                                 const vector<SystemForce *> &candidates,
+                                 Real tolerance) :
+  myId(id), myCandidates(candidates), myTolerance(tolerance), myForce(NULL) {}
+
+SystemAutoForce::~SystemAutoForce() {
+  for (unsigned int i = 0; i < myCandidates.size(); ++i)
+    delete myCandidates[i];
+}
+
+void SystemAutoForce::evaluate(const GenericTopology *topo,
+                               const Vector3DBlock *positions,
+                               Vector3DBlock *forces,
+                               ScalarStructure *energies) {
+  tune(topo, positions);
+  myForce->evaluate(topo, positions, forces, energies);
+}
+
+void SystemAutoForce::parallelEvaluate(const GenericTopology *topo,
+                                       const Vector3DBlock *positions,
+                                       Vector3DBlock *forces,
+                                       ScalarStructure *energies) {
+  tune(topo, positions);
+  myForce->parallelEvaluate(topo, positions, forces, energies);
+}
+
+void SystemAutoForce::preProcess(const GenericTopology *topo,
+                                 const Vector3DBlock *positions) {
+  tune(topo, positions);
+  myForce->preProcess(topo, positions);
+}
+
+void SystemAutoForce::postProcess(const GenericTopology *topo,
+                                  ScalarStructure *energies,
+                                  Vector3DBlock *forces) {
+  if (myForce != NULL)
+    myForce->postProcess(topo, energies, forces);
+}
+
+void SystemAutoForce::parallelPostProcess(const GenericTopology *topo,
+                                          ScalarStructure *energies) {
+  if (myForce != NULL)
+    myForce->parallelPostProcess(topo, energies);
+}
+
+bool SystemAutoForce::doParallelPostProcess() {
+  // Asked before the first evaluation, assume the reference
+  return (myForce != NULL ? myForce : myCandidates[0])->doParallelPostProcess();
+}
+
+unsigned int SystemAutoForce::numberOfBlocks(const GenericTopology *topo,
+                                             const Vector3DBlock *positions) {
+  // First call of all nodes in dynamic mode, the master does not evaluate
+  tune(topo, positions);
+  return myForce->numberOfBlocks(topo, positions);
+}
+
+void SystemAutoForce::uncache() {
+  for (unsigned int i = 0; i < myCandidates.size(); ++i)
+    myCandidates[i]->uncache();
+}
+
+Force *SystemAutoForce::doMake(const vector<Value> &values) const {
+  if (myForce != NULL) return myForce->make(values);
+
+  // The last value is -tolerance
+  return myCandidates[0]->make(vector<Value>(values.begin(),
+                                             values.end() - 1));
+}
+
+string SystemAutoForce::getIdNoAlias() const {
+  return myForce != NULL ? myForce->getIdNoAlias() : myId;
+}
+
+void SystemAutoForce::getParameters(vector<Parameter> &parameters) const {
+  if (myForce != NULL) {
+    myForce->getParameters(parameters);
+    return;
+  }
+
+  myCandidates[0]->getParameters(parameters);
+  parameters.push_back
+    (Parameter("-tolerance",
+               Value(myTolerance, ConstraintValueType::NotNegative()),
+               defaultTolerance,
+               Text("largest relative force and potential energy error of a "
+                    "candidate against the reference")));
+}
+
+void SystemAutoForce::tune(const GenericTopology *topo,
+                           const Vector3DBlock *positions) {
+  if (myForce != NULL) return;
+
+  // The cell size belongs to the topology, it is shared by all cutoff forces
+  GenericTopology *topology = const_cast<GenericTopology *>(topo);
+  const Real cellSize = topo->getCellSize();
+
+  // All options, the same on all nodes
+  vector<unsigned int> candidate;
+  vector<Real> cellSizes;
+  for (unsigned int i = 0; i < myCandidates.size(); ++i) {
+    candidate.push_back(i);
+    cellSizes.push_back(cellSize);
+    if (myCandidates[i]->getKeyword() != "NonbondedCutoff") continue;
+
+    Real cutoff = 0.0;
+    vector<Parameter> parameters;
+    myCandidates[i]->getParameters(parameters);
+    for (unsigned int j = 0; j < parameters.size(); ++j)
+      if (equalNocase(parameters[j].keyword, "-cutoff"))
+        parameters[j].value.get(cutoff);
+
+    Real sizes[2] = {0.5 * cutoff, cutoff};
+    for (unsigned int j = 0; j < 2; ++j)
+      if (sizes[j] > 0.0 && fabs(sizes[j] - cellSize) > 1e-6 * cellSize) {
+        candidate.push_back(i);
+        cellSizes.push_back(sizes[j]);
+      }
+  }
+
+  Vector3DBlock referenceForces;
+  ScalarStructure referenceEnergies;
+  // The reference is always acceptable
+  int best = 0;
+  Real bestTime = Constant::MAXREAL;
+
+  // The timings of the nodes differ, the master times and decides
+  if (Parallel::iAmMaster())
+    report << plain << "Tuning \'" << myId << "\', tolerance "
+           << myTolerance << ":" << endr;
+  for (unsigned int k = 0; k < candidate.size() && Parallel::iAmMaster();
+       ++k) {
+    SystemForce *force = myCandidates[candidate[k]];
+    topology->setCellSize(cellSizes[k]);
+
+    Vector3DBlock forces;
+    ScalarStructure energies;
+    const Real time =
+      this->time(force, topology, positions, &forces, &energies);
+
+    // The reference has no error, the others are compared against it
+    CompareForce::CompareError error;
+    if (k == 0) {
+      referenceForces = forces;
+      referenceEnergies = energies;
+    } else
+      error = CompareForce::compare(topo, referenceForces, referenceEnergies,
+                                    forces, energies);
+
+    const bool accepted =
+      error.rFavg <= myTolerance && error.rPE <= myTolerance;
+    if (accepted && time < bestTime) {
+      best = k;
+      bestTime = time;
+    }
+
+    report << plain << Constant::PRINTINDENT << label(force, cellSizes[k])
+           << " : " << time * 1000.0 << " ms, rFavg " << error.rFavg
+           << ", rPE " << error.rPE << (accepted ? "" : ", rejected") << endr;
+  }
+
+  Parallel::bcast(best);
+
+  myForce = myCandidates[candidate[best]];
+  // The serial timing may have cached what the parallel evaluation splits
+  myForce->uncache();
+  topology->setCellSize(myForce->getKeyword() == "NonbondedCutoff" ?
+                        cellSizes[best] : cellSize);
+  report << plain << "Using \'" << label(myForce, topo->getCellSize())
+         << "\' for \'" << myId << "\'." << endr;
+
+  for (unsigned int i = 0; i < myCandidates.size(); ++i)
+    if (myCandidates[i] != myForce)
+      delete myCandidates[i];
+  myCandidates.assign(1, myForce);
+}
+
+Real SystemAutoForce::time(SystemForce *force, GenericTopology *topo,
+                           const Vector3DBlock *positions,
+                           Vector3DBlock *forces, ScalarStructure *energies) {
+  // The first evaluation warms up caches and gives the compared result
+  forces->zero(positions->size());
+  energies->clear();
+  topo->uncacheCellList();
+  force->preProcess(topo, positions);
+  force->evaluate(topo, positions, forces, energies);
+  force->postProcess(topo, energies, forces);
+
+  Vector3DBlock scratchForces;
+  ScalarStructure scratchEnergies;
+  Timer timer;
+  unsigned int n = 0;
+  do {
+    scratchForces.zero(positions->size());
+    scratchEnergies.clear();
+
+    timer.start();
+    topo->uncacheCellList();
+    force->preProcess(topo, positions);
+    force->evaluate(topo, positions, &scratchForces, &scratchEnergies);
+    force->postProcess(topo, &scratchEnergies, &scratchForces);
+    timer.stop();
+  } while (++n < 10 && timer.getTime().getRealTime() < 0.05);
+
+  return timer.getTime().getRealTime() / n;
+}
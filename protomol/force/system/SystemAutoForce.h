@@ -0,0 +1,105 @@
+/* -*- c++ -*- */
+#ifndef SYSTEMAUTOFORCE_H
+#define SYSTEMAUTOFORCE_H
+
+#include <protomol/force/system/SystemForce.h>
+
+#include <vector>
+#include <string>
+
+namespace ProtoMol {
+  //________________________________________ SystemAutoForce
+
+  /**
+   * Force with -algorithm Auto. The ForceFactory makes all algorithms of
+   * the force which accept the given policies and parameters, and
+   * blocksize variants if no blocksize was given. The first candidate is
+   * the reference.
+   *
+   * At the first evaluation every candidate is evaluated on the actual
+   * positions and timed. NonbondedCutoff candidates also try cell sizes
+   * of half and full cutoff. A candidate is acceptable if its relative
+   * force error rFavg and potential energy error rPE against the
+   * reference, as computed by CompareForce, are at most -tolerance. The
+   * fastest acceptable candidate is used from then on, and its cell size
+   * is kept in the topology. Only the master times the serial evaluation,
+   * its decision is broadcast to the other nodes.
+   */
+  class SystemAutoForce : public SystemForce {
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // Constructors, destructors, assignment
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    SystemAutoForce(const std::string &id,
+                    const std::vector<SystemForce *> &candidates,
+                    Real tolerance);
+    virtual ~SystemAutoForce();
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // From class SystemForce
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    using SystemForce::evaluate; // Avoid compiler warning/error
+    virtual void evaluate(const GenericTopology *topo,
+                          const Vector3DBlock *positions,
+                          Vector3DBlock *forces,
+                          ScalarStructure *energies);
+    virtual void parallelEvaluate(const GenericTopology *topo,
+                                  const Vector3DBlock *positions,
+                                  Vector3DBlock *forces,
+                                  ScalarStructure *energies);
+    virtual void preProcess(const GenericTopology *topo,
+                            const Vector3DBlock *positions);
+    virtual void postProcess(const GenericTopology *topo,
+                             ScalarStructure *energies, Vector3DBlock *forces);
+    virtual void parallelPostProcess(const GenericTopology *topo,
+                                     ScalarStructure *energies);
+    virtual bool doParallelPostProcess();
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // From class Force
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    virtual std::string getKeyword() const {return keyword;}
+    virtual unsigned int numberOfBlocks(const GenericTopology *topo,
+                                        const Vector3DBlock *positions);
+    virtual void uncache();
+
+  private:
+    virtual Force *doMake(const std::vector<Value> &values) const;
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // From class Makeable
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    virtual std::string getIdNoAlias() const;
+    virtual void getParameters(std::vector<Parameter> &parameters) const;
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // New methods of class SystemAutoForce
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  private:
+    /// Chooses the candidate, once
+    void tune(const GenericTopology *topo, const Vector3DBlock *positions);
+    /// Average wall time of an evaluation, the result of the first
+    /// evaluation is left in forces and energies
+    Real time(SystemForce *force, GenericTopology *topo,
+              const Vector3DBlock *positions, Vector3DBlock *forces,
+              ScalarStructure *energies);
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // My data members
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    static const std::string keyword;
+    static const Real defaultTolerance;
+
+  private:
+    std::string myId;
+    std::vector<SystemForce *> myCandidates;
+    Real myTolerance;
+    /// Chosen candidate, 0 before the first evaluation
+    SystemForce *myForce;
+  };
+}
+#endif /* SYSTEMAUTOFORCE_H */
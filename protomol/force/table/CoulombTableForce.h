@@ -68,8 +68,8 @@ namespace ProtoMol {
                     Real /*rDistSquared*/, const Vector3D & /*diff*/,
                     const GenericTopology *topo, int atom1, int atom2,
                     ExclusionClass excl) const {
-      Real q = topo->atoms[atom1].scaledCharge *
-               topo->atoms[atom2].scaledCharge *
+      Real q = topo->atomCharge[atom1] *
+               topo->atomCharge[atom2] *
                ((topo->coulombScalingFactor != 1.0 && excl ==
                  EXCLUSION_MODIFIED) ? topo->coulombScalingFactor : 1.0);
 
@@ -0,0 +1,209 @@
+/* -*- c++ -*- */
+#ifndef LENNARDJONESCOULOMBTABLEFORCE_H
+#define LENNARDJONESCOULOMBTABLEFORCE_H
+
+#include <protomol/topology/GenericTopology.h>
+#include <protomol/type/ScalarStructure.h>
+#include <protomol/topology/ExclusionTable.h>
+#include <protomol/config/Parameter.h>
+#include <protomol/base/MathUtilities.h>
+#include <protomol/force/table/LookupTable.h>
+#include <string>
+#include <algorithm>
+
+namespace ProtoMol {
+  /**
+   * Defines the function(s) to be tabulated: the repulsive and the
+   * attractive Lennard-Jones term switched by the switching function of the
+   * table, and the charge independent Coulomb term switched by its own
+   * switching function.
+   */
+  template<class TSwitchingFunction>
+  class LennardJonesCoulombLookupValues {
+  public:
+    enum {ENTRIES = 3};
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // Constructors, destructors, assignment
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    LennardJonesCoulombLookupValues(const TSwitchingFunction &swf) :
+      coulombSwitchingFunction(swf) {}
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // New methods of class LennardJonesCoulombLookupValues
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    template<typename TReal>
+    void assign(Real r, Real r1, int ex, Real v, Real d, TReal *val) const {
+      Real e = (ex == -12 ? r : power < -12 > (r1)); // value
+      Real f = 12.0 * (ex == -14 ? r : power < -14 > (r1)); // gradient
+      val[0] = e * v;
+      val[1] = -0.5 * (f * v - e * d);
+      e = -(ex == -6 ? r : power < -6 > (r1)); // value
+      f = -6.0 * (ex == -8 ? r : power < -8 > (r1)); // gradient
+      val[4] = e * v;
+      val[5] = -0.5 * (f * v - e * d);
+
+      coulombSwitchingFunction(v, d, (ex == 2 ? r : r1 * r1));
+      e = (ex == -1 ? r : power < -1 > (r1)); // value
+      f = (ex == -3 ? r : power < -3 > (r1)); // gradient
+      val[8] = e * v;
+      val[9] = -0.5 * (f * v - e * d);
+    }
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // My data members
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  private:
+    TSwitchingFunction coulombSwitchingFunction;
+  };
+
+  //____ LennardJonesCoulombTableForce
+
+  /**
+   * Lennard-Jones and Coulomb potential with their switching functions
+   * tabulated in one cubic spline table over the squared distance. A pair
+   * costs one look up, the coefficients of the three terms are read from
+   * the same row and scaled by A, B and the charge product, such that
+   * neither powers, divisions nor switching polynomials are evaluated.
+   * Returns the two energies separately, to be used by OneAtomPairTable.
+   */
+  template<class TSwitchingFunctionLJ, class TSwitchingFunctionCoulomb,
+           unsigned int PRE, typename TReal = Real>
+  class LennardJonesCoulombTableForce :
+    public LookupTable<LennardJonesCoulombLookupValues
+                       <TSwitchingFunctionCoulomb>, PRE, TReal> {
+
+    typedef LennardJonesCoulombLookupValues<TSwitchingFunctionCoulomb>
+    LookupValues_t;
+    typedef LookupTable<LookupValues_t, PRE, TReal> LookupTable_t;
+
+  public:
+    enum {CUTOFF = 1};
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // Constructors, destructors, assignment
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    LennardJonesCoulombTableForce() : myCutoff(0.0), myCutoff2(0.0) {}
+
+    /// Constructor with cutoff switching functions
+    LennardJonesCoulombTableForce(TSwitchingFunctionLJ swfLJ,
+                                  TSwitchingFunctionCoulomb swfCoulomb) :
+      LookupTable_t(0.1, std::max(swfLJ.cutoffSquared(),
+                                  swfCoulomb.cutoffSquared()),
+                    2, LookupValues_t(swfCoulomb), swfLJ, 128),
+      myCutoff(std::max(swfLJ.cutoff(), swfCoulomb.cutoff())),
+      myCutoff2(myCutoff * myCutoff), switchingFunctionLJ(swfLJ),
+      switchingFunctionCoulomb(swfCoulomb) {}
+
+    /// Constructor without cutoff switching functions
+    LennardJonesCoulombTableForce(TSwitchingFunctionLJ swfLJ,
+                                  TSwitchingFunctionCoulomb swfCoulomb,
+                                  Real rc) :
+      LookupTable_t(0.1, square(rc), 2, LookupValues_t(swfCoulomb), swfLJ,
+                    128),
+      myCutoff(rc), myCutoff2(rc * rc), switchingFunctionLJ(swfLJ),
+      switchingFunctionCoulomb(swfCoulomb) {}
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // New methods of class LennardJonesCoulombTableForce
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    void operator()(Real &energyLJ, Real &energyCoulomb, Real &force,
+                    Real distSquared, const GenericTopology *topo,
+                    int atom1, int atom2, ExclusionClass excl) const {
+      const LennardJonesParameters &params =
+        topo->lennardJonesParameters(topo->atomTypeIndex[atom1],
+                                     topo->atomTypeIndex[atom2]);
+
+      Real A = (excl != EXCLUSION_MODIFIED ? params.A : params.A14);
+      Real B = (excl != EXCLUSION_MODIFIED ? params.B : params.B14);
+      Real q = topo->atomCharge[atom1] *
+               topo->atomCharge[atom2] *
+               ((topo->coulombScalingFactor != 1.0 && excl ==
+                 EXCLUSION_MODIFIED) ? topo->coulombScalingFactor : 1.0);
+
+      Real dt;
+      int i;
+      // get index and interpolation delta dt
+      this->index(distSquared, i, dt);
+
+      const TReal *t = &this->myTable[i];
+      Real forceLJ, forceCoulomb;
+      this->interpolate(t[0] * A + t[4] * B, t[1] * A + t[5] * B,
+                        t[2] * A + t[6] * B, t[3] * A + t[7] * B, dt,
+                        energyLJ, forceLJ);
+      this->interpolate(t[8] * q, t[9] * q, t[10] * q, t[11] * q, dt,
+                        energyCoulomb, forceCoulomb);
+      force = forceLJ + forceCoulomb;
+    }
+
+    static void accumulateEnergy(ScalarStructure *energies, Real energyLJ,
+                                 Real energyCoulomb) {
+      (*energies)[ScalarStructure::LENNARDJONES] += energyLJ;
+      (*energies)[ScalarStructure::COULOMB] += energyCoulomb;
+    }
+
+    static std::string getKeyword() {return "LennardJonesCoulombTable";}
+
+    // Parsing
+    static std::string getId() {
+      return getKeyword() +
+        std::string(!TSwitchingFunctionLJ::USE ? "" :
+                    std::string(" -switchingFunction " +
+                                TSwitchingFunctionLJ::getId())) +
+        std::string(!TSwitchingFunctionCoulomb::USE ? "" :
+                    std::string(" -switchingFunction " +
+                                TSwitchingFunctionCoulomb::getId()));
+    }
+
+    void getParameters(std::vector<Parameter> &parameters) const {
+      switchingFunctionLJ.getParameters(parameters);
+      switchingFunctionCoulomb.getParameters(parameters);
+      if (!CUTOFF_SWITCH)
+        parameters.push_back
+          (Parameter("-cutoff",
+                     Value(myCutoff, ConstraintValueType::Positive()),
+                     Text("cutoff for table look up")));
+    }
+
+    static unsigned int getParameterSize() {
+      return TSwitchingFunctionLJ::getParameterSize() +
+        TSwitchingFunctionCoulomb::getParameterSize() +
+        (CUTOFF_SWITCH ? 0 : 1);
+    }
+
+    static LennardJonesCoulombTableForce make(const std::vector<Value> &values) {
+      unsigned int n = TSwitchingFunctionLJ::getParameterSize();
+      unsigned int m = n + TSwitchingFunctionCoulomb::getParameterSize();
+      std::vector<Value> sLJ(values.begin(), values.begin() + n);
+      std::vector<Value> sCoulomb(values.begin() + n, values.begin() + m);
+
+      if (!CUTOFF_SWITCH)
+        return LennardJonesCoulombTableForce
+          (TSwitchingFunctionLJ::make(sLJ),
+           TSwitchingFunctionCoulomb::make(sCoulomb), values[m]);
+
+      return LennardJonesCoulombTableForce
+        (TSwitchingFunctionLJ::make(sLJ),
+         TSwitchingFunctionCoulomb::make(sCoulomb));
+    }
+
+    Real cutoffSquared() const {return myCutoff2;}
+
+  private:
+    /// both switching functions define the cutoff of the table
+    enum {CUTOFF_SWITCH = TSwitchingFunctionLJ::CUTOFF &&
+          TSwitchingFunctionCoulomb::CUTOFF};
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // My data members
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  private:
+    Real myCutoff;
+    Real myCutoff2;
+    TSwitchingFunctionLJ switchingFunctionLJ;
+    TSwitchingFunctionCoulomb switchingFunctionCoulomb;
+  };
+}
+#endif /* LENNARDJONESCOULOMBTABLEFORCE_H */
@@ -70,8 +70,8 @@ namespace ProtoMol {
                     const Vector3D & /*diff*/, const GenericTopology *topo,
                     int atom1, int atom2, ExclusionClass excl) const {
       const LennardJonesParameters &params =
-        topo->lennardJonesParameters(topo->atoms[atom1].type,
-                                     topo->atoms[atom2].type);
+        topo->lennardJonesParameters(topo->atomTypeIndex[atom1],
+                                     topo->atomTypeIndex[atom2]);
 
       Real A = (excl != EXCLUSION_MODIFIED ? params.A : params.A14);
       Real B = (excl != EXCLUSION_MODIFIED ? params.B : params.B14);
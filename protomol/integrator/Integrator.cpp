@@ -54,6 +54,11 @@ void Integrator::initialize(ProtoMolApp *app) {
   initializeModifiers();
 }
 
+bool Integrator::setTemperature(Real temperature) {
+  Integrator *n = next();
+  return n != NULL && n->setTemperature(temperature);
+}
+
 Integrator *Integrator::top() {
   Integrator *i = this;
   for (; i->previous() != 0; i = i->previous()) ;
@@ -49,6 +49,11 @@ namespace ProtoMol {
     //  Needed for calculating shadow Hamiltonian.
     virtual void updateBeta(Real /*timestep*/) {}
 
+    ///  Sets the target temperature of the thermostat, e.g., for replica
+    ///  exchange. Returns false if the integrator has none, by default
+    ///  the next level is asked.
+    virtual bool setTemperature(Real temperature);
+
     friend std::istream& operator>> (std::istream& i, Integrator& base){
       base.streamRead( i );
       return i;
@@ -49,6 +49,7 @@ void STSIntegrator::doDrift() {
   Real h = getTimestep() * Constant::INV_TIMEFACTOR;
   app->positions.intoWeightedAdd(h, app->velocities);
   buildMolecularCenterOfMass(&app->positions, app->topology);
+  app->outputCache.invalidateObservables();
 }
 
 void STSIntegrator::getParameters(vector<Parameter> &parameter) const {
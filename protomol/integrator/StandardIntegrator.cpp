@@ -17,12 +17,21 @@ using namespace ProtoMol;
 
 using namespace ProtoMol::Report;
 
+//____ Compensated sum, as the reductions of TopologyUtilities
+static inline void kahanAdd(Vector3D &sum, Vector3D &carry,
+                            const Vector3D &x) {
+  Vector3D y(x - carry);
+  Vector3D t(sum + y);
+  carry = (t - sum) - y;
+  sum = t;
+}
+
 //____ StandardIntegrator
 StandardIntegrator::StandardIntegrator() :
-  Integrator(), myPreviousIntegrator(NULL) {}
+  Integrator(), myPreviousIntegrator(NULL), myObservables(false) {}
 
 StandardIntegrator::StandardIntegrator(ForceGroup *forceGroup) :
-  Integrator(forceGroup), myPreviousIntegrator(NULL) {}
+  Integrator(forceGroup), myPreviousIntegrator(NULL), myObservables(false) {}
 
 long StandardIntegrator::run(const long numTimesteps) {
   for(int i = 0; i < numTimesteps; i++) {
@@ -30,7 +39,8 @@ long StandardIntegrator::run(const long numTimesteps) {
     doHalfKick();
     doDriftOrNextIntegrator();
     calculateForces();
-    doHalfKick();
+    if (i + 1 < numTimesteps) doHalfKick();
+    else doLastHalfKick();
     postStepModify();
   }
   return numTimesteps;
@@ -83,12 +93,60 @@ void StandardIntegrator::doHalfKick() {
 
   updateBeta(h);
 
+  if (myObservables && count > 0) {
+    // The same kick, summing the observables of the new velocities
+    const GenericTopology *topo = app->topology;
+    OutputCache::Observables obs;
+    Vector3D zero(0.0, 0.0, 0.0);
+    Vector3D momentumCarry(zero), positionCarry(zero), momentCarry(zero);
+
+    obs.kineticEnergy = 0.0;
+    obs.mass = 0.0;
+    obs.linearMomentum = obs.massPosition = obs.massMoment = zero;
+    obs.origin = app->positions[0];
+
+    for (unsigned int i = 0; i < count; ++i) {
+      const Real m = topo->atoms[i].scaledMass;
+      Vector3DB &v = app->velocities[i];
+      const Vector3DB &x = app->positions[i];
+
+      v += (*myForces)[i] * h / m;
+
+      obs.kineticEnergy += m * v.normSquared();
+      obs.mass += m;
+      kahanAdd(obs.linearMomentum, momentumCarry, v * m);
+      kahanAdd(obs.massPosition, positionCarry, x * m);
+      kahanAdd(obs.massMoment, momentCarry, (x - obs.origin).cross(v) * m);
+    }
+    obs.kineticEnergy *= 0.5;
+
+    buildMolecularMomentum(&app->velocities, app->topology);
+
+    obs.molecularKineticEnergy = 0.0;
+    for (unsigned int i = 0; i < topo->molecules.size(); i++) {
+      const Vector3D &p = topo->molecules[i].momentum;
+      obs.molecularKineticEnergy += p.dot(p) / topo->molecules[i].mass;
+    }
+    obs.molecularKineticEnergy *= 0.5;
+
+    app->outputCache.setObservables(obs);
+    return;
+  }
+
   for (unsigned int i = 0; i < count; ++i) {
      app->velocities[i] +=
        (*myForces)[i] * h / app->topology->atoms[i].scaledMass;
 
   }
   buildMolecularMomentum(&app->velocities, app->topology);
+  app->outputCache.invalidateObservables();
+}
+
+void StandardIntegrator::doLastHalfKick() {
+  // An outer integrator would still change the velocities
+  myObservables = top() == this;
+  doHalfKick();
+  myObservables = false;
 }
 
 void StandardIntegrator::doKick() {
@@ -102,6 +160,7 @@ void StandardIntegrator::doKick() {
       (*myForces)[i] * h / app->topology->atoms[i].scaledMass;
 
   buildMolecularMomentum(&app->velocities, app->topology);
+  app->outputCache.invalidateObservables();
 }
 
 Integrator *StandardIntegrator::previous() {
@@ -30,6 +30,11 @@ namespace ProtoMol {
     virtual void doDriftOrNextIntegrator() = 0;
     virtual void calculateForces();
 
+  protected:
+    /// Last half kick of a run, the top integrator also sums the
+    /// observables of the outputs on the way
+    void doLastHalfKick();
+
     //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
     // From class Integrator
     //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -43,6 +48,7 @@ namespace ProtoMol {
     //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
   protected:
     StandardIntegrator *myPreviousIntegrator;
+    bool myObservables;
   };
   //________________________________________ INLINES
 }
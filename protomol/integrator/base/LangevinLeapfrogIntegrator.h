@@ -33,6 +33,10 @@ namespace ProtoMol {
     //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
   public:
     virtual void initialize(ProtoMolApp *app);
+    virtual bool setTemperature(Real temperature) {
+      myLangevinTemperature = temperature;
+      return true;
+    }
 
     //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
     // From class StandardIntegrator
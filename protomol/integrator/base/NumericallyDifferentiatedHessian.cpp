@@ -35,11 +35,12 @@ void NumericallyDifferentiatedHessian::initialize(ProtoMolApp *app) {
   _3N = 3 * _N;
   hsn.initialData(_3N);
   hsn.clear();
+  numHsn.initialData(_3N);
+  numericalHessian.initialize(this, app);
   //
 }
 
 long NumericallyDifferentiatedHessian::run(const long numTimesteps) {
-  double *numHess;
   Real maxHessError = 0.0;
 
   if( numTimesteps < 0 ) return 0;
@@ -48,87 +49,26 @@ long NumericallyDifferentiatedHessian::run(const long numTimesteps) {
   calculateForces();
   //true for mass re-weight;
   hsn.evaluate(&app->positions, app->topology, false);
-  numHess = new double[_3N * _3N];
   cout << "timesteps " << numTimesteps << endl;
   for (int k = 0; k < numTimesteps; k++) {
     maxHessError = 0.0;
     if (k != 0) epsilon /= 2.0;
 
-    //Hessian
-    double* f_plus_2h = new double[_3N];
-    double* f_plus_h = new double[_3N];
-    double* f_x = new double[_3N];
-    double* f_h = new double[_3N];
-    double* f_2h = new double[_3N];
-    double* orig_pos = new double[_3N];
-    Real tempErr;
-    for (unsigned int i = 0;i < _3N; i++)
-      {
-        orig_pos[i] = app->positions[i / 3][i % 3];
-      }
-    for (unsigned int i = 0; i < _3N; i++)
-      {
-	app->positions[i / 3][i % 3] = orig_pos[i] + 2.0 * epsilon;
-	calculateForces();
-	for (unsigned int j = 0; j < _3N; j++)
-	  {
-	    f_plus_2h[j] = (*myForces)[j / 3][j % 3];
-	  }
-	      
-	app->positions[i / 3][i % 3] = orig_pos[i] + epsilon;
-	calculateForces();
-	for (unsigned int j = 0; j < _3N; j++)
-	  {
-	    f_plus_h[j] = (*myForces)[j / 3][j % 3];
-	  }
-
-	app->positions[i / 3][i % 3] = orig_pos[i] - epsilon;
-	calculateForces();
-	for (unsigned int j = 0; j < _3N; j++)
-	  {
-	    f_h[j] = (*myForces)[j / 3][j % 3];
-	  }
+    // Five-point stencil -- error is order h^4, columns over all nodes
+    numericalHessian.evaluate(&numHsn, epsilon, 4, false);
 
-	app->positions[i / 3][i % 3] = orig_pos[i] - 2.0 * epsilon;
-	calculateForces();
-	for (unsigned int j = 0; j < _3N; j++)
-	  {
-	    f_2h[j] = (*myForces)[j / 3][j % 3];
-	  }
-
-	// restore original position
-	app->positions[i / 3][i % 3] = orig_pos[i];
-	calculateForces();
-	for (unsigned int j = 0; j < _3N; j++)
-	  {
-	    f_x[j] = (*myForces)[j / 3][j % 3];
-	  }
-
-	// Five-point stencil -- error is order h^4
-	for (unsigned int j = 0; j < _3N; j++)
+    for (unsigned int i = 0; i < _3N * _3N; i++)
+      {
+	Real tempErr = fabs(numHsn.hessM[i] - hsn.hessM[i]);
+	if (tempErr > maxHessError)
 	  {
-	    numHess[i * _3N + j] = -1.0 *
-          (8.0 * f_plus_h[j] - 8.0 * f_h[j] + f_2h[j] - f_plus_2h[j]) /
-          (12.0 * epsilon);
-	    tempErr = fabs(numHess[i * _3N + j] - hsn.hessM[i * _3N + j]);
-	    if (tempErr > maxHessError)
-	      {
-		maxHessError = tempErr;
-		cout.precision(10);
-		cout << "numerical hessian " << numHess[i * _3N + j] << endl;
-		cout << "analytical hessian " << hsn.hessM[i * _3N + j] << endl;
-	      }
+	    maxHessError = tempErr;
+	    cout.precision(10);
+	    cout << "numerical hessian " << numHsn.hessM[i] << endl;
+	    cout << "analytical hessian " << hsn.hessM[i] << endl;
 	  }
       }
 
-    delete[] f_plus_2h;
-    delete[] f_plus_h;
-    delete[] f_x;
-    delete[] f_h;
-    delete[] f_2h;
-    delete[] orig_pos;
-
-
     report.precision(10);
     report << debug(1)
            << "[NumericallyDifferentiatedHessian::run] Hessian error = "
@@ -139,9 +79,6 @@ long NumericallyDifferentiatedHessian::run(const long numTimesteps) {
   report << hint << "[NumericallyDifferentiatedHessian::run] Hessian error = "
          << maxHessError << ", epsilon = " << epsilon << endr;
 
-  //remove storage
-  delete[] numHess;
-
   //
   postStepModify();
   
@@ -4,6 +4,7 @@
 
 #include <protomol/integrator/STSIntegrator.h>
 #include <protomol/integrator/hessian/Hessian.h>
+#include <protomol/integrator/hessian/NumericalHessian.h>
 
 namespace ProtoMol {
   class ScalarStructure;
@@ -54,8 +55,8 @@ namespace ProtoMol {
   private:
     Real epsilon;
     unsigned int _N, _3N;
-    Hessian hsn;
-    
+    Hessian hsn, numHsn;
+    NumericalHessian numericalHessian;
   };
 }
 
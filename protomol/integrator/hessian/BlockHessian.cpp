@@ -1199,10 +1199,11 @@ void BlockHessian::evaluateBlockForces( const unsigned int blockStart, const uns
   if (myLennardJones) {
     //loop over all pairs in this block only
     for (unsigned int i = blockStart; i <= blockEnd; i++){
+        ExclusionRow row = myTopo->exclusions.getRow(i, i + 1);
         for (unsigned int j = i + 1; j <= blockEnd; j++){
 
           //if not bonded/dihedral
-          const ExclusionClass ec = myTopo->exclusions.check(i, j);
+          const ExclusionClass ec = row.next(j);
           
           if (ec != EXCLUSION_FULL) {
 
@@ -1231,10 +1232,11 @@ void BlockHessian::evaluateBlockForces( const unsigned int blockStart, const uns
   if (myCoulomb) {
     //loop over all pairs in this block only
     for (unsigned int i = blockStart; i <= blockEnd; i++){
+        ExclusionRow row = myTopo->exclusions.getRow(i, i + 1);
         for (unsigned int j = i + 1; j <= blockEnd; j++){
 
           //if not bonded/dihedral
-          const ExclusionClass ec = myTopo->exclusions.check(i, j);
+          const ExclusionClass ec = row.next(j);
 
           if (ec != EXCLUSION_FULL) {
 
@@ -6,10 +6,16 @@
 #include <protomol/type/BlockMatrix.h>
 
 #include <protomol/base/Lapack.h>
+#include <protomol/base/PMConstants.h>
 
 #include <iostream>
 #include <stdio.h>
 #include <fstream>
+#include <algorithm>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
 
 using namespace std;
 using namespace ProtoMol::Report;
@@ -28,6 +34,10 @@ namespace ProtoMol {
   BlockHessianDiagonalize::BlockHessianDiagonalize() {
     bHess = 0; eigVal = 0; eigIndx = 0;
     blocks_num_eigs = 0; rE = 0;
+    numThreads = 1;
+#ifndef _WIN32
+    pthread_mutex_init(&workMutex, 0);
+#endif
 
   }
 
@@ -37,6 +47,9 @@ namespace ProtoMol {
     if(eigIndx != 0) delete [] eigIndx;
     if(blocks_num_eigs != 0) delete [] blocks_num_eigs;
     if(rE != 0) delete [] rE;
+#ifndef _WIN32
+    pthread_mutex_destroy(&workMutex);
+#endif
 
   }
 
@@ -44,13 +57,10 @@ namespace ProtoMol {
   // Initialize for Block Hessians
   //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
   void BlockHessianDiagonalize::initialize(BlockHessian * bHessIn, 
-                        const int sz, StandardIntegrator *intg) {
+                        const int sz, StandardIntegrator *intg,
+                        const int threads) {
 	this->intg = intg;
 	
-	if( !Lapack::isEnabled() ){
-		THROW("Block Hessian diagonalization requires Lapack libraries.");
-	}
-
     //assign pointer to BlockHessian object    
     bHess = bHessIn;  
     //assign arrays
@@ -73,6 +83,25 @@ namespace ProtoMol {
       blockEigVect[i].initialize(start,start,rows,rows);  //initialize block
       memory_footprint += rows * rows;
     }
+    blockInfo.resize(bHess->num_blocks);
+    blockSkipped.resize(bHess->num_blocks);
+    //Thread workspaces, sized for the largest block
+#ifdef _WIN32
+    numThreads = 1;
+#else
+    numThreads = threads;
+    if(numThreads <= 0) numThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if(numThreads <= 0) numThreads = 1;
+#endif
+    unsigned int max_rows = 0;
+    for(int i=0;i<bHess->num_blocks;i++)
+      max_rows = max(max_rows, (unsigned int)bHess->blocks_max[i]*3);
+    workspace.resize(numThreads);
+    for(int i=0;i<numThreads;i++){
+      workspace[i].index.resize(max_rows);
+      workspace[i].basis.MyArray.reserve(max_rows * max_rows);
+    }
+    report << debug(2) << "[BlockHessianDiagonalize::initialize] Using " << numThreads << " threads." << endr;
     //timers/counters for diagnostics
     rediagTime.reset();
     hessianTime.reset();
@@ -83,10 +112,6 @@ namespace ProtoMol {
   // Initialize for Full Hessians
   //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
   void BlockHessianDiagonalize::initialize(const int sz) {
-	if( !Lapack::isEnabled() ){
-		THROW("Block Hessian diagonalization requires Lapack libraries.");
-	}
-
     //assign pointer to BlockHessian object    
     bHess = 0;  
     //assign arrays
@@ -302,70 +327,82 @@ namespace ProtoMol {
       i_res_sum += blocks_num_eigs[i];
     }
 
-    //Do blocks if Hessian distance is 0
-    for(int ii=0;ii<bHess->num_blocks;ii++){  
-      BlockMatrix tempM((blockEigVect[ii]).ColumnStart, (bHess->blocks[ii]).ColumnStart, (blockEigVect[ii]).Columns, (bHess->blocks[ii]).Columns);
-      (blockEigVect[ii]).transposeProduct(bHess->blocks[ii], tempM); //Aaa^{T}This
-      tempM.product(blockEigVect[ii], innerDiag); //Aaa^{T}HAaa
+    //Collect the terms, blocks with Hessian distance 0 and 1, non-adjacent
+    //bond blocks and adjacent non-bond blocks
+    projections.clear();
+    for(int ii=0;ii<bHess->num_blocks;ii++){
+      Projection p = {&bHess->blocks[ii], ii, ii, false};
+      projections.push_back(p);
     }
-
-    //Do blocks if Hessian distance is 1
-    for(int ii=0;ii<bHess->num_blocks-1;ii++){  
-      BlockMatrix tempM((blockEigVect[ii]).ColumnStart, (bHess->adj_blocks[ii]).ColumnStart, (blockEigVect[ii]).Columns, (bHess->adj_blocks[ii]).Columns);
-      (blockEigVect[ii]).transposeProduct(bHess->adj_blocks[ii], tempM); //Aaa^{T}This
-      tempM.product(blockEigVect[ii+1], innerDiag); //Aaa^{T}HAbb
-      if(SYMHESS){
-        //Dont need this except for symmetric Hessians
-        for(unsigned jj=tempM.RowStart;jj<tempM.Rows+tempM.RowStart;jj++)
-          for(unsigned kk=(blockEigVect[ii+1]).ColumnStart;kk<(blockEigVect[ii+1]).Columns+(blockEigVect[ii+1]).ColumnStart;kk++)
-             innerDiag(kk,jj) = innerDiag(jj,kk);
-      }
+    for(int ii=0;ii<bHess->num_blocks-1;ii++){
+      Projection p = {&bHess->adj_blocks[ii], ii, ii+1, false};
+      projections.push_back(p);
     }
-    //Do non-adjacent bond blocks, distance > 1
     int non_adj_bond_blocks_size = bHess->non_adj_bond_blocks.size();
-    for(int ii=0;ii<non_adj_bond_blocks_size;ii++){  
-      int ar0 = bHess->non_adj_bond_index[ii*2]; int ar1 = bHess->non_adj_bond_index[ii*2+1];
-      BlockMatrix tempM((blockEigVect[ar0]).ColumnStart, (bHess->non_adj_bond_blocks[ii]).ColumnStart, (blockEigVect[ar0]).Columns, (bHess->non_adj_bond_blocks[ii]).Columns);
-      (blockEigVect[ar0]).transposeProduct(bHess->non_adj_bond_blocks[ii], tempM); //Aaa^{T}This
-      tempM.product(blockEigVect[ar1], innerDiag); //Aaa^{T}HAbb
-      if(SYMHESS){
-        //Dont need this except for symmetric Hessians
-        for(unsigned jj=tempM.RowStart;jj<tempM.Rows+tempM.RowStart;jj++)
-          for(unsigned kk=(blockEigVect[ar1]).ColumnStart;kk<(blockEigVect[ar1]).Columns+(blockEigVect[ar1]).ColumnStart;kk++)
-            innerDiag(kk,jj) = innerDiag(jj,kk);
-      }
+    for(int ii=0;ii<non_adj_bond_blocks_size;ii++){
+      Projection p = {&bHess->non_adj_bond_blocks[ii], bHess->non_adj_bond_index[ii*2],
+                      bHess->non_adj_bond_index[ii*2+1], false};
+      projections.push_back(p);
     }
-    //Do adjacent non-bond blocks
     int adj_nonbond_blocks_size = bHess->adj_nonbond_blocks.size();
-    for(int ii=0;ii<adj_nonbond_blocks_size;ii++){  
-      int ar0 = bHess->adj_nonbond_index[ii*2]; int ar1 = bHess->adj_nonbond_index[ii*2+1];
-      BlockMatrix tempM((blockEigVect[ar0]).ColumnStart, (bHess->adj_nonbond_blocks[ii]).ColumnStart, (blockEigVect[ar0]).Columns, (bHess->adj_nonbond_blocks[ii]).Columns);
-      (blockEigVect[ar0]).transposeProduct(bHess->adj_nonbond_blocks[ii], tempM); //Aaa^{T}This
-      tempM.sumProduct(blockEigVect[ar1], innerDiag); //Aaa^{T}HAbb
-      if(SYMHESS){
-        //Dont need this except for symmetric Hessians
-        for(unsigned jj=tempM.RowStart;jj<tempM.Rows+tempM.RowStart;jj++)
-          for(unsigned kk=(blockEigVect[ar1]).ColumnStart;kk<(blockEigVect[ar1]).Columns+(blockEigVect[ar1]).ColumnStart;kk++)
-            innerDiag(kk,jj) = innerDiag(jj,kk);
-      }
+    for(int ii=0;ii<adj_nonbond_blocks_size;ii++){
+      Projection p = {&bHess->adj_nonbond_blocks[ii], bHess->adj_nonbond_index[ii*2],
+                      bHess->adj_nonbond_index[ii*2+1], true};
+      projections.push_back(p);
     }
+
+    //Terms with the same target block run in order on one thread, the
+    //targets are disjoint
+    stable_sort(projections.begin(), projections.end());
+    projectionGroups.clear();
+    for(unsigned int i=0;i<projections.size();i++)
+      if(i == 0 || projections[i-1] < projections[i]) projectionGroups.push_back(i);
+    projectionGroups.push_back(projections.size());
+
+    runThreads(INNER_BLOCKS, projectionGroups.size() - 1);
     //
   }
 
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // Terms Q_a^T H Q_b of one target block of the 'inner' matrix
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  void BlockHessianDiagonalize::projectBlocks(int group, Workspace &space){
+    BlockMatrix &tempM = space.product;
+
+    for(int i=projectionGroups[group];i<projectionGroups[group+1];i++){
+      const Projection &p = projections[i];
+      tempM.initialize((blockEigVect[p.a]).ColumnStart, p.hessian->ColumnStart, (blockEigVect[p.a]).Columns, p.hessian->Columns);
+      (blockEigVect[p.a]).transposeProduct(*p.hessian, tempM); //Aaa^{T}This
+      if(p.sum) tempM.sumProduct(blockEigVect[p.b], innerDiag); //Aaa^{T}HAbb
+      else tempM.product(blockEigVect[p.b], innerDiag);
+    }
+
+    const Projection &p = projections[projectionGroups[group]];
+    if(SYMHESS && p.a != p.b){
+      //Dont need this except for symmetric Hessians
+      for(unsigned jj=tempM.RowStart;jj<tempM.Rows+tempM.RowStart;jj++)
+        for(unsigned kk=(blockEigVect[p.b]).ColumnStart;kk<(blockEigVect[p.b]).Columns+(blockEigVect[p.b]).ColumnStart;kk++)
+          innerDiag(kk,jj) = innerDiag(jj,kk);
+    }
+  }
+
   //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
   // Find 'inner' matrix, S'=Q^T H' Q, for full electrostatic Hessian H'
   //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
   void BlockHessianDiagonalize::fullElectrostaticBlocks(){
   
-    //Full electrostatics
-    for(int ii=0;ii<bHess->num_blocks;ii++){
-      BlockMatrix tempM((blockEigVect[ii]).ColumnStart, (bHess->electroStatics).ColumnStart, (blockEigVect[ii]).Columns, bHess->electroStatics.Columns);
-      (blockEigVect[ii]).transposeProduct(bHess->electroStatics, tempM); //Aaa^{T}This
-      int llStart = ii;
-      if(SYMHESS) llStart = 0;
-      for(int ll=llStart;ll<bHess->num_blocks;ll++){// should be from ii unless symmetric Hessians
-        tempM.sumProduct(blockEigVect[ll], innerDiag); //Aaa^{T}HAbb
-      }
+    //Full electrostatics, each block sums into its own rows
+    runThreads(ELECTROSTATIC_BLOCKS, bHess->num_blocks);
+  }
+
+  void BlockHessianDiagonalize::projectElectrostatics(int ii, Workspace &space){
+    BlockMatrix &tempM = space.product;
+    tempM.initialize((blockEigVect[ii]).ColumnStart, (bHess->electroStatics).ColumnStart, (blockEigVect[ii]).Columns, bHess->electroStatics.Columns);
+    (blockEigVect[ii]).transposeProduct(bHess->electroStatics, tempM); //Aaa^{T}This
+    int llStart = ii;
+    if(SYMHESS) llStart = 0;
+    for(int ll=llStart;ll<bHess->num_blocks;ll++){// should be from ii unless symmetric Hessians
+      tempM.sumProduct(blockEigVect[ll], innerDiag); //Aaa^{T}HAbb
     }
   }
 
@@ -395,202 +432,19 @@ namespace ProtoMol {
     Real max_eigenvalue = 0;
     int bHess_num_blks = bHess->num_blocks;
 
-    //find atom block start
-    unsigned int block_start = 0;
+    //diagonalize the blocks on the threads
+    workPositions = myPositions;
+    workTopo = myTopo;
+    workGeom = geom;
+    rediagTime.start();
+    runThreads(BLOCK_EIGS, bHess_num_blks);
+    rediagTime.stop();
 
     //for each block
     for(int ii=0;ii<bHess_num_blks;ii++){
-      int numFound;
-
-      //diagonalize block
-      rediagTime.start();
-      int infor = diagHessian(blockEigVect[ii].arrayPointer(), &rE[bHess->hess_eig_point[ii] * 3], 
-                                bHess->blocks[ii].arrayPointer(), bHess->blocks[ii].Rows, numFound);
-      rediagTime.stop();
-
-      if(infor) report << error << "[BlockHessianDiagonalize::findCoarseBlockEigs] Residue "<<ii+1<<" diagonalization failed."<<endr;
-
-      //sort by magnitude of eigenvalue
-      for(int i=0;i<bHess->blocks_max[ii] * 3;i++) eigIndx[i] = i;
-      absSort(blockEigVect[ii].arrayPointer(), &rE[bHess->hess_eig_point[ii] * 3], eigIndx, bHess->blocks_max[ii] * 3);
-
-      //~~~~Use geometrically generated conserved dof to generate a new basis set?
-      if( geom ){
-          //set conserved dof
-          unsigned int cdof = 6;
-
-          //create temporary matrix
-          const unsigned int rowstart = blockEigVect[ii].RowStart;
-          const unsigned int colstart = blockEigVect[ii].ColumnStart;
-
-          BlockMatrix tmpEigs( rowstart, colstart,
-                                blockEigVect[ii].Rows, blockEigVect[ii].Columns );
-
-          //clear it
-          tmpEigs.clear();
-
-          //find positions
-          const unsigned int block_max = bHess->blocks_max[ii];
-
-          //find center and norm (1/sqrt mass)
-          Vector3D pos_center(0.0,0.0,0.0);
-          Real totalmass = 0.0;
-          Real inorm = 0;
-
-          for( unsigned jj=0; jj<block_max; jj++ ){
-              const unsigned int atomindex = block_start + jj;
-              //sums
-              const Real mass = myTopo->atoms[atomindex].scaledMass;
-              pos_center += (*myPositions)[atomindex] * mass;
-              totalmass += mass;
-
-              const Real oneosrm = sqrt(myTopo->atoms[atomindex].scaledMass);
-              inorm += oneosrm * oneosrm;
-          }
-
-          //get inverse of actual norm
-          inorm = 1.0 / sqrt(inorm);
-
-          //actual center
-          pos_center /= totalmass;//(Real)block_max;
-
-          //create fixed dof vectors
-          for( unsigned jj=0; jj<block_max; jj++ ){
-              const unsigned int atomindex = block_start + jj;
-
-              //translational dof
-              Real factor = inorm * sqrt(myTopo->atoms[atomindex].scaledMass);
-              tmpEigs(rowstart + jj*3,colstart) = factor;
-              tmpEigs(rowstart + jj*3+1,colstart + 1) = factor;
-              tmpEigs(rowstart + jj*3+2,colstart + 2) = factor;
-
-              //rotational dof
-              //cross product of rotation axis and vector to center of molecule
-              //axb=ia2b3+ja3b1+ka1b2-ia3b2-ja1b3-ka2b1
-              //x-axis (b1=1) ja3-ka2
-              //y-axis (b2=1) ka1-ia3
-              //z-axis (b3=1) ia2-ja1
-              Vector3D diff = (*myPositions)[atomindex] - pos_center;
-              //x
-              tmpEigs(rowstart + jj*3+1,colstart + 3) = diff.c[2] * factor;//z;
-              tmpEigs(rowstart + jj*3+2,colstart + 3) = -diff.c[1] * factor;//y;
-              //y
-              tmpEigs(rowstart + jj*3,colstart + 4) = -diff.c[2] * factor;//z;
-              tmpEigs(rowstart + jj*3+2,colstart + 4) = diff.c[0] * factor;//x;
-              //y
-              tmpEigs(rowstart + jj*3,colstart + 5) = diff.c[1] * factor;//y;
-              tmpEigs(rowstart + jj*3+1,colstart + 5) = -diff.c[0] * factor;//x;
-
-          }
-
-          //~~~~Norm vector 1~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-          //norm the rotational vectors
-          Real rotnorm = 0.0;
-          for( unsigned ll=0; ll<block_max * 3; ll++ ){
-                rotnorm += tmpEigs(rowstart + ll, colstart + 3)
-                                * tmpEigs(rowstart + ll, colstart + 3);
-          }
-          rotnorm = 1.0 / sqrt(rotnorm);
-          //do norm
-          for( unsigned ll=0; ll<block_max * 3; ll++ ){
-                tmpEigs(rowstart + ll, colstart + 3) *= rotnorm;
-          }
-          //~~~~orthoganalize vectors 2 and 3~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-          for( unsigned jj=4; jj<=5; jj++ ){
-
-              //(new vectors already have cdof vectors in them)
-              for( unsigned kk=3; kk<jj; kk++ ){
-
-                  //get dot product (and norm of dots)
-                  Real dots = 0.0;
-                  for( unsigned ll=0; ll<block_max * 3; ll++ ){
-                    dots += tmpEigs(rowstart + ll, colstart + kk)
-                                    * tmpEigs(rowstart + ll, colstart + jj);
-                  }
-
-                  //subtract it from current vector
-                  for( unsigned ll=0; ll<block_max * 3; ll++ ){
-                      tmpEigs(rowstart + ll,colstart + jj) -=
-                              tmpEigs(rowstart + ll,colstart + kk) * dots;
-                  }
-
-              }
-
-              Real nnorm = 0.0;
-              for( unsigned ll=0; ll<block_max * 3; ll++ ){
-                  nnorm += tmpEigs(rowstart + ll,colstart + jj) * tmpEigs(rowstart + ll,colstart + jj);
-              }
-
-              nnorm = 1.0 / sqrt(nnorm);
-              //scale
-              for( unsigned ll=0; ll<block_max * 3; ll++ ){
-                  tmpEigs(rowstart + ll,colstart + jj) *= nnorm;
-              }
-
-          }
-          //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-
-          //sift actual vectors into array, orthogonalizing w.r.t. the conserved dof.
-          //conserved dof, cdof, set at top of routine
-
-          //loop over each vector in block
-          for( unsigned jj=0; jj< 3 * block_max - cdof; jj++ ){
-
-              //copy original vector
-              for( unsigned ll=0; ll<block_max * 3; ll++ ){
-                  tmpEigs(rowstart + ll, colstart + jj + cdof) = blockEigVect[ii](rowstart + ll,colstart + jj);
-              }
-
-              //get dot product with eack previous vector
-              //(new vectors already have cdof vectors in them)
-              for( unsigned kk=0; kk<jj+cdof; kk++ ){
-
-                  //get dot product (and norm of dots)
-                  Real dots = 0.0;
-                  for( unsigned ll=0; ll<block_max * 3; ll++ ){
-                    dots += tmpEigs(rowstart + ll, colstart + kk)
-                                    * blockEigVect[ii](rowstart + ll, colstart + jj);
-                  }
-
-                  //subtract it from current vector
-                  for( unsigned ll=0; ll<block_max * 3; ll++ ){
-                      tmpEigs(rowstart + ll,colstart + jj + cdof) -=
-                              tmpEigs(rowstart + ll,colstart + kk) * dots;
-                  }
-
-              }
-
-              //normalize the residual vector
-              Real nnorm = 0.0;
-              for( unsigned ll=0; ll<block_max * 3; ll++ ){
-                  nnorm += tmpEigs(rowstart + ll,colstart + jj + cdof) * tmpEigs(rowstart + ll,colstart + jj + cdof);
-              }
-
-              //remove if 1/20 th of original
-              if( nnorm < 0.05 && cdof > 0 ){//TODO## AND not last?
-                  report << debug(12) << "Residual vector " << jj << " norm is low = " << nnorm << " in block " 
-                                << ii << ", skipping." << endr;
-                  cdof--;
-              }else{
-                  
-                  nnorm = 1.0 / sqrt(nnorm);
-                  //scale
-                  for( unsigned ll=0; ll<block_max * 3; ll++ ){
-                      tmpEigs(rowstart + ll,colstart + jj + cdof) *= nnorm;
-                  }
-                  
-              }
-
-          }
-
-          //copy across
-          blockEigVect[ii] = tmpEigs;
-
-          //update start atom for next block
-          block_start += block_max;
-
-      }
-      //~~~~End geometric~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+      if(blockInfo[ii]) report << error << "[BlockHessianDiagonalize::findCoarseBlockEigs] Residue "<<ii+1<<" diagonalization failed."<<endr;
+      if(blockSkipped[ii]) report << debug(12) << blockSkipped[ii] << " residual vectors with low norm skipped in block "
+                                    << ii << "." << endr;
 
       //find number of eigs required, by the eigenvalue threshold, if block vector number not set
       //fix for no block vectors and eig_thresh greater than max_eig
@@ -648,6 +502,260 @@ namespace ProtoMol {
     //
   }
 
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // Diagonalize one block, and find its geometric basis
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  void BlockHessianDiagonalize::blockEigs(int ii, Workspace &space){
+    const Vector3DBlock *myPositions = workPositions;
+    const GenericTopology *myTopo = workTopo;
+
+    //find atom block start
+    const unsigned int block_start = bHess->hess_eig_point[ii];
+    int numFound;
+
+    //diagonalize block
+    blockInfo[ii] = diagHessian(blockEigVect[ii].arrayPointer(), &rE[bHess->hess_eig_point[ii] * 3], 
+                                  bHess->blocks[ii].arrayPointer(), bHess->blocks[ii].Rows, numFound);
+    blockSkipped[ii] = 0;
+
+    //sort by magnitude of eigenvalue
+    int *eigIndx = &space.index[0];
+    for(int i=0;i<bHess->blocks_max[ii] * 3;i++) eigIndx[i] = i;
+    absSort(blockEigVect[ii].arrayPointer(), &rE[bHess->hess_eig_point[ii] * 3], eigIndx, bHess->blocks_max[ii] * 3);
+
+    //~~~~Use geometrically generated conserved dof to generate a new basis set?
+    if( workGeom ){
+        //set conserved dof
+        unsigned int cdof = 6;
+
+        //create temporary matrix
+        const unsigned int rowstart = blockEigVect[ii].RowStart;
+        const unsigned int colstart = blockEigVect[ii].ColumnStart;
+
+        BlockMatrix &tmpEigs = space.basis;
+        tmpEigs.initialize( rowstart, colstart,
+                              blockEigVect[ii].Rows, blockEigVect[ii].Columns );
+
+        //clear it
+        tmpEigs.clear();
+
+        //find positions
+        const unsigned int block_max = bHess->blocks_max[ii];
+
+        //find center and norm (1/sqrt mass)
+        Vector3D pos_center(0.0,0.0,0.0);
+        Real totalmass = 0.0;
+        Real inorm = 0;
+
+        for( unsigned jj=0; jj<block_max; jj++ ){
+            const unsigned int atomindex = block_start + jj;
+            //sums
+            const Real mass = myTopo->atoms[atomindex].scaledMass;
+            pos_center += (*myPositions)[atomindex] * mass;
+            totalmass += mass;
+
+            const Real oneosrm = sqrt(myTopo->atoms[atomindex].scaledMass);
+            inorm += oneosrm * oneosrm;
+        }
+
+        //get inverse of actual norm
+        inorm = 1.0 / sqrt(inorm);
+
+        //actual center
+        pos_center /= totalmass;//(Real)block_max;
+
+        //create fixed dof vectors
+        for( unsigned jj=0; jj<block_max; jj++ ){
+            const unsigned int atomindex = block_start + jj;
+
+            //translational dof
+            Real factor = inorm * sqrt(myTopo->atoms[atomindex].scaledMass);
+            tmpEigs(rowstart + jj*3,colstart) = factor;
+            tmpEigs(rowstart + jj*3+1,colstart + 1) = factor;
+            tmpEigs(rowstart + jj*3+2,colstart + 2) = factor;
+
+            //rotational dof
+            //cross product of rotation axis and vector to center of molecule
+            //axb=ia2b3+ja3b1+ka1b2-ia3b2-ja1b3-ka2b1
+            //x-axis (b1=1) ja3-ka2
+            //y-axis (b2=1) ka1-ia3
+            //z-axis (b3=1) ia2-ja1
+            Vector3D diff = (*myPositions)[atomindex] - pos_center;
+            //x
+            tmpEigs(rowstart + jj*3+1,colstart + 3) = diff.c[2] * factor;//z;
+            tmpEigs(rowstart + jj*3+2,colstart + 3) = -diff.c[1] * factor;//y;
+            //y
+            tmpEigs(rowstart + jj*3,colstart + 4) = -diff.c[2] * factor;//z;
+            tmpEigs(rowstart + jj*3+2,colstart + 4) = diff.c[0] * factor;//x;
+            //y
+            tmpEigs(rowstart + jj*3,colstart + 5) = diff.c[1] * factor;//y;
+            tmpEigs(rowstart + jj*3+1,colstart + 5) = -diff.c[0] * factor;//x;
+
+        }
+
+        //~~~~Norm vector 1~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+        //norm the rotational vectors
+        Real rotnorm = 0.0;
+        for( unsigned ll=0; ll<block_max * 3; ll++ ){
+              rotnorm += tmpEigs(rowstart + ll, colstart + 3)
+                              * tmpEigs(rowstart + ll, colstart + 3);
+        }
+        rotnorm = 1.0 / sqrt(rotnorm);
+        //do norm
+        for( unsigned ll=0; ll<block_max * 3; ll++ ){
+              tmpEigs(rowstart + ll, colstart + 3) *= rotnorm;
+        }
+        //~~~~orthoganalize vectors 2 and 3~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+        for( unsigned jj=4; jj<=5; jj++ ){
+
+            //(new vectors already have cdof vectors in them)
+            for( unsigned kk=3; kk<jj; kk++ ){
+
+                //get dot product (and norm of dots)
+                Real dots = 0.0;
+                for( unsigned ll=0; ll<block_max * 3; ll++ ){
+                  dots += tmpEigs(rowstart + ll, colstart + kk)
+                                  * tmpEigs(rowstart + ll, colstart + jj);
+                }
+
+                //subtract it from current vector
+                for( unsigned ll=0; ll<block_max * 3; ll++ ){
+                    tmpEigs(rowstart + ll,colstart + jj) -=
+                            tmpEigs(rowstart + ll,colstart + kk) * dots;
+                }
+
+            }
+
+            Real nnorm = 0.0;
+            for( unsigned ll=0; ll<block_max * 3; ll++ ){
+                nnorm += tmpEigs(rowstart + ll,colstart + jj) * tmpEigs(rowstart + ll,colstart + jj);
+            }
+
+            nnorm = 1.0 / sqrt(nnorm);
+            //scale
+            for( unsigned ll=0; ll<block_max * 3; ll++ ){
+                tmpEigs(rowstart + ll,colstart + jj) *= nnorm;
+            }
+
+        }
+        //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+        //sift actual vectors into array, orthogonalizing w.r.t. the conserved dof.
+        //conserved dof, cdof, set at top of routine
+
+        //loop over each vector in block
+        for( unsigned jj=0; jj< 3 * block_max - cdof; jj++ ){
+
+            //copy original vector
+            for( unsigned ll=0; ll<block_max * 3; ll++ ){
+                tmpEigs(rowstart + ll, colstart + jj + cdof) = blockEigVect[ii](rowstart + ll,colstart + jj);
+            }
+
+            //get dot product with eack previous vector
+            //(new vectors already have cdof vectors in them)
+            for( unsigned kk=0; kk<jj+cdof; kk++ ){
+
+                //get dot product (and norm of dots)
+                Real dots = 0.0;
+                for( unsigned ll=0; ll<block_max * 3; ll++ ){
+                  dots += tmpEigs(rowstart + ll, colstart + kk)
+                                  * blockEigVect[ii](rowstart + ll, colstart + jj);
+                }
+
+                //subtract it from current vector
+                for( unsigned ll=0; ll<block_max * 3; ll++ ){
+                    tmpEigs(rowstart + ll,colstart + jj + cdof) -=
+                            tmpEigs(rowstart + ll,colstart + kk) * dots;
+                }
+
+            }
+
+            //normalize the residual vector
+            Real nnorm = 0.0;
+            for( unsigned ll=0; ll<block_max * 3; ll++ ){
+                nnorm += tmpEigs(rowstart + ll,colstart + jj + cdof) * tmpEigs(rowstart + ll,colstart + jj + cdof);
+            }
+
+            //remove if 1/20 th of original
+            if( nnorm < 0.05 && cdof > 0 ){//TODO## AND not last?
+                blockSkipped[ii]++;
+                cdof--;
+            }else{
+                
+                nnorm = 1.0 / sqrt(nnorm);
+                //scale
+                for( unsigned ll=0; ll<block_max * 3; ll++ ){
+                    tmpEigs(rowstart + ll,colstart + jj + cdof) *= nnorm;
+                }
+                
+            }
+
+        }
+
+        //copy across
+        blockEigVect[ii] = tmpEigs;
+
+    }
+    //~~~~End geometric~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // Threads
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  void BlockHessianDiagonalize::runThreads(Phase phase, int items){
+    workPhase = phase;
+    workNext = 0;
+    workItems = items;
+
+#ifdef _WIN32
+    //serial, the calling thread takes all items
+    worker(0);
+#else
+    //the calling thread is worker 0, if a thread fails to start the
+    //others take its share
+    const int threads = min(numThreads, items);
+    vector<pthread_t> thread(threads > 1 ? threads - 1 : 0);
+    vector<WorkerArg> arg(thread.size());
+    unsigned int started = 0;
+    for(;started<thread.size();started++){
+      arg[started].self = this;
+      arg[started].id = started + 1;
+      if(pthread_create(&thread[started], 0, callWorker, &arg[started]) != 0) break;
+    }
+    worker(0);
+    for(unsigned int i=0;i<started;i++) pthread_join(thread[i], 0);
+#endif
+  }
+
+#ifndef _WIN32
+  void *BlockHessianDiagonalize::callWorker(void *param){
+    WorkerArg *arg = (WorkerArg *)param;
+    arg->self->worker(arg->id);
+    return 0;
+  }
+#endif
+
+  void BlockHessianDiagonalize::worker(int id){
+    Workspace &space = workspace[id];
+
+    while(true){
+#ifndef _WIN32
+      pthread_mutex_lock(&workMutex);
+#endif
+      const int item = workNext++;
+#ifndef _WIN32
+      pthread_mutex_unlock(&workMutex);
+#endif
+      if(item >= workItems) break;
+
+      switch(workPhase){
+      case BLOCK_EIGS: blockEigs(item, space); break;
+      case INNER_BLOCKS: projectBlocks(item, space); break;
+      case ELECTROSTATIC_BLOCKS: projectElectrostatics(item, space); break;
+      }
+    }
+  }
+
   //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
   // Diagnostic output
   //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -815,4 +923,177 @@ namespace ProtoMol {
     delete [] tmpVect;
   }
 
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // Warm start from the last vectors
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+  //Solves the 3x3 system A x = b by Cramer's rule, false if singular
+  static bool solve3x3( const double *A, const double *b, double *x ){
+    const double det = A[0] * ( A[4] * A[8] - A[5] * A[7] )
+                     - A[1] * ( A[3] * A[8] - A[5] * A[6] )
+                     + A[2] * ( A[3] * A[7] - A[4] * A[6] );
+    if ( fabs( det ) < Constant::EPSILON ) return false;
+
+    x[0] = ( b[0] * ( A[4] * A[8] - A[5] * A[7] )
+           - A[1] * ( b[1] * A[8] - A[5] * b[2] )
+           + A[2] * ( b[1] * A[7] - A[4] * b[2] ) ) / det;
+    x[1] = ( A[0] * ( b[1] * A[8] - A[5] * b[2] )
+           - b[0] * ( A[3] * A[8] - A[5] * A[6] )
+           + A[2] * ( A[3] * b[2] - b[1] * A[6] ) ) / det;
+    x[2] = ( A[0] * ( A[4] * b[2] - b[1] * A[7] )
+           - A[1] * ( A[3] * b[2] - b[1] * A[6] )
+           + b[0] * ( A[3] * A[7] - A[4] * A[6] ) ) / det;
+    return true;
+  }
+
+  //The residual norm of each mode is the Rayleigh quotient bound of
+  //calcRayleigh(), a bound on the error of its eigenvalue. Only the new
+  //columns of the basis need products.
+  bool BlockHessianDiagonalize::warmStart(Product &H, const double *blocks,
+                                          double *mhQu, const int _3N,
+                                          const int p, const int modes,
+                                          const int iterations,
+                                          const Real tolerance,
+                                          Real &residual){
+    const int maxCols = std::min( p * ( iterations + 1 ), _3N );
+
+    ritzBasis.resize( _3N * maxCols );
+    ritzProduct.resize( _3N * maxCols );
+    ritzVectors.resize( _3N * p );
+    ritzVectorProducts.resize( _3N * p );
+    double *V = &ritzBasis[0];
+    double *HV = &ritzProduct[0];
+    double *X = &ritzVectors[0];
+    double *HX = &ritzVectorProducts[0];
+
+    std::copy( mhQu, mhQu + _3N * p, V );
+    H.product( V, HV, p );
+
+    int cols = p;
+    for ( int itr = 0; ; itr++ ) {
+      if ( !rayleighRitz( V, HV, cols, p, _3N, X, HX ) ) {
+        report << debug(1) << "[BlockHessianDiagonalize::warmStart] Rayleigh-Ritz diagonalization failed." << endr;
+        return false;
+      }
+
+      //residuals, the new basis columns
+      double *R = V + _3N * cols;
+      const int numR = std::min( p, maxCols - cols );
+      residual = 0.0;
+      for ( int j = 0;j < p;j++ ) {
+        Real norm = 0.0;
+        for ( int i = 0;i < _3N;i++ ) {
+          const Real r = HX[j*_3N+i] - eigVal[j] * X[j*_3N+i];
+          if ( j < numR ) R[j*_3N+i] = r;
+          norm += r * r;
+        }
+        if ( j < modes ) residual = std::max( residual, sqrt( norm ) );
+      }
+
+      report << debug(2) << "[BlockHessianDiagonalize::warmStart] Iteration " << itr
+             << ", basis " << cols << ", residual " << residual << "." << endr;
+
+      if ( residual <= tolerance ) {
+        std::copy( X, X + _3N * p, mhQu );
+        report << debug(1) << "[BlockHessianDiagonalize::warmStart] "
+               << itr << " iterations, residual " << residual << "." << endr;
+        return true;
+      }
+
+      if ( itr == iterations || numR == 0 ) return false;
+
+      //precondition with (D - eigVal I)^{-1}, D the atom blocks of H
+      for ( int j = 0;j < numR;j++ ) {
+        for ( int a = 0;a < _3N / 3;a++ ) {
+          double A[9], x[3];
+          std::copy( blocks + 9 * a, blocks + 9 * a + 9, A );
+          for ( int k = 0;k < 3;k++ ) A[k*3+k] -= eigVal[j];
+          if ( solve3x3( A, &R[j*_3N+3*a], x ) ) {
+            std::copy( x, x + 3, &R[j*_3N+3*a] );
+          }
+        }
+      }
+
+      //orthonormalize against the basis and each other, twice for
+      //stability, dropping dependent columns
+      int kept = 0;
+      for ( int j = 0;j < numR;j++ ) {
+        double *r = R + j * _3N;
+        for ( int pass = 0;pass < 2;pass++ ) {
+          for ( int k = 0;k < cols + kept;k++ ) {
+            const double *v = V + k * _3N;
+            Real dot = 0.0;
+            for ( int i = 0;i < _3N;i++ ) dot += v[i] * r[i];
+            for ( int i = 0;i < _3N;i++ ) r[i] -= dot * v[i];
+          }
+        }
+        Real norm = 0.0;
+        for ( int i = 0;i < _3N;i++ ) norm += r[i] * r[i];
+        norm = sqrt( norm );
+        if ( norm < 1e-10 ) continue;
+
+        double *w = R + kept * _3N;
+        for ( int i = 0;i < _3N;i++ ) w[i] = r[i] / norm;
+        kept++;
+      }
+
+      if ( kept == 0 ) {
+        report << debug(1) << "[BlockHessianDiagonalize::warmStart] Basis exhausted." << endr;
+        return false;
+      }
+
+      H.product( R, HV + _3N * cols, kept );
+      cols += kept;
+    }
+
+  }
+
+  //Lowest p Ritz pairs of the basis V with products HV, sorted on absolute
+  //value, the vectors and their products into X and HX
+  bool BlockHessianDiagonalize::rayleighRitz(double *V, double *HV, int cols,
+                                             int p, int _3N, double *X,
+                                             double *HX){
+    ritzInner.resize( cols * cols );
+    ritzInnerVectors.resize( cols * cols );
+
+    //S = V^T H V, symmetric up to round-off or finite differences
+    char transA = 'T'; char transB = 'N';
+    int m = cols; int n = cols; int k = _3N;
+    int lda = _3N; int ldb = _3N; int ldc = cols;
+    double alpha = 1.0; double beta = 0.0;
+    Lapack::dgemm( &transA, &transB, &m, &n, &k, &alpha, V, &lda, HV, &ldb, &beta, &ritzInner[0], &ldc );
+    for ( int i = 0;i < cols;i++ ) {
+      for ( int j = 0;j < i;j++ ) {
+        const double s = 0.5 * ( ritzInner[i*cols+j] + ritzInner[j*cols+i] );
+        ritzInner[i*cols+j] = ritzInner[j*cols+i] = s;
+      }
+    }
+
+    int numeFound;
+    if ( diagHessian( &ritzInnerVectors[0], eigVal, &ritzInner[0], cols, numeFound ) ) {
+      return false;
+    }
+    //the lowest values are reliable, interior ones need not be, so sort
+    //only the first p of the ascending values on absolute value
+    for ( int i = 0;i < p;i++ ) {
+      int k = i;
+      for ( int j = i + 1;j < p;j++ ) {
+        if ( fabs( eigVal[j] ) < fabs( eigVal[k] ) ) k = j;
+      }
+      if ( k == i ) continue;
+      std::swap( eigVal[i], eigVal[k] );
+      std::swap_ranges( &ritzInnerVectors[i*cols], &ritzInnerVectors[i*cols] + cols, &ritzInnerVectors[k*cols] );
+    }
+
+    //X = V Y, HX = HV Y for the first p columns of Y
+    transA = 'N';
+    m = _3N; n = p; k = cols;
+    lda = _3N; ldb = cols; ldc = _3N;
+    Lapack::dgemm( &transA, &transB, &m, &n, &k, &alpha, V, &lda, &ritzInnerVectors[0], &ldb, &beta, X, &ldc );
+    Lapack::dgemm( &transA, &transB, &m, &n, &k, &alpha, HV, &lda, &ritzInnerVectors[0], &ldb, &beta, HX, &ldc );
+
+    return true;
+  }
+
 }
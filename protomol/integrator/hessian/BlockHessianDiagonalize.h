@@ -9,12 +9,21 @@
 #include <protomol/ProtoMolApp.h>
 #include <protomol/integrator/StandardIntegrator.h>
 
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
 namespace ProtoMol {
   /**
    *
    * Diagonalizes the Block Hessians
    * for the current force field.
    *
+   * The residue blocks are diagonalized, and their projections into the
+   * 'inner' Hessian formed, on a team of threads. Each thread owns a
+   * workspace that is reused between blocks and calls. Without pthreads
+   * (Windows) the calling thread does all the work.
+   *
    */
   class BlockHessianDiagonalize {
     //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -24,6 +33,29 @@ namespace ProtoMol {
   enum {OUTPUTIHESS = 0};
   enum {OUTPUTEGVAL = 0};
   enum {OUTPUTBHESS = 0};
+  enum Phase {BLOCK_EIGS, INNER_BLOCKS, ELECTROSTATIC_BLOCKS};
+
+    // Scratch of one thread
+    struct Workspace {
+      BlockMatrix product; // Q_a^T H of one block
+      BlockMatrix basis; // geometric basis of one block
+      vector<int> index; // absSort order
+    };
+
+    // One Q_a^T H Q_b term of the inner Hessian
+    struct Projection {
+      const BlockMatrix *hessian;
+      int a, b;
+      bool sum;
+      bool operator<(const Projection &p) const {
+        return a < p.a || (a == p.a && b < p.b);
+      }
+    };
+
+    struct WorkerArg {
+      BlockHessianDiagonalize *self;
+      int id;
+    };
 
     //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
     // Constructors, destructors, assignment
@@ -36,8 +68,9 @@ namespace ProtoMol {
     // New methods of class BlockHessianDiagonalize
     //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
   public:
+    /// threads 0 for one per online processor
     void initialize(BlockHessian * bHessIn, const int sz, 
-            StandardIntegrator *intg);
+            StandardIntegrator *intg, const int threads = 0);
     void initialize(const int sz);
     Real findEigenvectors(Vector3DBlock *myPositions,
                           GenericTopology *myTopo, double * mhQu, 
@@ -50,7 +83,28 @@ namespace ProtoMol {
                     double *hsnhessM, int dim, int &numFound);
     void absSort(double *eigVec, double *eigVal, int *eigIndx, int dim);
 
+    /// Products Y = H V for warmStart(), V and Y column major with 3N rows
+    /// and cols columns
+    struct Product {
+      virtual ~Product() {}
+      virtual void product(double *V, double *Y, int cols) = 0;
+    };
+
+    /// Block Davidson from the first p columns of mhQu, orthonormal. Each
+    /// iteration adds the residuals of the Ritz vectors to the basis,
+    /// preconditioned with the 3x3 atom blocks of H, row major in blocks.
+    /// If the largest residual of the first modes Ritz vectors is at most
+    /// tolerance within iterations, the first p are stored in mhQu and
+    /// their values in eigVal, in the order of absSort(), and true is
+    /// returned. The last largest residual is left in residual.
+    bool warmStart(Product &H, const double *blocks, double *mhQu,
+                   const int _3N, const int p, const int modes,
+                   const int iterations, const Real tolerance,
+                   Real &residual);
+
   private:
+    bool rayleighRitz(double *V, double *HV, int cols, int p, int _3N,
+                      double *X, double *HX);
     void innerHessian();
     void calculateS(Vector3DBlock *myPositions,
                        GenericTopology *myTopo);
@@ -63,6 +117,16 @@ namespace ProtoMol {
     void fullElectrostaticBlocks();
     void outputDiagnostics(int typ); 
 
+    // Runs items 0..items-1 of phase on the threads, in any order
+    void runThreads(Phase phase, int items);
+#ifndef _WIN32
+    static void *callWorker(void *param);
+#endif
+    void worker(int id);
+    void blockEigs(int ii, Workspace &space);
+    void projectBlocks(int group, Workspace &space);
+    void projectElectrostatics(int ii, Workspace &space);
+
     //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
     // Friends of class BlockHessianDiagonalize
     //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -82,6 +146,26 @@ namespace ProtoMol {
     vector<Real> blocVectCol;
     //
     StandardIntegrator *intg;
+    //Threads and their scratch
+    int numThreads;
+    vector<Workspace> workspace;
+    //Work of the current phase, taken in order under workMutex
+#ifndef _WIN32
+    pthread_mutex_t workMutex;
+#endif
+    Phase workPhase;
+    int workNext, workItems;
+    //Per block results of BLOCK_EIGS
+    vector<int> blockInfo, blockSkipped;
+    const Vector3DBlock *workPositions;
+    const GenericTopology *workTopo;
+    bool workGeom;
+    //Terms of INNER_BLOCKS sorted by target, and the start of each target
+    vector<Projection> projections;
+    vector<int> projectionGroups;
+    //Warm start basis, its products and Ritz vectors
+    vector<double> ritzBasis, ritzProduct, ritzInner, ritzInnerVectors,
+      ritzVectors, ritzVectorProducts;
     //
   public:
     //Diagnostic data
@@ -809,9 +809,10 @@ void Hessian::evaluateBornRadii(const Vector3DBlock *myPositions,
   }
   //check all pairs
   for (unsigned int i = 0; i < atoms_size; i++){
+    ExclusionRow row = myTopo->exclusions.getRow(i, i + 1);
     for (unsigned int j = i + 1; j < atoms_size; j++){
       //if not bonded/dihedral
-      ExclusionClass ec = myTopo->exclusions.check(i, j);
+      ExclusionClass ec = row.next(j);
       if (ec != EXCLUSION_FULL) {
         Vector3D rij =
               myTopo->minimalDifference((*myPositions)[i], (*myPositions)[j]);
@@ -855,8 +856,9 @@ void Hessian::evaluateGBBornRadii(const Vector3DBlock *myPositions,
    gbBornRadii.preProcess(myTopo, myPositions);
 
    for (unsigned int i=0; i < atom_size ; i++) {
+      ExclusionRow row = myTopo->exclusions.getRow(i, i + 1);
       for (unsigned int j = i + 1; j < atom_size; j++){
-         ExclusionClass ec = myTopo->exclusions.check(i, j);
+         ExclusionClass ec = row.next(j);
          //Now include ALL atoms, no exclusions
          if (1) { //ec != EXCLUSION_FULL) {
            Vector3D rij =
@@ -881,8 +883,9 @@ void Hessian::evaluateGBPartialSum(const Vector3DBlock *myPositions,
   gbPartialSum.preProcess(myTopo, myPositions);
 
   for (unsigned int i=0; i < atom_size ; i++) {
+    ExclusionRow row = myTopo->exclusions.getRow(i, i + 1);
     for (unsigned int j = i + 1; j < atom_size; j++){
-      ExclusionClass ec = myTopo->exclusions.check(i, j);
+      ExclusionClass ec = row.next(j);
       //Now include ALL atoms, no exclusions
       if (1) { //ec != EXCLUSION_FULL) {
         Vector3D rij =
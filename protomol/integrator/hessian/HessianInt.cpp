@@ -123,10 +123,6 @@ void HessianInt::initialize(ProtoMolApp *app) {
     THROW("[HessianInt::initialize] Cannot output Hessian after Lapack "
           "diagonalization!");
 
-	if( !Lapack::isEnabled() ){
-      THROW("Block Hessian diagonalization requires Lapack libraries.");
-	}
-
   //creat hessian arrays and initialize sz
   int _N = app->positions.size();
   sz = 3 * _N;
@@ -0,0 +1,413 @@
+#include <protomol/integrator/hessian/HessianProduct.h>
+
+#include <protomol/base/Report.h>
+#include <protomol/base/PMConstants.h>
+#include <protomol/type/Vector3DBlock.h>
+#include <protomol/force/hessian/ReducedHessAngle.h>
+#include <protomol/force/hessian/ReducedHessBond.h>
+#include <protomol/force/hessian/HessDihedral.h>
+
+#include <algorithm>
+#include <math.h>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+using namespace std;
+using namespace ProtoMol::Report;
+using namespace ProtoMol;
+
+namespace ProtoMol {
+  //___________________________________________________________ HessianProduct
+
+  HessianProduct::HessianProduct(int threads) :
+    numThreads(threads), myPositions(0), myTopo(0), allPairs(true),
+    periodic(false), pairCutoff2(0), workNext(0), workV(0), workY(0),
+    workCols(0) {
+#ifdef _WIN32
+    numThreads = 1;
+#else
+    if (numThreads <= 0) numThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (numThreads <= 0) numThreads = 1;
+    pthread_mutex_init(&workMutex, 0);
+#endif
+    dim[0] = dim[1] = dim[2] = 1;
+  }
+
+  HessianProduct::~HessianProduct() {
+#ifndef _WIN32
+    pthread_mutex_destroy(&workMutex);
+#endif
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // Positions, Born radii, pair search and the work items
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  void HessianProduct::prepare(const Vector3DBlock *myPositions,
+                               GenericTopology *myTopo, const bool mrw) {
+    this->myPositions = myPositions;
+    this->myTopo = myTopo;
+
+    const unsigned int atoms_size = myTopo->atoms.size();
+    sz = 3 * atoms_size;
+    weight.resize(atoms_size);
+    for (unsigned int i = 0; i < atoms_size; i++)
+      weight[i] = mrw ? 1.0 / sqrt(myTopo->atoms[i].scaledMass) : 1.0;
+
+    //Pre-calculate Born radii and GB sums, as Hessian::evaluate
+    if (myBornRadii && myBornSelf && myTopo->doSCPISM)
+      evaluateBornRadii(myPositions, myTopo);
+    if (myGBBornRadii && myTopo->doGBSAOpenMM)
+      evaluateGBBornRadii(myPositions, myTopo);
+    if (myGBPartialSum && myTopo->doGBSAOpenMM)
+      evaluateGBPartialSum(myPositions, myTopo);
+
+    //Bonded terms in chunks
+    items.clear();
+    const unsigned int counts[5] = {
+      myImproper ? (unsigned int)myTopo->impropers.size() : 0,
+      myDihedral ? (unsigned int)myTopo->dihedrals.size() : 0,
+      myRBDihedral ? (unsigned int)myTopo->rb_dihedrals.size() : 0,
+      myBond ? (unsigned int)myTopo->bonds.size() : 0,
+      myAngle ? (unsigned int)myTopo->angles.size() : 0
+    };
+    const Term terms[5] = {IMPROPERS, DIHEDRALS, RBDIHEDRALS, BONDS, ANGLES};
+    for (unsigned int t = 0; t < 5; t++)
+      for (unsigned int b = 0; b < counts[t]; b += BONDED_CHUNK) {
+        Item item = {terms[t], b, min(b + (unsigned int)BONDED_CHUNK, counts[t])};
+        items.push_back(item);
+      }
+
+    //Pairs, beyond the largest cutoff all pair Hessians vanish
+    const bool bornSelf = myBornRadii && myBornSelf && myTopo->doSCPISM;
+    const bool gb = myGBBornRadii && (myGBACEForce || myGBForce) &&
+      myTopo->doGBSAOpenMM;
+    const bool coulomb = myCoulomb || myCoulombDielec || myCoulombSCPISM;
+    if (!myLennardJones && !coulomb && !bornSelf && !gb) return;
+
+    Real cutoff = cutOff;
+    if (bornSelf) cutoff = max(cutoff, sqrt((Real)BORNCUTOFF2));
+    allPairs = gb || (myLennardJones && !lSwitch) || (coulomb && !cSwitch) ||
+      cutoff <= 0.0;
+    pairCutoff2 = cutoff * cutoff;
+
+    //Cells of at least the cutoff, periodic grids need three per dimension
+    //not to see a neighbor twice
+    periodic = myTopo->getVolume() < Constant::MAXREAL;
+    Vector3D min, max;
+    if (periodic) {
+      if (!myTopo->isOrthogonal()) allPairs = true;
+      myTopo->getBoundaryConditionsBox(min, max);
+    } else
+      myPositions->boundingbox(min, max);
+
+    for (int d = 0; d < 3 && !allPairs; d++) {
+      dim[d] = std::max(1, std::min((int)MAX_CELLS,
+                                    (int)floor((max.c[d] - min.c[d]) / cutoff)));
+      if (periodic && dim[d] < 3) allPairs = true;
+    }
+
+    if (allPairs) {
+      for (unsigned int i = 0; i < atoms_size; i += PAIR_ROWS) {
+        Item item = {ALL_PAIRS, i, std::min(i + (unsigned int)PAIR_ROWS, atoms_size)};
+        items.push_back(item);
+      }
+      report << debug(2) << "[HessianProduct::prepare] All " << atoms_size
+             << " atom pairs." << endr;
+      return;
+    }
+
+    //Link the atoms into their cells
+    head.assign(dim[0] * dim[1] * dim[2], -1);
+    next.resize(atoms_size);
+    for (unsigned int i = 0; i < atoms_size; i++) {
+      const Vector3D p = periodic ? myTopo->minimalPosition((*myPositions)[i])
+        : Vector3D((*myPositions)[i]);
+
+      int c[3];
+      for (int d = 0; d < 3; d++) {
+        const Real width = max.c[d] - min.c[d];
+        c[d] = width > 0.0 ? (int)floor((p.c[d] - min.c[d]) / width * dim[d]) : 0;
+        c[d] = std::max(0, std::min(dim[d] - 1, c[d]));
+      }
+      const int cell = (c[0] * dim[1] + c[1]) * dim[2] + c[2];
+      next[i] = head[cell];
+      head[cell] = i;
+    }
+
+    //One item per column of cells
+    const unsigned int columns = dim[0] * dim[1], rows = dim[2];
+    for (unsigned int column = 0; column < columns; column++) {
+      Item item = {PAIR_CELLS, column * rows, (column + 1) * rows};
+      items.push_back(item);
+    }
+    report << debug(2) << "[HessianProduct::prepare] " << dim[0] << "x"
+           << dim[1] << "x" << dim[2] << " cells of " << cutoff << "." << endr;
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // Products
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  void HessianProduct::product(const Vector3DBlock &v, Vector3DBlock &y) {
+    if (y.size() != v.size()) Vector3DBlock(v.size()).swap(y);
+    product(v.c, y.c, 1);
+  }
+
+  void HessianProduct::product(const double *V, double *Y, const int cols) {
+    evaluateItems(V, Y, cols);
+  }
+
+  //The blocks are the 3 columns of Y, without V only those of i == j are
+  //summed
+  void HessianProduct::diagonalBlocks(double *blocks) {
+    evaluateItems(0, blocks, 3);
+  }
+
+  void HessianProduct::evaluateItems(const double *V, double *Y,
+                                     const int cols) {
+    if (myTopo == 0)
+      report << error << "[HessianProduct::evaluateItems] prepare() not called."
+             << endr;
+
+    workV = V;
+    workY = Y;
+    workCols = cols;
+    workNext = 0;
+    fill(Y, Y + sz * cols, 0.0);
+
+#ifdef _WIN32
+    //serial, the calling thread sums all items into Y
+    worker(0);
+#else
+    //the calling thread is worker 0 and sums into Y, if a thread fails to
+    //start the others take its share
+    const int threads = std::max(1, std::min(numThreads, (int)items.size()));
+    partial.resize(threads - 1);
+    vector<pthread_t> thread(threads - 1);
+    vector<WorkerArg> arg(threads - 1);
+    unsigned int started = 0;
+    for (; started < thread.size(); started++) {
+      arg[started].self = this;
+      arg[started].id = started + 1;
+      if (pthread_create(&thread[started], 0, callWorker, &arg[started]) != 0)
+        break;
+    }
+    worker(0);
+    for (unsigned int t = 0; t < started; t++) {
+      pthread_join(thread[t], 0);
+      const vector<double> &p = partial[t];
+      for (unsigned int k = 0; k < sz * cols; k++) Y[k] += p[k];
+    }
+#endif
+  }
+
+#ifndef _WIN32
+  void *HessianProduct::callWorker(void *param) {
+    WorkerArg *arg = (WorkerArg *)param;
+    arg->self->worker(arg->id);
+    return 0;
+  }
+#endif
+
+  void HessianProduct::worker(int id) {
+    double *Y = workY;
+    if (id > 0) {
+      partial[id - 1].assign(sz * workCols, 0.0);
+      Y = &partial[id - 1][0];
+    }
+
+    while (true) {
+#ifndef _WIN32
+      pthread_mutex_lock(&workMutex);
+#endif
+      const unsigned int item = workNext++;
+#ifndef _WIN32
+      pthread_mutex_unlock(&workMutex);
+#endif
+      if (item >= items.size()) break;
+
+      evaluateItem(items[item], Y);
+    }
+  }
+
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // Terms, the blocks of Hessian::evaluate applied to V
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  void HessianProduct::evaluateItem(const Item &item, double *Y) {
+    const Vector3DBlock &pos = *myPositions;
+
+    switch (item.term) {
+    case IMPROPERS:
+    case DIHEDRALS:
+      for (unsigned int i = item.begin; i < item.end; i++) {
+        const Torsion &t = item.term == IMPROPERS ? myTopo->impropers[i]
+          : myTopo->dihedrals[i];
+        bool nonZForce = false;       //test for force constants
+        for (int j = 0; j < t.multiplicity; j++)
+          if (t.forceConstant[j]) nonZForce = true;
+        if (!nonZForce) continue;
+
+        const int aout[4] = {t.atom1, t.atom2, t.atom3, t.atom4};
+        HessDihedral hd;
+        hd.evaluate(t, pos[aout[0]], pos[aout[1]], pos[aout[2]], pos[aout[3]]);
+        for (int ii = 0; ii < 4; ii++)
+          for (int kk = 0; kk < 4; kk++)
+            applyBlock(hd(ii, kk), weight[aout[ii]] * weight[aout[kk]],
+                       aout[ii], aout[kk], Y);
+      }
+      break;
+
+    case RBDIHEDRALS:
+      for (unsigned int i = item.begin; i < item.end; i++) {
+        const RBTorsion &rbt = myTopo->rb_dihedrals[i];
+        if (!(rbt.C0 || rbt.C1 || rbt.C2 || rbt.C3 || rbt.C4 || rbt.C5))
+          continue;
+
+        const int aout[4] = {rbt.atom1, rbt.atom2, rbt.atom3, rbt.atom4};
+        HessDihedral hd;
+        hd.evaluate(rbt, pos[aout[0]], pos[aout[1]], pos[aout[2]], pos[aout[3]]);
+        for (int ii = 0; ii < 4; ii++)
+          for (int kk = 0; kk < 4; kk++)
+            applyBlock(hd(ii, kk), weight[aout[ii]] * weight[aout[kk]],
+                       aout[ii], aout[kk], Y);
+      }
+      break;
+
+    case BONDS:
+      for (unsigned int i = item.begin; i < item.end; i++) {
+        const Bond &b = myTopo->bonds[i];
+        const unsigned int a1 = b.atom1, a2 = b.atom2;
+        const Matrix3By3 bondHess12 =
+          reducedHessBond(pos[a1], pos[a2], b.springConstant, b.restLength);
+        const Real w1 = weight[a1], w2 = weight[a2];
+        applyBlock(bondHess12, w1 * w1, a1, a1, Y);
+        applyBlock(bondHess12, w2 * w2, a2, a2, Y);
+        applyBlock(bondHess12, -w1 * w2, a1, a2, Y);
+        applyBlock(bondHess12, -w1 * w2, a2, a1, Y);
+      }
+      break;
+
+    case ANGLES:
+      for (unsigned int i = item.begin; i < item.end; i++) {
+        const Angle &a = myTopo->angles[i];
+        const int aout[3] = {a.atom1, a.atom2, a.atom3};
+        ReducedHessAngle rh;
+        rh.evaluate(pos[aout[0]], pos[aout[1]], pos[aout[2]], a.forceConstant,
+                    a.restAngle);
+        //ureyBradley, the same Hessian as a bond
+        if (a.ureyBradleyConstant) {
+          Matrix3By3 ubm =
+            reducedHessBond(pos[aout[0]], pos[aout[2]], a.ureyBradleyConstant,
+                            a.ureyBradleyRestLength);
+          rh.accumulateTo(0, 0, ubm);
+          rh.accumulateTo(2, 2, ubm);
+          rh.accumulateNegTo(2, 0, ubm);
+          rh.accumulateNegTo(0, 2, ubm);
+        }
+        for (int ii = 0; ii < 3; ii++)
+          for (int kk = 0; kk < 3; kk++)
+            applyBlock(rh(ii, kk), weight[aout[ii]] * weight[aout[kk]],
+                       aout[ii], aout[kk], Y);
+      }
+      break;
+
+    case PAIR_CELLS:
+      //Each pair is found from both cells, take it from the lower index
+      for (unsigned int cell = item.begin; cell < item.end; cell++) {
+        if (head[cell] < 0) continue;
+        const int n = cell;
+        const int c[3] = {n / (dim[1] * dim[2]), (n / dim[2]) % dim[1],
+                          n % dim[2]};
+
+        for (int nx = c[0] - 1; nx <= c[0] + 1; nx++)
+          for (int ny = c[1] - 1; ny <= c[1] + 1; ny++)
+            for (int nz = c[2] - 1; nz <= c[2] + 1; nz++) {
+              int k[3] = {nx, ny, nz};
+              bool inside = true;
+              for (int d = 0; d < 3; d++) {
+                if (periodic) k[d] = (k[d] + dim[d]) % dim[d];
+                else if (k[d] < 0 || k[d] >= dim[d]) inside = false;
+              }
+              if (!inside) continue;
+
+              const int neighbor = (k[0] * dim[1] + k[1]) * dim[2] + k[2];
+              for (int i = head[cell]; i >= 0; i = next[i])
+                for (int j = head[neighbor]; j >= 0; j = next[j])
+                  if (i < j) evaluatePair(i, j, Y);
+            }
+      }
+      break;
+
+    case ALL_PAIRS:
+      for (unsigned int i = item.begin; i < item.end; i++)
+        for (unsigned int j = i + 1; j < weight.size(); j++)
+          evaluatePair(i, j, Y);
+      break;
+    }
+  }
+
+  void HessianProduct::evaluatePair(unsigned int i, unsigned int j, double *Y) {
+    if (!allPairs &&
+        myTopo->minimalDifference((*myPositions)[i],
+                                  (*myPositions)[j]).normSquared() > pairCutoff2)
+      return;
+
+    Matrix3By3 rhp(0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0);
+    //Lennard jones
+    if (myLennardJones)
+      rhp += evaluatePairsMatrix(i, j, LENNARDJONES, myPositions, myTopo, true);
+    //Coulombic
+    if (myCoulomb)
+      rhp += evaluatePairsMatrix(i, j, COULOMB, myPositions, myTopo, true);
+    //Coulombic Implicit solvent
+    if (myCoulombDielec)
+      rhp += evaluatePairsMatrix(i, j, COULOMBDIELEC, myPositions, myTopo, true);
+    //SCP
+    if (myCoulombSCPISM)
+      rhp += evaluatePairsMatrix(i, j, COULOMBSCPISM, myPositions, myTopo, true);
+    //Bourn radii
+    if (myBornRadii && myBornSelf && myTopo->doSCPISM)
+      rhp += evaluateBornSelfPair(i, j, myPositions, myTopo);
+    //GB
+    if (myGBBornRadii && myGBACEForce && myTopo->doGBSAOpenMM)
+      rhp += evaluateGBACEPair(i, j, myPositions, myTopo);
+    if (myGBBornRadii && myGBForce && myTopo->doGBSAOpenMM)
+      rhp += evaluateGBPair(i, j, myPositions, myTopo);
+
+    const Real wi = weight[i], wj = weight[j];
+    applyBlock(rhp, wi * wi, i, i, Y);
+    applyBlock(rhp, wj * wj, j, j, Y);
+    applyBlock(rhp, -wi * wj, i, j, Y);
+    applyBlock(rhp, -wi * wj, j, i, Y);
+  }
+
+  //Rows of atom i of Y += s rha times rows of atom j of V, without V the
+  //diagonal block of atom i += s rha
+  void HessianProduct::applyBlock(const Matrix3By3 &rha, Real s,
+                                  unsigned int i, unsigned int j,
+                                  double *Y) const {
+    if (workV == 0) {
+      if (i != j) return;
+      double *b = Y + 9 * i;
+      for (int ll = 0; ll < 3; ll++)
+        for (int mm = 0; mm < 3; mm++)
+          b[3 * ll + mm] += s * rha(ll, mm);
+      return;
+    }
+
+    Real m[3][3];
+    for (int ll = 0; ll < 3; ll++)
+      for (int mm = 0; mm < 3; mm++)
+        m[ll][mm] = s * rha(ll, mm);
+
+    const double *v = workV + 3 * j;
+    double *y = Y + 3 * i;
+    for (int c = 0; c < workCols; c++, v += sz, y += sz) {
+      y[0] += m[0][0] * v[0] + m[0][1] * v[1] + m[0][2] * v[2];
+      y[1] += m[1][0] * v[0] + m[1][1] * v[1] + m[1][2] * v[2];
+      y[2] += m[2][0] * v[0] + m[2][1] * v[1] + m[2][2] * v[2];
+    }
+  }
+
+}
@@ -0,0 +1,116 @@
+/* -*- c++ -*- */
+#ifndef HESSIANPRODUCT_H
+#define HESSIANPRODUCT_H
+
+#include <protomol/integrator/hessian/Hessian.h>
+#include <protomol/topology/GenericTopology.h>
+
+#include <vector>
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+namespace ProtoMol {
+  /**
+   *
+   * Products Y = H V with the Hessian, or mass re-weighted Hessian, of the
+   * current force field without storing it. The 3x3 blocks of the bonded
+   * terms and of the atom pairs are those of Hessian::evaluate(); each is
+   * applied to all columns of V when it is evaluated and then dropped, so
+   * memory is O(N) plus the vectors.
+   *
+   * The atom pairs are found from a linked-cell grid of the largest
+   * cutoff. Forces without a cutoff, GB, and skewed or small periodic
+   * boxes fall back to all pairs. The terms are shared out over a team of
+   * threads, each summing into its own copy of Y. Without pthreads
+   * (Windows) the calling thread sums all terms.
+   *
+   * Call findForces() once and prepare() for each set of positions, then
+   * product() or diagonalBlocks() as often as needed.
+   *
+   */
+  class HessianProduct : public Hessian {
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // Types and Enums
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  enum {BONDED_CHUNK = 256};
+  enum {PAIR_ROWS = 16};
+  enum {MAX_CELLS = 64};
+  enum Term {IMPROPERS, DIHEDRALS, RBDIHEDRALS, BONDS, ANGLES, PAIR_CELLS,
+             ALL_PAIRS};
+
+    // A range of terms of one kind, or of cells or rows for the pairs
+    struct Item {
+      Term term;
+      unsigned int begin, end;
+    };
+
+    struct WorkerArg {
+      HessianProduct *self;
+      int id;
+    };
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // Constructors, destructors, assignment
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    /// threads 0 for one per online processor
+    HessianProduct(int threads = 0);
+    ~HessianProduct();
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // New methods of class HessianProduct
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    /// Sets the positions of the following products, evaluates the Born
+    /// radii and GB sums and bins the atoms
+    void prepare(const Vector3DBlock *myPositions, GenericTopology *myTopo,
+                 const bool mrw);
+
+    /// Y = H V, V and Y column major with 3N rows and cols columns
+    void product(const double *V, double *Y, const int cols);
+    /// y = H v
+    void product(const Vector3DBlock &v, Vector3DBlock &y);
+    /// The 3x3 blocks of H on the diagonal, 9 per atom, row major
+    void diagonalBlocks(double *blocks);
+
+  private:
+    void evaluateItems(const double *V, double *Y, const int cols);
+#ifndef _WIN32
+    static void *callWorker(void *param);
+#endif
+    void worker(int id);
+    void evaluateItem(const Item &item, double *Y);
+    void evaluatePair(unsigned int i, unsigned int j, double *Y);
+    void applyBlock(const Matrix3By3 &rha, Real s, unsigned int i,
+                    unsigned int j, double *Y) const;
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // private data members
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  private:
+    int numThreads;
+    const Vector3DBlock *myPositions;
+    GenericTopology *myTopo;
+    std::vector<Real> weight;   // 1/sqrt(m), or 1 without mass weighting
+
+    // Pair search, cells of the grid and the atoms linked into them
+    bool allPairs, periodic;
+    Real pairCutoff2;
+    int dim[3];
+    std::vector<int> head, next;
+
+    // Work of one product, taken in order under workMutex
+    std::vector<Item> items;
+    std::vector<std::vector<double> > partial;
+#ifndef _WIN32
+    pthread_mutex_t workMutex;
+#endif
+    unsigned int workNext;
+    const double *workV;
+    double *workY;
+    int workCols;
+  };
+}
+#endif /* HESSIANPRODUCT_H */
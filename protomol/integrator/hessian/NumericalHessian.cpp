@@ -0,0 +1,112 @@
+#include <protomol/integrator/hessian/NumericalHessian.h>
+#include <protomol/integrator/StandardIntegrator.h>
+#include <protomol/topology/GenericTopology.h>
+#include <protomol/parallel/Parallel.h>
+#include <protomol/base/Exception.h>
+#include <protomol/base/Report.h>
+#include <protomol/ProtoMolApp.h>
+
+#include <math.h>
+
+using namespace std;
+using namespace ProtoMol::Report;
+using namespace ProtoMol;
+
+//____ Stencils, displacements in epsilon and weights of the forces
+static const int stencilSize[] = {0, 1, 2, 0, 4};
+static const Real stencilShift[][4] = {
+  {0, 0, 0, 0}, {1, 0, 0, 0}, {1, -1, 0, 0}, {0, 0, 0, 0}, {2, 1, -1, -2}
+};
+static const Real stencilWeight[][4] = {
+  {0, 0, 0, 0}, {-1.0, 0, 0, 0}, {-0.5, 0.5, 0, 0}, {0, 0, 0, 0},
+  {1.0 / 12.0, -8.0 / 12.0, 8.0 / 12.0, -1.0 / 12.0}
+};
+
+//____ NumericalHessian
+
+NumericalHessian::NumericalHessian() : intg(NULL), app(NULL) {}
+
+void NumericalHessian::initialize(StandardIntegrator *intg,
+                                  ProtoMolApp *app) {
+  this->intg = intg;
+  this->app = app;
+}
+
+void NumericalHessian::evaluate(Hessian *hessian, Real epsilon, int order,
+                                bool massWeight) {
+  if (order != 1 && order != 2 && order != 4)
+    THROW("[NumericalHessian::evaluate] order must be 1, 2 or 4.");
+
+  const unsigned int n = app->positions.size();
+  const unsigned int sz = 3 * n;
+
+  // Columns of this node, the nodes forget about each other while
+  // evaluating them
+  const unsigned int nodes = Parallel::isParallel() ? Parallel::getNum() : 1;
+  const unsigned int id = Parallel::isParallel() ? Parallel::getId() : 0;
+
+  // Each force evaluation increments the time
+  const Real actTime = app->topology->time;
+  myForces = *intg->getForces();
+  myEnergies = app->energies;
+  if (myColumn.size() != n) Vector3DBlock(n).swap(myColumn);
+  if (myRound.size() != nodes * n) Vector3DBlock(nodes * n).swap(myRound);
+
+  Parallel::isolateNode();
+  if (order == 1) {
+    intg->calculateForces();
+    myInitialForces = *intg->getForces();
+  }
+
+  hessian->clear();
+  for (unsigned int round = 0; round < sz; round += nodes) {
+    if (round + id < sz)
+      evaluateColumn(round + id, epsilon, order);
+    else
+      myColumn.zero();
+
+    if (nodes > 1) {
+      Parallel::integrateNode();
+      Parallel::allgather(myColumn.c, sz, myRound.c);
+      Parallel::isolateNode();
+    } else
+      myRound = myColumn;
+
+    for (unsigned int k = 0; k < nodes && round + k < sz; k++) {
+      const unsigned int i = round + k;
+      for (unsigned int j = 0; j < sz; j++)
+        myColumn.c[j] = myRound.c[k * sz + j];
+      if (massWeight) {
+        const Real w = 1.0 / sqrt(app->topology->atoms[i / 3].scaledMass);
+        myColumn.intoWeighted(w, myColumn);
+      }
+
+      hessian->setHessianColumn(myColumn, i, app->topology, massWeight);
+    }
+  }
+  Parallel::integrateNode();
+
+  *intg->getForces() = myForces;
+  app->energies = myEnergies;
+  app->topology->time = actTime;
+}
+
+void NumericalHessian::evaluateColumn(unsigned int i, Real epsilon,
+                                      int order) {
+  Vector3DBlock &positions = app->positions;
+  const Real x = positions[i / 3][i % 3];
+
+  if (order == 1)
+    myColumn.intoWeighted(1.0 / epsilon, myInitialForces);
+  else
+    myColumn.zero();
+
+  for (int k = 0; k < stencilSize[order]; k++) {
+    positions[i / 3][i % 3] = x + stencilShift[order][k] * epsilon;
+    intg->calculateForces();
+    myColumn.intoWeightedAdd(stencilWeight[order][k] / epsilon,
+                             *intg->getForces());
+  }
+
+  positions[i / 3][i % 3] = x;
+}
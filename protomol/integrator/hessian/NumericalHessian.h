@@ -0,0 +1,62 @@
+/* -*- c++ -*- */
+#ifndef NUMERICALHESSIAN_H
+#define NUMERICALHESSIAN_H
+
+#include <protomol/integrator/hessian/Hessian.h>
+#include <protomol/type/Vector3DBlock.h>
+#include <protomol/type/ScalarStructure.h>
+
+namespace ProtoMol {
+  class StandardIntegrator;
+  class ProtoMolApp;
+
+  /**
+   *
+   * Hessian by finite differences of the forces of an integrator, the
+   * fallback for force fields without analytic Hessian terms. Column i is
+   * -dF/dx_i.
+   *
+   * The columns are distributed round robin over the nodes. Each node
+   * evaluates its columns alone, displacing its own positions in place.
+   * After each round of one column per node the columns are gathered on
+   * all nodes and stored in order with Hessian::setHessianColumn().
+   *
+   */
+  class NumericalHessian {
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // Constructors, destructors, assignment
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    NumericalHessian();
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // New methods of class NumericalHessian
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    void initialize(StandardIntegrator *intg, ProtoMolApp *app);
+
+    /**
+     * Clears the Hessian and sets all columns. order 1 is the forward
+     * difference with one force evaluation per column, 2 the central and
+     * 4 the five point stencil with two and four evaluations. The forces
+     * and energies of the integrator and the time are restored afterwards.
+     */
+    void evaluate(Hessian *hessian, Real epsilon, int order,
+                  bool massWeight);
+
+  private:
+    void evaluateColumn(unsigned int i, Real epsilon, int order);
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // private data members
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  private:
+    StandardIntegrator *intg;
+    ProtoMolApp *app;
+
+    // Buffers kept between evaluations
+    Vector3DBlock myForces, myInitialForces, myColumn, myRound;
+    ScalarStructure myEnergies;
+  };
+}
+#endif /* NUMERICALHESSIAN_H */
@@ -62,7 +62,7 @@ long LeapfrogDataAcquisition::run(const long numTimesteps) {
     writeDCD();
   }
 
-  doHalfKick();
+  doLastHalfKick();
   postStepModify();
 
   return numTimesteps;
@@ -51,6 +51,7 @@ void LeapfrogIntegrator::doHalfKickdoDrift() {
 
     buildMolecularCenterOfMass(&app->positions, app->topology);
     buildMolecularMomentum(&app->velocities, app->topology);
+    app->outputCache.invalidateObservables();
     postDriftOrNextModify();
   }
 }
@@ -82,6 +83,7 @@ void LeapfrogIntegrator::doKickdoDrift() {
 
     buildMolecularCenterOfMass(&app->positions, app->topology);
     buildMolecularMomentum(&app->velocities, app->topology);
+    app->outputCache.invalidateObservables();
     postDriftOrNextModify();
   }
 }
@@ -97,7 +99,7 @@ long LeapfrogIntegrator::run(const long numTimesteps) {
     calculateForces();
   }
 
-  doHalfKick();
+  doLastHalfKick();
   postStepModify();
   
   return numTimesteps;
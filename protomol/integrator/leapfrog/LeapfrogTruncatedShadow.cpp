@@ -458,10 +458,11 @@ calcPairInteractionHess(Real doSwitch, Real switchon, Real cutoff, Real order,
   ExclusionClass ec;
 
   accum = 0.0;
-  for (unsigned int i = 0; i < app->topology->atoms.size(); i++)
+  for (unsigned int i = 0; i < app->topology->atoms.size(); i++) {
+    ExclusionRow row = app->topology->exclusions.getRow(i, i + 1);
     for (unsigned int j = i + 1; j < app->topology->atoms.size(); j++) {
       //if not bonded/dihedral
-      ec = app->topology->exclusions.check(i, j);
+      ec = row.next(j);
       if (ec != EXCLUSION_FULL) {
         Vector3D rij =
           app->topology->minimalDifference(app->positions[i],
@@ -612,6 +613,7 @@ calcPairInteractionHess(Real doSwitch, Real switchon, Real cutoff, Real order,
         accum += v[1].dot(-sm);
       }
     }
+  }
 
   return accum;
 }
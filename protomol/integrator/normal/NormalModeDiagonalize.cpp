@@ -40,14 +40,15 @@ namespace ProtoMol
     memory_eigenvector(0), checkpointUpdate(false), origCEigVal(0),
     origTimestep(0), autoParmeters(false), adaptiveTimestep(0),
     postDiagonalizeMinimize(0), minLim(0), maxMinSteps(0), 
-    geometricfdof(false), numerichessians(false) {
+    geometricfdof(false), numerichessians(false), rediagIterations(0),
+    rediagTolerance(0), blockThreads(0) {
   }
 
   NormalModeDiagonalize::
   NormalModeDiagonalize(int cycles, int redi, bool fDiag, bool rRand,
                         Real redhy, Real eTh, int bvc, int rpb, Real dTh, 
                         bool apar, bool adts, bool pdm, Real ml, int maxit,
-                        bool geo, bool num,
+                        bool geo, bool num, int rIt, Real rTol, int bth,
                         ForceGroup *overloadedForces,
                         StandardIntegrator *nextIntegrator ) :
     MTSIntegrator( cycles, overloadedForces, nextIntegrator ),
@@ -60,10 +61,13 @@ namespace ProtoMol
     residuesPerBlock( rpb ),  memory_Hessian(0), memory_eigenvector(0),
     checkpointUpdate( false ), origCEigVal(0), origTimestep(0),
     autoParmeters(apar), adaptiveTimestep( adts ), postDiagonalizeMinimize(pdm),
-    minLim(ml), maxMinSteps(maxit), geometricfdof(geo), numerichessians(num) {
+    minLim(ml), maxMinSteps(maxit), geometricfdof(geo), numerichessians(num),
+    rediagIterations(rIt), rediagTolerance(rTol), blockThreads(bth),
+    hsnProduct(bth) {
 
     //find forces and parameters
     rHsn.findForces( overloadedForces );
+    hsnProduct.findForces( overloadedForces );
 
   }
 
@@ -74,8 +78,11 @@ namespace ProtoMol
     if ( rediagCounter && hessianCounter ) {
       report << plain
       << "NML Timing: Hessian: " << ( blockDiag.hessianTime.getTime() ).getRealTime() << "[s] (" << hessianCounter << " times)"
-      << " diagonalize: " << ( blockDiag.rediagTime.getTime() ).getRealTime() << "[s] (" << rediagCounter << " re-diagonalizations)."
-      << endl;
+      << " diagonalize: " << ( blockDiag.rediagTime.getTime() ).getRealTime() << "[s] (" << rediagCounter << " re-diagonalizations";
+      if ( rediagIterations ) {
+        report << ", " << rediagUpdateCounter << " warm started";
+      }
+      report << ")." << endl;
 
       if ( !fullDiag ) {
         report << plain << "NML Memory: "
@@ -155,11 +162,17 @@ namespace ProtoMol
     //flag used eigs
     app->eigenInfo.myNumUsedEigenvectors = _rfM;
 
+    //warm start falls back to the full method
+    if ( rediagIterations && !fullDiag ) {
+      report << warning << "[NormalModeDiagonalize::initialize] reDiagIterations needs fullDiag, ignored." << endr;
+      rediagIterations = 0;
+    }
+
     //Initialize BlockHessianDiagonalize, pass BlockHessian if Blocks (not full diag)
     if ( fullDiag ) {
       blockDiag.initialize( _3N );
     } else {
-      blockDiag.initialize( &rHsn, _3N, (StandardIntegrator *)this );
+      blockDiag.initialize( &rHsn, _3N, (StandardIntegrator *)this, blockThreads );
     }
 
     //Diagnostics
@@ -199,6 +212,9 @@ namespace ProtoMol
       //Diagonalization if repetitive, first for forced
       if ( ( rediagCount && currentStepNum >= nextRediag ) || firstDiag || app->eigenInfo.reDiagonalize) {
 
+        //scheduled re-diagonalizations may start from the last vectors
+        const bool warmStart = rediagIterations && !firstDiag && !app->eigenInfo.reDiagonalize;
+
         nextRediag += rediagCount;
 
         newDiag = true;
@@ -229,7 +245,7 @@ namespace ProtoMol
             //I am the MASTER if I get here
             
             //do actual diagonalization
-            max_eig = doDiagonalization();
+            max_eig = doDiagonalization( warmStart );
 
             //set new max eigenvalue in C
             app->eigenInfo.myNewCEigval = fabs(blockDiag.eigVal[_rfM]); //safe as eigval set t length sz=_3N >= _rfM
@@ -251,7 +267,7 @@ namespace ProtoMol
         }else{
 #endif
           //do actual diagonalization
-          max_eig = doDiagonalization();
+          max_eig = doDiagonalization( warmStart );
           
           //set new max eigenvalue in C
           app->eigenInfo.myNewCEigval = fabs(blockDiag.eigVal[_rfM]); //safe as eigval set t length sz=_3N >= _rfM
@@ -261,6 +277,7 @@ namespace ProtoMol
         
         //flag update to eigenvectors
         *eigVecChangedP = true;
+        app->eigenInfo.mySingleEigsChanged = true;
 
         //set flags if firstDiag
         if ( firstDiag ) {
@@ -335,8 +352,16 @@ namespace ProtoMol
   }
 
   //actual diagonalization code
-  Real NormalModeDiagonalize::doDiagonalization(){
+  Real NormalModeDiagonalize::doDiagonalization( bool warmStart ){
     
+    //Warm start from the last vectors, full diagonalization if not converged
+    if ( warmStart ) {
+      Real max_eig;
+      if ( warmStartDiagonalization( max_eig ) ) {
+        return max_eig;
+      }
+    }
+
     //Diagonalize
     if ( fullDiag ) {
       //****Full method**********************************************************************//
@@ -411,6 +436,7 @@ namespace ProtoMol
       
       //flag update to eigenvectors
       *eigVecChangedP = true;
+      app->eigenInfo.mySingleEigsChanged = true;
             
       report << debug(2) << "Coarse diagonalization complete. Maximum eigenvalue = " << max_eigenvalue << "." << endr;
       
@@ -422,6 +448,62 @@ namespace ProtoMol
   
   //********************************************************************************************************************************************
 
+  //*************************************************************************************
+  //****Warm started re-diagonalization**************************************************
+  //*************************************************************************************
+
+  //Products with the mass weighted Hessian, not stored
+  class WarmStartProduct : public BlockHessianDiagonalize::Product {
+  public:
+    WarmStartProduct( HessianProduct &hessian ) : hessian( hessian ) {}
+
+    virtual void product( double *V, double *Y, int cols ){
+      hessian.product( V, Y, cols );
+    }
+
+  private:
+    HessianProduct &hessian;
+  };
+
+  //Block Davidson from the last vectors, for the full method, see
+  //BlockHessianDiagonalize::warmStart()
+  bool NormalModeDiagonalize::warmStartDiagonalization( Real &max_eig ){
+
+    //Ritz vectors, the modes and some guard vectors if stored
+    const int p = std::min( _rfM + RITZ_GUARD, ( int )app->eigenInfo.myNumEigenvectors );
+    const int modes = std::min( _rfM, p );
+
+    blockDiag.hessianTime.start(); //time Hessian
+    hsnProduct.prepare( &app->positions, app->topology, true ); //mass re-weighted hessian
+
+    //atom blocks of the preconditioner
+    atomBlocks.resize( 9 * _N );
+    hsnProduct.diagonalBlocks( &atomBlocks[0] );
+    blockDiag.hessianTime.stop();
+    hessianCounter++;
+
+    blockDiag.rediagTime.start();
+    WarmStartProduct product( hsnProduct );
+    Real residual;
+    const bool converged = blockDiag.warmStart( product, &atomBlocks[0], *Q, _3N, p, modes,
+                                                rediagIterations, rediagTolerance, residual );
+    blockDiag.rediagTime.stop();
+
+    if ( !converged ) {
+      report << debug(1) << "[NormalModeDiagonalize::run] Warm start residual " << residual
+             << " above " << rediagTolerance << ", full re-diagonalization." << endr;
+      return false;
+    }
+
+    //the vectors past p are those of the last full diagonalization, no
+    //longer orthogonal to the new ones, so they are cleared
+    std::fill( *Q + _3N * p, *Q + _3N * app->eigenInfo.myNumEigenvectors, 0.0 );
+    rediagCounter++; rediagUpdateCounter++;
+
+    max_eig = blockDiag.eigVal[p-1];
+    return true;
+  }
+
   //*************************************************************************************
   //****Output int paramiters************************************************************
   //*************************************************************************************
@@ -503,6 +585,21 @@ namespace ProtoMol
                                     Value(numerichessians, ConstraintValueType::NoConstraints()),
                                     false, Text("Calculate Hessians numerically.")));
 
+    parameters.push_back( Parameter( "reDiagIterations",
+                                    Value( rediagIterations, ConstraintValueType::NotNegative() ),
+                                    0,
+                                    Text( "Warm started iterations before a full re-diagonalization, 0 for none (fullDiag only)." ) ) );
+
+    parameters.push_back( Parameter( "reDiagTolerance",
+                                    Value( rediagTolerance, ConstraintValueType::NotNegative() ),
+                                    0.1,
+                                    Text( "Rayleigh quotient residual of the modes accepted from warm start." ) ) );
+
+    parameters.push_back( Parameter( "blockThreads",
+                                    Value( blockThreads, ConstraintValueType::NotNegative() ),
+                                    0,
+                                    Text( "Threads of the coarse block diagonalization and warm start products, 0 for one per processor." ) ) );
+
 
     
       }
@@ -515,6 +612,7 @@ namespace ProtoMol
                                       values[6], values[7], values[8], 
                                       values[9], values[10], values[11],
                                       values[12], values[13],values[14], values[15], 
+                                      values[16], values[17], values[18],
                                       fg, nextIntegrator               );
   }
 
@@ -6,6 +6,7 @@
 #include <protomol/integrator/normal/NormalModeUtilities.h>
 #include <protomol/integrator/hessian/BlockHessian.h>
 #include <protomol/integrator/hessian/BlockHessianDiagonalize.h>
+#include <protomol/integrator/hessian/HessianProduct.h>
 
 #include <protomol/type/Vector3DBlock.h>
 #include <protomol/type/BlockMatrix.h>
@@ -29,6 +30,7 @@ namespace ProtoMol
       //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
       enum {MAX_ATOMS_PER_RES = 30};
       enum {REGRESSION_T = 0};
+      enum {RITZ_GUARD = 4};
 
       //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
       // Constructors, destructors, assignment
@@ -39,7 +41,8 @@ namespace ProtoMol
                              bool rRand,
                              Real redhy, Real eTh, int bvc, int rpb, Real dTh, 
                              bool apar, bool adts, bool pdm, Real ml, int maxit,
-                             bool geo, bool num, ForceGroup *overloadedForces,
+                             bool geo, bool num, int rIt, Real rTol, int bth,
+                             ForceGroup *overloadedForces,
                              StandardIntegrator *nextIntegrator );
       ~NormalModeDiagonalize();
 
@@ -57,7 +60,7 @@ namespace ProtoMol
       //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
     public:
       virtual std::string getIdNoAlias() const {return keyword;}
-      virtual unsigned int getParameterSize() const {return 16;}
+      virtual unsigned int getParameterSize() const {return 19;}
       virtual void getParameters( std::vector<Parameter>& parameters ) const;
 
       //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -85,7 +88,11 @@ namespace ProtoMol
       virtual void streamRead( std::istream& inStream );
       virtual void streamWrite( std::ostream& outStream ) const;
     private:
-      Real doDiagonalization();
+      Real doDiagonalization(bool warmStart);
+
+      /// Block Davidson iterations from the last vectors, false if the
+      /// residual of the modes stays above rediagTolerance
+      bool warmStartDiagonalization(Real &max_eig);
 
       //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
       // My data members
@@ -132,6 +139,19 @@ namespace ProtoMol
       //numerical and geometric Hessian
       bool geometricfdof, numerichessians;
 
+      //warm started re-diagonalization and the atom blocks of its
+      //preconditioner
+      int rediagIterations;
+      Real rediagTolerance;
+      std::vector<double> atomBlocks;
+
+      //threads of the coarse block diagonalization and of the warm start
+      //products
+      int blockThreads;
+
+      //Hessian products of the warm start
+      HessianProduct hsnProduct;
+
   };
 }
 
@@ -2,18 +2,88 @@
 #include <protomol/topology/TopologyUtilities.h>
 #include <protomol/type/ScalarStructure.h>
 
+#include <protomol/module/NormalModeModule.h>
+
 #include <protomol/base/Lapack.h>
 
+#include <algorithm>
+
 using namespace ProtoMol::Report;
 
 namespace ProtoMol {
 
+  //____ Blocked projection kernels, Q is m x n column major with leading
+  //____ dimension m, the k vectors of X and columns of C are stored one
+  //____ after the other. A block of rows of X stays in cache while the
+  //____ block of all n eigenvectors streams past it.
+  enum {PROJECTION_BLOCK = 256, PROJECTION_LANES = 8};
+
+  //C = Q^TX
+  template<class T>
+  static void modeSpaceBlocked(const T *Q, int m, int n, const double *X, int k, double *C){
+    for( int i = 0;i < n * k;i++ ) C[i] = 0.0;
+
+    for( int r0 = 0;r0 < m;r0 += PROJECTION_BLOCK ){
+      const int rows = std::min( (int)PROJECTION_BLOCK, m - r0 );
+      for( int j = 0;j < n;j++ ){
+        const T *q = Q + j * m + r0;
+        for( int v = 0;v < k;v++ ){
+          const double *x = X + v * m + r0;
+          //independent partial sums, the compiler vectorizes over the lanes
+          double lane[PROJECTION_LANES] = {0.0};
+          int r = 0;
+          for( ;r + PROJECTION_LANES <= rows;r += PROJECTION_LANES )
+            for( int l = 0;l < PROJECTION_LANES;l++ ) lane[l] += q[r + l] * x[r + l];
+          double sum = 0.0;
+          for( int l = 0;l < PROJECTION_LANES;l++ ) sum += lane[l];
+          for( ;r < rows;r++ ) sum += q[r] * x[r];
+          C[v * n + j] += sum;
+        }
+      }
+    }
+  }
+
+  //X = QC, or X = X - QC for the complement
+  template<class T>
+  static void cartSpaceBlocked(const T *Q, int m, int n, const double *C, int k, double *X, bool complement){
+    const double alpha = complement ? -1.0 : 1.0;
+
+    for( int r0 = 0;r0 < m;r0 += PROJECTION_BLOCK ){
+      const int rows = std::min( (int)PROJECTION_BLOCK, m - r0 );
+      if( !complement )
+        for( int v = 0;v < k;v++ )
+          for( int r = 0;r < rows;r++ ) X[v * m + r0 + r] = 0.0;
+
+      //four eigenvectors at a time, one load and store of X for four updates
+      int j = 0;
+      for( ;j + 4 <= n;j += 4 ){
+        const T *q0 = Q + j * m + r0, *q1 = q0 + m, *q2 = q1 + m, *q3 = q2 + m;
+        for( int v = 0;v < k;v++ ){
+          const double *c = C + v * n + j;
+          const double c0 = alpha * c[0], c1 = alpha * c[1], c2 = alpha * c[2], c3 = alpha * c[3];
+          double *x = X + v * m + r0;
+          for( int r = 0;r < rows;r++ ) x[r] += c0 * q0[r] + c1 * q1[r] + c2 * q2[r] + c3 * q3[r];
+        }
+      }
+      for( ;j < n;j++ ){
+        const T *q = Q + j * m + r0;
+        for( int v = 0;v < k;v++ ){
+          const double c = alpha * C[v * n + j];
+          double *x = X + v * m + r0;
+          for( int r = 0;r < rows;r++ ) x[r] += c * q[r];
+        }
+      }
+    }
+  }
+
   //constructors
-  NormalModeUtilities::NormalModeUtilities(): firstMode(1), numMode(-1), myGamma(-1), mySeed(-1), myTemp(-1)
+  NormalModeUtilities::NormalModeUtilities(): firstMode(1), numMode(-1), myGamma(-1), mySeed(-1), myTemp(-1),
+    eigInfoP(NULL), singleEigenvectors(false)
     {/*tmpFX=NULL;*/ tmpC=NULL; invSqrtMass=NULL; sqrtMass=NULL;}
 
     NormalModeUtilities::NormalModeUtilities( int firstmode, int nummode, Real gamma, int seed, Real temperature):
-        firstMode(firstmode), numMode(nummode), myGamma(gamma/ (1000 * Constant::INV_TIMEFACTOR)), mySeed(seed), myTemp(temperature)
+        firstMode(firstmode), numMode(nummode), myGamma(gamma/ (1000 * Constant::INV_TIMEFACTOR)), mySeed(seed), myTemp(temperature),
+        eigInfoP(NULL), singleEigenvectors(false)
   {
     /*tmpFX=NULL;*/ tmpC=NULL; invSqrtMass=NULL; sqrtMass=NULL;
   }
@@ -28,16 +98,14 @@ namespace ProtoMol {
   }
 
   void NormalModeUtilities::initialize(int sz, ProtoMolApp *app, Vector3DBlock * myForces, int nm_flags){
-	if( !Lapack::isEnabled() ){
-		THROW("Normal Mode integrators require Lapack libraries.");
-	}
-
     //Set up eigenvector pointers
     numEigvectsu = app->eigenInfo.myNumEigenvectors;
     eigVecChangedP = &app->eigenInfo.myEigVecChanged;
     eigValP = &app->eigenInfo.myMaxEigenvalue;
     Q = &app->eigenInfo.myEigenvectors;
     pMetropolisPE = &app->eigenInfo.metropolisPE;
+    eigInfoP = &app->eigenInfo;
+    singleEigenvectors = app->config[InputSingleEigenvectors::keyword];
 
     //find topology pointer
     GenericTopology *myTopo = app->topology;
@@ -104,6 +172,7 @@ namespace ProtoMol {
     eigVecChangedP = &eipt->myEigVecChanged;
     eigValP = &eipt->myMaxEigenvalue;
     Q = &eipt->myEigenvectors;
+    eigInfoP = eipt;
     //find next integrators
     for(Integrator* i = integrator->next();i != NULL;i = i->next()){
         nmint = dynamic_cast<NormalModeUtilities*>(i);
@@ -111,6 +180,7 @@ namespace ProtoMol {
         nmint->eigVecChangedP = &eipt->myEigVecChanged;
         nmint->eigValP = &eipt->myMaxEigenvalue;
         nmint->Q = &eipt->myEigenvectors;
+        nmint->eigInfoP = eipt;
         nmint->numEigvectsu = numEigvectsu;
     }
   }
@@ -129,18 +199,8 @@ namespace ProtoMol {
     //f'=M^{-1/2}*f
     for( int i=0; i < _3N; i++)
          iPforce->c[i] *= invSqrtMass[i/3];
-    //c=hQ^T*M^{-1/2}*f
-    char transA = 'T';							// Transpose Q, LAPACK checks only first character N/V
-    int m = _3N; int n = _rfM; int incxy = 1;	//sizes
-    double alpha = 1.0;	double beta = 0.0;		//multiplyers, see Blas docs.
-
-    Lapack::dgemv(&transA, &m, &n, &alpha, (*Q), &m, iPforce->c, &incxy, &beta, tmpC, &incxy);
-
-    //calculate f''=M^{-1/2}*f'-hQc using BLAS
-    char transB = 'N';
-    alpha = -1.0;	beta = 1.0;
-
-    Lapack::dgemv(&transB, &m, &n, &alpha, (*Q), &m, tmpC, &incxy, &beta, iPforce->c, &incxy);
+    //f''=M^{-1/2}*f'-hQhQ^TM^{-1/2}*f
+    modeProjection(iPforce->c, 1, 0, _rfM, true);
 
     //f'''=M^{1/2}*f''
     for( int i=0; i < _3N; i++)
@@ -161,18 +221,8 @@ namespace ProtoMol {
     //f'=M^{-1/2}*f
     for( int i=0; i < _3N; i++)
             iPforce->c[i] *= sqrtMass[i/3];
-    //c=hQ^T*M^{-1/2}*f
-    char transA = 'T';							// Transpose Q, LAPACK checks only first character N/V
-    int m = _3N; int n = _rfM; int incxy = 1;	//sizes
-    double alpha = 1.0;	double beta = 0.0;		//multiplyers, see Blas docs.
-
-    Lapack::dgemv(&transA, &m, &n, &alpha, (*Q), &m, iPforce->c, &incxy, &beta, tmpC, &incxy);
-
-    //calculate f''=M^{-1/2}*f'-hQc using BLAS
-    char transB = 'N';
-    alpha = -1.0;	beta = 1.0;
-
-    Lapack::dgemv(&transB, &m, &n, &alpha, (*Q), &m, tmpC, &incxy, &beta, iPforce->c, &incxy);
+    //f''=M^{-1/2}*f'-hQhQ^TM^{-1/2}*f
+    modeProjection(iPforce->c, 1, 0, _rfM, true);
 
     //f'''=M^{1/2}*f''
     for( int i=0; i < _3N; i++)
@@ -194,18 +244,8 @@ namespace ProtoMol {
     for( int i=0; i < _3N; i++) {
             iPforce->c[i] *= invSqrtMass[i/3];
     }
-    //c=Q^T*M^{-1/2}*f
-    char transA = 'T';							// Transpose, LAPACK checks only first character N/V
-    int m = _3N; int n = _rfM-(firstMode-1); int incxy = 1;	//sizes
-    double alpha = 1.0;	double beta = 0.0;
-
-    Lapack::dgemv(&transA, &m, &n, &alpha, &((*Q)[_3N*(firstMode-1)]), &m, iPforce->c, &incxy, &beta, tmpC, &incxy);
-
-    //f''=Qc
-    char transB = 'N'; /* LAPACK checks only first character N/V */
-    alpha = 1.0;	beta = 0.0;
-
-    Lapack::dgemv(&transB, &m, &n, &alpha, &((*Q)[_3N*(firstMode-1)]), &m, tmpC, &incxy, &beta, iPforce->c, &incxy);
+    //f''=QQ^T*M^{-1/2}*f
+    modeProjection(iPforce->c, 1, firstMode-1, _rfM-(firstMode-1), false);
 
     //f'''=M^{1/2}*f''
     for( int i=0; i < _3N; i++) {
@@ -227,18 +267,8 @@ namespace ProtoMol {
     //v'=M^{1/2}*v
     for( int i=0; i < _3N; i++)
             iPforce->c[i] *= sqrtMass[i/3];
-    //c=Q^T*M^{-1/2}*v
-    char transA = 'T';							//Transpose, LAPACK checks only first character N/V
-    int m = _3N; int n = _rfM-(firstMode-1); int incxy = 1;	//sizes
-    double alpha = 1.0;	double beta = 0.0;
-
-    Lapack::dgemv(&transA, &m, &n, &alpha, &((*Q)[_3N*(firstMode-1)]), &m, iPforce->c, &incxy, &beta, tmpC, &incxy);
-
-    //v''=Qc
-    char transB = 'N'; /* LAPACK checks only first character N/V */
-    alpha = 1.0;	beta = 0.0;
-
-    Lapack::dgemv(&transB, &m, &n, &alpha, &((*Q)[_3N*(firstMode-1)]), &m, tmpC, &incxy, &beta, iPforce->c, &incxy);
+    //v''=QQ^T*M^{1/2}*v
+    modeProjection(iPforce->c, 1, firstMode-1, _rfM-(firstMode-1), false);
 
     //v'''=M^{-1/2}*v''
     for( int i=0; i < _3N; i++)
@@ -250,6 +280,33 @@ namespace ProtoMol {
     return iPforce;
   }
 
+  //Project k vectors onto the modes from first, or onto their complement
+  void NormalModeUtilities::modeProjection(double *X, int k, int first, int numv, bool complement){
+    if( (int)projC.size() < numv * k ) projC.resize( numv * k );
+
+    if( singleEigenvectors ){
+      const float *sQ = eigInfoP->getFloatEigPointer();
+      if( sQ == NULL ) report << error << "No single precision eigenvectors for the projection." << endr;
+      modeSpaceBlocked( sQ + _3N * first, _3N, numv, X, k, &projC[0] );
+      cartSpaceBlocked( sQ + _3N * first, _3N, numv, &projC[0], k, X, complement );
+      return;
+    }
+
+    char transA = 'T'; char transB = 'N';	// LAPACK checks only first character N/V
+    int m = _3N; int n = numv; int nv = k; int incxy = 1;	//sizes
+    double alpha = 1.0;	double beta = 0.0;
+    double *dQ = &((*Q)[_3N*first]);
+
+    //c=Q^T*X
+    if( k == 1 ) Lapack::dgemv(&transA, &m, &n, &alpha, dQ, &m, X, &incxy, &beta, &projC[0], &incxy);
+    else Lapack::dgemm(&transA, &transB, &n, &nv, &m, &alpha, dQ, &m, X, &m, &beta, &projC[0], &n);
+
+    //X=Qc or X=X-Qc
+    if( complement ){ alpha = -1.0; beta = 1.0; }
+    if( k == 1 ) Lapack::dgemv(&transB, &m, &n, &alpha, dQ, &m, &projC[0], &incxy, &beta, X, &incxy);
+    else Lapack::dgemm(&transB, &transB, &m, &nv, &n, &alpha, dQ, &m, &projC[0], &n, &beta, X, &m);
+  }
+
   void NormalModeUtilities::subSpaceSift(Vector3DBlock *velocities, Vector3DBlock *forces){
     //sift current data into subspace
     subspaceVelocity(velocities, velocities);
@@ -365,18 +422,44 @@ namespace ProtoMol {
     Real langDriftZ1 = langDriftVal * ( tau1 - tau2 ) / sqrtTau2;
     Real langDriftZ2 = langDriftVal * sqrtVal1;
 
-    //generate 1st and 2nd set of random force variables and project into sub space
-    if(genCompNoise) genProjGaussC(&gaussRandCoord1, &tempV3DBlk, myTopo); //and comliment if required
-    else genProjGauss(&gaussRandCoord1, myTopo);
-    genProjGauss(&gaussRandCoord2, myTopo);
+    //generate 1st and 2nd set of random force variables and project into sub space.
+    //The velocities of the position change are in the same sub space as the projected
+    //randoms, project them in the same pass instead of projecting the position change.
+    const bool projectVelocities = !complimentForces;
+    const int k = projectVelocities ? 3 : 2;
+    projX.resize( k * _3N );
+    double *xRand1 = &projX[0], *xRand2 = xRand1 + _3N, *xVel = xRand2 + _3N;
+    for( int i = 0; i < _3N; i++ )
+        xRand1[i] = randomGaussianNumber(mySeed) * sqrtMass[i/3];
+    for( int i = 0; i < _3N; i++ )
+        xRand2[i] = randomGaussianNumber(mySeed) * sqrtMass[i/3];
+    if(genCompNoise) //and comliment if required
+        for( int i = 0; i < _3N; i++ ) tempV3DBlk.c[i] = xRand1[i];
+    //f'=M^{-1/2}*f, v'=M^{1/2}*v
+    for( int i = 0; i < _3N; i++ ){
+        xRand1[i] *= invSqrtMass[i/3];
+        xRand2[i] *= invSqrtMass[i/3];
+        if(projectVelocities) xVel[i] = myVelocities->c[i] * sqrtMass[i/3];
+    }
+    if(complimentForces) modeProjection(&projX[0], k, 0, _rfM, true);
+    else modeProjection(&projX[0], k, firstMode-1, _rfM-(firstMode-1), false);
+    for( int i = 0; i < _3N; i++ ){
+        const Real mass = myTopo->atoms[i/3].scaledMass;
+        gaussRandCoord1.c[i] = xRand1[i] * sqrtMass[i/3];
+        gaussRandCoord2.c[i] = xRand2[i] * sqrtMass[i/3] / mass;
+        if(genCompNoise) tempV3DBlk.c[i] = (tempV3DBlk.c[i] - gaussRandCoord1.c[i]) / mass;
+        gaussRandCoord1.c[i] /= mass;
+    }
     // Update positions and correct (semi-update) velocity
-    for( unsigned int i = 0; i < myPositions->size(); i++ ) {
-      posTemp[i] =(gaussRandCoord1[i]*langDriftZ1 +gaussRandCoord2[i]*langDriftZ2 +(*myVelocities)[i])*tau1;
+    const Real velocityDecay = exp(-myGamma*dt);
+    for( int i = 0; i < _3N; i++ ) {
+      const Real velocity = projectVelocities ? xVel[i] * invSqrtMass[i/3] : myVelocities->c[i];
+      posTemp.c[i] =(gaussRandCoord1.c[i]*langDriftZ1 +gaussRandCoord2.c[i]*langDriftZ2 +velocity)*tau1;
       // semi-update velocities
-      (*myVelocities)[i] = (*myVelocities)[i]*exp(-myGamma*dt)+gaussRandCoord1[i]*sqrtFCoverM*sqrtTau2;
+      myVelocities->c[i] = myVelocities->c[i]*velocityDecay+gaussRandCoord1.c[i]*sqrtFCoverM*sqrtTau2;
     }
     //Check position change is in the sub space and add to positions
-    subspaceVelocity(&posTemp, &posTemp);
+    if(!projectVelocities) subspaceVelocity(&posTemp, &posTemp);
     for( unsigned int i = 0; i < myPositions->size(); i++ )
             (*myPositions)[i]+=posTemp[i];
     //fix COM/momentum (not conserved)
@@ -9,6 +9,8 @@
 #include <protomol/type/EigenvectorInfo.h>
 #include <protomol/integrator/Integrator.h>
 
+#include <vector>
+
 namespace ProtoMol {
   class ScalarStructure;
     /**
@@ -67,6 +69,16 @@ namespace ProtoMol {
         void setIntegratorSetPointers(Integrator *integrator, EigenvectorInfo *eipt, bool eiValid);
         Vector3DBlock *cartSpaceProj(double *tmpC, Vector3DBlock * iPos, Vector3DBlock * ex0);
         double *modeSpaceProj(double *cPos, Vector3DBlock * iPos, Vector3DBlock * ex0);
+    protected:
+        /**
+         * Projects the k vectors of length 3N in X, stored one after the
+         * other, onto the numv eigenvectors from column first, X = QQ^TX,
+         * or onto their complement, X = X - QQ^TX. Q is streamed once for
+         * c = Q^TX and once for the update of X, for all k vectors. With
+         * singleEigenvectors the float copy of Q is used, the sums are in
+         * double.
+         */
+        void modeProjection(double *X, int k, int first, int numv, bool complement);
 
         //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
         // Friends of class NormalModeUtilities
@@ -106,11 +118,17 @@ namespace ProtoMol {
         bool newDiag;
         //previous integrator potential energy for metropolis
         Real *pMetropolisPE;
+        //eigenvectors of the chain, for the single precision copy
+        EigenvectorInfo *eigInfoP;
+        //project with the single precision eigenvectors
+        bool singleEigenvectors;
 
     protected:
         double *invSqrtMass, *sqrtMass;
         int numSteps;
         Vector3DBlock gaussRandCoord2, posTemp;
+        //blocks of vectors and their mode space coefficients
+        std::vector<double> projX, projC;
         Vector3DBlock *myForcesP;
         bool complimentForces;
 
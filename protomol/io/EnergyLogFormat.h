@@ -0,0 +1,23 @@
+/*  -*- c++ -*-  */
+#ifndef ENERGYLOGFORMAT_H
+#define ENERGYLOGFORMAT_H
+
+namespace ProtoMol {
+  //____EnergyLogFormat
+
+  /// Layout of the energy log of EnergyLogWriter and EnergyLogReader
+  namespace EnergyLogFormat {
+    const char LOG_MAGIC[8] = {'P', 'M', 'E', 'N', 'E', 'R', 'G', 'Y'};
+    const int LOG_VERSION = 1;
+    const int LOG_BYTE_ORDER = 0x01020304;
+    const int LOG_BLOCK_MAGIC = 0x4B4F4C42;
+    // Length of the column names written
+    const unsigned int LOG_NAME = 32;
+
+    // magic and six int32
+    const unsigned int LOG_HEADER = 32;
+    // magic, rows, first and last step
+    const unsigned int LOG_BLOCK_HEADER = 24;
+  }
+}
+#endif /* ENERGYLOGFORMAT_H */
@@ -0,0 +1,162 @@
+#include <protomol/io/EnergyLogReader.h>
+#include <protomol/io/EnergyLogFormat.h>
+
+#include <protomol/base/Report.h>
+#include <protomol/base/SystemUtilities.h>
+#include <protomol/base/Exception.h>
+
+#include <limits>
+
+#include <string.h>
+
+using namespace std;
+using namespace ProtoMol::Report;
+using namespace ProtoMol;
+using namespace ProtoMol::EnergyLogFormat;
+
+//____EnergyLogReader
+
+namespace {
+  template<typename T>
+  T get(const char *c, bool swap) {
+    T t;
+    memcpy(&t, c, sizeof(T));
+    if (swap) swapBytes(t);
+    return t;
+  }
+}
+
+EnergyLogReader::EnergyLogReader() :
+  Reader(ios::binary), myHeader(false), mySwap(false), myBlockRows(0),
+  myRows(0), myFirstStep(0), myLastStep(0) {}
+
+EnergyLogReader::EnergyLogReader(const string &filename) :
+  Reader(ios::binary, filename), myHeader(false), mySwap(false),
+  myBlockRows(0), myRows(0), myFirstStep(0), myLastStep(0) {}
+
+EnergyLogReader::~EnergyLogReader() {}
+
+bool EnergyLogReader::tryFormat() {
+  if (!open()) return false;
+
+  char head[LOG_HEADER];
+  File::read(head, LOG_HEADER);
+  const int32 order = get<int32>(head + 12, false);
+  const int32 swapped = get<int32>(head + 12, true);
+  const bool ok = !file.fail() && !memcmp(head, LOG_MAGIC, 8) &&
+    (order == LOG_BYTE_ORDER || swapped == LOG_BYTE_ORDER);
+  close();
+
+  return ok;
+}
+
+bool EnergyLogReader::read() {
+  return read(numeric_limits<long>::min(), numeric_limits<long>::max());
+}
+
+bool EnergyLogReader::readHeader() {
+  try {
+    doReadHeader();
+    return true;
+
+  } catch (const Exception &e) {
+    report << recoverable << e.getMessage() << endr;
+  }
+
+  return false;
+}
+
+bool EnergyLogReader::read(long first, long last) {
+  try {
+    if (!myHeader) doReadHeader();
+    return doRead(first, last);
+
+  } catch (const Exception &e) {
+    report << recoverable << e.getMessage() << endr;
+  }
+
+  return false;
+}
+
+void EnergyLogReader::doReadHeader() {
+  if (!is_open())
+    if (!open()) THROWS("Can not open energy log '" << getFilename() << "'");
+
+  char head[LOG_HEADER];
+  File::read(head, LOG_HEADER);
+  if (file.fail() || memcmp(head, LOG_MAGIC, 8))
+    THROWS("'" << getFilename() << "' is not an energy log");
+
+  mySwap = get<int32>(head + 12, false) != LOG_BYTE_ORDER;
+  if (get<int32>(head + 12, mySwap) != LOG_BYTE_ORDER)
+    THROWS("Invalid energy log byte order in '" << getFilename() << "'");
+
+  const int32 version = get<int32>(head + 8, mySwap);
+  if (version != LOG_VERSION)
+    THROWS("Unsupported energy log version " << version);
+
+  const int32 columns = get<int32>(head + 16, mySwap);
+  const int32 nameLength = get<int32>(head + 20, mySwap);
+  const int32 blockRows = get<int32>(head + 24, mySwap);
+  if (columns < 1 || nameLength < 1 || blockRows < 1)
+    THROWS("Invalid energy log header in '" << getFilename() << "'");
+  myBlockRows = blockRows;
+
+  vector<char> names(columns * nameLength + 1, 0);
+  File::read(&names[0], columns * nameLength);
+  if (file.fail()) THROWS("Truncated energy log column names");
+
+  myColumns.resize(columns);
+  for (int i = 0; i < columns; i++)
+    myColumns[i] = string(&names[i * nameLength],
+                          strnlen(&names[i * nameLength], nameLength));
+
+  myRows = 0;
+  myHeader = true;
+}
+
+bool EnergyLogReader::doRead(long first, long last) {
+  const unsigned int columns = myColumns.size();
+
+  while (file.peek() != char_traits<char>::eof()) {
+    char head[LOG_BLOCK_HEADER];
+    File::read(head, LOG_BLOCK_HEADER);
+    if (file.fail()) THROWS("Truncated energy log block header");
+
+    if (get<int32>(head, mySwap) != LOG_BLOCK_MAGIC)
+      THROWS("Invalid energy log block in '" << getFilename() << "'");
+
+    const int32 rows = get<int32>(head + 4, mySwap);
+    if (rows < 1 || (unsigned int)rows > myBlockRows)
+      THROWS("Invalid energy log block of " << rows << " rows");
+
+    const int64 firstStep = get<int64>(head + 8, mySwap);
+    const int64 lastStep = get<int64>(head + 16, mySwap);
+    const streamsize size = sizeof(double) * columns * rows;
+
+    // Steps increase along the log, blocks before the range are skipped
+    // without reading their values
+    if (firstStep > last) return false;
+    if (lastStep < first) {
+      file.seekg(size, ios::cur);
+      if (file.fail()) THROWS("Truncated energy log block");
+      continue;
+    }
+
+    myBlock.resize(columns * rows);
+    File::read(reinterpret_cast<char *>(&myBlock[0]), size);
+    if (file.fail())
+      THROWS("Truncated energy log block at step " << firstStep);
+
+    if (mySwap)
+      for (unsigned int i = 0; i < myBlock.size(); i++) swapBytes(myBlock[i]);
+
+    myRows = rows;
+    myFirstStep = firstStep;
+    myLastStep = lastStep;
+
+    return true;
+  }
+
+  return false;
+}
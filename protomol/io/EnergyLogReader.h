@@ -0,0 +1,83 @@
+/*  -*- c++ -*-  */
+#ifndef ENERGYLOGREADER_H
+#define ENERGYLOGREADER_H
+
+#include <protomol/io/Reader.h>
+#include <protomol/type/Real.h>
+#include <protomol/type/TypeSelection.h>
+
+#include <vector>
+
+namespace ProtoMol {
+  //____EnergyLogReader
+
+  /**
+   * Reads an energy log written by EnergyLogWriter, a block of rows at a
+   * time. Blocks outside a range of steps are skipped by their headers
+   * without reading the values. A log of the other byte order is swapped.
+   */
+  class EnergyLogReader : public Reader {
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // Typedef
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  private:
+    typedef TypeSelection::Int<4>::type int32;
+    typedef TypeSelection::Int<8>::type int64;
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // Constructors, destructors (both default here), assignment
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    EnergyLogReader();
+    explicit EnergyLogReader(const std::string &filename);
+    virtual ~EnergyLogReader();
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // From class Reader
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    virtual bool tryFormat();
+    /// Reads the next block
+    virtual bool read();
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // New methods of class EnergyLogReader
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    /// Reads the header, done by the first read otherwise
+    bool readHeader();
+    /// Reads the next block with steps in [first, last], false at the end
+    bool read(long first, long last);
+
+    /// Column names, the first is the step
+    const std::vector<std::string> &getColumns() const {return myColumns;}
+    unsigned int getBlockRows() const {return myBlockRows;}
+
+    /// Rows of the last block read
+    unsigned int getRows() const {return myRows;}
+    Real getValue(unsigned int row, unsigned int column) const {
+      return myBlock[column * myRows + row];
+    }
+    long getFirstStep() const {return myFirstStep;}
+    long getLastStep() const {return myLastStep;}
+
+  private:
+    void doReadHeader();
+    bool doRead(long first, long last);
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // My data members
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  private:
+    bool myHeader;
+    bool mySwap;
+    std::vector<std::string> myColumns;
+    unsigned int myBlockRows;
+
+    unsigned int myRows;
+    int64 myFirstStep;
+    int64 myLastStep;
+    std::vector<double> myBlock;
+  };
+}
+#endif /* ENERGYLOGREADER_H */
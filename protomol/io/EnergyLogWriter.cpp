@@ -0,0 +1,114 @@
+#include <protomol/io/EnergyLogWriter.h>
+#include <protomol/io/EnergyLogFormat.h>
+
+#include <protomol/base/Report.h>
+#include <protomol/base/Exception.h>
+
+#include <string.h>
+
+using namespace std;
+using namespace ProtoMol::Report;
+using namespace ProtoMol;
+using namespace ProtoMol::EnergyLogFormat;
+
+//____EnergyLogWriter
+
+namespace {
+  template<typename T>
+  void put(vector<char> &buffer, const T &t) {
+    const char *c = reinterpret_cast<const char *>(&t);
+    buffer.insert(buffer.end(), c, c + sizeof(T));
+  }
+}
+
+EnergyLogWriter::EnergyLogWriter(unsigned int blockRows) :
+  Writer(ios::binary | ios::trunc), myBlockRows(blockRows ? blockRows : 1),
+  myColumns(0), myRows(0), myFirstStep(0), myLastStep(0) {}
+
+EnergyLogWriter::EnergyLogWriter(const string &filename,
+                                 unsigned int blockRows) :
+  Writer(ios::binary | ios::trunc, filename),
+  myBlockRows(blockRows ? blockRows : 1), myColumns(0), myRows(0),
+  myFirstStep(0), myLastStep(0) {}
+
+EnergyLogWriter::~EnergyLogWriter() {
+  flush();
+  close();
+}
+
+bool EnergyLogWriter::writeHeader(const vector<string> &columns) {
+  if (!is_open() && !open()) return false;
+
+  myColumns = columns.size() + 1;
+  myRows = 0;
+  myBlock.resize(myColumns * myBlockRows);
+
+  myBuffer.clear();
+  myBuffer.insert(myBuffer.end(), LOG_MAGIC, LOG_MAGIC + 8);
+  put(myBuffer, (int32)LOG_VERSION);
+  put(myBuffer, (int32)LOG_BYTE_ORDER);
+  put(myBuffer, (int32)myColumns);
+  put(myBuffer, (int32)LOG_NAME);
+  put(myBuffer, (int32)myBlockRows);
+  put(myBuffer, (int32)0);
+
+  for (unsigned int i = 0; i < myColumns; i++) {
+    const string &name = i ? columns[i - 1] : string("Step");
+    if (name.size() >= LOG_NAME)
+      THROWS("Energy log column name '" << name << "' longer than "
+             << LOG_NAME - 1 << " characters");
+
+    char padded[LOG_NAME];
+    memset(padded, 0, LOG_NAME);
+    memcpy(padded, name.c_str(), name.size());
+    myBuffer.insert(myBuffer.end(), padded, padded + LOG_NAME);
+  }
+
+  File::write(&myBuffer[0], myBuffer.size());
+  file.flush();
+
+  return !file.fail();
+}
+
+bool EnergyLogWriter::write(long step, const vector<Real> &values) {
+  if (values.size() + 1 != myColumns)
+    THROWS("Energy log row of " << values.size() << " values, expected "
+           << (int)myColumns - 1);
+
+  if (!myRows) myFirstStep = step;
+  myLastStep = step;
+
+  double *row = &myBlock[myRows];
+  row[0] = step;
+  for (unsigned int i = 1; i < myColumns; i++)
+    row[i * myBlockRows] = values[i - 1];
+
+  if (++myRows == myBlockRows) return flush();
+
+  return true;
+}
+
+bool EnergyLogWriter::flush() {
+  if (!myRows) return true;
+  if (!is_open()) return false;
+
+  myBuffer.clear();
+  myBuffer.reserve(LOG_BLOCK_HEADER + sizeof(double) * myColumns * myRows);
+  put(myBuffer, (int32)LOG_BLOCK_MAGIC);
+  put(myBuffer, (int32)myRows);
+  put(myBuffer, myFirstStep);
+  put(myBuffer, myLastStep);
+
+  // Columns of a short last block are written without the unused rows
+  for (unsigned int i = 0; i < myColumns; i++) {
+    const char *c = reinterpret_cast<const char *>(&myBlock[i * myBlockRows]);
+    myBuffer.insert(myBuffer.end(), c, c + sizeof(double) * myRows);
+  }
+
+  myRows = 0;
+
+  File::write(&myBuffer[0], myBuffer.size());
+  file.flush();
+
+  return !file.fail();
+}
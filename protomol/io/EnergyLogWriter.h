@@ -0,0 +1,72 @@
+/*  -*- c++ -*-  */
+#ifndef ENERGYLOGWRITER_H
+#define ENERGYLOGWRITER_H
+
+#include <protomol/io/Writer.h>
+#include <protomol/type/Real.h>
+#include <protomol/type/TypeSelection.h>
+
+#include <vector>
+
+namespace ProtoMol {
+  //____EnergyLogWriter
+
+  /**
+   * Writes a binary, self describing log of energies and other scalars.
+   *
+   * The file starts with a 32 byte header: the magic "PMENERGY", then
+   * int32 version, byte order mark 0x01020304, number of columns, length of
+   * a column name, rows per block and a reserved 0. The column names follow,
+   * NUL padded; the first column is always the step.
+   *
+   * The rows are appended in blocks: an int32 block magic, the number of
+   * rows, the int64 first and last step, then the rows as doubles, column
+   * after column. Every block but the last has the same number of rows, so
+   * the block headers are an index a reader can walk by seeking over the
+   * data. Values are written in the native byte order.
+   */
+  class EnergyLogWriter : public Writer {
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // Typedef
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  private:
+    typedef TypeSelection::Int<4>::type int32;
+    typedef TypeSelection::Int<8>::type int64;
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // Constructors, destructors (both default here), assignment
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    explicit EnergyLogWriter(unsigned int blockRows = 256);
+    EnergyLogWriter(const std::string &filename, unsigned int blockRows = 256);
+    /// Writes the rows not yet written
+    virtual ~EnergyLogWriter();
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // New methods of class EnergyLogWriter
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    /// Writes the header, the names of the columns after the step
+    bool writeHeader(const std::vector<std::string> &columns);
+    /// Appends a row, one value for each column after the step
+    bool write(long step, const std::vector<Real> &values);
+    /// Writes the rows of the unfinished block, the next row starts a new one
+    bool flush();
+
+    unsigned int getBlockRows() const {return myBlockRows;}
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // My data members
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  private:
+    unsigned int myBlockRows;
+    unsigned int myColumns;
+    unsigned int myRows;
+    int64 myFirstStep;
+    int64 myLastStep;
+    // The block being filled, column major with myBlockRows per column
+    std::vector<double> myBlock;
+    std::vector<char> myBuffer;
+  };
+}
+#endif /* ENERGYLOGWRITER_H */
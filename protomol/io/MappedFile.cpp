@@ -0,0 +1,100 @@
+#include <protomol/io/MappedFile.h>
+
+#include <fstream>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+using namespace ProtoMol;
+
+//____MappedFile
+
+MappedFile::MappedFile() :
+  myData(0), mySize(0), myOpen(false), myMapped(false) {}
+
+MappedFile::MappedFile(const string &filename) :
+  myData(0), mySize(0), myOpen(false), myMapped(false) {
+  open(filename);
+}
+
+MappedFile::~MappedFile() {
+  close();
+}
+
+bool MappedFile::open(const string &filename) {
+  close();
+  myFilename = filename;
+
+#ifndef _WIN32
+  const int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0) return false;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    ::close(fd);
+    return false;
+  }
+
+  mySize = static_cast<size_t>(st.st_size);
+  if (mySize == 0) {
+    ::close(fd);
+    myOpen = true;
+    return true;
+  }
+
+  void *addr = mmap(0, mySize, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd); // The mapping keeps its own reference
+
+  if (addr != MAP_FAILED) {
+    myData = static_cast<const char *>(addr);
+    myMapped = true;
+    myOpen = true;
+    return true;
+  }
+#endif
+
+  // Fallback, read the whole file
+  ifstream in(filename.c_str(), ios::binary);
+  if (!in) return false;
+
+  in.seekg(0, ios::end);
+  mySize = static_cast<size_t>(in.tellg());
+  in.seekg(0, ios::beg);
+
+  myBuffer.resize(mySize);
+  if (mySize) in.read(&myBuffer[0], mySize);
+  if (in.fail()) {
+    close();
+    return false;
+  }
+
+  myData = mySize ? &myBuffer[0] : 0;
+  myOpen = true;
+
+  return true;
+}
+
+void MappedFile::close() {
+#ifndef _WIN32
+  if (myMapped && myData)
+    munmap(const_cast<char *>(myData), mySize);
+#endif
+
+  vector<char>().swap(myBuffer);
+  myData = 0;
+  mySize = 0;
+  myOpen = false;
+  myMapped = false;
+}
+
+void MappedFile::adviseSequential() const {
+#if !defined(_WIN32) && defined(MADV_SEQUENTIAL)
+  if (myMapped && myData)
+    madvise(const_cast<char *>(myData), mySize, MADV_SEQUENTIAL);
+#endif
+}
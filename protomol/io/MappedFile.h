@@ -0,0 +1,59 @@
+/*  -*- c++ -*-  */
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <string>
+#include <vector>
+
+namespace ProtoMol {
+  //____MappedFile
+
+  /**
+   * Read-only memory mapping of a whole file. On systems without mmap the
+   * file is read into memory once, so users can always treat the contents
+   * as one contiguous, immutable block of bytes.
+   *
+   * NB: The mapping is not null terminated, parsers must honor end().
+   */
+  class MappedFile {
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // Constructors, destructors, assignment
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    MappedFile();
+    explicit MappedFile(const std::string &filename);
+    ~MappedFile();
+
+  private:
+    MappedFile(const MappedFile &);
+    MappedFile &operator=(const MappedFile &);
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // New methods of class MappedFile
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    bool open(const std::string &filename);
+    void close();
+    bool is_open() const {return myOpen;}
+
+    const char *begin() const {return myData;}
+    const char *end() const {return myData + mySize;}
+    size_t size() const {return mySize;}
+    const std::string &getFilename() const {return myFilename;}
+
+    /// Hint the OS that the range will be read sequentially
+    void adviseSequential() const;
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // My data members
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  private:
+    std::string myFilename;
+    const char *myData;
+    size_t mySize;
+    bool myOpen;
+    bool myMapped;
+    std::vector<char> myBuffer;
+  };
+}
+#endif /* MAPPEDFILE_H */
@@ -0,0 +1,298 @@
+#include <protomol/io/MappedTrajectoryReader.h>
+
+#include <protomol/io/TextTokenizer.h>
+#include <protomol/base/Report.h>
+#include <protomol/base/SystemUtilities.h>
+#include <protomol/base/Exception.h>
+
+#include <cstring>
+
+using namespace std;
+using namespace ProtoMol::Report;
+using namespace ProtoMol;
+
+//____MappedTrajectoryReader
+
+namespace {
+  const char *skipLine(const char *p, const char *end) {
+    const char *nl = static_cast<const char *>(memchr(p, '\n', end - p));
+    return nl ? nl + 1 : end;
+  }
+
+  const char *skipBlanks(const char *p, const char *end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) p++;
+    return p;
+  }
+
+  const char *skipToken(const char *p, const char *end) {
+    while (p < end && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n')
+      p++;
+    return p;
+  }
+
+  bool parseDouble(const char *&p, const char *end, Real &value) {
+    p = skipBlanks(p, end);
+    const char *b = p;
+    p = skipToken(p, end);
+    return p != b && TextTokenizer::toReal(b, p, value);
+  }
+
+  bool parseUInt(const char *&p, const char *end, unsigned int &value) {
+    p = skipBlanks(p, end);
+    const char *b = p;
+    p = skipToken(p, end);
+    return p != b && TextTokenizer::toUInt(b, p, value);
+  }
+
+  template<typename T>
+  T getValue(const char *p, bool swap) {
+    T value;
+    memcpy(&value, p, sizeof(T));
+    if (swap) swapBytes(value);
+    return value;
+  }
+
+  // Fresh block of n atoms, avoids growing a non-empty block in place
+  void sizeBlock(Vector3DBlock &coords, unsigned int n) {
+    if (coords.size() != n) {
+      Vector3DBlock tmp(n);
+      coords.swap(tmp);
+    }
+  }
+}
+
+MappedTrajectoryReader::MappedTrajectoryReader() :
+  myFormat(UNDEFINED), mySwap(false), myFrames(0), myAtoms(0),
+  myFirstStep(0), myFirstFrame(0), myFrameSize(0), myCellSize(0), myNext(0),
+  myStride(1) {}
+
+MappedTrajectoryReader::MappedTrajectoryReader(const string &filename) :
+  myFormat(UNDEFINED), mySwap(false), myFrames(0), myAtoms(0),
+  myFirstStep(0), myFirstFrame(0), myFrameSize(0), myCellSize(0), myNext(0),
+  myStride(1) {
+  open(filename);
+}
+
+bool MappedTrajectoryReader::open(const string &filename) {
+  close();
+  if (!myFile.open(filename)) return false;
+
+  if (indexDCD()) myFormat = DCD;
+  else if (indexXYZ()) myFormat = XYZ;
+  else {
+    myFile.close();
+    return false;
+  }
+
+  report << debug(1) << "[MappedTrajectoryReader::open] "
+         << (myFormat == DCD ? "DCD" : "XYZ") << " '" << filename << "' "
+         << myFrames << " frames of " << myAtoms << " atoms." << endr;
+
+  return true;
+}
+
+void MappedTrajectoryReader::close() {
+  myFile.close();
+  myFormat = UNDEFINED;
+  mySwap = false;
+  myFrames = myAtoms = 0;
+  myFirstStep = 0;
+  myComment.clear();
+  myFirstFrame = myFrameSize = myCellSize = 0;
+  vector<size_t>().swap(myOffsets);
+  myNext = 0;
+  myStride = 1;
+}
+
+bool MappedTrajectoryReader::indexDCD() {
+  const char *data = myFile.begin();
+  const size_t size = myFile.size();
+  if (size < 104) return false;
+
+  // Endianess from the header record length
+  const int32 n = getValue<int32>(data, false);
+  if (n == 84) mySwap = false;
+  else if (getValue<int32>(data, true) == 84) mySwap = true;
+  else return false;
+
+  if (memcmp(data + 4, "CORD", 4) != 0) return false;
+
+  // CHARMM control array following "CORD"
+  const char *icntrl = data + 8;
+  myFirstStep = getValue<int32>(icntrl + 4, mySwap);
+  const int32 freeIndexes = getValue<int32>(icntrl + 4 * 8, mySwap);
+  const int32 hasCell = getValue<int32>(icntrl + 4 * 10, mySwap);
+  const int32 charmm = getValue<int32>(icntrl + 4 * 19, mySwap);
+
+  if (getValue<int32>(data + 88, mySwap) != 84) return false;
+
+  // Title record
+  size_t pos = 92;
+  const int32 title = getValue<int32>(data + pos, mySwap);
+  if (title < 4 || pos + 8 + title > size) return false;
+  myComment.assign(data + pos + 8, title - 4);
+  pos += 8 + title;
+
+  // Number of atoms record
+  if (pos + 12 > size || getValue<int32>(data + pos, mySwap) != 4)
+    return false;
+  const int32 natoms = getValue<int32>(data + pos + 4, mySwap);
+  if (natoms <= 0) return false;
+  pos += 12;
+
+  if (freeIndexes > 0) {
+    report << recoverable << "[MappedTrajectoryReader::open] DCD files with "
+           << "fixed atoms are not supported." << endr;
+    return false;
+  }
+
+  myAtoms = natoms;
+  myCellSize = (charmm != 0 && hasCell != 0) ? 4 + 48 + 4 : 0;
+  myFirstFrame = pos;
+  myFrameSize = myCellSize + 3 * (8 + 4 * static_cast<size_t>(natoms));
+  myFrames = (size - pos) / myFrameSize;
+
+  // Check the record marker of the first frame
+  if (myFrames > 0 &&
+      getValue<int32>(data + pos + myCellSize, mySwap) != 4 * natoms)
+    return false;
+
+  return true;
+}
+
+bool MappedTrajectoryReader::indexXYZ() {
+  const char *p = myFile.begin();
+  const char *end = myFile.end();
+
+  // Number of frames, informative only
+  unsigned int n = 0;
+  if (!parseUInt(p, end, n)) return false;
+  p = skipLine(p, end);
+
+  myFile.adviseSequential();
+
+  while (true) {
+    const char *line = skipBlanks(p, end);
+    if (line == end || *line == '\n') break;
+
+    unsigned int count = 0;
+    if (!parseUInt(p, end, count)) return false;
+    p = skipLine(p, end);
+
+    // Optional comment
+    if (p < end && *p == '!') p = skipLine(p, end);
+
+    if (myOffsets.empty()) myAtoms = count;
+    else if (count != myAtoms) {
+      report << recoverable << "[MappedTrajectoryReader::open] XYZ frame "
+             << myOffsets.size() << " has " << count << " atoms, expected "
+             << myAtoms << "." << endr;
+      break;
+    }
+
+    const size_t offset = p - myFile.begin();
+    unsigned int lines = 0;
+    while (lines < count && p < end) {
+      p = skipLine(p, end);
+      lines++;
+    }
+
+    // Partial last frame
+    if (lines < count) break;
+
+    myOffsets.push_back(offset);
+  }
+
+  myFrames = myOffsets.size();
+
+  return myFrames > 0;
+}
+
+bool MappedTrajectoryReader::read(unsigned int frame,
+                                  Vector3DBlock &coords) const {
+  try {
+    doRead(frame, coords);
+    return true;
+
+  } catch (const Exception &e) {}
+
+  return false;
+}
+
+void MappedTrajectoryReader::doRead(unsigned int frame,
+                                    Vector3DBlock &coords) const {
+  if (frame >= myFrames)
+    THROWS("Frame " << frame << " out of range [0," << myFrames << ") in '"
+           << getFilename() << "'");
+
+  sizeBlock(coords, myAtoms);
+  Real *c = coords.c;
+
+  if (myFormat == DCD) {
+    const char *base = myFile.begin() + myFirstFrame + frame * myFrameSize +
+      myCellSize;
+
+    for (unsigned int dim = 0; dim < 3; dim++) {
+      const char *x = base + dim * (8 + 4 * myAtoms) + 4;
+      if (mySwap)
+        for (unsigned int i = 0; i < myAtoms; i++)
+          c[3 * i + dim] = getValue<float4>(x + 4 * i, true);
+      else {
+        const float4 *f = reinterpret_cast<const float4 *>(x);
+        for (unsigned int i = 0; i < myAtoms; i++)
+          c[3 * i + dim] = f[i];
+      }
+    }
+
+  } else {
+    const char *p = myFile.begin() + myOffsets[frame];
+    const char *end = myFile.end();
+
+    for (unsigned int i = 0; i < myAtoms; i++) {
+      // Skip name
+      p = skipToken(skipBlanks(p, end), end);
+      if (!parseDouble(p, end, c[3 * i]) ||
+          !parseDouble(p, end, c[3 * i + 1]) ||
+          !parseDouble(p, end, c[3 * i + 2]))
+        THROWS("Invalid XYZ line " << i << " of frame " << frame << " in '"
+               << getFilename() << "'");
+      p = skipLine(p, end);
+    }
+  }
+}
+
+unsigned int MappedTrajectoryReader::read(unsigned int first,
+                                          unsigned int count,
+                                          unsigned int stride,
+                                          vector<Vector3DBlock> &frames) const {
+  if (!stride) stride = 1;
+
+  unsigned int n = 0;
+  if (first < myFrames)
+    n = min(count, (myFrames - first + stride - 1) / stride);
+
+  frames.resize(n);
+  for (unsigned int i = 0; i < n; i++)
+    doRead(first + i * stride, frames[i]);
+
+  return n;
+}
+
+bool MappedTrajectoryReader::next(Vector3DBlock &coords) {
+  if (myNext >= myFrames) return false;
+
+  if (!read(myNext, coords)) return false;
+  myNext += myStride;
+
+  return true;
+}
+
+const MappedTrajectoryReader::float4 *
+MappedTrajectoryReader::getFloatView(unsigned int frame,
+                                     unsigned int dim) const {
+  if (myFormat != DCD || mySwap || frame >= myFrames || dim > 2) return 0;
+
+  return reinterpret_cast<const float4 *>
+    (myFile.begin() + myFirstFrame + frame * myFrameSize + myCellSize +
+     dim * (8 + 4 * myAtoms) + 4);
+}
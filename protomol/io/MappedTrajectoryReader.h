@@ -0,0 +1,109 @@
+/*  -*- c++ -*-  */
+#ifndef MAPPEDTRAJECTORYREADER_H
+#define MAPPEDTRAJECTORYREADER_H
+
+#include <protomol/io/MappedFile.h>
+#include <protomol/type/Vector3DBlock.h>
+#include <protomol/type/TypeSelection.h>
+
+#include <vector>
+
+namespace ProtoMol {
+  //____MappedTrajectoryReader
+
+  /**
+   * Random access reader for DCD and XYZ trajectories on top of a memory
+   * mapped file. Opening builds a frame index (computed for DCD, one scan
+   * for XYZ), after which any frame is reached in O(1) without re-parsing
+   * the preceding ones.
+   *
+   * DCD frames stored in the machine's endianess can be accessed without
+   * copying through getFloatView(), which points straight into the mapping.
+   */
+  class MappedTrajectoryReader {
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // Typedef & enum
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    typedef TypeSelection::Int<4>::type int32;
+    typedef TypeSelection::Float<4>::type float4;
+
+    enum Format {UNDEFINED, DCD, XYZ};
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // Constructors, destructors (both default here), assignment
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    MappedTrajectoryReader();
+    explicit MappedTrajectoryReader(const std::string &filename);
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // New methods of class MappedTrajectoryReader
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    /// Maps the file and builds the frame index, false if not DCD or XYZ
+    bool open(const std::string &filename);
+    void close();
+    bool is_open() const {return myFormat != UNDEFINED;}
+
+    Format getFormat() const {return myFormat;}
+    unsigned int getNumFrames() const {return myFrames;}
+    unsigned int getNumAtoms() const {return myAtoms;}
+    /// First step stored in the DCD header, 0 for XYZ
+    int getFirstStep() const {return myFirstStep;}
+    const std::string &getComment() const {return myComment;}
+    const std::string &getFilename() const {return myFile.getFilename();}
+
+    /// Random access, frame in [0, getNumFrames())
+    bool read(unsigned int frame, Vector3DBlock &coords) const;
+    void doRead(unsigned int frame, Vector3DBlock &coords) const;
+
+    /// Converts count frames first, first + stride, ... in one call,
+    /// returns the number of frames read
+    unsigned int read(unsigned int first, unsigned int count,
+                      unsigned int stride,
+                      std::vector<Vector3DBlock> &frames) const;
+
+    /// Strided sequential iteration
+    void seek(unsigned int frame) {myNext = frame;}
+    void setStride(unsigned int stride) {myStride = stride ? stride : 1;}
+    unsigned int tell() const {return myNext;}
+    bool next(Vector3DBlock &coords);
+
+    /**
+     * Zero-copy view of dimension dim (0: x, 1: y, 2: z) of a DCD frame,
+     * getNumAtoms() floats. Returns 0 for XYZ trajectories or if the file
+     * endianess differs from the machine, use read() then.
+     */
+    const float4 *getFloatView(unsigned int frame, unsigned int dim) const;
+
+  private:
+    bool indexDCD();
+    bool indexXYZ();
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // My data members
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  private:
+    MappedFile myFile;
+    Format myFormat;
+    bool mySwap;
+    unsigned int myFrames;
+    unsigned int myAtoms;
+    int myFirstStep;
+    std::string myComment;
+
+    // DCD: offset of the first frame and bytes per frame, including the
+    // optional CHARMM unit cell record
+    size_t myFirstFrame;
+    size_t myFrameSize;
+    size_t myCellSize;
+
+    // XYZ: offset of the first atom line of each frame
+    std::vector<size_t> myOffsets;
+
+    unsigned int myNext;
+    unsigned int myStride;
+  };
+}
+#endif /* MAPPEDTRAJECTORYREADER_H */
@@ -1,5 +1,7 @@
 #include <protomol/io/PARReader.h>
 
+#include <protomol/io/MappedFile.h>
+#include <protomol/io/TextTokenizer.h>
 #include <protomol/base/StringUtilities.h>
 #include <protomol/base/Report.h>
 #include <algorithm>
@@ -81,10 +83,14 @@ bool PARReader::read() {
 bool PARReader::read(PAR &par) {
   if (!tryFormat())
     return false;
-  if (!open())
-    return false;
   par.clear();
 
+  MappedFile mapped(filename);
+  if (!mapped.is_open()) {
+    file.setstate(ios::failbit);
+    return false;
+  }
+
   vector<vector<string> > input;   // Stripped PAR file input
   vector<string> signatures;       // 'd' for Real or int, 'w' for a word
   vector<int> lines;               // line number in PAR file
@@ -93,10 +99,13 @@ bool PARReader::read(PAR &par) {
   int count = 0;                   // PAR file line counter
 
   int comment = 0;
-  while (!file.eof()) {
+  TextTokenizer in(mapped.begin(), mapped.end());
+  const char *b, *e;
+  while (in.nextLine(b, e)) {
     vector<string> data;
     string numbers = "";
-    string str(removeBeginEndBlanks(getline()));
+    TextTokenizer::trim(b, e);
+    string str(b, e);
     ++count;
 
     // Remove {} comments
@@ -142,17 +151,14 @@ bool PARReader::read(PAR &par) {
     // Remove ! comments
     str.resize(find(str.begin(), str.end(), '!') - str.begin());
 
-    stringstream ss(str);
-    while (!ss.eof()) {
-      string i;
-      ss >> i;
+    TextTokenizer tok(str.data(), str.data() + str.size());
+    while (tok.nextToken(b, e)) {
       // Skip * comments
-      if (i[0] == '*')
+      if (*b == '*')
         break;
-      if (!i.empty()) {
-        data.push_back(i);
-        numbers += (isReal(i) ? "d" : "w");
-      }
+      Real r;
+      data.push_back(string(b, e));
+      numbers += (TextTokenizer::toReal(b, e, r) ? "d" : "w");
     }
 
     // Remove REMARK and SET
@@ -484,8 +490,7 @@ bool PARReader::read(PAR &par) {
     }
   }
 
-  close();
-  return !file.fail();
+  return true;
 }
 
 //____isKeywordCharmm19
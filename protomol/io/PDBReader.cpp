@@ -1,9 +1,13 @@
 #include <protomol/io/PDBReader.h>
 
+#include <protomol/io/MappedFile.h>
+#include <protomol/io/TextTokenizer.h>
 #include <protomol/base/StringUtilities.h>
 #include <protomol/base/Report.h>
 #include <protomol/base/MathUtilities.h>
 
+#include <algorithm>
+
 //____#define DEBUG_PDB
 
 using namespace std;
@@ -11,6 +15,64 @@ using namespace ProtoMol::Report;
 using namespace ProtoMol;
 //____PDBReader
 
+namespace {
+  // Column field of a fixed format record [begin, end), as substr() of the
+  // record filled with blanks
+  void getField(const char *begin, const char *end, unsigned int start,
+                unsigned int length, const char *&b, const char *&e) {
+    b = min(begin + start, end);
+    e = min(begin + start + length, end);
+  }
+
+  string getString(const char *begin, const char *end, unsigned int start,
+                   unsigned int length) {
+    const char *b, *e;
+    getField(begin, end, start, length, b, e);
+    TextTokenizer::trim(b, e);
+    return string(b, e);
+  }
+
+  int getInt(const char *begin, const char *end, unsigned int start,
+             unsigned int length) {
+    const char *b, *e;
+    getField(begin, end, start, length, b, e);
+    int i = 0;
+    TextTokenizer::toInt(b, e, i);
+    return i;
+  }
+
+  Real getReal(const char *begin, const char *end, unsigned int start,
+               unsigned int length) {
+    const char *b, *e;
+    getField(begin, end, start, length, b, e);
+    Real r = 0.0;
+    TextTokenizer::toReal(b, e, r);
+    return r;
+  }
+
+  // Residue sequence, including X-Plor numbers starting with a character
+  int getResSeq(const char *begin, const char *end, unsigned int start,
+                unsigned int length, int &big, int &toBig) {
+    const char *b, *e;
+    getField(begin, end, start, length, b, e);
+    TextTokenizer::trim(b, e);
+    int resSeq = 0;
+    if (!TextTokenizer::toInt(b, e, resSeq)) {
+      int n = 0;
+      if (e - b == 4 && TextTokenizer::toInt(b + 1, e, n) &&
+          b[0] >= 'A' && b[0] <= 'Z') {
+        resSeq = (b[0] - 'A') * 1000 + 10000 + n;
+        ++big;
+      } else {
+        resSeq = -1;
+        ++toBig;
+      }
+    }
+
+    return resSeq;
+  }
+}
+
 PDBReader::PDBReader() :
   Reader(), myCoords(NULL), myAtoms(NULL), myTers(NULL) {}
 
@@ -66,106 +128,82 @@ bool PDBReader::read(Vector3DBlock &coords, vector<PDB::Atom> &atoms,
                      vector<PDB::Ter> &ters) {
   if (!tryFormat())
     return false;
-  if (!open())
-    return false;
   coords.clear();
   atoms.clear();
   ters.clear();
+
+  MappedFile mapped(filename);
+  if (!mapped.is_open()) {
+    file.setstate(ios::failbit);
+    return false;
+  }
+  mapped.adviseSequential();
+
+  // Typical 81 bytes per record
+  atoms.reserve(mapped.size() / 81);
   std::vector<Vector3D> tmpdata;
+  tmpdata.reserve(mapped.size() / 81);
+
   // Now we want to read data in until the record name is "END", then stop.
   int big = 0;
   int toBig = 0;
   comment = "";
-  do {
-    string record(getline());
-    if (equalStart("END", record))
+  TextTokenizer tok(mapped.begin(), mapped.end());
+  const char *b, *e;
+  while (tok.nextLine(b, e)) {
+    if (TextTokenizer::equalStart("END", b, e))
       break;
-    if (equalStart("REMARK", record) || record.empty()) {
-      record = removeBeginEndBlanks(record);
-      if (!record.empty())
-        comment += (comment.empty() ? "" : "\n") + record;
+    if (TextTokenizer::equalStart("REMARK", b, e) || b == e) {
+      TextTokenizer::trim(b, e);
+      if (b != e)
+        comment += (comment.empty() ? "" : "\n") + string(b, e);
       continue;
     }
-    if (equalStart("ATOM", record) || equalStart("HETATM", record)) {
-      record = getRightFill(record, 80);
-      string str =
-        removeBeginEndBlanks(record.substr(PDB::Atom::S_RES_SEQ,
-            PDB::Atom::L_RES_SEQ));
-      int resSeq = toInt(str);
-      if (!isInt(str)) {
-        if (str.size() == 4 &&
-            isInt(string(&str[1],
-                &str[4])) && str[0] >= 'A' && str[0] <= 'Z') {
-          resSeq =
-            (str[0] - 'A') * 1000 + 10000 + toInt(string(&str[1], &str[4]));
-          ++big;
-        } else {
-          resSeq = -1;
-          ++toBig;
-        }
-      }
+    if (TextTokenizer::equalStart("ATOM", b, e) ||
+        TextTokenizer::equalStart("HETATM", b, e)) {
+      e = min(e, b + 80);
+      int resSeq = getResSeq(b, e, PDB::Atom::S_RES_SEQ, PDB::Atom::L_RES_SEQ,
+                             big, toBig);
 
-      atoms.push_back(PDB::Atom(removeBeginEndBlanks(record.substr(PDB::Atom::
-                S_RECORD_NAME, PDB::Atom::L_RECORD_NAME)),
-          toInt(record.substr(PDB::Atom::S_SERIAL, PDB::Atom::L_SERIAL)),
-          removeBeginEndBlanks(record.substr(PDB::Atom::S_ATOM_NAME,
-              PDB::Atom::L_ATOM_NAME)),
-          removeBeginEndBlanks(record.substr(PDB::Atom::S_ALT_LOC,
-              PDB::Atom::L_ALT_LOC)),
-          removeBeginEndBlanks(record.substr(PDB::Atom::S_RES_NAME,
-              PDB::Atom::L_RES_NAME + 1)),   // enable to read TIP3
-          removeBeginEndBlanks(record.substr(PDB::Atom::S_CHAIN_ID,
-              PDB::Atom::L_CHAIN_ID)),
+      atoms.push_back(PDB::Atom(getString(b, e, PDB::Atom::S_RECORD_NAME,
+                                          PDB::Atom::L_RECORD_NAME),
+          getInt(b, e, PDB::Atom::S_SERIAL, PDB::Atom::L_SERIAL),
+          getString(b, e, PDB::Atom::S_ATOM_NAME, PDB::Atom::L_ATOM_NAME),
+          getString(b, e, PDB::Atom::S_ALT_LOC, PDB::Atom::L_ALT_LOC),
+          getString(b, e, PDB::Atom::S_RES_NAME,
+                    PDB::Atom::L_RES_NAME + 1),   // enable to read TIP3
+          getString(b, e, PDB::Atom::S_CHAIN_ID, PDB::Atom::L_CHAIN_ID),
           resSeq,
-          removeBeginEndBlanks(record.substr(PDB::Atom::S_I_CODE,
-              PDB::Atom::L_I_CODE)),
-          toReal(record.substr(PDB::Atom::S_OCCUP, PDB::Atom::L_OCCUP)),
-          toReal(record.substr(PDB::Atom::S_TEMP_FACT,
-                               PDB::Atom::L_TEMP_FACT)),
-          removeBeginEndBlanks(record.substr(PDB::Atom::S_SEG_ID,
-              PDB::Atom::L_SEG_ID)),
-          removeBeginEndBlanks(record.substr(PDB::Atom::S_ELEMENT_SYMBOL,
-              PDB::Atom::L_ELEMENT_SYMBOL)),
-          removeBeginEndBlanks(record.substr(PDB::Atom::S_CHARGE,
-              PDB::Atom::L_CHARGE)),
+          getString(b, e, PDB::Atom::S_I_CODE, PDB::Atom::L_I_CODE),
+          getReal(b, e, PDB::Atom::S_OCCUP, PDB::Atom::L_OCCUP),
+          getReal(b, e, PDB::Atom::S_TEMP_FACT, PDB::Atom::L_TEMP_FACT),
+          getString(b, e, PDB::Atom::S_SEG_ID, PDB::Atom::L_SEG_ID),
+          getString(b, e, PDB::Atom::S_ELEMENT_SYMBOL,
+                    PDB::Atom::L_ELEMENT_SYMBOL),
+          getString(b, e, PDB::Atom::S_CHARGE, PDB::Atom::L_CHARGE),
           0));
-      tmpdata.push_back(Vector3D(toReal(record.substr(PDB::Atom::S_X,
-              PDB::Atom::L_X)),
-          toReal(record.substr(PDB::Atom::S_Y, PDB::Atom::L_Y)),
-          toReal(record.substr(PDB::Atom::S_Z, PDB::Atom::L_Z))));
-    } else if (equalStart("TER", record)) {
-      record = getRightFill(record, 27);
-      string str =
-        removeBeginEndBlanks(record.substr(PDB::Ter::S_RES_SEQ,
-            PDB::Ter::L_RES_SEQ));
-      int resSeq = toInt(str);
-      if (!isInt(str)) {
-        if (str.size() == 4 &&
-            isInt(string(&str[1],
-                &str[4])) && str[0] >= 'A' && str[0] <= 'Z') {
-          resSeq =
-            (str[0] - 'A') * 1000 + 10000 + toInt(string(&str[1], &str[4]));
-          ++big;
-        } else {
-          resSeq = -1;
-          ++toBig;
-        }
-      }
+      tmpdata.push_back(Vector3D(getReal(b, e, PDB::Atom::S_X, PDB::Atom::L_X),
+          getReal(b, e, PDB::Atom::S_Y, PDB::Atom::L_Y),
+          getReal(b, e, PDB::Atom::S_Z, PDB::Atom::L_Z)));
+    } else if (TextTokenizer::equalStart("TER", b, e)) {
+      e = min(e, b + 27);
+      int resSeq = getResSeq(b, e, PDB::Ter::S_RES_SEQ, PDB::Ter::L_RES_SEQ,
+                             big, toBig);
 
-      ters.push_back(PDB::Ter(removeBeginEndBlanks(record.substr(PDB::Ter::
-                S_RECORD_NAME, PDB::Ter::L_RECORD_NAME)),
-          toInt(record.substr(PDB::Ter::S_SERIAL, PDB::Ter::L_SERIAL)),
-          removeBeginEndBlanks(record.substr(PDB::Ter::S_RES_NAME,
-              PDB::Ter::L_RES_NAME + 1)),  // enable to read TIP3
-          removeBeginEndBlanks(record.substr(PDB::Ter::S_CHAIN_ID,
-              PDB::Ter::L_CHAIN_ID)),
+      ters.push_back(PDB::Ter(getString(b, e, PDB::Ter::S_RECORD_NAME,
+                                        PDB::Ter::L_RECORD_NAME),
+          getInt(b, e, PDB::Ter::S_SERIAL, PDB::Ter::L_SERIAL),
+          getString(b, e, PDB::Ter::S_RES_NAME,
+                    PDB::Ter::L_RES_NAME + 1),  // enable to read TIP3
+          getString(b, e, PDB::Ter::S_CHAIN_ID, PDB::Ter::L_CHAIN_ID),
           resSeq,
-          removeBeginEndBlanks(record.substr(PDB::Ter::S_I_CODE,
-              PDB::Ter::L_I_CODE))));
-    } else
+          getString(b, e, PDB::Ter::S_I_CODE, PDB::Ter::L_I_CODE)));
+    } else {
+      TextTokenizer::trim(b, e);
       report << recoverable << "[PDB::read] Record unknown:\'" <<
-      removeBeginEndBlanks(record) << "\'." << endr;
-  } while (!(file.eof()));
+      string(b, e) << "\'." << endr;
+    }
+  }
 
   coords.resize(tmpdata.size());
   for (unsigned int i = 0; i < tmpdata.size(); i++)
@@ -178,8 +216,7 @@ bool PDBReader::read(Vector3DBlock &coords, vector<PDB::Atom> &atoms,
   if (toBig > 0)
     report << recoverable << "[PDB::read] Found " << toBig <<
     " non interger/X-Plor residue number(s)." << endr;
-  close();
-  return !file.fail();
+  return true;
 }
 
 Vector3DBlock *PDBReader::orphanCoords() {
@@ -1,9 +1,13 @@
 #include <protomol/io/PSFReader.h>
 
+#include <protomol/io/MappedFile.h>
+#include <protomol/io/TextTokenizer.h>
 #include <protomol/base/StringUtilities.h>
 #include <protomol/base/Report.h>
 #include <protomol/base/MathUtilities.h>
 
+#include <cstring>
+
 //____#define DEBUG_PSF
 
 using namespace std;
@@ -11,6 +15,116 @@ using namespace ProtoMol::Report;
 using namespace ProtoMol;
 //____PSFReader
 
+namespace {
+  enum SectionType {
+    NATOM, NBOND, NTHETA, NPHI, NIMPHI, NDON, NACC, NNB, NGRP, UNKNOWN,
+    NUM_SECTIONS = UNKNOWN
+  };
+
+  // One record of the PSF file, body is [begin, end) of the mapping
+  struct Section {
+    Section() :
+      type(UNKNOWN), count(0), begin(0), end(0), offset(0), read(0),
+      ok(true) {}
+
+    SectionType type;
+    std::string keyword;
+    int count;
+    const char *begin;
+    const char *end;
+    unsigned int offset;        // first slot in the PSF container
+    int read;
+    bool ok;
+    std::vector<std::string> residues;  // non integer residue sequences
+  };
+
+  SectionType getSectionType(const char *begin, const char *end) {
+    if (TextTokenizer::equalStartNocase("!NATOM", begin, end)) return NATOM;
+    if (TextTokenizer::equalStartNocase("!NBOND", begin, end)) return NBOND;
+    if (TextTokenizer::equalStartNocase("!NTHETA", begin, end)) return NTHETA;
+    if (TextTokenizer::equalStartNocase("!NPHI", begin, end)) return NPHI;
+    if (TextTokenizer::equalStartNocase("!NIMPHI", begin, end)) return NIMPHI;
+    if (TextTokenizer::equalStartNocase("!NDON", begin, end)) return NDON;
+    if (TextTokenizer::equalStartNocase("!NACC", begin, end)) return NACC;
+    if (TextTokenizer::equalStartNocase("!NNB", begin, end)) return NNB;
+    return UNKNOWN;
+  }
+
+  // Records of N atom numbers, numbered from 1 within the section
+  template<typename T, unsigned int N>
+  bool parseRecords(Section &section, vector<T> &records,
+                    int T::*const (&fields)[N]) {
+    TextTokenizer tok(section.begin, section.end);
+    for (int counter = 1; counter <= section.count; ++counter) {
+      T &record = records[section.offset + counter - 1];
+      record.number = counter;
+      for (unsigned int i = 0; i < N; i++)
+        if (!tok.nextInt(record.*fields[i])) return false;
+      section.read = counter;
+    }
+
+    return true;
+  }
+
+  bool parseAtoms(Section &section, vector<PSF::Atom> &atoms) {
+    TextTokenizer tok(section.begin, section.end);
+    const char *b, *e;
+    for (int counter = 1; counter <= section.count; ++counter) {
+      PSF::Atom &atom = atoms[section.offset + counter - 1];
+      if (!tok.nextInt(atom.number) ||         // read atom number
+          !tok.nextString(atom.seg_id) ||      // read segment identifier
+          !tok.nextToken(b, e) ||              // read in residue sequence
+          !tok.nextString(atom.residue_name) ||// read in residue name
+          !tok.nextString(atom.atom_name) ||   // read in atom name
+          !tok.nextString(atom.atom_type) ||   // read in name of the 2nd atom
+          !tok.nextReal(atom.charge) ||        // read in charge
+          !tok.nextReal(atom.mass) ||          // read in mass
+          !tok.nextUInt(atom.identity))        // atom's chemical identity
+        return false;                          // (used only by iSGProtomol)
+
+      if (!TextTokenizer::toInt(b, e, atom.residue_sequence))
+        section.residues.push_back(string(b, e));
+      section.read = counter;
+    }
+
+    return true;
+  }
+
+  bool parseSection(Section &section, PSF &psf) {
+    static int PSF::Bond::*const bond[] =
+      {&PSF::Bond::atom1, &PSF::Bond::atom2};
+    static int PSF::Angle::*const angle[] =
+      {&PSF::Angle::atom1, &PSF::Angle::atom2, &PSF::Angle::atom3};
+    static int PSF::Dihedral::*const dihedral[] =
+      {&PSF::Dihedral::atom1, &PSF::Dihedral::atom2, &PSF::Dihedral::atom3,
+       &PSF::Dihedral::atom4};
+    static int PSF::Improper::*const improper[] =
+      {&PSF::Improper::atom1, &PSF::Improper::atom2, &PSF::Improper::atom3,
+       &PSF::Improper::atom4};
+    static int PSF::Donor::*const donor[] =
+      {&PSF::Donor::atom1, &PSF::Donor::atom2};
+    static int PSF::Acceptor::*const acceptor[] =
+      {&PSF::Acceptor::atom1, &PSF::Acceptor::atom2};
+    static int PSF::Nonbonded::*const nonbonded[] =
+      {&PSF::Nonbonded::atom1};
+    static int PSF::Ngrp::*const ngrp[] =
+      {&PSF::Ngrp::atom1, &PSF::Ngrp::atom2, &PSF::Ngrp::atom3};
+
+    switch (section.type) {
+    case NATOM: return parseAtoms(section, psf.atoms);
+    case NBOND: return parseRecords(section, psf.bonds, bond);
+    case NTHETA: return parseRecords(section, psf.angles, angle);
+    case NPHI: return parseRecords(section, psf.dihedrals, dihedral);
+    case NIMPHI: return parseRecords(section, psf.impropers, improper);
+    case NDON: return parseRecords(section, psf.donors, donor);
+    case NACC: return parseRecords(section, psf.acceptors, acceptor);
+    case NNB: return parseRecords(section, psf.nonbondeds, nonbonded);
+    case NGRP: return parseRecords(section, psf.ngrp, ngrp);
+    default: return true;
+    }
+  }
+}
+
 PSFReader::PSFReader() :
   Reader(), myPSF(NULL) {}
 
@@ -37,249 +151,168 @@ bool PSFReader::read() {
 }
 
 bool PSFReader::read(PSF &psf) {
-  if (!tryFormat() || !open()) return false;
+  if (!tryFormat()) return false;
+  close();
   psf.clear();
 
+  MappedFile mapped(filename);
+  if (!mapped.is_open()) {
+    file.setstate(ios::failbit);
+    return false;
+  }
+  mapped.adviseSequential();
+
   // Find header
-  string psfHead;
-  file >> psfHead;
-  if (!equalNocase("PSF", psfHead)) {
+  TextTokenizer tok(mapped.begin(), mapped.end());
+  const char *b, *e;
+  if (!tok.nextToken(b, e) || e - b != 3 ||
+      !TextTokenizer::equalStartNocase("PSF", b, e)) {
     file.setstate(ios::failbit);
-    close();
     return false;
   }
+  tok.skipLine();
 
-  while (!file.eof()) {
-    string line(removeBeginEndBlanks(getline()));
-
-    // Exit if nothing more to read
-    if (line.empty() && file.eof()) {
-      close();
-      return true;
-    }
+  // Locate the records, the bodies are parsed afterwards
+  vector<Section> sections;
+  while (tok.nextLine(b, e)) {
+    TextTokenizer::trim(b, e);
 
     // Find '!', otherwise continue with next line
-    if (find(line.begin(), line.end(), '!') == line.end())
+    if (!memchr(b, '!', e - b))
       continue;
 
     // Parse header
-    stringstream ss(line);
-    vector<string> header;
+    TextTokenizer header(b, e);
+    const char *nb = 0, *ne = 0, *kb = 0, *ke = 0, *tb, *te;
+    int size = 0;
     int index = -1;
-    string str;
-    while (ss >> str) {
-      if (str[0] == '!' && index < 0)
-        index = header.size();
-      header.push_back(str);
+    while (header.nextToken(tb, te)) {
+      if (*tb == '!' && index < 0) {
+        index = size;
+        kb = tb;
+        ke = te;
+      }
+      if (size == 0) {
+        nb = tb;
+        ne = te;
+      }
+      size++;
     }
 
-    if (file.fail() || index < 1 || index > 2 || header.size() < 2) {
+    if (index < 1 || index > 2 || size < 2) {
       report << recoverable
              << " PSF file \'" << filename
              << "\' has corrupt record header." << endl
-             << "\'" << line << "\'"
+             << "\'" << string(b, e) << "\'"
              << endr;
       file.setstate(ios::failbit);
       return false;
     }
-    string keyword = header[index];
-    int numrecords = toInt(header[0]);
+
+    Section section;
+    section.keyword.assign(kb, ke);
+    const bool numeric = TextTokenizer::toInt(nb, ne, section.count);
 
     // Branch
     if (index == 1) {
       // Normal case: int,keyword
 
-      if (!isInt(header[0])) {
+      if (!numeric) {
         report << recoverable
                << " PSF file \'" << filename
                <<
         "\' has corrupt record header, number of records should be an integer."
                << endl
-               << "\'" << line << "\'"
+               << "\'" << string(b, e) << "\'"
                << endr;
         file.setstate(ios::failbit);
-        close();
         return false;
       }
 
-      if (equalStartNocase("!NTITLE", keyword)) {  // title
+      if (TextTokenizer::equalStartNocase("!NTITLE", kb, ke)) {  // title
         comment = "";
-        for (int counter = 0; counter < numrecords; ++counter) {
+        for (int counter = 0; counter < section.count; ++counter) {
           // lines of title + one empty line
-          line = removeBeginEndBlanks(getline());
-          if (!line.empty())
-            comment += (comment.empty() ? "" : "\n") + line;
-        }
-
-        continue;
-      } else if (equalStartNocase("!NATOM", keyword)) {
-        for (int counter = 1; counter <= numrecords; ++counter) {
-          PSF::Atom temp_atom;
-          file >> temp_atom.number  // read atom number
-          >> temp_atom.seg_id       // read segment identifier
-          >> str                    // read in residue sequence
-          >> temp_atom.residue_name // read in residue name
-          >> temp_atom.atom_name    // read in atom name
-          >> temp_atom.atom_type    // read in name of the second atom
-          >> temp_atom.charge       // read in charge
-          >> temp_atom.mass         // read in mass
-          >> temp_atom.identity;    // atom's chemical identity (used only by
-                                    // iSGProtomol)
-          temp_atom.residue_sequence = toInt(str);
-          if (!isInt(str))
-            report << recoverable
-                   << "[PSF::read] Expecting a number for residue sequence. "
-                   << "I do not know what to do with \'" << str << "\'." <<
-            endr;
-          psf.atoms.push_back(temp_atom);
-          if (file.fail() || (file.eof() && counter < numrecords)) {
-            file.setstate(ios::failbit);
-            close();
-            return false;
-          }
+          if (!tok.nextLine(b, e)) break;
+          TextTokenizer::trim(b, e);
+          if (b != e)
+            comment += (comment.empty() ? "" : "\n") + string(b, e);
         }
 
         continue;
-      } else if (equalStartNocase("!NBOND", keyword)) {
-        for (int counter = 1; counter <= numrecords; ++counter) {
-          PSF::Bond temp_bond;
-          temp_bond.number = counter;
-          file >> temp_bond.atom1;
-          file >> temp_bond.atom2;
-          psf.bonds.push_back(temp_bond);
-          if (file.fail() || (file.eof() && counter < numrecords)) {
-            file.setstate(ios::failbit);
-            close();
-            return false;
-          }
-        }
+      }
 
-        continue;
-      } else if (equalStartNocase("!NTHETA", keyword)) {
-        for (int counter = 1; counter <= numrecords; ++counter) {
-          PSF::Angle temp_angle;
-          temp_angle.number = counter;
-          file >> temp_angle.atom1;
-          file >> temp_angle.atom2;
-          file >> temp_angle.atom3;
-          psf.angles.push_back(temp_angle);
-          if (file.fail() || (file.eof() && counter < numrecords)) {
-            file.setstate(ios::failbit);
-            close();
-            return false;
-          }
-        }
+      section.type = getSectionType(kb, ke);
 
-        continue;
-      } else if (equalStartNocase("!NPHI", keyword)) {
-        for (int counter = 1; counter <= numrecords; ++counter) {
-          PSF::Dihedral temp_dihedral;
-          temp_dihedral.number = counter;
-          file >> temp_dihedral.atom1;
-          file >> temp_dihedral.atom2;
-          file >> temp_dihedral.atom3;
-          file >> temp_dihedral.atom4;
-          psf.dihedrals.push_back(temp_dihedral);
-          if (file.fail() || (file.eof() && counter < numrecords)) {
-            file.setstate(ios::failbit);
-            close();
-            return false;
-          }
-        }
+    } else if (TextTokenizer::equalStartNocase("!NGRP", kb, ke))
+      section.type = NGRP;
 
-        continue;
-      } else if (equalStartNocase("!NIMPHI", keyword)) {
-        for (int counter = 1; counter <= numrecords; ++counter) {
-          PSF::Improper temp_improper;
-          temp_improper.number = counter;
-          file >> temp_improper.atom1;
-          file >> temp_improper.atom2;
-          file >> temp_improper.atom3;
-          file >> temp_improper.atom4;
-          psf.impropers.push_back(temp_improper);
-          if (file.fail() || (file.eof() && counter < numrecords)) {
-            file.setstate(ios::failbit);
-            close();
-            return false;
-          }
-        }
+    // The body ends at the next line with a '!'
+    section.begin = tok.getPos();
+    const char *bang = static_cast<const char *>
+      (memchr(section.begin, '!', mapped.end() - section.begin));
+    if (bang) {
+      while (bang > section.begin && bang[-1] != '\n') bang--;
+      section.end = bang;
+    } else
+      section.end = mapped.end();
+    tok.setPos(section.end);
 
-        continue;
-      } else if (equalStartNocase("!NDON", keyword)) {
-        for (int counter = 1; counter <= numrecords; ++counter) {
-          PSF::Donor temp_donor;
-          temp_donor.number = counter;
-          file >> temp_donor.atom1;
-          file >> temp_donor.atom2;
-          psf.donors.push_back(temp_donor);
-          if (file.fail() || (file.eof() && counter < numrecords)) {
-            file.setstate(ios::failbit);
-            close();
-            return false;
-          }
-        }
-
-        continue;
-      } else if (equalStartNocase("!NACC", keyword)) {
-        for (int counter = 1; counter <= numrecords; ++counter) {
-          PSF::Acceptor temp_acceptor;
-          temp_acceptor.number = counter;
-          file >> temp_acceptor.atom1;
-          file >> temp_acceptor.atom2;
-          psf.acceptors.push_back(temp_acceptor);
-          if (file.fail() || (file.eof() && counter < numrecords)) {
-            file.setstate(ios::failbit);
-            close();
-            return false;
-          }
-        }
-
-        continue;
-      } else if (equalStartNocase("!NNB", keyword)) {
-        for (int counter = 1; counter <= numrecords; ++counter) {
-          PSF::Nonbonded temp_nonbonded;
-          temp_nonbonded.number = counter;
-          file >> temp_nonbonded.atom1;
-          psf.nonbondeds.push_back(temp_nonbonded);
-          if (file.fail() || (file.eof() && counter < numrecords)) {
-            report << recoverable << "[PSF::read] Expecting " <<
-            numrecords << " NNB, read " << counter - 1 <<
-            ", reached end of file." << endr;
-            close();
-            return false;
-          }
-        }
+    sections.push_back(section);
+  }
 
-        continue;
-      }
+  // Size the containers, each record has its own slots
+  unsigned int total[NUM_SECTIONS] = {0};
+  for (unsigned int i = 0; i < sections.size(); i++)
+    if (sections[i].type != UNKNOWN && sections[i].count > 0) {
+      sections[i].offset = total[sections[i].type];
+      total[sections[i].type] += sections[i].count;
     }
 
-    if (index == 2)
-      if (equalStartNocase("!NGRP", keyword)) {
-        for (int counter = 1; counter <= numrecords; ++counter) {
-          PSF::Ngrp temp_ngrp;
-          temp_ngrp.number = counter;
-          file >> temp_ngrp.atom1;
-          file >> temp_ngrp.atom2;
-          file >> temp_ngrp.atom3;
-          psf.ngrp.push_back(temp_ngrp);
-          if (file.fail() || (file.eof() && counter < numrecords)) {
-            report << recoverable << "[PSF::read] Expecting " <<
-            numrecords << " NGRP, read " << counter - 1 <<
-            ", reached end of file." << endr;
-            close();
-            return false;
-          }
-        }
-
-        continue;
-      }
-
-    report << recoverable << "[PSF::read] Record " << keyword << " with " <<
-    numrecords << " entries not recognized." << endr;
+  psf.atoms.resize(total[NATOM]);
+  psf.bonds.resize(total[NBOND]);
+  psf.angles.resize(total[NTHETA]);
+  psf.dihedrals.resize(total[NPHI]);
+  psf.impropers.resize(total[NIMPHI]);
+  psf.donors.resize(total[NDON]);
+  psf.acceptors.resize(total[NACC]);
+  psf.nonbondeds.resize(total[NNB]);
+  psf.ngrp.resize(total[NGRP]);
+
+  // Records are independent, parse them concurrently
+  const int numSections = static_cast<int>(sections.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+  for (int i = 0; i < numSections; i++)
+    sections[i].ok = parseSection(sections[i], psf);
+
+  // Report in file order
+  for (unsigned int i = 0; i < sections.size(); i++) {
+    const Section &section = sections[i];
+
+    for (unsigned int j = 0; j < section.residues.size(); j++)
+      report << recoverable
+             << "[PSF::read] Expecting a number for residue sequence. "
+             << "I do not know what to do with \'" << section.residues[j]
+             << "\'." << endr;
+
+    if (section.type == UNKNOWN)
+      report << recoverable << "[PSF::read] Record " << section.keyword <<
+      " with " << section.count << " entries not recognized." << endr;
+
+    if (!section.ok) {
+      if (section.type == NNB || section.type == NGRP)
+        report << recoverable << "[PSF::read] Expecting " <<
+        section.count << (section.type == NNB ? " NNB" : " NGRP") <<
+        ", read " << section.read << ", reached end of file." << endr;
+      else
+        file.setstate(ios::failbit);
+      return false;
+    }
   }
-  close();
-  return !file.fail();
+
+  return true;
 }
 
 PSF *PSFReader::orphanPSF() {
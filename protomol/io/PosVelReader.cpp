@@ -6,17 +6,22 @@
 #include <protomol/io/XYZBinReader.h>
 #include <protomol/io/XYZReader.h>
 #include <protomol/io/PDBReader.h>
+#include <protomol/io/XTCTrajectoryReader.h>
+#include <protomol/io/MappedTrajectoryReader.h>
+#include <protomol/base/Report.h>
+#include <protomol/base/Exception.h>
 
 using namespace std;
+using namespace ProtoMol::Report;
 using namespace ProtoMol;
 //____ File
 
 PosVelReader::PosVelReader() :
-  filename(""), myOk(true), myType(PosVelReaderType::UNDEFINED) {}
+  filename(""), myOk(true), myType(PosVelReaderType::UNDEFINED), myFrame(0) {}
 
 PosVelReader::PosVelReader(const string &filename) :
   filename(filename), myOk(SystemUtilities::isAccessible(filename)),
-  myType(PosVelReaderType::UNDEFINED) {}
+  myType(PosVelReaderType::UNDEFINED), myFrame(0) {}
 
 PosVelReader::operator void*() const {
   return !myOk ? 0 : const_cast<PosVelReader *>(this);
@@ -52,6 +57,12 @@ bool PosVelReader::tryFormat(PosVelReaderType::Enum type) {
   } else if (type == PosVelReaderType::XYZBIN) {
     XYZBinReader reader(filename);
     return reader.tryFormat();
+  } else if (type == PosVelReaderType::XTC) {
+    XTCTrajectoryReader reader(filename);
+    return reader.tryFormat();
+  } else if (type == PosVelReaderType::DCD) {
+    MappedTrajectoryReader reader(filename);
+    return reader.getFormat() == MappedTrajectoryReader::DCD;
   } else
     return SystemUtilities::isAccessible(filename);
 }
@@ -60,6 +71,42 @@ PosVelReaderType PosVelReader::getType() const {
   return myType;
 }
 
+bool PosVelReader::readTrajectory(Vector3DBlock &coords) {
+  // A single XYZ frame keeps its atom names through XYZReader
+  MappedTrajectoryReader reader(filename);
+  if (myFrame == 0 && reader.getFormat() != MappedTrajectoryReader::DCD)
+    return false;
+
+  if (!reader.is_open()) {
+    if (myFrame != 0) {
+      report << recoverable << "Frame " << myFrame << " of '" << filename
+             << "' requested, only DCD and XYZ trajectories have frames."
+             << endr;
+      myOk = false;
+    }
+
+    return false;
+  }
+
+  myType = reader.getFormat() == MappedTrajectoryReader::DCD ?
+    PosVelReaderType::DCD : PosVelReaderType::XYZ;
+
+  const int frame = myFrame < 0 ? (int)reader.getNumFrames() + myFrame :
+    myFrame;
+
+  try {
+    if (frame < 0) THROWS("Frame " << myFrame << " out of range");
+    reader.doRead(frame, coords);
+    myOk = true;
+
+  } catch (const Exception &e) {
+    report << recoverable << e.getMessage() << endr;
+    myOk = false;
+  }
+
+  return true;
+}
+
 namespace ProtoMol {
   PosVelReader &operator>>(PosVelReader &posReader, PDB &pdb) {
     posReader.myType = PosVelReaderType::UNDEFINED;
@@ -78,6 +125,13 @@ namespace ProtoMol {
   PosVelReader &operator>>(PosVelReader &posReader, XYZ &xyz) {
     posReader.myType = PosVelReaderType::UNDEFINED;
 
+    // DCD or XYZ trajectory, any frame
+    if (posReader.readTrajectory(xyz.coords)) {
+      xyz.names.resize(xyz.coords.size(), "NONAME");
+      return posReader;
+    }
+    if (!posReader.myOk) return posReader;
+
     // XYZ
     XYZReader xyzReader(posReader.filename);
     posReader.myOk = xyzReader.tryFormat();
@@ -95,6 +149,16 @@ namespace ProtoMol {
       }
     }
 
+    // XTC, first frame
+    if (!posReader.myOk) {
+      XTCTrajectoryReader xtcReader(posReader.filename);
+      if (xtcReader.tryFormat()) {
+        posReader.myOk = (xtcReader.read(xyz.coords) ? true : false);
+        xyz.names.resize(xyz.coords.size(), "NONAME");
+        posReader.myType = PosVelReaderType::XTC;
+      }
+    }
+
     // PDB
     if (!posReader.myOk) {
       PDBReader pdbReader(posReader.filename);
@@ -109,7 +173,11 @@ namespace ProtoMol {
 
   PosVelReader &operator>>(PosVelReader &posReader, Vector3DBlock &coords) {
     posReader.myType = PosVelReaderType::UNDEFINED;
-    
+
+    // DCD or XYZ trajectory, any frame
+    if (posReader.readTrajectory(coords)) return posReader;
+    if (!posReader.myOk) return posReader;
+
     // XYZ
     XYZReader xyzReader(posReader.filename);
     posReader.myOk = xyzReader.tryFormat();
@@ -127,6 +195,15 @@ namespace ProtoMol {
       }
     }
     
+    // XTC, first frame
+    if (!posReader.myOk) {
+      XTCTrajectoryReader xtcReader(posReader.filename);
+      if (xtcReader.tryFormat()) {
+        posReader.myOk = (xtcReader.read(coords) ? true : false);
+        posReader.myType = PosVelReaderType::XTC;
+      }
+    }
+
     // PDB
     if (!posReader.myOk) {
       PDBReader pdbReader(posReader.filename);
@@ -28,12 +28,22 @@ namespace ProtoMol {
     bool open(const std::string &filename);
     bool tryFormat(PosVelReaderType::Enum type);
 
+    /// Frame of a DCD or XYZ trajectory to read, negative counts from the
+    /// last frame; other formats only have frame 0
+    void setFrame(int frame) {myFrame = frame;}
+    int getFrame() const {return myFrame;}
+
     operator void*() const;
     bool operator!() const;
     // enable expression testing
 
     PosVelReaderType getType() const;
 
+  private:
+    /// Reads myFrame of a DCD or XYZ trajectory, false if neither or if
+    /// frame 0 of an XYZ file is read the usual way
+    bool readTrajectory(Vector3DBlock &coords);
+
     //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
     // Friends
     //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -50,6 +60,7 @@ namespace ProtoMol {
     std::string filename;
     bool myOk;
     PosVelReaderType myType;
+    int myFrame;
   };
 }
 #endif
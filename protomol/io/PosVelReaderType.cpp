@@ -10,5 +10,7 @@ const string PosVelReaderEnum::str[static_cast<int>(LAST) -
   string("undefined"),  // Returned when no enum matches
   string("PDB"),
   string("XYZ"),
-  string("XYZBin")
+  string("XYZBin"),
+  string("XTC"),
+  string("DCD")
 };
@@ -16,6 +16,8 @@ namespace ProtoMol {
       PDB,
       XYZ,
       XYZBIN,
+      XTC,
+      DCD,
       LAST              // Used internally only
     };
 
@@ -0,0 +1,210 @@
+#include <protomol/io/TextTokenizer.h>
+
+#include <protomol/base/StringUtilities.h>
+#include <protomol/type/TypeSelection.h>
+
+#include <cstring>
+#include <cctype>
+
+using namespace std;
+using namespace ProtoMol;
+
+//____TextTokenizer
+
+namespace {
+  typedef TypeSelection::Int<8>::type int64;
+
+  // Exactly representable powers of ten
+  const double POW10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12,
+    1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+  };
+
+  // Largest integer mantissa every double can hold exactly, 2^53
+  const int64 MAX_MANTISSA = static_cast<int64>(1) << 53;
+
+  bool isDigit(char c) {return c >= '0' && c <= '9';}
+
+  // Plain [+-]ddd[.ddd][(e|E)[+-]ddd] spanning the whole range. Only
+  // accepted if the mantissa and the power of ten are both exact doubles,
+  // then one multiplication or division is correctly rounded and equals
+  // strtod (Clinger's fast path).
+  bool fastReal(const char *p, const char *end, double &d) {
+    bool negative = false;
+    if (p < end && (*p == '+' || *p == '-')) negative = *p++ == '-';
+
+    int64 m = 0;
+    int digits = 0;
+    int scale = 0;
+    bool any = false;
+
+    for (; p < end && isDigit(*p); p++) {
+      if (m || *p != '0') {
+        if (++digits > 18) return false;
+        m = m * 10 + (*p - '0');
+      }
+      any = true;
+    }
+
+    if (p < end && *p == '.')
+      for (p++; p < end && isDigit(*p); p++) {
+        if (m || *p != '0') {
+          if (++digits > 18) return false;
+          m = m * 10 + (*p - '0');
+        }
+        scale--;
+        any = true;
+      }
+
+    if (!any) return false;
+
+    if (p < end && (*p == 'e' || *p == 'E')) {
+      p++;
+      bool negativeExp = false;
+      if (p < end && (*p == '+' || *p == '-')) negativeExp = *p++ == '-';
+      if (p == end || !isDigit(*p)) return false;
+
+      int e = 0;
+      for (; p < end && isDigit(*p); p++) {
+        e = e * 10 + (*p - '0');
+        if (e > 1000) return false;
+      }
+      scale += negativeExp ? -e : e;
+    }
+
+    if (p != end || m > MAX_MANTISSA) return false;
+
+    if (m == 0) d = 0.0;
+    else if (scale < -22 || scale > 22) return false;
+    else if (scale < 0) d = static_cast<double>(m) / POW10[-scale];
+    else d = static_cast<double>(m) * POW10[scale];
+
+    if (negative) d = -d;
+
+    return true;
+  }
+
+  // Plain [+-]ddd with at most 9 digits, always fits an int
+  bool fastInt(const char *p, const char *end, bool sign, int &i) {
+    bool negative = false;
+    if (sign && p < end && (*p == '+' || *p == '-')) negative = *p++ == '-';
+    if (p == end || end - p > 9) return false;
+
+    int v = 0;
+    for (; p < end; p++) {
+      if (!isDigit(*p)) return false;
+      v = v * 10 + (*p - '0');
+    }
+
+    i = negative ? -v : v;
+
+    return true;
+  }
+}
+
+bool TextTokenizer::nextToken(const char *&begin, const char *&end) {
+  while (myPos < myEnd && isBlank(*myPos)) myPos++;
+  if (myPos == myEnd) return false;
+
+  begin = myPos;
+  while (myPos < myEnd && !isBlank(*myPos)) myPos++;
+  end = myPos;
+
+  return true;
+}
+
+bool TextTokenizer::nextString(string &str) {
+  const char *b, *e;
+  if (!nextToken(b, e)) return false;
+  str.assign(b, e);
+
+  return true;
+}
+
+bool TextTokenizer::nextInt(int &i) {
+  const char *b, *e;
+  return nextToken(b, e) && toInt(b, e, i);
+}
+
+bool TextTokenizer::nextUInt(unsigned int &i) {
+  const char *b, *e;
+  return nextToken(b, e) && toUInt(b, e, i);
+}
+
+bool TextTokenizer::nextReal(Real &r) {
+  const char *b, *e;
+  return nextToken(b, e) && toReal(b, e, r);
+}
+
+bool TextTokenizer::nextLine(const char *&begin, const char *&end) {
+  if (myPos >= myEnd) return false;
+
+  begin = myPos;
+  const char *nl =
+    static_cast<const char *>(memchr(myPos, '\n', myEnd - myPos));
+  end = nl ? nl : myEnd;
+  myPos = nl ? nl + 1 : myEnd;
+
+  return true;
+}
+
+void TextTokenizer::skipLine() {
+  const char *b, *e;
+  nextLine(b, e);
+}
+
+void TextTokenizer::trim(const char *&begin, const char *&end) {
+  while (begin < end && isBlank(*begin)) begin++;
+  while (end > begin && isBlank(end[-1])) end--;
+}
+
+bool TextTokenizer::toInt(const char *begin, const char *end, int &i) {
+  const char *b = begin, *e = end;
+  trim(b, e);
+  if (fastInt(b, e, true, i)) return true;
+
+  return ProtoMol::toInt(string(begin, end), i);
+}
+
+bool TextTokenizer::toUInt(const char *begin, const char *end,
+                           unsigned int &i) {
+  const char *b = begin, *e = end;
+  trim(b, e);
+  int v;
+  if (fastInt(b, e, false, v)) {
+    i = static_cast<unsigned int>(v);
+    return true;
+  }
+
+  return ProtoMol::toUInt(string(begin, end), i);
+}
+
+bool TextTokenizer::toReal(const char *begin, const char *end, Real &r) {
+  const char *b = begin, *e = end;
+  trim(b, e);
+  double d;
+  if (fastReal(b, e, d)) {
+    r = static_cast<Real>(d);
+    return true;
+  }
+
+  return ProtoMol::toReal(string(begin, end), r);
+}
+
+bool TextTokenizer::equalStart(const char *prefix, const char *begin,
+                               const char *end) {
+  for (; *prefix; prefix++, begin++)
+    if (begin == end || *begin != *prefix) return false;
+
+  return true;
+}
+
+bool TextTokenizer::equalStartNocase(const char *prefix, const char *begin,
+                                     const char *end) {
+  for (; *prefix; prefix++, begin++)
+    if (begin == end ||
+        toupper(static_cast<unsigned char>(*begin)) !=
+        toupper(static_cast<unsigned char>(*prefix))) return false;
+
+  return true;
+}
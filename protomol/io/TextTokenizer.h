@@ -0,0 +1,78 @@
+/*  -*- c++ -*-  */
+#ifndef TEXTTOKENIZER_H
+#define TEXTTOKENIZER_H
+
+#include <protomol/type/Real.h>
+
+#include <string>
+
+namespace ProtoMol {
+  //____TextTokenizer
+
+  /**
+   * Tokenizer over an immutable character range, typically a MappedFile.
+   * Tokens and lines are returned as [begin, end) views into the range, so
+   * nothing is copied unless the caller asks for a std::string.
+   *
+   * The number conversions are locale-free and give exactly the same
+   * results as toInt()/toReal() from StringUtilities; only plain decimal
+   * numbers are converted inline, anything else (exponents out of the
+   * exact range, hex, garbage, ...) is handed to the StringUtilities
+   * version.
+   */
+  class TextTokenizer {
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // Constructors, destructors (both default here), assignment
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    TextTokenizer(const char *begin, const char *end) :
+      myPos(begin), myEnd(end) {}
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // New methods of class TextTokenizer
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    bool eof() const {return myPos >= myEnd;}
+    const char *getPos() const {return myPos;}
+    const char *getEnd() const {return myEnd;}
+    void setPos(const char *pos) {myPos = pos;}
+
+    /// Next blank separated token, crossing line ends
+    bool nextToken(const char *&begin, const char *&end);
+    bool nextString(std::string &str);
+    bool nextInt(int &i);
+    bool nextUInt(unsigned int &i);
+    bool nextReal(Real &r);
+
+    /// Rest of the current line without the line end, moves to the next line
+    bool nextLine(const char *&begin, const char *&end);
+    void skipLine();
+
+    /// Removes blanks (" \t\n\r") at both ends, as removeBeginEndBlanks()
+    static void trim(const char *&begin, const char *&end);
+    static bool isBlank(char c) {
+      return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    /// Same value and return value as toInt(const std::string&, int&)
+    static bool toInt(const char *begin, const char *end, int &i);
+    /// Same value and return value as toUInt(const std::string&, ...)
+    static bool toUInt(const char *begin, const char *end, unsigned int &i);
+    /// Same value and return value as toReal(const std::string&, Real&)
+    static bool toReal(const char *begin, const char *end, Real &r);
+
+    /// True if [begin, end) starts with the null terminated prefix
+    static bool equalStart(const char *prefix, const char *begin,
+                           const char *end);
+    static bool equalStartNocase(const char *prefix, const char *begin,
+                                 const char *end);
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // My data members
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  private:
+    const char *myPos;
+    const char *myEnd;
+  };
+}
+#endif /* TEXTTOKENIZER_H */
@@ -0,0 +1,569 @@
+#include <protomol/io/XTCCoordinateCodec.h>
+
+#include <protomol/base/SystemUtilities.h>
+#include <protomol/base/Exception.h>
+
+#include <climits>
+#include <cmath>
+#include <cstring>
+
+using namespace std;
+using namespace ProtoMol;
+
+//____XTCCoordinateCodec
+
+namespace {
+  // Table of integers whose cube fits into the index number of bits, taken
+  // from the xdr3dfcoord specification. magicints[FIRSTIDX - 1] == 0.
+  const int magicints[] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0,
+    8, 10, 12, 16, 20, 25, 32, 40, 50, 64,
+    80, 101, 128, 161, 203, 256, 322, 406, 512, 645,
+    812, 1024, 1290, 1625, 2048, 2580, 3250, 4096, 5060, 6501,
+    8192, 10321, 13003, 16384, 20642, 26007, 32768, 41285, 52015, 65536,
+    82570, 104031, 131072, 165140, 208063, 262144, 330280, 416127, 524287,
+    660561, 832255, 1048576, 1321122, 1664510, 2097152, 2642245, 3329021,
+    4194304, 5284491, 6658042, 8388607, 10568983, 13316085, 16777216
+  };
+
+  const int FIRSTIDX = 9;
+  const int LASTIDX = sizeof(magicints) / sizeof(*magicints);
+
+  // Scaled coordinates beyond this can not be represented as int
+  const float MAXABS = static_cast<float>(INT_MAX - 2);
+
+  inline int absDiff(int a, int b) {return a > b ? a - b : b - a;}
+
+  // Number of bits needed to store an integer of value size
+  int sizeOfInt(unsigned int size) {
+    unsigned int num = 1;
+    int numBits = 0;
+    while (size >= num && numBits < 32) {
+      numBits++;
+      num <<= 1;
+    }
+
+    return numBits;
+  }
+
+  // Number of bits needed to store the product of the three sizes
+  int sizeOfInts(const unsigned int sizes[3]) {
+    unsigned int bytes[32];
+    unsigned int numBytes = 1;
+    bytes[0] = 1;
+    for (int i = 0; i < 3; i++) {
+      unsigned int tmp = 0;
+      unsigned int cnt;
+      for (cnt = 0; cnt < numBytes; cnt++) {
+        tmp = bytes[cnt] * sizes[i] + tmp;
+        bytes[cnt] = tmp & 0xff;
+        tmp >>= 8;
+      }
+
+      while (tmp != 0) {
+        bytes[cnt++] = tmp & 0xff;
+        tmp >>= 8;
+      }
+      numBytes = cnt;
+    }
+
+    unsigned int num = 1;
+    int numBits = 0;
+    numBytes--;
+    while (bytes[numBytes] >= num) {
+      numBits++;
+      num *= 2;
+    }
+
+    return numBits + numBytes * 8;
+  }
+}
+
+XTCCoordinateCodec::XTCCoordinateCodec() {}
+
+void XTCCoordinateCodec::putInt(vector<char> &out, int32 value) {
+  if (ISLITTLEENDIAN) swapBytes(value);
+  const char *c = reinterpret_cast<const char *>(&value);
+  out.insert(out.end(), c, c + 4);
+}
+
+void XTCCoordinateCodec::putFloat(vector<char> &out, float4 value) {
+  if (ISLITTLEENDIAN) swapBytes(value);
+  const char *c = reinterpret_cast<const char *>(&value);
+  out.insert(out.end(), c, c + 4);
+}
+
+XTCCoordinateCodec::int32 XTCCoordinateCodec::getInt(const char *in) {
+  int32 value;
+  memcpy(&value, in, 4);
+  if (ISLITTLEENDIAN) swapBytes(value);
+  return value;
+}
+
+XTCCoordinateCodec::float4 XTCCoordinateCodec::getFloat(const char *in) {
+  float4 value;
+  memcpy(&value, in, 4);
+  if (ISLITTLEENDIAN) swapBytes(value);
+  return value;
+}
+
+void XTCCoordinateCodec::sendBits(int numBits, unsigned int num) {
+  unsigned char *cbuf = &myBits.data[0];
+  unsigned int cnt = myBits.count;
+  int lastBits = myBits.lastBits;
+  unsigned int lastByte = myBits.lastByte;
+
+  while (numBits >= 8) {
+    lastByte = (lastByte << 8) | (num >> (numBits - 8));
+    cbuf[cnt++] = static_cast<unsigned char>(lastByte >> lastBits);
+    numBits -= 8;
+  }
+
+  if (numBits > 0) {
+    lastByte = (lastByte << numBits) | num;
+    lastBits += numBits;
+    if (lastBits >= 8) {
+      lastBits -= 8;
+      cbuf[cnt++] = static_cast<unsigned char>(lastByte >> lastBits);
+    }
+  }
+
+  myBits.count = cnt;
+  myBits.lastBits = lastBits;
+  myBits.lastByte = lastByte;
+  if (lastBits > 0)
+    cbuf[cnt] = static_cast<unsigned char>(lastByte << (8 - lastBits));
+}
+
+void XTCCoordinateCodec::sendInts(int numBits, const unsigned int sizes[3],
+                                  const unsigned int nums[3]) {
+  unsigned int bytes[32];
+  int numBytes = 0;
+  unsigned int tmp = nums[0];
+  do {
+    bytes[numBytes++] = tmp & 0xff;
+    tmp >>= 8;
+  } while (tmp != 0);
+
+  for (int i = 1; i < 3; i++) {
+    // One step multiply
+    tmp = nums[i];
+    int cnt;
+    for (cnt = 0; cnt < numBytes; cnt++) {
+      tmp = bytes[cnt] * sizes[i] + tmp;
+      bytes[cnt] = tmp & 0xff;
+      tmp >>= 8;
+    }
+
+    while (tmp != 0) {
+      bytes[cnt++] = tmp & 0xff;
+      tmp >>= 8;
+    }
+    numBytes = cnt;
+  }
+
+  if (numBits >= numBytes * 8) {
+    for (int i = 0; i < numBytes; i++)
+      sendBits(8, bytes[i]);
+    sendBits(numBits - numBytes * 8, 0);
+  } else {
+    int i;
+    for (i = 0; i < numBytes - 1; i++)
+      sendBits(8, bytes[i]);
+    sendBits(numBits - (numBytes - 1) * 8, bytes[i]);
+  }
+}
+
+int XTCCoordinateCodec::receiveBits(int numBits) {
+  const unsigned int mask = numBits < 32 ? (1u << numBits) - 1 : ~0u;
+  unsigned int cnt = myBits.count;
+  unsigned int lastBits = static_cast<unsigned int>(myBits.lastBits);
+  unsigned int lastByte = myBits.lastByte;
+
+  // Whole bytes plus one more if the bits left of the last byte are short
+  const unsigned int need = numBits / 8 +
+    (static_cast<unsigned int>(numBits % 8) > lastBits ? 1 : 0);
+  if (need > myBits.data.size() - cnt)
+    THROWS("Truncated XTC coordinate stream, " << numBits << " bits at byte "
+           << cnt << " of " << myBits.data.size());
+  const unsigned char *cbuf = need ? &myBits.data[0] : 0;
+
+  unsigned int num = 0;
+  while (numBits >= 8) {
+    lastByte = (lastByte << 8) | cbuf[cnt++];
+    num |= (lastByte >> lastBits) << (numBits - 8);
+    numBits -= 8;
+  }
+
+  if (numBits > 0) {
+    if (lastBits < static_cast<unsigned int>(numBits)) {
+      lastBits += 8;
+      lastByte = (lastByte << 8) | cbuf[cnt++];
+    }
+    lastBits -= numBits;
+    num |= (lastByte >> lastBits) & ((1u << numBits) - 1);
+  }
+
+  myBits.count = cnt;
+  myBits.lastBits = static_cast<int>(lastBits);
+  myBits.lastByte = lastByte;
+
+  return static_cast<int>(num & mask);
+}
+
+void XTCCoordinateCodec::receiveInts(int numBits, const unsigned int sizes[3],
+                                     int nums[3]) {
+  unsigned int bytes[32];
+  int numBytes = 0;
+  bytes[1] = bytes[2] = bytes[3] = 0;
+
+  while (numBits > 8) {
+    bytes[numBytes++] = receiveBits(8);
+    numBits -= 8;
+  }
+  if (numBits > 0)
+    bytes[numBytes++] = receiveBits(numBits);
+
+  for (int i = 2; i > 0; i--) {
+    unsigned int num = 0;
+    for (int j = numBytes - 1; j >= 0; j--) {
+      num = (num << 8) | bytes[j];
+      const unsigned int p = num / sizes[i];
+      bytes[j] = p;
+      num = num - p * sizes[i];
+    }
+    nums[i] = static_cast<int>(num);
+  }
+  nums[0] = static_cast<int>(bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) |
+                             (bytes[3] << 24));
+}
+
+bool XTCCoordinateCodec::compress(const float4 *x, unsigned int natoms,
+                                  float4 precision, vector<char> &out) {
+  putInt(out, static_cast<int32>(natoms));
+
+  // Few coordinates are not worth compressing, write plain floats
+  if (natoms <= 9) {
+    for (unsigned int i = 0; i < 3 * natoms; i++)
+      putFloat(out, x[i]);
+
+    return true;
+  }
+
+  putFloat(out, precision);
+
+  const unsigned int size3 = 3 * natoms;
+  myInts.resize(size3);
+  int *ip = &myInts[0];
+
+  bool ok = true;
+  int minint[3] = {INT_MAX, INT_MAX, INT_MAX};
+  int maxint[3] = {INT_MIN, INT_MIN, INT_MIN};
+  int mindiff = INT_MAX;
+  int old[3] = {0, 0, 0};
+
+  // Scale to nearest integer, collect bounds and smallest neighbor distance
+  for (unsigned int i = 0; i < natoms; i++) {
+    int lint[3];
+    for (unsigned int k = 0; k < 3; k++) {
+      const float4 scaled = x[3 * i + k] * precision;
+      const float4 lf = static_cast<float4>
+        (scaled >= 0.0 ? scaled + 0.5 : scaled - 0.5);
+      if (fabs(lf) > MAXABS) ok = false;
+      lint[k] = static_cast<int>(lf);
+      if (lint[k] < minint[k]) minint[k] = lint[k];
+      if (lint[k] > maxint[k]) maxint[k] = lint[k];
+      ip[3 * i + k] = lint[k];
+    }
+
+    const int diff = absDiff(old[0], lint[0]) + absDiff(old[1], lint[1]) +
+      absDiff(old[2], lint[2]);
+    if (diff < mindiff && i > 0) mindiff = diff;
+    old[0] = lint[0];
+    old[1] = lint[1];
+    old[2] = lint[2];
+  }
+
+  for (unsigned int k = 0; k < 3; k++)
+    putInt(out, minint[k]);
+  for (unsigned int k = 0; k < 3; k++)
+    putInt(out, maxint[k]);
+
+  // Turning values unsigned by subtracting minint would overflow
+  for (unsigned int k = 0; k < 3; k++)
+    if (static_cast<float>(maxint[k]) - static_cast<float>(minint[k]) >=
+        MAXABS) ok = false;
+
+  unsigned int sizeint[3], bitsizeint[3] = {0, 0, 0};
+  for (unsigned int k = 0; k < 3; k++)
+    sizeint[k] = maxint[k] - minint[k] + 1;
+
+  // Sizes too big to be multiplied are sent one by one
+  int bitsize = 0;
+  if ((sizeint[0] | sizeint[1] | sizeint[2]) > 0xffffff)
+    for (unsigned int k = 0; k < 3; k++)
+      bitsizeint[k] = sizeOfInt(sizeint[k]);
+  else
+    bitsize = sizeOfInts(sizeint);
+
+  int smallidx = FIRSTIDX;
+  while (smallidx < LASTIDX - 1 && magicints[smallidx] < mindiff)
+    smallidx++;
+  putInt(out, smallidx);
+
+  const int maxidx = min(LASTIDX - 1, smallidx + 8);
+  const int minidx = maxidx - 8; // often equal smallidx
+  int smaller = magicints[max(FIRSTIDX, smallidx - 1)] / 2;
+  int smallnum = magicints[smallidx] / 2;
+  unsigned int sizesmall[3];
+  sizesmall[0] = sizesmall[1] = sizesmall[2] = magicints[smallidx];
+  const int larger = magicints[maxidx] / 2;
+
+  // At most 96 bits per large and 72 bits per small triple plus flags
+  myBits.reset();
+  myBits.data.resize(13 * natoms + 16);
+
+  unsigned int tmpcoord[30];
+  int prevcoord[3] = {0, 0, 0};
+  int prevrun = -1;
+  unsigned int i = 0;
+  while (i < natoms) {
+    int *thiscoord = ip + 3 * i;
+    bool isSmall = false;
+    int isSmaller;
+    if (smallidx < maxidx && i >= 1 &&
+        absDiff(thiscoord[0], prevcoord[0]) < larger &&
+        absDiff(thiscoord[1], prevcoord[1]) < larger &&
+        absDiff(thiscoord[2], prevcoord[2]) < larger)
+      isSmaller = 1;
+    else if (smallidx > minidx)
+      isSmaller = -1;
+    else
+      isSmaller = 0;
+
+    if (i + 1 < natoms &&
+        absDiff(thiscoord[0], thiscoord[3]) < smallnum &&
+        absDiff(thiscoord[1], thiscoord[4]) < smallnum &&
+        absDiff(thiscoord[2], thiscoord[5]) < smallnum) {
+      // Interchange first with second atom for better compression of
+      // water molecules
+      for (unsigned int k = 0; k < 3; k++)
+        std::swap(thiscoord[k], thiscoord[k + 3]);
+      isSmall = true;
+    }
+
+    for (unsigned int k = 0; k < 3; k++)
+      tmpcoord[k] = thiscoord[k] - minint[k];
+
+    if (bitsize == 0)
+      for (unsigned int k = 0; k < 3; k++)
+        sendBits(bitsizeint[k], tmpcoord[k]);
+    else
+      sendInts(bitsize, sizeint, tmpcoord);
+
+    for (unsigned int k = 0; k < 3; k++)
+      prevcoord[k] = thiscoord[k];
+    thiscoord += 3;
+    i++;
+
+    int run = 0;
+    if (!isSmall && isSmaller == -1)
+      isSmaller = 0;
+
+    while (isSmall && run < 8 * 3) {
+      if (isSmaller == -1) {
+        const int dx = thiscoord[0] - prevcoord[0];
+        const int dy = thiscoord[1] - prevcoord[1];
+        const int dz = thiscoord[2] - prevcoord[2];
+        if (dx * dx + dy * dy + dz * dz >= smaller * smaller)
+          isSmaller = 0;
+      }
+
+      for (unsigned int k = 0; k < 3; k++) {
+        tmpcoord[run++] = thiscoord[k] - prevcoord[k] + smallnum;
+        prevcoord[k] = thiscoord[k];
+      }
+
+      i++;
+      thiscoord += 3;
+      isSmall = (i < natoms &&
+                 absDiff(thiscoord[0], prevcoord[0]) < smallnum &&
+                 absDiff(thiscoord[1], prevcoord[1]) < smallnum &&
+                 absDiff(thiscoord[2], prevcoord[2]) < smallnum);
+    }
+
+    if (run != prevrun || isSmaller != 0) {
+      prevrun = run;
+      sendBits(1, 1); // flag the change in run-length
+      sendBits(5, run + isSmaller + 1);
+    } else
+      sendBits(1, 0); // run-length did not change
+
+    for (int k = 0; k < run; k += 3)
+      sendInts(smallidx, sizesmall, &tmpcoord[k]);
+
+    if (isSmaller != 0) {
+      smallidx += isSmaller;
+      if (isSmaller < 0) {
+        smallnum = smaller;
+        smaller = smallidx > FIRSTIDX ? magicints[smallidx - 1] / 2 : 0;
+      } else {
+        smaller = smallnum;
+        smallnum = magicints[smallidx] / 2;
+      }
+      sizesmall[0] = sizesmall[1] = sizesmall[2] = magicints[smallidx];
+    }
+  }
+
+  unsigned int numBytes = myBits.count;
+  if (myBits.lastBits != 0) numBytes++;
+
+  putInt(out, static_cast<int32>(numBytes));
+  const char *c = reinterpret_cast<const char *>(&myBits.data[0]);
+  out.insert(out.end(), c, c + numBytes);
+
+  // XDR opaque data is padded to a multiple of four bytes
+  out.insert(out.end(), (4 - numBytes % 4) % 4, 0);
+
+  return ok;
+}
+
+unsigned int XTCCoordinateCodec::payloadSize(const char *in, unsigned int size,
+                                             unsigned int natoms) {
+  if (natoms <= 9) {
+    const unsigned int need = 4 + 12 * natoms;
+    return size >= need ? need : 0;
+  }
+
+  // natoms, precision, minint[3], maxint[3], smallidx, byte count
+  const unsigned int fixed = 4 * 10;
+  if (size < fixed) return 0;
+
+  const int32 numBytes = getInt(in + fixed - 4);
+  if (numBytes < 0) return 0;
+
+  const unsigned int need = fixed + ((numBytes + 3) / 4) * 4;
+  return size >= need ? need : 0;
+}
+
+bool XTCCoordinateCodec::decompress(const char *in, unsigned int size,
+                                    unsigned int natoms, float4 *x,
+                                    float4 &precision, unsigned int &used) {
+  used = payloadSize(in, size, natoms);
+  if (!used) return false;
+
+  if (getInt(in) != static_cast<int32>(natoms)) return false;
+  in += 4;
+
+  if (natoms <= 9) {
+    precision = -1;
+    for (unsigned int i = 0; i < 3 * natoms; i++)
+      x[i] = getFloat(in + 4 * i);
+
+    return true;
+  }
+
+  precision = getFloat(in);
+  int minint[3], maxint[3];
+  for (unsigned int k = 0; k < 3; k++) {
+    minint[k] = getInt(in + 4 + 4 * k);
+    maxint[k] = getInt(in + 16 + 4 * k);
+  }
+
+  int smallidx = getInt(in + 28);
+  if (smallidx < FIRSTIDX || smallidx >= LASTIDX) return false;
+
+  const unsigned int numBytes = getInt(in + 32);
+
+  unsigned int sizeint[3], bitsizeint[3] = {0, 0, 0};
+  for (unsigned int k = 0; k < 3; k++)
+    sizeint[k] = maxint[k] - minint[k] + 1;
+
+  int bitsize = 0;
+  if ((sizeint[0] | sizeint[1] | sizeint[2]) > 0xffffff)
+    for (unsigned int k = 0; k < 3; k++)
+      bitsizeint[k] = sizeOfInt(sizeint[k]);
+  else
+    bitsize = sizeOfInts(sizeint);
+
+  int smaller = magicints[max(FIRSTIDX, smallidx - 1)] / 2;
+  int smallnum = magicints[smallidx] / 2;
+  unsigned int sizesmall[3];
+  sizesmall[0] = sizesmall[1] = sizesmall[2] = magicints[smallidx];
+
+  // The bit reader throws rather than read past the stream
+  myBits.reset();
+  myBits.data.assign(in + 36, in + 36 + numBytes);
+
+  myInts.resize(3 * natoms);
+  int *ip = &myInts[0];
+  const float4 invPrecision = 1.0f / precision;
+  float4 *lfp = x;
+
+  int run = 0;
+  unsigned int i = 0;
+  while (i < natoms) {
+    int *thiscoord = ip + 3 * i;
+
+    if (bitsize == 0)
+      for (unsigned int k = 0; k < 3; k++)
+        thiscoord[k] = receiveBits(bitsizeint[k]);
+    else
+      receiveInts(bitsize, sizeint, thiscoord);
+
+    i++;
+    int prevcoord[3];
+    for (unsigned int k = 0; k < 3; k++) {
+      thiscoord[k] += minint[k];
+      prevcoord[k] = thiscoord[k];
+    }
+
+    int isSmaller = 0;
+    if (receiveBits(1) == 1) {
+      run = receiveBits(5);
+      isSmaller = run % 3;
+      run -= isSmaller;
+      isSmaller--;
+    }
+
+    if (run > 0) {
+      if (i + run / 3 > natoms) return false;
+
+      thiscoord += 3;
+      for (int k = 0; k < run; k += 3) {
+        receiveInts(smallidx, sizesmall, thiscoord);
+        i++;
+        for (unsigned int l = 0; l < 3; l++)
+          thiscoord[l] += prevcoord[l] - smallnum;
+
+        if (k == 0) {
+          // Interchange first with second atom, see compress()
+          for (unsigned int l = 0; l < 3; l++)
+            std::swap(thiscoord[l], prevcoord[l]);
+          for (unsigned int l = 0; l < 3; l++)
+            *lfp++ = prevcoord[l] * invPrecision;
+        } else
+          for (unsigned int l = 0; l < 3; l++)
+            prevcoord[l] = thiscoord[l];
+
+        for (unsigned int l = 0; l < 3; l++)
+          *lfp++ = thiscoord[l] * invPrecision;
+      }
+    } else
+      for (unsigned int l = 0; l < 3; l++)
+        *lfp++ = thiscoord[l] * invPrecision;
+
+    smallidx += isSmaller;
+    if (smallidx < FIRSTIDX || smallidx >= LASTIDX) return false;
+    if (isSmaller < 0) {
+      smallnum = smaller;
+      smaller = smallidx > FIRSTIDX ? magicints[smallidx - 1] / 2 : 0;
+    } else if (isSmaller > 0) {
+      smaller = smallnum;
+      smallnum = magicints[smallidx] / 2;
+    }
+    sizesmall[0] = sizesmall[1] = sizesmall[2] = magicints[smallidx];
+  }
+
+  return true;
+}
@@ -0,0 +1,96 @@
+/*  -*- c++ -*-  */
+#ifndef XTCCOORDINATECODEC_H
+#define XTCCOORDINATECODEC_H
+
+#include <protomol/type/TypeSelection.h>
+
+#include <vector>
+
+namespace ProtoMol {
+  //____XTCCoordinateCodec
+
+  /**
+   * Self-contained implementation of the xdr3dfcoord lossy coordinate
+   * compression used by GROMACS XTC trajectories. Coordinates are scaled by
+   * the precision, rounded to integers and packed with the adaptive
+   * small/large integer run-length scheme of the original libxdrf code, so
+   * files are bit-compatible with GROMACS, VMD and friends.
+   *
+   * The codec keeps its integer and bit buffers between calls, such that
+   * writing or reading a sequence of equally sized frames does not allocate.
+   */
+  class XTCCoordinateCodec {
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // Typedef
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    typedef TypeSelection::Int<4>::type int32;
+    typedef TypeSelection::Float<4>::type float4;
+
+  private:
+    /// Bit stream state, mirrors the (count, lastbits, lastbyte) triple
+    /// of libxdrf
+    struct BitBuffer {
+      std::vector<unsigned char> data;
+      unsigned int count;
+      int lastBits;
+      unsigned int lastByte;
+
+      BitBuffer() : count(0), lastBits(0), lastByte(0) {}
+      void reset() {count = 0; lastBits = 0; lastByte = 0;}
+    };
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // Constructors, destructors (both default here), assignment
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    XTCCoordinateCodec();
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // New methods of class XTCCoordinateCodec
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    /**
+     * Encodes natoms x,y,z triples (nm) into the XDR stream layout
+     * following the atom count of an XTC frame, i.e., everything from the
+     * second natoms field to the end of the padded opaque data. Returns
+     * false if the coordinates overflow the integer range at the given
+     * precision.
+     */
+    bool compress(const float4 *x, unsigned int natoms, float4 precision,
+                  std::vector<char> &out);
+
+    /**
+     * Decodes the compressed payload (starting at the natoms field) into
+     * x. The number of bytes consumed is returned in used, false on a
+     * corrupt stream. Throws if the bits of the stream run out.
+     */
+    bool decompress(const char *in, unsigned int size, unsigned int natoms,
+                    float4 *x, float4 &precision, unsigned int &used);
+
+    /// Size in bytes of the compressed payload at in, 0 if not complete
+    static unsigned int payloadSize(const char *in, unsigned int size,
+                                    unsigned int natoms);
+
+    /// XDR helpers, big endian 4 byte values
+    static void putInt(std::vector<char> &out, int32 value);
+    static void putFloat(std::vector<char> &out, float4 value);
+    static int32 getInt(const char *in);
+    static float4 getFloat(const char *in);
+
+  private:
+    void sendBits(int numBits, unsigned int num);
+    void sendInts(int numBits, const unsigned int sizes[3],
+                  const unsigned int nums[3]);
+    int receiveBits(int numBits);
+    void receiveInts(int numBits, const unsigned int sizes[3], int nums[3]);
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // My data members
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  private:
+    std::vector<int> myInts;
+    BitBuffer myBits;
+  };
+}
+#endif /* XTCCOORDINATECODEC_H */
@@ -0,0 +1,138 @@
+#include <protomol/io/XTCTrajectoryReader.h>
+
+#include <protomol/base/Report.h>
+#include <protomol/base/PMConstants.h>
+#include <protomol/base/Exception.h>
+
+using namespace std;
+using namespace ProtoMol::Report;
+using namespace ProtoMol;
+
+//____XTCTrajectoryReader
+
+namespace {
+  const int XTC_MAGIC = 1995;
+  // magic, natoms, step, time and 3x3 box
+  const unsigned int XTC_HEADER = 13 * 4;
+  // natoms, precision, minint[3], maxint[3], smallidx, byte count
+  const unsigned int XTC_COORD_HEADER = 10 * 4;
+}
+
+XTCTrajectoryReader::XTCTrajectoryReader() :
+  Reader(ios::binary), xyz(0), myStep(0), myTime(0.0), myPrecision(0.0) {}
+
+XTCTrajectoryReader::XTCTrajectoryReader(const string &filename) :
+  Reader(ios::binary, filename), xyz(0), myStep(0), myTime(0.0),
+  myPrecision(0.0) {}
+
+XTCTrajectoryReader::~XTCTrajectoryReader() {
+  if (xyz) delete xyz;
+}
+
+bool XTCTrajectoryReader::tryFormat() {
+  if (!open()) return false;
+
+  char head[8];
+  File::read(head, 8);
+  const bool ok = !file.fail() &&
+    XTCCoordinateCodec::getInt(head) == XTC_MAGIC &&
+    XTCCoordinateCodec::getInt(head + 4) >= 0;
+  close();
+
+  return ok;
+}
+
+bool XTCTrajectoryReader::read() {
+  if (!xyz) xyz = new Vector3DBlock();
+  return read(*xyz);
+}
+
+bool XTCTrajectoryReader::read(Vector3DBlock &coords) {
+  try {
+    doRead(coords);
+    return true;
+
+  } catch (const Exception &e) {}
+
+  return false;
+}
+
+void XTCTrajectoryReader::doRead(Vector3DBlock &coords) {
+  if (!is_open())
+    if (!open()) THROW("Open failed");
+
+  // Frame header
+  char head[XTC_HEADER];
+  File::read(head, XTC_HEADER);
+  if (file.fail()) THROW("No more frames");
+
+  if (XTCCoordinateCodec::getInt(head) != XTC_MAGIC)
+    THROWS("Invalid XTC magic number in " << getFilename());
+
+  const int32 natoms = XTCCoordinateCodec::getInt(head + 4);
+  if (natoms < 0) THROWS("Invalid XTC atom count " << natoms);
+
+  myStep = XTCCoordinateCodec::getInt(head + 8);
+  myTime = XTCCoordinateCodec::getFloat(head + 12);
+  for (unsigned int i = 0; i < 3; i++)
+    for (unsigned int j = 0; j < 3; j++)
+      myBox[i][j] = XTCCoordinateCodec::getFloat(head + 16 + 12 * i + 4 * j) *
+        Constant::NM_ANGSTROM;
+
+  // Coordinate payload, fixed part then the padded compressed bytes
+  unsigned int size = natoms <= 9 ? 4 + 12 * natoms : XTC_COORD_HEADER;
+  myBuffer.resize(size);
+  File::read(&myBuffer[0], size);
+  if (file.fail()) THROWS("XTC read error at frame step " << myStep);
+
+  if (natoms > 9) {
+    const int32 numBytes =
+      XTCCoordinateCodec::getInt(&myBuffer[XTC_COORD_HEADER - 4]);
+    if (numBytes < 0) THROWS("Invalid XTC byte count " << numBytes);
+
+    const unsigned int padded = ((numBytes + 3) / 4) * 4;
+    myBuffer.resize(size + padded);
+    File::read(&myBuffer[size], padded);
+    if (file.fail()) THROWS("Truncated XTC frame at step " << myStep);
+    size += padded;
+  }
+
+  myX.resize(3 * natoms);
+  float4 precision = 0;
+  unsigned int used = 0;
+  if (!myCodec.decompress(&myBuffer[0], size, natoms,
+                          natoms ? &myX[0] : 0, precision, used))
+    THROWS("Corrupt XTC coordinates at step " << myStep);
+  myPrecision = precision;
+
+  coords.resize(natoms);
+  for (int i = 0; i < 3 * natoms; i++)
+    coords.c[i] = myX[i] * Constant::NM_ANGSTROM;
+}
+
+Vector3DBlock *XTCTrajectoryReader::orphanXYZ() {
+  Vector3DBlock *tmp = xyz;
+  xyz = 0;
+  return tmp;
+}
+
+namespace ProtoMol {
+  XTCTrajectoryReader &operator>>(XTCTrajectoryReader &reader,
+                                  Vector3DBlock &coords) {
+    try {
+      reader.doRead(coords);
+
+    } catch (const Exception &e) {
+      THROWSC("Failed to read XTC file '" << reader.getFilename() << "'", e);
+    }
+
+    return reader;
+  }
+
+  XTCTrajectoryReader &operator>>(XTCTrajectoryReader &reader, XYZ &xyz) {
+    reader >> xyz.coords;
+    xyz.names.resize(xyz.coords.size(), "NONAME");
+
+    return reader;
+  }
+}
@@ -0,0 +1,79 @@
+/*  -*- c++ -*-  */
+#ifndef XTCTRAJECTORYREADER_H
+#define XTCTRAJECTORYREADER_H
+
+#include <protomol/io/Reader.h>
+#include <protomol/io/XTCCoordinateCodec.h>
+#include <protomol/type/XYZ.h>
+
+#include <vector>
+
+namespace ProtoMol {
+  //____XTCTrajectoryReader
+
+  /**
+   * Reads a GROMACS XTC trajectory file, frame by frame, without the GROMACS
+   * library. Coordinates are returned in Angstrom.
+   */
+  class XTCTrajectoryReader : public Reader {
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // Typedef
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  private:
+    typedef XTCCoordinateCodec::int32 int32;
+    typedef XTCCoordinateCodec::float4 float4;
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // Constructors, destructors (both default here), assignment
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    XTCTrajectoryReader();
+    explicit XTCTrajectoryReader(const std::string &filename);
+    virtual ~XTCTrajectoryReader();
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // From class Reader
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    virtual bool tryFormat();
+    virtual bool read();
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // New methods of class XTCTrajectoryReader
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    bool read(Vector3DBlock &coords);
+    void doRead(Vector3DBlock &coords);
+
+    /// Step, time (ps) and box (Angstrom) of the last frame read
+    int getStep() const {return myStep;}
+    Real getTime() const {return myTime;}
+    Real getPrecision() const {return myPrecision;}
+    const Vector3D &getBox(unsigned int i) const {return myBox[i];}
+
+    Vector3DBlock *orphanXYZ();
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // Friends
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    friend XTCTrajectoryReader &operator>>(XTCTrajectoryReader &reader,
+                                           Vector3DBlock &coords);
+    friend XTCTrajectoryReader &operator>>(XTCTrajectoryReader &reader,
+                                           XYZ &xyz);
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // My data members
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  private:
+    Vector3DBlock *xyz;
+    int myStep;
+    Real myTime;
+    Real myPrecision;
+    Vector3D myBox[3];
+    XTCCoordinateCodec myCodec;
+    std::vector<float4> myX;
+    std::vector<char> myBuffer;
+  };
+}
+#endif /* XTCTRAJECTORYREADER_H */
@@ -0,0 +1,90 @@
+#include <protomol/io/XTCTrajectoryWriter.h>
+
+#include <protomol/base/Report.h>
+#include <protomol/base/PMConstants.h>
+#include <protomol/base/Exception.h>
+
+using namespace std;
+using namespace ProtoMol::Report;
+using namespace ProtoMol;
+
+//____XTCTrajectoryWriter
+
+namespace {
+  // XTC frame magic number
+  const int XTC_MAGIC = 1995;
+}
+
+XTCTrajectoryWriter::XTCTrajectoryWriter(Real precision) :
+  Writer(ios::binary | ios::trunc), myPrecision(precision), myFrames(0) {}
+
+XTCTrajectoryWriter::XTCTrajectoryWriter(const string &filename,
+                                         Real precision) :
+  Writer(ios::binary | ios::trunc, filename), myPrecision(precision),
+  myFrames(0) {}
+
+XTCTrajectoryWriter::XTCTrajectoryWriter(const string &filename, bool append,
+                                         Real precision) :
+  Writer(ios::binary | (append ? ios::app : ios::trunc), filename),
+  myPrecision(precision), myFrames(0) {}
+
+XTCTrajectoryWriter::~XTCTrajectoryWriter() {
+  close();
+}
+
+void XTCTrajectoryWriter::setPrecision(Real precision) {
+  myPrecision = precision;
+}
+
+bool XTCTrajectoryWriter::write(const Vector3DBlock &coords, int step,
+                                Real time) {
+  return write(coords, step, time, Vector3D(0, 0, 0), Vector3D(0, 0, 0),
+               Vector3D(0, 0, 0));
+}
+
+bool XTCTrajectoryWriter::write(const Vector3DBlock &coords, int step,
+                                Real time, const Vector3D &a,
+                                const Vector3D &b, const Vector3D &c) {
+  if (!is_open() && !open()) return false;
+
+  const unsigned int count = coords.size();
+
+  // Convert to nm single precision in one sweep
+  myX.resize(3 * count);
+  for (unsigned int i = 0; i < 3 * count; i++)
+    myX[i] = static_cast<float4>(coords.c[i] * Constant::ANGSTROM_NM);
+
+  myBuffer.clear();
+  myBuffer.reserve(4 * (13 + 3 * count));
+
+  XTCCoordinateCodec::putInt(myBuffer, XTC_MAGIC);
+  XTCCoordinateCodec::putInt(myBuffer, count);
+  XTCCoordinateCodec::putInt(myBuffer, step);
+  XTCCoordinateCodec::putFloat(myBuffer, static_cast<float4>(time));
+
+  const Vector3D *box[3] = {&a, &b, &c};
+  for (unsigned int i = 0; i < 3; i++)
+    for (unsigned int j = 0; j < 3; j++)
+      XTCCoordinateCodec::putFloat
+        (myBuffer, static_cast<float4>((*box[i])[j] * Constant::ANGSTROM_NM));
+
+  if (!myCodec.compress(count ? &myX[0] : 0, count,
+                        static_cast<float4>(myPrecision), myBuffer))
+    report << warning << "[XTCTrajectoryWriter::write] Coordinates of "
+           << "frame " << myFrames << " overflow precision " << myPrecision
+           << " in '" << filename << "'." << endr;
+
+  File::write(&myBuffer[0], myBuffer.size());
+  file.flush();
+  myFrames++;
+
+  return !file.fail();
+}
+
+namespace ProtoMol {
+  XTCTrajectoryWriter &operator<<(XTCTrajectoryWriter &xtcWriter,
+                                  const Vector3DBlock &coords) {
+    xtcWriter.write(coords, xtcWriter.myFrames);
+    return xtcWriter;
+  }
+}
@@ -0,0 +1,69 @@
+/*  -*- c++ -*-  */
+#ifndef XTCTRAJECTORYWRITER_H
+#define XTCTRAJECTORYWRITER_H
+
+#include <protomol/io/Writer.h>
+#include <protomol/io/XTCCoordinateCodec.h>
+#include <protomol/type/Vector3DBlock.h>
+
+namespace ProtoMol {
+  //____XTCTrajectoryWriter
+
+  /**
+   * Writes GROMACS compatible XTC (compressed xdr3dfcoord) trajectories
+   * without the GROMACS library. Frames are independent, hence appending
+   * to an existing file is just writing at the end.
+   *
+   * Coordinates and box vectors are taken in Angstrom and stored in nm,
+   * time is stored as given (ps).
+   */
+  class XTCTrajectoryWriter : public Writer {
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // Typedef
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  private:
+    typedef XTCCoordinateCodec::float4 float4;
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // Constructors, destructors (both default here), assignment
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    explicit XTCTrajectoryWriter(Real precision = 1000.0);
+    explicit XTCTrajectoryWriter(const std::string &filename,
+                                 Real precision = 1000.0);
+    /// append true opens an existing file for adding frames
+    XTCTrajectoryWriter(const std::string &filename, bool append,
+                        Real precision = 1000.0);
+    virtual ~XTCTrajectoryWriter();
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // New methods of class XTCTrajectoryWriter
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    bool write(const Vector3DBlock &coords, int step = 0, Real time = 0.0);
+    /// Writes a frame with the box given by its three basis vectors
+    bool write(const Vector3DBlock &coords, int step, Real time,
+               const Vector3D &a, const Vector3D &b, const Vector3D &c);
+
+    void setPrecision(Real precision);
+    Real getPrecision() const {return myPrecision;}
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // Friends
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    friend XTCTrajectoryWriter &operator<<(XTCTrajectoryWriter &xtcWriter,
+                                           const Vector3DBlock &coords);
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // My data members
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  private:
+    Real myPrecision;
+    int myFrames;
+    XTCCoordinateCodec myCodec;
+    std::vector<float4> myX;
+    std::vector<char> myBuffer;
+  };
+}
+#endif /* XTCTRAJECTORYWRITER_H */
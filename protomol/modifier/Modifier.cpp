@@ -20,7 +20,11 @@ void Modifier::execute(Integrator *i) {
     << "(" << (long)(this) << ") (enable=" << myEnable << ") at "
     << app->topology->time << endr;
   
-  if (myEnable) doExecute(i);
+  if (myEnable) {
+    doExecute(i);
+    // Velocities or positions may have changed
+    app->outputCache.invalidateObservables();
+  }
 }
 
 void Modifier::initialize(ProtoMolApp *app, Vector3DBlock *forces) {
@@ -5,6 +5,10 @@
 #include <protomol/factory/AnalysisFactory.h>
 
 #include <protomol/analysis/AnalysisDihedral.h>
+#include <protomol/analysis/AnalysisRDF.h>
+#include <protomol/analysis/AnalysisRMSD.h>
+#include <protomol/analysis/AnalysisRMSF.h>
+#include <protomol/analysis/AnalysisContacts.h>
 
 using namespace ProtoMol;
 
@@ -14,4 +18,8 @@ void AnalysisModule::init(ProtoMolApp *app) {
 	InputAnalysis::registerConfiguration(&app->config, true);
 
 	app->analysisFactory.registerExemplar(new AnalysisDihedral());
+	app->analysisFactory.registerExemplar(new AnalysisRDF());
+	app->analysisFactory.registerExemplar(new AnalysisRMSD());
+	app->analysisFactory.registerExemplar(new AnalysisRMSF());
+	app->analysisFactory.registerExemplar(new AnalysisContacts());
 }
@@ -6,6 +6,7 @@
 #include <protomol/force/bonded/AngleSystemForce.h>
 #include <protomol/force/bonded/ImproperSystemForce.h>
 #include <protomol/force/bonded/HarmDihedralSystemForce.h>
+#include <protomol/force/bonded/BondedSystemForce.h>
 
 #include <protomol/ProtoMolApp.h>
 #include <protomol/base/StringUtilities.h>
@@ -32,6 +33,7 @@ void BondedForcesModule::registerForces(ProtoMolApp *app) {
     f.registerExemplar(new ImproperSystemForce<PeriodicBoundaryConditions>());
     f.registerExemplar(new
                        HarmDihedralSystemForce<PeriodicBoundaryConditions>());
+    f.registerExemplar(new BondedSystemForce<PeriodicBoundaryConditions>());
 
   } else if (equalNocase(boundConds, VacuumBoundaryConditions::keyword)) {
     f.registerExemplar(new RBDihedralSystemForce<VacuumBoundaryConditions>());
@@ -40,5 +42,6 @@ void BondedForcesModule::registerForces(ProtoMolApp *app) {
     f.registerExemplar(new AngleSystemForce<VacuumBoundaryConditions>());
     f.registerExemplar(new ImproperSystemForce<VacuumBoundaryConditions>());
     f.registerExemplar(new HarmDihedralSystemForce<VacuumBoundaryConditions>());
+    f.registerExemplar(new BondedSystemForce<VacuumBoundaryConditions>());
   }
 }
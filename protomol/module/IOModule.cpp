@@ -32,6 +32,9 @@ defineInputValueWithAliases(InputPAR, "parfile", ("parameters"))
 defineInputValue(InputPDBScaling, "pdbScaling")
 defineInputValue(InputDihedralMultPSF, "dihedralMultPSF")
 defineInputValue(InputSCPISM, "scpismfile")
+defineInputValue(InputTopologyCache, "topologyCache")
+defineInputValue(InputPositionsFrame, "posFrame")
+defineInputValue(InputVelocitiesFrame, "velFrame")
 
 //for GROMACS
 defineInputValue(InputGromacsTopo, "gromacstopologyfile")
@@ -51,6 +54,9 @@ void IOModule::init(ProtoMolApp *app) {
   InputPDBScaling::registerConfiguration(config);
   InputDihedralMultPSF::registerConfiguration(config);
   InputSCPISM::registerConfiguration(config);
+  InputTopologyCache::registerConfiguration(config);
+  InputPositionsFrame::registerConfiguration(config);
+  InputVelocitiesFrame::registerConfiguration(config);
 
   //for GROMACS
   InputGromacsTopo::registerConfiguration(config);
@@ -76,11 +82,19 @@ void IOModule::read(ProtoMolApp *app) {
 
   // Positions
   PosVelReader reader;
+  if (config.valid(InputPositionsFrame::keyword))
+    reader.setFrame((int)config[InputPositionsFrame::keyword]);
+
   if (!reader.open(config[InputPositions::keyword]))
     THROW(string("Can't open position file '") +
       config[InputPositions::keyword].getString() + "'.");
 
   if (reader.tryFormat(PosVelReaderType::PDB)) {
+    if (reader.getFrame())
+      THROWS("PDB position file '"
+             << config[InputPositions::keyword].getString()
+             << "' has no frame " << reader.getFrame() << ".");
+
     PDB pdb;
 	if (!(reader >> pdb)) {
       THROW(string("Could not parse PDB position file '") +
@@ -94,7 +108,9 @@ void IOModule::read(ProtoMolApp *app) {
     app->outputCache.add(pdb.atoms);
 
   } else if (reader.tryFormat(PosVelReaderType::XYZ) ||
-             reader.tryFormat(PosVelReaderType::XYZBIN)) {
+             reader.tryFormat(PosVelReaderType::XYZBIN) ||
+             reader.tryFormat(PosVelReaderType::XTC) ||
+             reader.tryFormat(PosVelReaderType::DCD)) {
 	  XYZ xyz;
 	  if (!(reader >> xyz)) {
 		THROW(string("Could not parse position file '") +
@@ -109,10 +125,15 @@ void IOModule::read(ProtoMolApp *app) {
 
   report << plain << "Using " << reader.getType() << " posfile '"
          << config[InputPositions::keyword] << "' ("
-         << app->positions.size() << ")." << endr;
+         << app->positions.size() << ")";
+  if (reader.getFrame()) report << ", frame " << reader.getFrame();
+  report << "." << endr;
 
   // Velocities
   if (config.valid(InputVelocities::keyword)) {
+    reader.setFrame(config.valid(InputVelocitiesFrame::keyword) ?
+                    (int)config[InputVelocitiesFrame::keyword] : 0);
+
     if (!reader.open(config[InputVelocities::keyword]))
       THROW(string("Can't open velocity file '") +
         config[InputVelocities::keyword].getString() + "'.");
@@ -168,6 +189,12 @@ void IOModule::read(ProtoMolApp *app) {
            }
        }
 
+    } else if (openTopologyCache(app) && app->topologyCache.isValid()) {
+      report << plain << "Using topology cache '"
+             << app->topologyCache.getFilename() << "' ("
+             << app->topologyCache.getNumAtoms() << "), PSF and PAR files "
+             << "not parsed." << endr;
+
     } else {
       // PSF
       PSFReader psfReader;
@@ -224,12 +251,14 @@ void IOModule::read(ProtoMolApp *app) {
     }
 
     // Test input if normal topology
+    const unsigned int atoms = app->topologyCache.isValid() ?
+      app->topologyCache.getNumAtoms() : app->psf.atoms.size();
     if (app->positions.size() != app->velocities.size() ||
-        app->positions.size() != app->psf.atoms.size())
+        app->positions.size() != atoms)
       THROWS("Positions, velocities and PSF input have different number "
              "of atoms. positions=" << app->positions.size()
              << " velocities=" << app->velocities.size()
-             << " atoms=" << app->psf.atoms.size());
+             << " atoms=" << atoms);
   }else{
 
     // Test input for positions and velocities only if TPR
@@ -240,3 +269,39 @@ void IOModule::read(ProtoMolApp *app) {
 
   }
 }
+
+bool IOModule::openTopologyCache(ProtoMolApp *app) {
+  Configuration &config = app->config;
+  if (!config.valid(InputTopologyCache::keyword)) return false;
+
+  // Per atom SCPISM and GBSA parameters are not part of the cache
+  if (config.valid(InputSCPISM::keyword) ||
+      (config.valid(InputDoSCPISM::keyword) &&
+       (bool)config[InputDoSCPISM::keyword]) ||
+      (config.valid(InputDoGBSAObc::keyword) &&
+       (bool)config[InputDoGBSAObc::keyword])) {
+    report << hint << "Topology cache disabled for SCPISM and GBSA." << endr;
+    return false;
+  }
+
+  // Options changing the built topology
+  string options;
+  const string keywords[] = {"exclude", InputDihedralMultPSF::keyword};
+  for (unsigned int i = 0; i < 2; i++)
+    options += keywords[i] + "=" +
+      (config.valid(keywords[i]) ? config[keywords[i]].getString() : "") +
+      " ";
+
+  vector<string> files;
+  files.push_back(config[InputPSF::keyword]);
+  files.push_back(config[InputPAR::keyword]);
+
+  if (!app->topologyCache.open(config[InputTopologyCache::keyword], files,
+                               options)) {
+    report << warning << "Topology cache disabled, can not read the PSF or "
+           << "PAR file." << endr;
+    return false;
+  }
+
+  return true;
+}
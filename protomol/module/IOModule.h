@@ -16,6 +16,9 @@ namespace ProtoMol {
   declareInputValue(InputPDBScaling, BOOL, NOCONSTRAINTS)
   declareInputValue(InputDihedralMultPSF, BOOL, NOCONSTRAINTS)
   declareInputValue(InputSCPISM, STRING, NOTEMPTY)
+  declareInputValue(InputTopologyCache, STRING, NOTEMPTY)
+  declareInputValue(InputPositionsFrame, INT, NOCONSTRAINTS)
+  declareInputValue(InputVelocitiesFrame, INT, NOCONSTRAINTS)
 
   declareInputValue(InputGromacsTopo, STRING, NOTEMPTY)
   declareInputValue(InputGromacsParamPath, STRING, NOTEMPTY)
@@ -33,6 +36,10 @@ namespace ProtoMol {
 
     void init(ProtoMolApp *app);
     void read(ProtoMolApp *app);
+
+  private:
+    /// Opens the topology cache if configured, false if not used
+    bool openTopologyCache(ProtoMolApp *app);
   };
 }
 
@@ -38,12 +38,31 @@ defineInputValueAndText(InputMinimalImage, "minimalImage",
                         "global default flag whether the coordinates should be "
                         "transformed to minimal image or not")
 defineInputValue(InputDebugLimit, "debugstart")
+defineInputValueAndText(InputMixedPrecision, "mixedPrecision",
+                        "compute the Lennard-Jones and Coulomb pair terms of "
+                        "NonbondedCutoff and NonbondedSimpleFull in single "
+                        "precision, accumulate forces and energies in double")
+defineInputValueAndText(InputSequentialReplicas, "sequentialReplicas",
+                        "number of independent replicas sharing the topology, "
+                        "stepped one after the other in one process between "
+                        "outputs. Each replica runs the kernels of a single "
+                        "system, the forces are not batched across replicas. "
+                        "Replica r draws its velocities with seed + r, the "
+                        "random numbers of stochastic integrators come from "
+                        "one generator shared by all replicas")
 
 // Parallel (no parallel module)
 defineInputValue(InputUseBarrier,"useBarrier")
 defineInputValue(InputParallelPipe,"parallelPipe")
 defineInputValue(InputParallelMode,"parallelMode")
 defineInputValue(InputMaxPackages,"maxPackages")
+defineInputValueAndText(InputReplicaExchangeTemperatures,
+                        "replicaExchangeTemperatures",
+                        "temperature ladder of replica exchange, the nodes are "
+                        "split into one group per temperature")
+defineInputValueAndText(InputReplicaExchangeFrequency,
+                        "replicaExchangeFrequency",
+                        "number of steps between replica exchange attempts")
 
 
 void MainModule::init(ProtoMolApp *app) {
@@ -66,6 +85,8 @@ void MainModule::init(ProtoMolApp *app) {
   InputMinimalImage::registerConfiguration(&app->config, false);
   InputDoGBSAObc::registerConfiguration(config, 0);
   InputDebugLimit::registerConfiguration(config, 0);
+  InputMixedPrecision::registerConfiguration(config, false);
+  InputSequentialReplicas::registerConfiguration(config, 1);
   //lel, no defaults
   InputSimulationTime::registerConfiguration(config);
   InputOutputTime::registerConfiguration(config);
@@ -73,6 +94,8 @@ void MainModule::init(ProtoMolApp *app) {
   InputParallelPipe::registerConfiguration(config);
   InputParallelMode::registerConfiguration(config);
   InputMaxPackages::registerConfiguration(config);
+  InputReplicaExchangeTemperatures::registerConfiguration(config);
+  InputReplicaExchangeFrequency::registerConfiguration(config, 1000L);
 
 }
 
@@ -89,6 +112,13 @@ void MainModule::configure(ProtoMolApp *app) {
   Parallel::bcast(seed);
   config[InputSeed::keyword] = seed;
 
+  // Replica exchange runs one replica per group of nodes
+  if (config.valid(InputReplicaExchangeTemperatures::keyword)) {
+    vector<Real> temperatures;
+    config[InputReplicaExchangeTemperatures::keyword].get(temperatures);
+    Parallel::split(temperatures.size());
+  }
+
   int randomtype;
 
   if (config.valid("Checkpoint")) {
@@ -99,7 +129,7 @@ void MainModule::configure(ProtoMolApp *app) {
 
   Parallel::bcast(randomtype);
   config[InputRandomType::keyword] = randomtype;
-  randomNumber(seed, randomtype);
+  randomNumber(seed + Parallel::getGroup(), randomtype);
 
 
   // Check if configuration is complete
@@ -118,6 +148,8 @@ void MainModule::configure(ProtoMolApp *app) {
 
 
 void MainModule::postBuild(ProtoMolApp *app) {
+  app->topology->mixedPrecision = app->config[InputMixedPrecision::keyword];
+
   // Reduce image
   app->topology->minimalMolecularDistances =
     app->topology->checkMoleculePairDistances(app->positions);
@@ -22,6 +22,8 @@ namespace ProtoMol {
   declareInputValue(InputOutputfreq, LONG, NOTNEGATIVE)
   declareInputValue(InputOutput, BOOL, NOCONSTRAINTS)
   declareInputValue(InputMinimalImage, BOOL, NOCONSTRAINTS)
+  declareInputValue(InputMixedPrecision, BOOL, NOCONSTRAINTS)
+  declareInputValue(InputSequentialReplicas, INT, POSITIVE)
   declareInputValue(InputDoGBSAObc, BOOL, NOCONSTRAINTS)
   declareInputValue(InputDebugLimit, INT, NOCONSTRAINTS)
   //parallel
@@ -31,6 +33,8 @@ namespace ProtoMol {
   declareInputValue(InputParallelMode, STRING,NOTEMPTY)
   declareInputValue(InputParallelPipe, INT, NOCONSTRAINTS)
   declareInputValue(InputMaxPackages, INT, NOCONSTRAINTS)
+  declareInputValue(InputReplicaExchangeTemperatures, VECTOR, NOTEMPTY)
+  declareInputValue(InputReplicaExchangeFrequency, LONG, POSITIVE)
 
 
   class MainModule : public Module {
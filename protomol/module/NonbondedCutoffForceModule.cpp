@@ -10,6 +10,7 @@
 #include <protomol/force/OneAtomPairTwo.h>
 #include <protomol/force/OneAtomPairThree.h>
 #include <protomol/force/OneAtomPairNoExclusion.h>
+#include <protomol/force/OneAtomPairTable.h>
 #include <protomol/force/CoulombForce.h>
 #include <protomol/force/LennardJonesForce.h>
 #include <protomol/force/coulomb/CoulombSCPISMForce.h>
@@ -17,6 +18,7 @@
 #include <protomol/force/born/BornSelfForce.h>
 #include <protomol/force/nonbonded/NonbondedCutoffSystemForce.h>
 #include <protomol/force/table/LennardJonesTableForce.h>
+#include <protomol/force/table/LennardJonesCoulombTableForce.h>
 
 #include <protomol/switch/C1SwitchingFunction.h>
 #include <protomol/switch/C2SwitchingFunction.h>
@@ -87,6 +89,18 @@ void NonbondedCutoffForceModule::registerForces(ProtoMolApp *app) {
     f.reg(new CutoffSystem<CCM, OneAtomPairTwo<PBC, CmpCnCn, LennardJonesForce,
           CmpCnCn, CoulombForce> >());
 
+    // NonbondedCutoffSystemForce LennardJonesCoulombTableForce
+    f.reg(new CutoffSystem<CCM, OneAtomPairTable<PBC,
+          LennardJonesCoulombTableForce<C2, C1, 7, Real> > >());
+    f.reg(new CutoffSystem<CCM, OneAtomPairTable<PBC,
+          LennardJonesCoulombTableForce<C2, C2, 7, Real> > >());
+    f.reg(new CutoffSystem<CCM, OneAtomPairTable<PBC,
+          LennardJonesCoulombTableForce<C2, Cn, 7, Real> > >());
+    f.reg(new CutoffSystem<CCM, OneAtomPairTable<PBC,
+          LennardJonesCoulombTableForce<Cn, Cn, 7, Real> > >());
+    f.reg(new CutoffSystem<CCM, OneAtomPairTable<PBC,
+          LennardJonesCoulombTableForce<CmpCnCn, CmpCnCn, 7, Real> > >());
+
 
     // SCPISM stuff
     // NonbondedCutoffSystemForce CoulombSCPISMForce
@@ -142,6 +156,18 @@ void NonbondedCutoffForceModule::registerForces(ProtoMolApp *app) {
     f.reg(new CutoffSystem<CCM, OneAtomPairTwo<VBC, CmpCnCn, LennardJonesForce,
           C1, CoulombForce> >());
 
+    // NonbondedCutoffSystemForce LennardJonesCoulombTableForce
+    f.reg(new CutoffSystem<CCM, OneAtomPairTable<VBC,
+          LennardJonesCoulombTableForce<C2, C1, 7, Real> > >());
+    f.reg(new CutoffSystem<CCM, OneAtomPairTable<VBC,
+          LennardJonesCoulombTableForce<C2, C2, 7, Real> > >());
+    f.reg(new CutoffSystem<CCM, OneAtomPairTable<VBC,
+          LennardJonesCoulombTableForce<C2, Cn, 7, Real> > >());
+    f.reg(new CutoffSystem<CCM, OneAtomPairTable<VBC,
+          LennardJonesCoulombTableForce<Cn, Cn, 7, Real> > >());
+    f.reg(new CutoffSystem<CCM, OneAtomPairTable<VBC,
+          LennardJonesCoulombTableForce<CmpCnCn, C1, 7, Real> > >());
+
     // SCPISM stuff
     // Born radius
     f.reg(new CutoffSystem<CCM, OneAtomPair<VBC, Cutoff, BornRadii> >());
@@ -4,8 +4,10 @@
 #include <protomol/base/StringUtilities.h>
 #include <protomol/module/TopologyModule.h>
 #include <protomol/topology/PeriodicBoundaryConditions.h>
+#include <protomol/topology/VacuumBoundaryConditions.h>
 
 #include <protomol/force/nonbonded/NonbondedFullEwaldSystemForce.h>
+#include <protomol/force/nonbonded/NonbondedTreecodeSystemForce.h>
 
 #include <protomol/switch/CutoffSwitchingFunction.h>
 
@@ -35,6 +37,9 @@ void NonbondedFullElectrostaticForceModule::registerForces(ProtoMolApp *app) {
     f.reg(new FullEwald<PBC,CCM,false,true,true,Cutoff>());
     f.reg(new FullEwald<PBC,CCM,false,false,true,Cutoff>());
 
-  } 
+  } else if (equalNocase(boundConds, VacuumBoundaryConditions::keyword)) {
+    // Barnes-Hut treecode
+    f.reg(new NonbondedTreecodeSystemForce());
+  }
 
 }
@@ -27,11 +27,15 @@ using namespace ProtoMol::Report;
 defineInputValue(InputEigenVectors, "eigfile")
 defineInputValue(InputEigTextFile, "eigtextfile")
 defineInputValue(InputEigenValues, "eigvaluefile")
+defineInputValueAndText(InputSingleEigenvectors, "singleEigenvectors",
+                        "project onto the normal modes with single precision "
+                        "eigenvectors, accumulate in double")
 
 void NormalModeModule::init(ProtoMolApp *app) {
   InputEigenVectors::registerConfiguration(&app->config);
   InputEigTextFile::registerConfiguration(&app->config);
   InputEigenValues::registerConfiguration(&app->config);
+  InputSingleEigenvectors::registerConfiguration(&app->config, false);
 
   app->integratorFactory.registerExemplar(new NormalModeLangevin());
   app->integratorFactory.registerExemplar(new NormalModeLangLf());
@@ -12,6 +12,7 @@ namespace ProtoMol {
   declareInputValue(InputEigenVectors, STRING, NOTEMPTY)
   declareInputValue(InputEigTextFile, STRING, NOTEMPTY)
   declareInputValue(InputEigenValues, STRING, NOTEMPTY)
+  declareInputValue(InputSingleEigenvectors, BOOL, NOCONSTRAINTS)
 
   class NormalModeModule : public Module {
 
@@ -15,11 +15,13 @@
 #include <protomol/output/OutputXYZTrajectoryPos.h>
 #include <protomol/output/OutputXYZTrajectoryVel.h>
 #include <protomol/output/OutputEnergies.h>
+#include <protomol/output/OutputEnergyLog.h>
 #include <protomol/output/OutputFAHGUI.h>
 #include <protomol/output/OutputFAHFile.h>
 #include <protomol/output/OutputScreen.h>
 #include <protomol/output/OutputXTCTrajectory.h>
 #include <protomol/output/OutputDihedrals.h>
+#include <protomol/output/OutputStream.h>
 
 using namespace std;
 using namespace ProtoMol;
@@ -38,11 +40,15 @@ void OutputModule::init(ProtoMolApp *app) {
   f.registerExemplar(new OutputXYZTrajectoryPos());
   f.registerExemplar(new OutputXYZTrajectoryVel());
   f.registerExemplar(new OutputEnergies());
+  f.registerExemplar(new OutputEnergyLog());
 #if defined (HAVE_GUI) || defined (HAVE_LIBFAH)
   f.registerExemplar(new OutputFAHGUI());
 #endif
   f.registerExemplar(new OutputFAHFile());
   f.registerExemplar(new OutputXTCTrajectory());
   f.registerExemplar(new OutputDihedrals());
+#ifdef HAVE_EPOLL
+  f.registerExemplar(new OutputStream());
+#endif
 
 }
@@ -28,7 +28,7 @@ OutputCache::OutputCache() :
   minimalPositions(new Vector3DBlock()),
   dihedralPhi(Constant::REAL_NAN),
   dihedralPhis(new vector<Real>()),
-  brentMaxima(new vector<vector<Real> >()) {
+  brentMaxima(new vector<vector<Real> >()), validObservables(false) {
   uncache();
 }
 
@@ -44,6 +44,14 @@ OutputCache::~OutputCache() {
 void OutputCache::initialize(const ProtoMolApp *app) {
   this->app = app;
   *initialPositions = app->positions;
+  validObservables = false;
+}
+
+
+void OutputCache::setObservables(const Observables &obs) {
+  observables = obs;
+  validObservables = true;
+  uncache();
 }
 
 
@@ -63,7 +71,8 @@ Real OutputCache::getPotentialEnergy() const {
 
 Real OutputCache::getKineticEnergy() const {
   if (!cachedKE) {
-    kE = ProtoMol::kineticEnergy(app->topology, &app->velocities);
+    kE = validObservables ? observables.kineticEnergy :
+      ProtoMol::kineticEnergy(app->topology, &app->velocities);
     t = ProtoMol::temperature(kE, app->topology->degreesOfFreedom);
     cachedKE = true;
   }
@@ -72,11 +81,7 @@ Real OutputCache::getKineticEnergy() const {
 
 
 Real OutputCache::getTemperature() const {
-  if (!cachedKE) {
-    kE = ProtoMol::kineticEnergy(app->topology, &app->velocities);
-    t = ProtoMol::temperature(kE, app->topology->degreesOfFreedom);
-    cachedKE = true;
-  }
+  getKineticEnergy();
   return t;
 }
 
@@ -94,7 +99,8 @@ Real OutputCache::getMolecularTemperature() const {
 
 Real OutputCache::getMolecularKineticEnergy() const {
   if (!cachedMolKE) {
-    molKE = ProtoMol::molecularKineticEnergy(app->topology, &app->velocities);
+    molKE = validObservables ? observables.molecularKineticEnergy :
+      ProtoMol::molecularKineticEnergy(app->topology, &app->velocities);
     cachedMolKE = true;
   }
 
@@ -144,7 +150,7 @@ Real OutputCache::getVolume() const {
 
 Vector3D OutputCache::getLinearMomentum() const {
   if (!cachedLinearMomentum) {
-    linearMomentum =
+    linearMomentum = validObservables ? observables.linearMomentum :
       ProtoMol::linearMomentum(&app->velocities, app->topology);
     cachedLinearMomentum = true;
   }
@@ -153,9 +159,15 @@ Vector3D OutputCache::getLinearMomentum() const {
 
 Vector3D OutputCache::getAngularMomentum() const {
   if (!cachedAngularMomentum) {
-    angularMomentum =
-      ProtoMol::angularMomentum(&app->positions, &app->velocities,
-                                app->topology, getCenterOfMass());
+    if (validObservables)
+      // sum m (x - c) x v = sum m (x - o) x v - (c - o) x sum m v
+      angularMomentum = observables.massMoment -
+        (getCenterOfMass() - observables.origin).cross(
+          observables.linearMomentum);
+    else
+      angularMomentum =
+        ProtoMol::angularMomentum(&app->positions, &app->velocities,
+                                  app->topology, getCenterOfMass());
     cachedAngularMomentum = true;
   }
 
@@ -165,7 +177,9 @@ Vector3D OutputCache::getAngularMomentum() const {
 
 Vector3D OutputCache::getCenterOfMass() const {
   if (!cachedCenterOfMass) {
-    centerOfMass = ProtoMol::centerOfMass(&app->positions, app->topology);
+    centerOfMass = validObservables ?
+      observables.massPosition / observables.mass :
+      ProtoMol::centerOfMass(&app->positions, app->topology);
     cachedCenterOfMass = true;
   }
 
@@ -206,10 +220,13 @@ Real OutputCache::getDensity() const {
 
 Real OutputCache::getMass() const {
   if (!cachedMass) {
-    mass = 0.0;
-    unsigned int numberOfAtoms = app->positions.size();
-    for (unsigned int i = 0; i < numberOfAtoms; i++)
-      mass += app->topology->atoms[i].scaledMass;
+    if (validObservables) mass = observables.mass;
+    else {
+      mass = 0.0;
+      unsigned int numberOfAtoms = app->positions.size();
+      for (unsigned int i = 0; i < numberOfAtoms; i++)
+        mass += app->topology->atoms[i].scaledMass;
+    }
 
     cachedMass = true;
   }
@@ -28,6 +28,21 @@ namespace ProtoMol {
      Topology chang
    */
   class OutputCache  {
+  public:
+    /// Sums over the atoms taken by the integrator along its last half
+    /// kick, so the outputs need not sweep the velocities and positions
+    /// again. Valid until the integrator or a modifier moves on.
+    struct Observables {
+      Real kineticEnergy;
+      Real molecularKineticEnergy;
+      Real mass;
+      Vector3D linearMomentum;
+      Vector3D massPosition;  // sum m x
+      Vector3D origin;
+      Vector3D massMoment;    // sum m (x - origin) x v
+    };
+
+  private:
     const ProtoMolApp *app;
 
     Vector3DBlock *initialPositions;
@@ -90,6 +105,9 @@ namespace ProtoMol {
 
     mutable bool cachedMinimalPositions;
 
+    mutable bool validObservables;
+    Observables observables;
+
     bool restore;
 
   public:
@@ -139,6 +157,11 @@ namespace ProtoMol {
     // / To be called before every run() or finialize()
     void uncache() const;
 
+    // / Observables of the current velocities and positions
+    void setObservables(const Observables &obs);
+    // / To be called when the velocities or positions change otherwise
+    void invalidateObservables() const {validObservables = false;}
+
     void setRestore() {restore = true;}
     void clearRestore() {restore = false;}
     bool getRestore() const {return restore;}
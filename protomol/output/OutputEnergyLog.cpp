@@ -0,0 +1,121 @@
+#include "OutputEnergyLog.h"
+
+#include <protomol/config/Configuration.h>
+#include <protomol/type/ScalarStructure.h>
+#include <protomol/output/OutputCache.h>
+#include <protomol/base/SystemUtilities.h>
+#include <protomol/base/Exception.h>
+#include <protomol/io/EnergyLogWriter.h>
+#include <protomol/ProtoMolApp.h>
+
+using namespace std;
+using namespace ProtoMol::Report;
+using namespace ProtoMol;
+
+const string OutputEnergyLog::keyword("energyLogFile");
+
+
+OutputEnergyLog::OutputEnergyLog() :
+  log(0), doMolecularTemperature(false), blockRows(256) {}
+
+
+OutputEnergyLog::OutputEnergyLog(const string &filename, long freq,
+                                 bool doMolTemp, int blockRows) :
+  Output(freq), log(0), filename(filename), doMolecularTemperature(doMolTemp),
+  blockRows(blockRows) {}
+
+
+OutputEnergyLog::~OutputEnergyLog() {
+  if (log) delete log;
+}
+
+
+void OutputEnergyLog::doInitialize() {
+  SystemUtilities::ensureDirectory(SystemUtilities::dirname(filename));
+
+  vector<string> columns;
+  columns.push_back("Time(fs)");
+  columns.push_back("E_potential");
+  columns.push_back("E_kinetic");
+  columns.push_back("E_total");
+  columns.push_back("Temperature");
+  columns.push_back("E_bond");
+  columns.push_back("E_angle");
+  columns.push_back("E_dihedral");
+  columns.push_back("E_improper");
+  columns.push_back("E_VdW");
+  columns.push_back("E_coulomb");
+  columns.push_back("E_other");
+  columns.push_back("Volume(A^3)");
+
+  if (app->energies.virial()) columns.push_back("Pressure(bar)");
+  if (app->energies.molecularVirial()) columns.push_back("Mol_Pres(bar)");
+  if (doMolecularTemperature) columns.push_back("Mol_Temp(K)");
+
+  columns.push_back("E_shadow");
+  row.resize(columns.size());
+
+  log = new EnergyLogWriter(filename, blockRows);
+  if (!log->is_open() || !log->writeHeader(columns))
+    THROWS("Failed to open energy log file '" << filename << "'");
+}
+
+
+void OutputEnergyLog::doRun(long step) {
+  unsigned int i = 0;
+
+  row[i++] = app->outputCache.getTime();
+  row[i++] = app->outputCache.getPotentialEnergy();
+  row[i++] = app->outputCache.getKineticEnergy();
+  row[i++] = app->outputCache.getTotalEnergy();
+  row[i++] = app->outputCache.getTemperature();
+  row[i++] = app->energies[ScalarStructure::BOND];
+  row[i++] = app->energies[ScalarStructure::ANGLE];
+  row[i++] = app->energies[ScalarStructure::DIHEDRAL];
+  row[i++] = app->energies[ScalarStructure::IMPROPER];
+  row[i++] = app->energies[ScalarStructure::LENNARDJONES];
+  row[i++] = app->energies[ScalarStructure::COULOMB];
+  row[i++] = app->energies[ScalarStructure::OTHER];
+  row[i++] = app->outputCache.getVolume();
+
+  if (app->energies.virial())
+    row[i++] = app->outputCache.getPressure();
+
+  if (app->energies.molecularVirial())
+    row[i++] = app->outputCache.getMolecularPressure();
+
+  if (doMolecularTemperature)
+    row[i++] = app->outputCache.getMolecularTemperature();
+
+  row[i++] = app->energies[ScalarStructure::SHADOW];
+
+  if (!log->write(step, row))
+    THROWS("Could not write " << getId() << " '" << filename << "'.");
+}
+
+
+void OutputEnergyLog::doFinalize(long) {
+  if (log) {
+    log->flush();
+    log->close();
+  }
+}
+
+
+Output *OutputEnergyLog::doMake(const vector<Value> &values) const {
+  return new OutputEnergyLog(values[0], values[1], values[2], values[3]);
+}
+
+
+void OutputEnergyLog::getParameters(vector<Parameter> &parameter) const {
+  parameter.push_back
+    (Parameter(keyword, Value(filename, ConstraintValueType::NotEmpty())));
+  Output::getParameters(parameter);
+  parameter.push_back(Parameter("molecularTemperature",
+                                Value(doMolecularTemperature), false));
+  parameter.push_back
+    (Parameter(keyword + "BlockRows",
+               Value(blockRows, ConstraintValueType::Positive()), 256,
+               Text("rows written at a time, each block is indexed by "
+                    "its steps")));
+}
@@ -0,0 +1,45 @@
+/*  -*- c++ -*-  */
+#ifndef PROTOMOL_OUTPUT_ENERGY_LOG_H
+#define PROTOMOL_OUTPUT_ENERGY_LOG_H
+
+#include "Output.h"
+
+namespace ProtoMol {
+  class EnergyLogWriter;
+
+  /**
+   * The columns of allEnergiesFile as a binary energy log, see
+   * EnergyLogWriter; the rows are kept as doubles and written a block at a
+   * time without any formatting. The EnergyLog utility prints it as text.
+   */
+  class OutputEnergyLog : public Output {
+  public:
+    static const std::string keyword;
+
+  private:
+    EnergyLogWriter *log;
+    std::string filename;
+    bool doMolecularTemperature;
+    int blockRows;
+    std::vector<Real> row;
+
+  public:
+    OutputEnergyLog();
+    OutputEnergyLog(const std::string &filename, long freq, bool doMolTemp,
+                    int blockRows);
+    virtual ~OutputEnergyLog();
+
+  private:
+    //   From class Output
+    void doInitialize();
+    void doRun(long step);
+    void doFinalize(long step);
+
+  public:
+    //  From class Makeable
+    Output *doMake(const std::vector<Value> &values) const;
+    std::string getIdNoAlias() const {return keyword;}
+    void getParameters(std::vector<Parameter> &parameter) const;
+  };
+}
+#endif //  PROTOMOL_OUTPUT_ENERGY_LOG_H
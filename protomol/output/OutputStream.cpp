@@ -0,0 +1,128 @@
+#ifdef HAVE_EPOLL
+
+#include <protomol/output/OutputStream.h>
+#include <protomol/output/StreamServer.h>
+#include <protomol/output/OutputCache.h>
+#include <protomol/topology/GenericTopology.h>
+#include <protomol/base/Report.h>
+#include <protomol/ProtoMolApp.h>
+
+using namespace std;
+using namespace ProtoMol::Report;
+using namespace ProtoMol;
+
+const string OutputStream::keyword("Stream");
+
+
+OutputStream::OutputStream() :
+  port(0), precision(0), keyframes(100), maxClients(16), server(0) {}
+
+
+OutputStream::OutputStream(int port, long freq, Real precision, int keyframes,
+                           int maxClients) :
+  Output(freq), port(port), precision(precision), keyframes(keyframes),
+  maxClients(maxClients), server(0) {}
+
+
+OutputStream::~OutputStream() {
+  delete server;
+}
+
+
+void OutputStream::doInitialize() {
+  const GenericTopology *topo = app->topology;
+
+  server = new StreamServer("ProtoMol", topo->atoms.size(), topo->bonds.size(),
+                            port, precision, keyframes, maxClients);
+
+  for (unsigned int i = 0; i < topo->atoms.size(); i++) {
+    const string &name = topo->atoms[i].name;
+    FAH_ATOM &atom = server->atoms[i];
+
+    for (unsigned int j = 0; j < 4; j++)
+      atom.type[j] = j < name.length() ? name[j] : 0;
+
+    // van der Waals radii of the elements
+    float radius = 1.9;
+    switch (atom.type[0]) {
+    case 'H': radius = 1.2; break;
+    case 'C': radius = 1.7; break;
+    case 'N': radius = 1.55; break;
+    case 'O': radius = 1.52; break;
+    case 'S': radius = 1.85; break;
+    default: break;
+    }
+
+    atom.charge = topo->atoms[i].scaledCharge;
+    atom.radius = radius / 2.0;
+  }
+
+  for (unsigned int i = 0; i < topo->bonds.size(); i++) {
+    const int a = topo->bonds[i].atom1, b = topo->bonds[i].atom2;
+    server->bonds[i].a = min(a, b);
+    server->bonds[i].b = max(a, b);
+  }
+
+  server->startServer();
+  report << plain << "[" << getId() << "] Streaming every " << getOutputFreq()
+         << " steps on localhost port " << port << "." << endr;
+}
+
+
+void OutputStream::doRun(long step) {
+  if (!server->wanted()) return;
+
+  const Vector3DBlock &positions = *app->outputCache.getMinimalPositions();
+  FAH_XYZ *xyz = server->frame();
+  for (unsigned int i = 0; i < positions.size(); i++) {
+    xyz[i].x = positions[i].c[0];
+    xyz[i].y = positions[i].c[1];
+    xyz[i].z = positions[i].c[2];
+  }
+
+  server->publish(step, app->outputCache.getTime(),
+                  app->outputCache.getTotalEnergy(),
+                  app->outputCache.getTemperature());
+}
+
+
+void OutputStream::doFinalize(long /*step*/) {
+  server->stopServer();
+
+  report << plain << "[" << getId() << "] " << server->getPublished()
+         << " frames, " << server->getSent() << " sent to "
+         << server->getClientsServed() << " clients, "
+         << server->getDropped() << " dropped." << endr;
+
+  delete server;
+  server = 0;
+}
+
+
+Output *OutputStream::doMake(const vector<Value> &values) const {
+  return new OutputStream(values[0], values[1], values[2], values[3],
+                          values[4]);
+}
+
+
+void OutputStream::getParameters(vector<Parameter> &parameter) const {
+  parameter.push_back
+    (Parameter(keyword, Value(port, ConstraintValueType::Positive()),
+               Text("loopback port of the viewers")));
+  Output::getParameters(parameter);
+  parameter.push_back
+    (Parameter(keyword + "Precision",
+               Value(precision, ConstraintValueType::NotNegative()), 0.0,
+               Text("quantization step [AA] of delta encoded frames, 0 for "
+                    "floats")));
+  parameter.push_back
+    (Parameter(keyword + "Keyframes",
+               Value(keyframes, ConstraintValueType::Positive()), 100,
+               Text("frames between full frames of a delta encoded stream")));
+  parameter.push_back
+    (Parameter(keyword + "Clients",
+               Value(maxClients, ConstraintValueType::Positive()), 16,
+               Text("maximum number of viewers")));
+}
+
+#endif // HAVE_EPOLL
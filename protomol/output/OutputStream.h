@@ -0,0 +1,50 @@
+/*  -*- c++ -*-  */
+#ifndef PROTOMOL_OUTPUT_STREAM_H
+#define PROTOMOL_OUTPUT_STREAM_H
+
+#ifdef HAVE_EPOLL
+
+#include <protomol/output/Output.h>
+
+namespace ProtoMol {
+  class StreamServer;
+
+  /**
+   * Streams the minimal positions, energy and temperature to local viewers
+   * on the loopback port Stream, see StreamServer for the protocol. Frames
+   * are only taken while a client is connected and the integrator never
+   * waits for a client.
+   */
+  class OutputStream : public Output {
+  public:
+    static const std::string keyword;
+
+  private:
+    int port;
+    Real precision;
+    int keyframes, maxClients;
+    StreamServer *server;
+
+  public:
+    OutputStream();
+    OutputStream(int port, long freq, Real precision, int keyframes,
+                 int maxClients);
+    ~OutputStream();
+
+    //   From class Output
+  private:
+    void doInitialize();
+    void doRun(long step);
+    void doFinalize(long step);
+    bool addDoKeyword() const {return false;}
+
+    //  From class Makeable
+  public:
+    Output *doMake(const std::vector<Value> &values) const;
+    std::string getIdNoAlias() const {return keyword;}
+    void getParameters(std::vector<Parameter> &parameter) const;
+  };
+}
+
+#endif // HAVE_EPOLL
+#endif // PROTOMOL_OUTPUT_STREAM_H
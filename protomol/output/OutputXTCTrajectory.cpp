@@ -7,11 +7,8 @@
 #include <protomol/ProtoMolApp.h>
 #include <protomol/base/Exception.h>
 
-#ifdef HAVE_GROMACS
-extern "C" {
-#include <gromacs/xtcio.h>
-}
-#endif
+#include <protomol/io/XTCTrajectoryWriter.h>
+#include <protomol/topology/GenericTopology.h>
 
 using namespace std;
 using namespace ProtoMol::Report;
@@ -22,86 +19,70 @@ const string OutputXTCTrajectory::keyword("XTCFile");
 
 
 OutputXTCTrajectory::OutputXTCTrajectory() :
-  fxtc(0), minimalImage(false), frameOffset(0) {}
+  xtc(0), minimalImage(false), frameOffset(0), precision(1000.0) {}
 
 
 OutputXTCTrajectory::OutputXTCTrajectory(const string &filename, int freq,
-                                         bool minimal, int frameoffs) :
-  Output(freq), fxtc(0), minimalImage(minimal), frameOffset(frameoffs),
-  filename(filename) {
+                                         bool minimal, int frameoffs,
+                                         Real prec) :
+  Output(freq), xtc(0), minimalImage(minimal), frameOffset(frameoffs),
+  filename(filename), precision(prec) {
 
   report << plain
          << "XTC FrameOffset parameter set to " << frameOffset << "." << endr;
 }
 
 
+OutputXTCTrajectory::~OutputXTCTrajectory() {
+  if (xtc) delete xtc;
+}
+
+
 void OutputXTCTrajectory::doInitialize() {
-#ifdef HAVE_GROMACS
   //  Get first frame (must exist or error)
   const int firstframe = toInt(app->config["firststep"]);
 
   report << debug(2) << "Firstframe " << firstframe << "." << endr;
 
-  //  Open fil
-  //  If frameOffset is zero default to overwrite data
+  //  Open file
+  //  If frameOffset is zero default to overwrite data, XTC frames are
+  //  self-contained so restarts just append.
   //  NOTE: now include "firstframe" data.
-  fxtc = open_xtc(filename.c_str(), frameOffset ? "a" : "w");
+  xtc = new XTCTrajectoryWriter(filename, frameOffset != 0, precision);
 
   //  Test opened
-  if (!fxtc) THROWS("Can not open '" << filename << "' for " << getId() << ".");
-
-#else
-  THROW("GROMACS XTC format output not available.");
-#endif
+  if (!xtc->is_open())
+    THROWS("Can not open '" << filename << "' for " << getId() << ".");
 }
 
 
 void OutputXTCTrajectory::doRun(long step) {
-#ifdef HAVE_GROMACS
   const Vector3DBlock *pos =
     (minimalImage ? app->outputCache.getMinimalPositions() : &app->positions);
 
-  //  Bounding Box
-  //  The computational box which is stored as a set of three basis vectors,
-  //  to allow for triclinic PBC. For a rectangular box the box edges ar
-  //  stored on the diagonal of the matrix.
-  Vector3D a, b;
-  app->topology->getBoundingbox(*pos, a, b);
-  matrix box = {{a.c[0], a.c[1], a.c[2]}, {b.c[0], b.c[1], b.c[2]},
-                {b.c[0] - a.c[0], b.c[1] - a.c[1], b.c[2] - a.c[2]}};
-
-  //  Gromacs XYZ data struct
-  const unsigned possize = pos->size(); //  Size
-  SmartPointer<rvec>::Array x = new rvec[possize];
-
-  //  Copy & convert dat
-  for (unsigned i = 0; i < possize; i++)
-    for (unsigned j = 0; j < 3; j++)
-      x[i][j] = (*pos)[i][j] * Constant::ANGSTROM_NM;
-
-  //  Defines precision, 1000 is the GROMACS default.
-  //  Can be read from TPR file.
-  real prec = 1000;
-  int natoms = possize; //  Number of atom
-	real time = app->outputCache.getTime() * Constant::FS_PS; //  Real time
-
-  //  Write to fil
-  if (!write_xtc((t_fileio *)fxtc, natoms, app->currentStep, time,
-                 box, x.get(), prec))
+  //  Periodic cell
+  //  The computational box is stored as a set of three basis vectors,
+  //  to allow for triclinic PBC. In vacuum there is no cell and the box is
+  //  written as zero, as GROMACS does.
+  Vector3D e1, e2, e3;
+  app->topology->getCellBasisVectors(e1, e2, e3);
+
+  const Real time = app->outputCache.getTime() * Constant::FS_PS;
+
+  //  Write to file, conversion to nm is done by the writer
+  if (!xtc->write(*pos, app->currentStep, time, e1, e2, e3))
     THROWS("Could not write " <<  getId() << " '" << filename << "'.");
-#endif
 }
 
 
 void OutputXTCTrajectory::doFinalize(long) {
-#ifdef HAVE_GROMACS
-  close_xtc((t_fileio *)fxtc);
-#endif
+  if (xtc) xtc->close();
 }
 
 
 Output *OutputXTCTrajectory::doMake(const vector<Value> &values) const {
-  return new OutputXTCTrajectory(values[0], values[1], values[2], values[3]);
+  return new OutputXTCTrajectory(values[0], values[1], values[2], values[3],
+                                 values[4]);
 }
 
 
@@ -116,6 +97,10 @@ void OutputXTCTrajectory::getParameters(vector<Parameter> &parameter) const {
   parameter.push_back
     (Parameter(keyword + "FrameOffset",
                Value(frameOffset, ConstraintValueType::NotNegative()), 0));
+  parameter.push_back
+    (Parameter(keyword + "Precision",
+               Value(precision, ConstraintValueType::Positive()), 1000.0,
+               Text("XTC coordinate precision, 1000 is the GROMACS default")));
 }
 
 
@@ -4,19 +4,22 @@
 #include "Output.h"
 
 namespace ProtoMol {
+  class XTCTrajectoryWriter;
+
   class OutputXTCTrajectory : public Output {
-    void *fxtc;
+    XTCTrajectoryWriter *xtc;
     bool minimalImage;
     int frameOffset;
     string filename;
+    Real precision;
 
   public:
     static const std::string keyword;
 
     OutputXTCTrajectory();
     OutputXTCTrajectory(const std::string &filename, int freq, bool minimal,
-                        int frameoffs);
-    virtual ~OutputXTCTrajectory() {}
+                        int frameoffs, Real prec);
+    virtual ~OutputXTCTrajectory();
 
     //  From Output
     Output *doMake(const std::vector<Value> &values) const;
@@ -0,0 +1,379 @@
+#ifdef HAVE_EPOLL
+
+#include <protomol/output/StreamServer.h>
+
+#include <protomol/base/Exception.h>
+
+#include <algorithm>
+#include <iostream>
+
+#include <errno.h>
+#include <math.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+using namespace std;
+using namespace ProtoMol;
+
+//____ Events taken from epoll per wait
+static const int MAX_EVENTS = 64;
+
+static int setNonBlocking(int fd) {
+  int opts = fcntl(fd, F_GETFL);
+  if (opts < 0) return -1;
+  return fcntl(fd, F_SETFL, opts | O_NONBLOCK);
+}
+
+static void appendBytes(vector<char> &out, const void *data, size_t length) {
+  const char *c = (const char *)data;
+  out.insert(out.end(), c, c + length);
+}
+
+static int32_t quantize(float x, float precision) {
+  // Coordinates beyond the integer range at this precision are clamped
+  const double q = floor(x / precision + 0.5);
+  if (q >= 2147483647.0) return 2147483647;
+  if (q <= -2147483648.0) return -2147483647 - 1;
+  return (int32_t)q;
+}
+
+static void appendVarint(vector<char> &out, int32_t value) {
+  // zig-zag, small differences of either sign in few bytes
+  uint32_t v = ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+  while (v >= 0x80) {
+    out.push_back((char)(v | 0x80));
+    v >>= 7;
+  }
+  out.push_back((char)v);
+}
+
+
+StreamServer::StreamServer(const char *name, int natoms, int nbonds, int port,
+                           float precision, int keyframes, int maxClients) :
+  atoms(natoms), bonds(nbonds), port(port), precision(precision),
+  keyframes(keyframes), maxClients(maxClients), running(false),
+  listenFd(-1), epollFd(-1), wakeFd(-1), staging(natoms), shared(natoms),
+  current(natoms), clients(0), shutdown(false), published(0), sent(0),
+  dropped(0), served(0) {
+
+  memset(&info, 0, sizeof(STREAM_INFO));
+  info.magic = STREAM_MAGIC;
+  info.version = STREAM_VERSION;
+  strncpy((char *)info.name, name, 64);
+  info.name[63] = 0;
+  info.atom_count = natoms;
+  info.bond_count = nbonds;
+  info.precision = precision;
+
+  memset(&sharedHeader, 0, sizeof(STREAM_FRAME));
+  currentHeader = sharedHeader;
+
+  pthread_mutex_init(&mutex, 0);
+}
+
+
+StreamServer::~StreamServer() {
+  stopServer();
+  pthread_mutex_destroy(&mutex);
+}
+
+
+void StreamServer::startServer() {
+  struct sockaddr_in addr;
+
+  if ((listenFd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP)) < 0)
+    THROWS("Could not create stream socket: " << strerror(errno));
+
+  int on = 1;
+  setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+  // Local viewers only
+  memset((void *)&addr, 0, sizeof(addr));
+  addr.sin_family      = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port        = htons(port);
+
+  if (bind(listenFd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+      listen(listenFd, SOMAXCONN) < 0 || setNonBlocking(listenFd) < 0) {
+    int err = errno;
+    ::close(listenFd);
+    listenFd = -1;
+    THROWS("Could not listen on stream port " << port << ": " << strerror(err));
+  }
+
+  wakeFd = eventfd(0, EFD_NONBLOCK);
+  epollFd = epoll_create(maxClients + 2);
+  if (wakeFd < 0 || epollFd < 0)
+    THROWS("Could not create stream events: " << strerror(errno));
+
+  struct epoll_event event;
+  memset(&event, 0, sizeof(event));
+  event.events = EPOLLIN;
+  event.data.fd = listenFd;
+  epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event);
+  event.data.fd = wakeFd;
+  epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event);
+
+  shutdown = false;
+  if (pthread_create(&thread, 0, callServerThread, (void *)this))
+    THROW("Error starting stream server thread.");
+  running = true;
+}
+
+
+void StreamServer::stopServer() {
+  if (running) {
+    pthread_mutex_lock(&mutex);
+    shutdown = true;
+    pthread_mutex_unlock(&mutex);
+    wake();
+    pthread_join(thread, 0);
+    running = false;
+  }
+
+  while (!connections.empty()) closeClient(connections.begin()->first);
+  if (epollFd >= 0) ::close(epollFd);
+  if (wakeFd >= 0) ::close(wakeFd);
+  if (listenFd >= 0) ::close(listenFd);
+  epollFd = wakeFd = listenFd = -1;
+}
+
+
+bool StreamServer::wanted() {
+  pthread_mutex_lock(&mutex);
+  bool any = clients > 0;
+  pthread_mutex_unlock(&mutex);
+
+  return any;
+}
+
+
+void StreamServer::publish(long step, float time, float energy,
+                           float temperature) {
+  pthread_mutex_lock(&mutex);
+  staging.swap(shared);
+  sharedHeader.frame = ++published;
+  sharedHeader.step = step;
+  sharedHeader.time = time;
+  sharedHeader.energy = energy;
+  sharedHeader.temperature = temperature;
+  pthread_mutex_unlock(&mutex);
+
+  wake();
+}
+
+
+void StreamServer::wake() {
+  uint64_t one = 1;
+  if (write(wakeFd, &one, sizeof(one)) < 0) {} // already pending
+}
+
+
+void *StreamServer::callServerThread(void *param) {
+  try {
+    ((StreamServer *)param)->serverThread();
+  } catch (const Exception &e) {
+    // report is not thread safe
+    cerr << "[StreamServer] " << e.getMessage() << endl;
+  }
+
+  return 0;
+}
+
+
+void StreamServer::serverThread() {
+  struct epoll_event events[MAX_EVENTS];
+
+  while (true) {
+    int n = epoll_wait(epollFd, events, MAX_EVENTS, -1);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      THROWS("Stream server wait failed: " << strerror(errno));
+    }
+
+    for (int i = 0; i < n; i++) {
+      const int fd = events[i].data.fd;
+
+      if (fd == listenFd) acceptClients();
+      else if (fd == wakeFd) {
+        uint64_t count;
+        if (read(wakeFd, &count, sizeof(count)) < 0) {}
+
+      } else {
+        map<int, Client>::iterator c = connections.find(fd);
+        if (c == connections.end()) continue;
+
+        bool closed = (events[i].events & (EPOLLERR | EPOLLHUP)) != 0;
+        if (!closed && (events[i].events & EPOLLIN)) {
+          // Nothing is expected from clients but the end of the connection
+          char buffer[256];
+          int got = recv(fd, buffer, sizeof(buffer), 0);
+          closed = got == 0 || (got < 0 && errno != EAGAIN);
+        }
+
+        if (closed) closeClient(fd);
+        else if (events[i].events & EPOLLOUT) flush(fd, c->second);
+      }
+    }
+
+    // Take the latest frame, the last one is still offered on shutdown
+    pthread_mutex_lock(&mutex);
+    const bool stop = shutdown;
+    const bool fresh = sharedHeader.frame != currentHeader.frame;
+    if (fresh) {
+      shared.swap(current);
+      currentHeader = sharedHeader;
+    }
+    pthread_mutex_unlock(&mutex);
+
+    if (fresh && precision > 0) {
+      quantized.resize(3 * current.size());
+      for (unsigned int j = 0; j < current.size(); j++) {
+        quantized[3 * j]     = quantize(current[j].x, precision);
+        quantized[3 * j + 1] = quantize(current[j].y, precision);
+        quantized[3 * j + 2] = quantize(current[j].z, precision);
+      }
+    }
+
+    // Clients done with their last frame get the latest one
+    if (currentHeader.frame > 0)
+      for (map<int, Client>::iterator c = connections.begin();
+           c != connections.end();) {
+        map<int, Client>::iterator next = c;
+        ++next;
+        if (c->second.out.empty() && c->second.frame < currentHeader.frame) {
+          encode(c->second);
+          flush(c->first, c->second);
+        }
+        c = next;
+      }
+
+    if (stop) break;
+  }
+}
+
+
+void StreamServer::acceptClients() {
+  int fd;
+  while ((fd = ::accept(listenFd, 0, 0)) >= 0) {
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+
+    if (connections.size() >= maxClients || setNonBlocking(fd) < 0 ||
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+      ::close(fd);
+      continue;
+    }
+
+    // Keep the kernel from queueing frames for a slow client, it should
+    // skip them instead
+    int buffer = max(65536, (int)(2 * (sizeof(STREAM_FRAME) +
+                                       sizeof(FAH_XYZ) * atoms.size())));
+    setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &buffer, sizeof(buffer));
+
+    Client &client = connections[fd];
+    client.sent = 0;
+    client.frame = 0;
+    client.sinceKey = 0;
+    client.writing = false;
+    appendBytes(client.out, &info, sizeof(STREAM_INFO));
+    if (!atoms.empty())
+      appendBytes(client.out, &atoms[0], sizeof(FAH_ATOM) * atoms.size());
+    if (!bonds.empty())
+      appendBytes(client.out, &bonds[0], sizeof(FAH_BOND) * bonds.size());
+    served++;
+
+    pthread_mutex_lock(&mutex);
+    clients = connections.size();
+    pthread_mutex_unlock(&mutex);
+
+    flush(fd, client);
+  }
+}
+
+
+void StreamServer::closeClient(int fd) {
+  epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, 0);
+  ::close(fd);
+  connections.erase(fd);
+
+  pthread_mutex_lock(&mutex);
+  clients = connections.size();
+  pthread_mutex_unlock(&mutex);
+}
+
+
+void StreamServer::flush(int fd, Client &client) {
+  while (client.sent < client.out.size()) {
+    int n = send(fd, &client.out[client.sent], client.out.size() - client.sent,
+                 MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (n < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+      closeClient(fd);
+      return;
+    }
+    client.sent += n;
+  }
+
+  const bool done = client.sent == client.out.size();
+  if (done) {
+    client.out.clear();
+    client.sent = 0;
+  }
+
+  // Only ask for EPOLLOUT while there is something left to write
+  if (done == client.writing) {
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = done ? EPOLLIN : EPOLLIN | EPOLLOUT;
+    event.data.fd = fd;
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &event);
+    client.writing = !done;
+  }
+}
+
+
+void StreamServer::encode(Client &client) {
+  if (client.frame > 0) dropped += currentHeader.frame - client.frame - 1;
+  client.frame = currentHeader.frame;
+  sent++;
+
+  STREAM_FRAME header = currentHeader;
+  header.magic = STREAM_MAGIC;
+  client.out.resize(sizeof(STREAM_FRAME));
+
+  if (precision <= 0) {
+    header.type = STREAM_FULL;
+    if (!current.empty())
+      appendBytes(client.out, &current[0], sizeof(FAH_XYZ) * current.size());
+
+  } else if (client.sinceKey == 0 || client.sinceKey >= keyframes) {
+    header.type = STREAM_KEY;
+    if (!quantized.empty())
+      appendBytes(client.out, &quantized[0],
+                  sizeof(int32_t) * quantized.size());
+    client.reference = quantized;
+    client.sinceKey = 1;
+
+  } else {
+    header.type = STREAM_DELTA;
+    for (unsigned int i = 0; i < quantized.size(); i++) {
+      appendVarint(client.out, quantized[i] - client.reference[i]);
+      client.reference[i] = quantized[i];
+    }
+    client.sinceKey++;
+  }
+
+  header.length = client.out.size() - sizeof(STREAM_FRAME);
+  memcpy(&client.out[0], &header, sizeof(STREAM_FRAME));
+}
+
+#endif // HAVE_EPOLL
@@ -0,0 +1,135 @@
+/*  -*- c++ -*-  */
+#ifndef PROTOMOL_STREAM_SERVER_H
+#define PROTOMOL_STREAM_SERVER_H
+
+#ifdef HAVE_EPOLL
+
+#define STREAM_MAGIC   0x4D525453
+#define STREAM_VERSION 1
+
+#include <protomol/output/GUIServer.h>
+
+#include <pthread.h>
+#include <map>
+#include <vector>
+
+namespace ProtoMol {
+
+  /*
+   * On connect a client gets a STREAM_INFO followed by atom_count FAH_ATOMs
+   * and bond_count FAH_BONDs, then a STREAM_FRAME and length bytes of
+   * coordinates for each frame it takes. The client sends nothing, closing
+   * the connection ends it.
+   */
+  struct STREAM_INFO {
+    uint32_t magic;
+    uint32_t version;
+    uint8_t  name[64];
+    uint32_t atom_count;
+    uint32_t bond_count;
+    float    precision;  // quantization step of KEY and DELTA frames
+  } __attribute__((packed));
+
+  struct STREAM_FRAME {
+    uint32_t magic;
+    uint32_t type;       // StreamServer::frame_t
+    uint64_t frame;      // sequence number, gaps are dropped frames
+    int64_t  step;
+    float    time;
+    float    energy;
+    float    temperature;
+    uint32_t length;     // bytes of coordinates that follow
+  } __attribute__((packed));
+
+  /**
+   * Streams the latest frame of the simulation to local viewers.
+   *
+   * The simulation thread fills frame() and calls publish(), which swaps
+   * the buffer with the shared one under a mutex and wakes the server; it
+   * never waits on a socket. The server thread serves all clients from one
+   * epoll loop on non-blocking sockets. Each client is sent a frame only
+   * when the previous one has been written out, always the latest, so a
+   * slow client just skips frames.
+   *
+   * With a precision the coordinates are rounded to multiples of it; a
+   * client then gets a KEY frame of int32 every keyframes frames, and in
+   * between DELTA frames of the zig-zag varint differences to the last
+   * frame it was sent, usually one or two bytes a coordinate.
+   */
+  class StreamServer {
+  public:
+    typedef enum {
+      STREAM_FULL,   // float x, y, z
+      STREAM_KEY,    // int32 x, y, z in units of the precision
+      STREAM_DELTA   // varints of the KEY values minus the last frame's
+    } frame_t;
+
+  private:
+    struct Client {
+      std::vector<char> out;
+      unsigned int sent;
+      uint64_t frame;           // last frame queued, 0 none
+      unsigned int sinceKey;
+      std::vector<int32_t> reference;
+      bool writing;             // waiting for EPOLLOUT
+    };
+
+  public:
+    std::vector<FAH_ATOM> atoms;
+    std::vector<FAH_BOND> bonds;
+
+    /// Listens on the loopback port, precision 0 sends float frames
+    StreamServer(const char *name, int natoms, int nbonds, int port,
+                 float precision, int keyframes, int maxClients);
+    ~StreamServer();
+
+    /// Starts the server thread, atoms and bonds are set
+    void startServer();
+    /// Closes the clients and joins the server thread
+    void stopServer();
+    /// Whether a client is connected, otherwise publishing can be skipped
+    bool wanted();
+    /// Buffer of the next frame, natoms coordinates
+    FAH_XYZ *frame() {return &staging[0];}
+    void publish(long step, float time, float energy, float temperature);
+
+    uint64_t getPublished() const {return published;}
+    uint64_t getSent() const {return sent;}
+    uint64_t getDropped() const {return dropped;}
+    unsigned int getClientsServed() const {return served;}
+
+  private:
+    static void *callServerThread(void *param);
+    void serverThread();
+    void acceptClients();
+    void closeClient(int fd);
+    void flush(int fd, Client &client);
+    void encode(Client &client);
+    void wake();
+
+  private:
+    STREAM_INFO info;
+    int port;
+    float precision;
+    unsigned int keyframes, maxClients;
+
+    pthread_t thread;
+    bool running;
+    int listenFd, epollFd, wakeFd;
+
+    // Frames, filled by the simulation, shared under mutex and served
+    pthread_mutex_t mutex;
+    std::vector<FAH_XYZ> staging, shared, current;
+    STREAM_FRAME sharedHeader, currentHeader;
+    std::vector<int32_t> quantized;
+    int clients;
+    bool shutdown;
+
+    std::map<int, Client> connections;
+    uint64_t published, sent, dropped;
+    unsigned int served;
+  };
+}
+
+#endif // HAVE_EPOLL
+#endif // PROTOMOL_STREAM_SERVER_H
@@ -14,6 +14,7 @@
 #include <protomol/base/SystemUtilities.h>
 #include <protomol/base/TimerStatistic.h>
 #include <protomol/base/Report.h>
+#include <protomol/base/Exception.h>
 
 #include <unistd.h>
 
@@ -37,6 +38,10 @@ using namespace ProtoMol;
 #ifdef HAVE_MPI
 // Not data member to avoid dependcies
 static MPI_Comm slaveComm = MPI_COMM_NULL;
+// Nodes working on the same system, all nodes unless split()
+static MPI_Comm groupComm = MPI_COMM_NULL;
+// Masters of all groups
+static MPI_Comm leaderComm = MPI_COMM_NULL;
 const int NEED_RANGE = 1;
 const int SEND_RANGE = 2;
 #endif
@@ -67,9 +72,9 @@ void mpiExit() {
 #ifdef HAVE_MPI
 static void mpiStartSerial(bool exludeMaster) {
   if (Parallel::ok()) {
-    MPI_Barrier((exludeMaster ? slaveComm : MPI_COMM_WORLD));
+    MPI_Barrier((exludeMaster ? slaveComm : groupComm));
     for (int p = 0; p < Parallel::getId(); p++)
-      MPI_Barrier((exludeMaster ? slaveComm : MPI_COMM_WORLD));
+      MPI_Barrier((exludeMaster ? slaveComm : groupComm));
   }
 }
 #endif
@@ -79,9 +84,9 @@ static void mpiStartSerial(bool exludeMaster) {
 static void mpiEndSerial(bool exludeMaster) {
   if (Parallel::ok()) {
     for (int p = Parallel::getId() + 1; p < Parallel::getNum(); p++)
-      MPI_Barrier((exludeMaster ? slaveComm : MPI_COMM_WORLD));
+      MPI_Barrier((exludeMaster ? slaveComm : groupComm));
 
-    MPI_Barrier((exludeMaster ? slaveComm : MPI_COMM_WORLD));
+    MPI_Barrier((exludeMaster ? slaveComm : groupComm));
   }
 }
 #endif
@@ -110,7 +115,7 @@ template<bool exludeMaster>
 void doBarrier() {
   if (Parallel::isBarrier()) {
     TimerStatistic::timer[TimerStatistic::IDLE].start();
-    MPI_Barrier((exludeMaster ? slaveComm : MPI_COMM_WORLD));
+    MPI_Barrier((exludeMaster ? slaveComm : groupComm));
     TimerStatistic::timer[TimerStatistic::IDLE].stop();
   }
 }
@@ -122,7 +127,7 @@ void allReduceScalar(T &begin) {
   if (dobarrier)
     doBarrier<exludeMaster>();
   MPI_Allreduce(&tmp, &begin, 1, MPITypeTraits<T>::datatype, MPI_SUM,
-                (exludeMaster ? slaveComm : MPI_COMM_WORLD));
+                (exludeMaster ? slaveComm : groupComm));
 }
 
 //____ allReduce
@@ -134,7 +139,7 @@ void allReduce(T *begin, T *end) {
     doBarrier<exludeMaster>();
   MPI_Allreduce(&(tmp[0]), begin, (end - begin), MPITypeTraits<T>::datatype,
                 MPI_SUM,
-                (exludeMaster ? slaveComm : MPI_COMM_WORLD));
+                (exludeMaster ? slaveComm : groupComm));
 }
 
 template<bool exludeMaster, bool dobarrier>
@@ -157,7 +162,7 @@ void broadcastScalar(T &begin) {
   if (dobarrier)
     doBarrier<exludeMaster>();
   MPI_Bcast(&begin, 1, MPITypeTraits<T>::datatype, master,
-            (exludeMaster ? slaveComm : MPI_COMM_WORLD));
+            (exludeMaster ? slaveComm : groupComm));
 }
 
 //____ broadcast
@@ -216,7 +221,7 @@ void broadcast(T *begin, T *end) {
     doBarrier<exludeMaster>();
   BroadcastNonBlocking(begin, (end - begin), MPITypeTraits<T>::datatype,
             (exludeMaster ? 0 : master),
-            (exludeMaster ? slaveComm : MPI_COMM_WORLD));
+            (exludeMaster ? slaveComm : groupComm));
 }
 
 template<bool exludeMaster, bool dobarrier>
@@ -248,6 +253,8 @@ bool Parallel::myFinalized = false;
 int Parallel::myId = 0;
 int Parallel::myMasterId = master;
 int Parallel::myNum = 1;
+int Parallel::myGroup = 0;
+int Parallel::myNumGroups = 1;
 int Parallel::myAvailableId = 0;
 int Parallel::myAvailableNum = 1;
 bool Parallel::myIsParallel = Parallel::isMPI;
@@ -290,6 +297,8 @@ Parallel::Parallel() {
   myId = 0;
   myMasterId = master;
   myNum = 1;
+  myGroup = 0;
+  myNumGroups = 1;
   myAvailableId = 0;
   myAvailableNum = 1;
   myIsParallel = Parallel::isMPI;
@@ -337,6 +346,7 @@ void Parallel::init(int &argc, char ** &argv) {
   if (!myInitialized && !myFinalized) {
 #ifdef HAVE_MPI
     MPI_Init(&argc, &argv);
+    groupComm = MPI_COMM_WORLD;
     MPI_Comm_size(MPI_COMM_WORLD, &myNum);
     MPI_Comm_rank(MPI_COMM_WORLD, &myId);
     MPI_Barrier(MPI_COMM_WORLD);
@@ -373,6 +383,10 @@ void Parallel::finalize() {
 #ifdef HAVE_MPI
     if (iAmSlave())
       MPI_Comm_free(&slaveComm);
+    if (leaderComm != MPI_COMM_NULL)
+      MPI_Comm_free(&leaderComm);
+    if (groupComm != MPI_COMM_WORLD)
+      MPI_Comm_free(&groupComm);
 
     if (myBuffer != NULL) {
       int size;
@@ -386,6 +400,45 @@ void Parallel::finalize() {
   }
 }
 
+void Parallel::split(int numGroups) {
+  if (numGroups == myNumGroups || !ok("Called [Parallel::split]."))
+    return;
+#ifdef HAVE_MPI
+  int worldNum, worldId;
+  MPI_Comm_size(MPI_COMM_WORLD, &worldNum);
+  MPI_Comm_rank(MPI_COMM_WORLD, &worldId);
+  if (myNumGroups != 1)
+    THROW("[Parallel::split] Nodes are already split.");
+  if (numGroups < 1 || worldNum % numGroups != 0)
+    THROWS("[Parallel::split] Can not split " << worldNum << " nodes into "
+           << numGroups << " groups of equal size.");
+
+  // Consecutive ids form a group, its first node is the master
+  myNumGroups = numGroups;
+  myGroup = worldId / (worldNum / numGroups);
+  MPI_Comm_split(MPI_COMM_WORLD, myGroup, worldId, &groupComm);
+  MPI_Comm_size(groupComm, &myNum);
+  MPI_Comm_rank(groupComm, &myId);
+  MPI_Comm_split(MPI_COMM_WORLD, (myId == myMasterId ? 0 : MPI_UNDEFINED),
+                 worldId, &leaderComm);
+
+  myIsParallel = (myNum > 1);
+  myIAmMaster = (myId == myMasterId);
+  report.setIAmMaster(worldId == master);
+  setMode(isParallel() ? ParallelType::DYNAMIC : ParallelType::STATIC);
+  setPipeSize(myPipeSize);
+  TimerStatistic::setParallel(myIsParallel);
+  myDone.clear();
+  if (iAmMaster() && isParallel())
+    myDone.resize(myNum);
+
+  report << plain << "Split " << worldNum << " nodes into " << numGroups
+         << " groups." << endr;
+#else
+  THROW("[Parallel::split] No MPI compilation.");
+#endif
+}
+
 bool Parallel::ok(const string &err) {
   if (ok())
     return true;
@@ -424,9 +477,9 @@ void Parallel::setMode(ParallelType mode) {
     myMasterId
   };
 
-  MPI_Comm_group(MPI_COMM_WORLD, &worldGroup);
+  MPI_Comm_group(groupComm, &worldGroup);
   MPI_Group_excl(worldGroup, myNum - myAvailableNum, excl, &slaveGroup);
-  MPI_Comm_create(MPI_COMM_WORLD, slaveGroup, &slaveComm);
+  MPI_Comm_create(groupComm, slaveGroup, &slaveComm);
   MPI_Group_free(&worldGroup);
   MPI_Group_free(&slaveGroup);
   if (slaveComm != MPI_COMM_NULL)
@@ -481,7 +534,7 @@ Parallel::WorkState Parallel::getWorkState() {
 
 void Parallel::sync() {
 #ifdef HAVE_MPI
-  MPI_Barrier(MPI_COMM_WORLD);
+  MPI_Barrier(groupComm);
 #endif
 }
 
@@ -597,7 +650,7 @@ void Parallel::send(Real *data, int num, int address) {
   // Just a nice wrapper that automatically selects the MPI datatype for you
   // and handles all the annoying things
   MPI_Send(data, num, MPITypeTraits<Real>::datatype, address, 0,
-           MPI_COMM_WORLD);
+           groupComm);
 }
 
 #else
@@ -610,7 +663,7 @@ void Parallel::recv(Real *data, int num, int address) {
   // Another MPI wrapper function....
   MPI_Status status;
   MPI_Recv(data, num, MPITypeTraits<Real>::datatype, address, 0,
-           MPI_COMM_WORLD,
+           groupComm,
            &status);
 }
 
@@ -626,7 +679,7 @@ void Parallel::sendrecv(Real *senddata, int sendnum, int sendaddr,
   MPI_Status status;
   MPI_Sendrecv(senddata, sendnum, MPITypeTraits<Real>::datatype, sendaddr, 0,
                recvdata, recvnum, MPITypeTraits<Real>::datatype, recvaddr, 0,
-               MPI_COMM_WORLD,
+               groupComm,
                &status);
 }
 
@@ -640,7 +693,7 @@ void Parallel::sendrecv_replace(Real *data, int num, int sendaddr,
                                 int recvaddr) {
   MPI_Status status;
   MPI_Sendrecv_replace(data, num, MPITypeTraits<Real>::datatype, sendaddr, 0,
-                       recvaddr, 0, MPI_COMM_WORLD,
+                       recvaddr, 0, groupComm,
                        &status);
 }
 
@@ -653,7 +706,7 @@ void Parallel::sendrecv_replace(Real *, int, int, int) {}
 void Parallel::gather(Real *data, int num, Real *data_array, int address) {
   MPI_Gather(data, num, MPITypeTraits<Real>::datatype, data_array, num,
              MPITypeTraits<Real>::datatype, address,
-             MPI_COMM_WORLD);
+             groupComm);
 }
 
 #else
@@ -665,7 +718,7 @@ void Parallel::gather(Real *, int, Real *, int) {}
 void Parallel::allgather(Real *data, int num, Real *data_array) {
   MPI_Allgather(data, num, MPITypeTraits<Real>::datatype, data_array, num,
                 MPITypeTraits<Real>::datatype,
-                MPI_COMM_WORLD);
+                groupComm);
 }
 
 #else
@@ -762,6 +815,35 @@ void Parallel::bcast(int &) {}
 
 #endif
 
+#ifdef HAVE_MPI
+void Parallel::bcast(Real *begin, Real *end) {
+  if (!isParallel())
+    return;
+  broadcast<false, true>(begin, end);
+}
+
+#else
+void Parallel::bcast(Real *, Real *) {}
+
+#endif
+
+#ifdef HAVE_MPI
+void Parallel::allgatherGroups(Real *data, int num, Real *data_array) {
+  if (leaderComm == MPI_COMM_NULL) {
+    copy(data, data + num, data_array);
+    return;
+  }
+  MPI_Allgather(data, num, MPITypeTraits<Real>::datatype, data_array, num,
+                MPITypeTraits<Real>::datatype, leaderComm);
+}
+
+#else
+void Parallel::allgatherGroups(Real *data, int num, Real *data_array) {
+  copy(data, data + num, data_array);
+}
+
+#endif
+
 #ifdef HAVE_MPI
 void Parallel::bcastSlaves(Real *begin, Real *end) {
   if (!iAmSlave() || !isParallel())
@@ -841,7 +923,7 @@ void Parallel::resetNext(const vector<int> &blocks) {
       continue;
 
     MPI_Bsend(&(myBlockList[myI]), 2, MPI_INT, myP, SEND_RANGE,
-              MPI_COMM_WORLD);
+              groupComm);
 #ifdef DEBUG_PARALLEL
     report << allnodes << plain << "Block[" << myI << "] = [" <<
     myBlockList[myI] << "," <<
@@ -877,10 +959,10 @@ void Parallel::nextMaster() {
     while (!test) {
       myP = (1 + myP) % myNum;
       if (myP != myMasterId)
-        MPI_Iprobe(myP, NEED_RANGE, MPI_COMM_WORLD, &test, &status);
+        MPI_Iprobe(myP, NEED_RANGE, groupComm, &test, &status);
     }
 
-    MPI_Recv(tmp, 0, MPI_CHAR, myP, NEED_RANGE, MPI_COMM_WORLD, &status);
+    MPI_Recv(tmp, 0, MPI_CHAR, myP, NEED_RANGE, groupComm, &status);
     myRecv--;
 #ifdef DEBUG_PARALLEL
     report << allnodes << plain << "Recieve from " << myP << "." << endr;
@@ -892,7 +974,7 @@ void Parallel::nextMaster() {
     // receiving any messages.
     if (myDone[myP] == 0) {
       MPI_Bsend(&(myBlockList[myI]), 2, MPI_INT, myP, SEND_RANGE,
-                MPI_COMM_WORLD);
+                groupComm);
 #ifdef DEBUG_PARALLEL
       report << allnodes << plain << "Block[" << myI << "] = [" <<
       myBlockList[myI] << "," <<
@@ -929,10 +1011,10 @@ bool Parallel::next() {
         MPI_Status status;
         char tmp[1];
 
-        MPI_Iprobe(myP, NEED_RANGE, MPI_COMM_WORLD, &test, &status);
+        MPI_Iprobe(myP, NEED_RANGE, groupComm, &test, &status);
 
         if (test) {
-          MPI_Recv(tmp, 0, MPI_CHAR, myP, NEED_RANGE, MPI_COMM_WORLD, &status);
+          MPI_Recv(tmp, 0, MPI_CHAR, myP, NEED_RANGE, groupComm, &status);
           myRecv--;
 #ifdef DEBUG_PARALLEL
           report << allnodes << plain << "Recieve from " << myP << "." <<
@@ -944,7 +1026,7 @@ bool Parallel::next() {
           // receiving any messages.
           if (myDone[myP] == 0) {
             MPI_Bsend(&(myBlockList[myI]), 2, MPI_INT, myP, SEND_RANGE,
-                      MPI_COMM_WORLD);
+                      groupComm);
 #if defined (DEBUG_PARALLEL)
             report << allnodes << plain << "Block[" << myI << "] = [" <<
             myBlockList[myI] << "," <<
@@ -993,7 +1075,7 @@ bool Parallel::next() {
       endr;
 #endif
       MPI_Recv(myNextRange, 2, MPI_INT, myMasterId, SEND_RANGE,
-               MPI_COMM_WORLD,
+               groupComm,
                &status);
 #ifdef DEBUG_PARALLEL
       report << allnodes << plain << "Recv new block " << getId() << " [" <<
@@ -1002,7 +1084,7 @@ bool Parallel::next() {
       // Asking for the next range such we have it when we need it next time.
       TimerStatistic::timer[TimerStatistic::IDLE].stop();
       if (myNextRange[1] >= 0) {
-        MPI_Bsend(tmp, 0, MPI_CHAR, myMasterId, NEED_RANGE, MPI_COMM_WORLD);
+        MPI_Bsend(tmp, 0, MPI_CHAR, myMasterId, NEED_RANGE, groupComm);
 #ifdef DEBUG_PARALLEL
         report << allnodes << plain << "Ask new block " << getId() << "." <<
         endr;
@@ -57,6 +57,10 @@ namespace ProtoMol {
 
     static int getNum()               {return myNum;}
 
+    static int getGroup()             {return myGroup;}
+
+    static int getNumGroups()         {return myNumGroups;}
+
     static int getAvailableId()       {return myAvailableId;}
 
     static int getAvailableNum()      {return myAvailableNum;}
@@ -85,6 +89,13 @@ namespace ProtoMol {
 
     static void setMaxPackages(int n);
 
+    /**
+     * Splits the nodes into numGroups groups of consecutive nodes, each
+     * working on its own system with its own master. Everything below
+     * then works inside the group. Only the master of group 0 reports.
+     */
+    static void split(int numGroups);
+
   public:
 
     /**
@@ -94,6 +105,11 @@ namespace ProtoMol {
      */
     static void bcast(Vector3DBlock *coords);
     static void bcast(int &n);
+    static void bcast(Real *begin, Real *end);
+
+    /// Gathers num Reals from the master of every group and stores them in
+    /// an array, available on all masters. Only called by the masters.
+    static void allgatherGroups(Real *data, int num, Real *data_array);
 
     /**
      * Does the preprocessing, clearing the energies and forces for
@@ -200,6 +216,8 @@ namespace ProtoMol {
     static int myId;            ///< Actual id of the node, [0,1,...,N-1]
     static int myMasterId;      ///< Id of the master
     static int myNum;           ///< Number of nodes, N
+    static int myGroup;         ///< Group of the node, see split()
+    static int myNumGroups;     ///< Number of groups
     static int myAvailableId;   ///< Actual master-slave id, -1 for the master
     static int myAvailableNum;  ///< Available number of nodes for computation
     static bool myIsParallel;    ///< If environment has more that 1 node
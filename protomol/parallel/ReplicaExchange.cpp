@@ -0,0 +1,164 @@
+#include <protomol/parallel/ReplicaExchange.h>
+
+#include <protomol/ProtoMolApp.h>
+#include <protomol/type/Vector3DBlock.h>
+#include <protomol/parallel/Parallel.h>
+#include <protomol/integrator/Integrator.h>
+#include <protomol/topology/GenericTopology.h>
+#include <protomol/topology/TopologyUtilities.h>
+#include <protomol/base/PMConstants.h>
+#include <protomol/base/Exception.h>
+#include <protomol/base/Report.h>
+#include <protomol/base/StringUtilities.h>
+
+#include <math.h>
+
+using namespace std;
+using namespace ProtoMol;
+using namespace ProtoMol::Report;
+
+//____ ReplicaExchange
+
+ReplicaExchange::ReplicaExchange(const vector<Real> &temperatures,
+                                 long frequency, unsigned int seed) :
+  app(0), myTemperatures(temperatures), myFrequency(frequency),
+  myIndex(temperatures.size()), myAttempted(temperatures.size(), 0),
+  myAccepted(temperatures.size(), 0), myCurrent(0), myExchanges(0),
+  mySeed(seed) {
+  for (unsigned int i = 0; i < myIndex.size(); i++)
+    myIndex[i] = i;
+}
+
+void ReplicaExchange::initialize(ProtoMolApp *app) {
+  this->app = app;
+  myCurrent = Parallel::getGroup();
+
+  if ((int)myTemperatures.size() != Parallel::getNumGroups())
+    THROWS("Replica exchange with " << myTemperatures.size()
+           << " temperatures on " << Parallel::getNumGroups()
+           << " groups of nodes.");
+  if (myFrequency < 1)
+    THROW("Replica exchange frequency must be positive.");
+
+  // Start from the velocities at the temperature of the replica
+  const Real t = temperature(app->topology, &app->velocities);
+  const Real target = getTemperature();
+  if (t > 0.0)
+    rescale(&app->velocities, t, target);
+  app->outputCache.invalidateObservables();
+
+  if (!app->integrator->setTemperature(target))
+    THROW("Replica exchange needs an integrator with a thermostat, "
+          "e.g., LangevinLeapfrog.");
+
+  report << plain << "Replica exchange : replica " << Parallel::getGroup()
+         << " of " << myTemperatures.size() << " at " << target
+         << "K, exchange every " << myFrequency << " steps." << endr;
+}
+
+long ReplicaExchange::getNext(long step) const {
+  return (step / myFrequency + 1) * myFrequency;
+}
+
+void ReplicaExchange::run(long step) {
+  if (step % myFrequency != 0)
+    return;
+
+  const int n = myTemperatures.size();
+  vector<Real> index(n);
+
+  if (Parallel::iAmMaster()) {
+    Real energy = app->energies.potentialEnergy();
+    vector<Real> energies(n);
+    Parallel::allgatherGroups(&energy, 1, &energies[0]);
+
+    exchange(energies);
+
+    for (int r = 0; r < n; r++)
+      index[r] = myIndex[r];
+  } else myExchanges++;
+
+  // The nodes of the group follow their master
+  Parallel::bcast(&index[0], &index[0] + n);
+  for (int r = 0; r < n; r++)
+    myIndex[r] = (int)index[r];
+
+  setTemperature(myIndex[Parallel::getGroup()]);
+
+  if (Parallel::iAmMaster()) {
+    vector<Real> rates(n - 1, 0.0);
+    for (int k = 0; k + 1 < n; k++)
+      rates[k] = getAcceptance(k);
+    app->outputCache.add(rates);
+  }
+}
+
+void ReplicaExchange::finalize() const {
+  if (myTemperatures.size() < 2)
+    return;
+
+  report << plain << "Replica exchange acceptance :";
+  for (unsigned int k = 0; k + 1 < myTemperatures.size(); k++)
+    report << " " << toString(myTemperatures[k]) << "K-"
+           << toString(myTemperatures[k + 1]) << "K "
+           << toString(getAcceptance(k), 1, 2);
+  report << endr;
+}
+
+Real ReplicaExchange::getTemperature() const {
+  return myTemperatures[myCurrent];
+}
+
+void ReplicaExchange::exchange(const vector<Real> &energies) {
+  const int n = myTemperatures.size();
+
+  vector<int> replica(n);
+  for (int r = 0; r < n; r++)
+    replica[myIndex[r]] = r;
+
+  // The first number after seeding grows with small seeds, it is dropped
+  myRandom.seed(mySeed + myExchanges);
+  myRandom.rand();
+
+  // The even pairs on even exchanges, the odd ones on odd exchanges
+  for (int k = myExchanges % 2; k + 1 < n; k += 2) {
+    const int a = replica[k];
+    const int b = replica[k + 1];
+    const Real delta = logAcceptance(myTemperatures[k], myTemperatures[k + 1],
+                                     energies[a], energies[b]);
+
+    myAttempted[k]++;
+    if (delta >= 0.0 || myRandom.rand() < exp(delta)) {
+      swap(myIndex[a], myIndex[b]);
+      myAccepted[k]++;
+    }
+  }
+  myExchanges++;
+}
+
+Real ReplicaExchange::getAcceptance(int k) const {
+  return myAttempted[k] > 0 ? (Real)myAccepted[k] / myAttempted[k] : 0.0;
+}
+
+Real ReplicaExchange::logAcceptance(Real ti, Real tj, Real ui, Real uj) {
+  return (1.0 / ti - 1.0 / tj) / Constant::BOLTZMANN * (ui - uj);
+}
+
+void ReplicaExchange::rescale(Vector3DBlock *velocities, Real from, Real to) {
+  const Real scale = sqrt(to / from);
+  for (unsigned int i = 0; i < velocities->size(); i++)
+    (*velocities)[i] *= scale;
+}
+
+void ReplicaExchange::setTemperature(int index) {
+  if (index == myCurrent)
+    return;
+
+  // Rescale the velocities to the new temperature
+  rescale(&app->velocities, myTemperatures[myCurrent], myTemperatures[index]);
+  buildMolecularMomentum(&app->velocities, app->topology);
+  app->outputCache.invalidateObservables();
+
+  myCurrent = index;
+  app->integrator->setTemperature(myTemperatures[index]);
+}
@@ -0,0 +1,91 @@
+/*  -*- c++ -*-  */
+#ifndef REPLICAEXCHANGE_H
+#define REPLICAEXCHANGE_H
+
+#include <vector>
+
+#include <protomol/type/Real.h>
+#include <protomol/base/Random.h>
+
+namespace ProtoMol {
+  class ProtoMolApp;
+  class Vector3DBlock;
+
+  //____ ReplicaExchange
+
+  /**
+   * Temperature replica exchange between the groups of Parallel::split().
+   * Group g simulates replica g, which starts at temperature g of the
+   * ladder. Inside a group the forces are parallelized as usual.
+   *
+   * Every frequency steps neighboring temperatures, alternately the even
+   * and the odd pairs, are exchanged with probability
+   * min(1, exp((1/kT_i - 1/kT_j) (U_i - U_j))). Only the potential
+   * energies travel between the group masters. All masters draw the same
+   * random numbers, from a generator seeded with seed plus the number of
+   * the exchange, hence take the same decisions without further messages. An accepted exchange swaps the temperatures of the two
+   * replicas, i.e., the thermostat target is changed and the velocities
+   * are rescaled, the configurations stay where they are.
+   */
+  class ReplicaExchange {
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // Constructors, destructors, assignment
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    ReplicaExchange(const std::vector<Real> &temperatures, long frequency,
+                    unsigned int seed);
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // New methods of class ReplicaExchange
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    /// Sets the temperature of the replica of this group
+    void initialize(ProtoMolApp *app);
+    /// Next step after step at which exchanges are attempted
+    long getNext(long step) const;
+    /// Attempts the exchanges if step is an exchange step
+    void run(long step);
+    /// Reports the acceptance ratios
+    void finalize() const;
+
+    /// Actual temperature of the replica of this group
+    Real getTemperature() const;
+
+    /// Attempts the exchanges of one step given the potential energy of
+    /// each replica, the same on all masters
+    void exchange(const std::vector<Real> &energies);
+    /// Temperature index of replica r
+    int getIndex(int r) const {return myIndex[r];}
+    /// Accepted over attempted exchanges of temperature k and k + 1
+    Real getAcceptance(int k) const;
+
+    /// Log of the Metropolis probability to exchange the temperatures ti and
+    /// tj of two replicas with the potential energies ui and uj
+    static Real logAcceptance(Real ti, Real tj, Real ui, Real uj);
+    /// Scales the velocities from the temperature from to the one to
+    static void rescale(Vector3DBlock *velocities, Real from, Real to);
+
+  private:
+    void setTemperature(int index);
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // My data members
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  private:
+    ProtoMolApp *app;
+    std::vector<Real> myTemperatures;
+    long myFrequency;
+    /// Temperature index of each replica
+    std::vector<int> myIndex;
+    /// Attempted and accepted exchanges of temperature k and k + 1
+    std::vector<int> myAttempted;
+    std::vector<int> myAccepted;
+    /// Temperature index of the replica of this group
+    int myCurrent;
+    int myExchanges;
+    unsigned int mySeed;
+    /// Random numbers of the exchanges, the same on all masters
+    Random myRandom;
+  };
+}
+#endif /* REPLICAEXCHANGE_H */
@@ -6,6 +6,7 @@
 
 #include <protomol/config/Parameter.h>
 #include <protomol/type/Matrix3By3.h>
+#include <protomol/force/MixedPrecision.h>
 
 namespace ProtoMol {
   //____ C1SwitchingFunction
@@ -49,6 +50,20 @@ namespace ProtoMol {
       derivOverD = -my15Cutoff_1 / dist + dist * my15Cutoff_3;
     }
 
+    void singlePrecision(float &value, float &derivOverD,
+                         float distSquared) const {
+      if (distSquared > myCutoff2) {
+        value = 0.0f;
+        derivOverD = 0.0f;
+        return;
+      }
+      float dist = sqrtf(distSquared);
+      value = 1.0f - dist * (static_cast<float>(my15Cutoff_1) -
+                             distSquared * static_cast<float>(my05Cutoff_3));
+      derivOverD = -static_cast<float>(my15Cutoff_1) / dist +
+        dist * static_cast<float>(my15Cutoff_3);
+    }
+
     Matrix3By3 hessian(const Vector3D &rij, Real distSquared) const;
 
     static const std::string getId() {return "C1";}
@@ -64,6 +79,11 @@ namespace ProtoMol {
          my15Cutoff_3;
   };
 
+  template<>
+  struct MixedPrecision<C1SwitchingFunction> {
+    enum {SUPPORTED = 1};
+  };
+
   //____ INLINES
 }
 #endif /* C1SWITCHINGFUNCTION_H */
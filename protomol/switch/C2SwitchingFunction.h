@@ -7,6 +7,7 @@
 
 #include <protomol/config/Parameter.h>
 #include <protomol/type/Matrix3By3.h>
+#include <protomol/force/MixedPrecision.h>
 
 namespace ProtoMol {
   //____ C2SwitchingFunction
@@ -52,6 +53,19 @@ namespace ProtoMol {
         value = 1.0;
     }
 
+    void singlePrecision(float &value, float &deriv, float distSquared) const {
+      deriv = 0.0f;
+      if (distSquared > myCutoff2)
+        value = 0.0f;
+      else if (distSquared >= mySwitchon2) {
+        float c2 = static_cast<float>(myCutoff2) - distSquared;
+        float c4 = c2 * (static_cast<float>(mySwitch2) + 2.0f * distSquared);
+        value = static_cast<float>(mySwitch1) * (c2 * c4);
+        deriv = static_cast<float>(mySwitch3) * (c2 * c2 - c4);
+      } else
+        value = 1.0f;
+    }
+
     Matrix3By3 hessian(const Vector3D &rij, Real distSquared) const;
 
     static const std::string getId() {return "C2";}
@@ -66,6 +80,11 @@ namespace ProtoMol {
     Real mySwitchon, mySwitchon2, myCutoff, myCutoff2, mySwitch1, mySwitch2,
          mySwitch3;
   };
+
+  template<>
+  struct MixedPrecision<C2SwitchingFunction> {
+    enum {SUPPORTED = 1};
+  };
   //____ INLINES
 }
 #endif /* C2SWITCHINGFUNCTION_H */
@@ -5,6 +5,7 @@
 #include <vector>
 
 #include <protomol/config/Parameter.h>
+#include <protomol/force/MixedPrecision.h>
 
 namespace ProtoMol {
   //____ CutoffSwitchingFunction
@@ -43,6 +44,12 @@ namespace ProtoMol {
       value = (distSquared > myCutoff2 ? 0.0 : 1.0);
     }
 
+    void singlePrecision(float &value, float &derivOverD,
+                         float distSquared) const {
+      derivOverD = 0;
+      value = (distSquared > myCutoff2 ? 0.0f : 1.0f);
+    }
+
     static const std::string getId() {return "Cutoff";}
     void getParameters(std::vector<Parameter> &parameters) const {
       parameters.push_back
@@ -61,5 +68,10 @@ namespace ProtoMol {
   private:
     Real myCutoff, myCutoff2;
   };
+
+  template<>
+  struct MixedPrecision<CutoffSwitchingFunction> {
+    enum {SUPPORTED = 1};
+  };
 }
 #endif /* CUTOFFSWITCHINGFUNCTION_H */
@@ -6,6 +6,7 @@
 
 #include <protomol/config/Parameter.h>
 #include <protomol/base/PMConstants.h>
+#include <protomol/force/MixedPrecision.h>
 
 namespace ProtoMol {
   //____ UniversalSwitchingFunction
@@ -47,6 +48,11 @@ namespace ProtoMol {
       deriv = 0.0;
     }
 
+    void singlePrecision(float &value, float &deriv, float) const {
+      value = 1.0f;
+      deriv = 0.0f;
+    }
+
     static const std::string getId() {return "Universal";}
     static unsigned int getParameterSize() {return 0;}
     void getParameters(std::vector<Parameter> &) const {};
@@ -55,6 +61,11 @@ namespace ProtoMol {
       return UniversalSwitchingFunction();
     }
   };
+
+  template<>
+  struct MixedPrecision<UniversalSwitchingFunction> {
+    enum {SUPPORTED = 1};
+  };
 }
 
 #endif /* UNIVERSALSWITCHINGFUNCTION_H */
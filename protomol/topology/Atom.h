@@ -168,7 +168,7 @@ namespace ProtoMol {
     // Constructors, destructors, assignment
     //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
     Atom() : type(-1), scaledCharge(0.0), scaledMass(0.0), hvyAtom(-1),
-      atomNum(-1), cellListNext(-1), molecule(-1), mybonds(std::vector<int>()),
+      atomNum(-1), molecule(-1), mybonds(std::vector<int>()),
              mySCPISM_A(0), myGBSA_T(0) {}
 
     // A default constructor for the atom class
@@ -194,10 +194,6 @@ namespace ProtoMol {
     ///< Original order number of the atom, used to undo Heavy Atom Come
     ///< First ordering
 
-    mutable int cellListNext;
-    ///< The index of the next atom in this atom's cell list, or -1 if this
-    ///< atom is the last in its list.
-
     int molecule;
     ///< The ID# of the molecule to which this atom belongs
 
@@ -889,6 +889,7 @@ void ProtoMol::buildTopology(GenericTopology *topo, const PSF &psf,
 
   // store the molecule information
   buildMoleculeTable(topo);
+  topo->updateAtomArrays();
   buildExclusionTable(topo, topo->exclude);
 }
 
@@ -942,6 +942,7 @@ void ProtoMol::buildTopologyFromTpr(GenericTopology *topo, Vector3DBlock &pos,
 
   // store the molecule information
   buildMoleculeTable(topo);
+  topo->updateAtomArrays();
 
   // Calculate exclusions based on TPR file rather than physical topology?
 #if defined(GROMACSEXCL)
@@ -685,6 +685,7 @@ void ProtoMol::buildTopologyFromXML(GenericTopology *topo, Vector3DBlock &pos,
 
   // store the molecule information
   buildMoleculeTable(topo);
+  topo->updateAtomArrays();
 
   // optimize again
   topo->exclusions.optimize();
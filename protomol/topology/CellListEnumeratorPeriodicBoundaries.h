@@ -13,7 +13,9 @@ namespace ProtoMol {
 
   /**
    * Specialization of the cell enumerator for periodic boundary conditions
-   * and cubic cell manager
+   * and cubic cell manager. For skewed boxes the cells are parallelepipeds
+   * along the basis vectors and the stencil holds the cells within the
+   * cutoff of the skewed cell.
    */
   template<>
   class CellListEnumerator<PeriodicBoundaryConditions, CubicCellManager> {
@@ -35,16 +37,29 @@ namespace ProtoMol {
       the_counter = the_first;
       myCellListStruct = &(topo->cellLists);
 
+      const PeriodicBoundaryConditions &bc = topo->boundaryConditions;
       if (myCutoff != cutoff ||
           topo->cellManager.getCellSizeVector() != myCellSize ||
-          !(myMax == topo->cellManager.findCell(topo->max - topo->min))) {
+          !(myMax == topo->cellManager.findCell(topo->max - topo->min)) ||
+          bc.e1() != myE1 || bc.e2() != myE2 || bc.e3() != myE3) {
         myCellSize = topo->cellManager.getCellSizeVector();
         myCutoff = cutoff;
+        myE1 = bc.e1();
+        myE2 = bc.e2();
+        myE3 = bc.e3();
 
         myMax = topo->cellManager.findCell(topo->max - topo->min);
 
         Real cutoff2 = cutoff * cutoff;
 
+        // Edges of a skewed cell
+        Vector3D a[3];
+        if (!bc.isOrthogonal()) {
+          a[0] = myE1 / topo->cellLists.getDimX();
+          a[1] = myE2 / topo->cellLists.getDimY();
+          a[2] = myE3 / topo->cellLists.getDimZ();
+        }
+
         CubicCellManager::Cell zero(0, 0, 0);
         myDeltaList.clear();
         int nx = (int)(cutoff / myCellSize.c[0] + 1.0 + Constant::EPSILON);
@@ -67,7 +82,9 @@ namespace ProtoMol {
             Real d1 = d0 + y * y * yy;
             for (int m = -n2; m <= n2; m++) {
               int z = abs(m) - 1; if (z < 0) z = 0;
-              if (d1 + z * z * zz < cutoff2) {
+              if (bc.isOrthogonal() ? d1 + z * z * zz < cutoff2 :
+                  cellDistanceSquared(a[0] * k + a[1] * l + a[2] * m, a) <
+                  cutoff2) {
                 CubicCellManager::Cell delta(k, l, m);
                 CubicCellManager::Cell minimalDelta =
                   myCellListStruct->basisCell(delta);
@@ -133,6 +150,57 @@ namespace ProtoMol {
       while (i > j);
     }
 
+  private:
+    /**
+     * Squared distance between two skewed cells with edges a, the second
+     * one shifted by s. This is the distance of the origin to the
+     * parallelepiped s + t0 a0 + t1 a1 + t2 a2, -1 <= ti <= 1, which is zero
+     * inside, else taken on a face or, if the closest point of the plane of
+     * the face lies outside, on one of its edges.
+     */
+    static Real cellDistanceSquared(const Vector3D &s, const Vector3D *a) {
+      Vector3D b(a[1].cross(a[2]));
+      Real det = a[0].dot(b);
+      if (fabs(b.dot(s)) <= fabs(det) &&
+          fabs(a[2].cross(a[0]).dot(s)) <= fabs(det) &&
+          fabs(a[0].cross(a[1]).dot(s)) <= fabs(det))
+        return 0.0;
+
+      Real best = Constant::REAL_INFINITY;
+      for (int k = 0; k < 3; k++) {
+        const Vector3D &u = a[(k + 1) % 3];
+        const Vector3D &v = a[(k + 2) % 3];
+        Real uu = u.normSquared();
+        Real vv = v.normSquared();
+        Real uv = u.dot(v);
+        for (int sign = -1; sign <= 1; sign += 2) {
+          Vector3D c(s + a[k] * sign);
+
+          // Closest point in the plane of the face
+          Real cu = -u.dot(c);
+          Real cv = -v.dot(c);
+          Real d = uu * vv - uv * uv;
+          Real p = (cu * vv - cv * uv) / d;
+          Real q = (cv * uu - cu * uv) / d;
+          if (fabs(p) <= 1.0 && fabs(q) <= 1.0) {
+            best = std::min(best, (c + u * p + v * q).normSquared());
+            continue;
+          }
+
+          // Closest points on the edges of the face
+          for (int e = -1; e <= 1; e += 2) {
+            Vector3D cu1(c + u * e);
+            Real t = std::max(-1.0, std::min(1.0, -v.dot(cu1) / vv));
+            best = std::min(best, (cu1 + v * t).normSquared());
+            Vector3D cv1(c + v * e);
+            t = std::max(-1.0, std::min(1.0, -u.dot(cv1) / uu));
+            best = std::min(best, (cv1 + u * t).normSquared());
+          }
+        }
+      }
+      return best;
+    }
+
     //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
     // My data members
     //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -145,6 +213,7 @@ namespace ProtoMol {
     const CubicCellManager::CellListStructure *myCellListStruct;
     Vector3D myCellSize;
     CubicCellManager::Cell myMax;
+    Vector3D myE1, myE2, myE3;
   };
 }
 #endif /* CELLLISTENUMERATOR_PERDIOCBOUNDARIES_H */
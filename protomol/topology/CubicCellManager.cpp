@@ -29,6 +29,12 @@ namespace ProtoMol {
 		return mCellSize;
 	}
 
+	void CubicCellManager::setCellSize( const Real cellSize ) {
+		mCellSize = cellSize;
+		mCellSizeVector = Vector3D( cellSize, cellSize, cellSize );
+		mCellSizeVectorInverse = Vector3D( 1.0 / cellSize, 1.0 / cellSize, 1.0 / cellSize );
+	}
+
 	Real CubicCellManager::getCellVolume() const {
 		return mCellSizeVector.c[0] * mCellSizeVector.c[1] * mCellSizeVector.c[2];
 	}
@@ -30,6 +30,8 @@ namespace ProtoMol {
 			CubicCellManager( const Real cellsize );
 		public:
 			Real getCellSize() const;
+			/// Takes effect at the next initialize()
+			void setCellSize( const Real cellSize );
 			Real getCellVolume() const;
 			Vector3D getCellSizeVector() const;
 
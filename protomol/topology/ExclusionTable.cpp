@@ -1,5 +1,8 @@
 #include <protomol/topology/ExclusionTable.h>
 #include <protomol/base/Report.h>
+#include <protomol/base/Exception.h>
+
+#include <algorithm>
 
 using namespace std;
 using namespace ProtoMol::Report;
@@ -69,6 +72,35 @@ void ExclusionTable::resize(int count) {
 
 void ExclusionTable::optimize() {
   mySet.clear();
+
+  // Compressed rows of all pairs in both directions sorted by atom1 and
+  // atom2, with the class in effect
+  vector<ExclusionPair> pairs;
+  pairs.reserve(2 * myTable.size());
+  myModified.clear();
+  for (unsigned int i = 0; i < myTable.size(); i++) {
+    const int a1 = myTable[i].a1, a2 = myTable[i].a2;
+    const ExclusionClass excl = check(a1, a2);
+    pairs.push_back(ExclusionPair(a1, a2, excl));
+    pairs.push_back(ExclusionPair(a2, a1, excl));
+    if (excl == EXCLUSION_MODIFIED)
+      myModified.push_back(PairInt(a1, a2));
+  }
+  sort(pairs.begin(), pairs.end());
+  sort(myModified.begin(), myModified.end());
+
+  myRowStart.assign(myCurrentSize + 1, 0);
+  myPartners.resize(pairs.size());
+  myClasses.resize(pairs.size());
+  for (unsigned int i = 0; i < pairs.size(); i++) {
+    myRowStart[pairs[i].a1 + 1]++;
+    myPartners[i] = pairs[i].a2;
+    myClasses[i] = pairs[i].excl;
+  }
+  for (int i = 0; i < myCurrentSize; i++)
+    myRowStart[i + 1] += myRowStart[i];
+  highDeltas.clear();
+
   int count = myMaxDelta + 1;
   // minimize the lowDeltas array
   if (count < myFastDeltaMax) {
@@ -98,17 +130,38 @@ void ExclusionTable::clear(void) {
   myMaxDelta = 0;
   myTable.resize(0);
   mySet.clear();
+  myRowStart.clear();
+  myPartners.clear();
+  myClasses.clear();
+  myModified.clear();
 }
 
 void ExclusionTable::add(int atom1, int atom2, ExclusionClass type) {
+  if (!myRowStart.empty())
+    expand();
   if (atom1 > atom2)
     swap(atom1, atom2);
-  int delta = atom2 - atom1;
   if (type != EXCLUSION_NONE && atom1 != atom2 &&
       mySet.find(ExclusionPair(atom1, atom2, type)) == mySet.end()) {
     myTable.push_back(ExclusionPair(atom1, atom2, type));
     mySet.insert(ExclusionPair(atom1, atom2, type));
   }
+  set(atom1, atom2, type);
+}
+
+void ExclusionTable::restore(const vector<ExclusionPair> &table,
+                             const vector<ExclusionClass> &classes) {
+  clear();
+  myTable = table;
+  mySet.insert(table.begin(), table.end());
+  for (unsigned int i = 0; i < table.size(); i++)
+    set(table[i].a1, table[i].a2, classes[i]);
+}
+
+void ExclusionTable::set(int atom1, int atom2, ExclusionClass type) {
+  if (atom1 > atom2)
+    swap(atom1, atom2);
+  int delta = atom2 - atom1;
   if (delta > myMaxDelta)
     myMaxDelta = delta;
   if (delta < myFastDeltaMax)
@@ -119,3 +172,41 @@ void ExclusionTable::add(int atom1, int atom2, ExclusionClass type) {
   }
 }
 
+ExclusionClass ExclusionTable::checkHigh(int atom1, int atom2) const {
+  if (myRowStart.empty()) {
+    map<PairInt, ExclusionClass>::const_iterator i =
+      highDeltas.find(PairInt(atom1, atom2 - atom1));
+    return i == highDeltas.end() ? EXCLUSION_NONE : i->second;
+  }
+
+  const int *begin = &myPartners[0] + myRowStart[atom1];
+  const int *end = &myPartners[0] + myRowStart[atom1 + 1];
+  const int *i = lower_bound(begin, end, atom2);
+  if (i == end || *i != atom2)
+    return EXCLUSION_NONE;
+  return myClasses[i - &myPartners[0]];
+}
+
+void ExclusionTable::expand() {
+  for (int a1 = 0; a1 < myCurrentSize; a1++)
+    for (int i = myRowStart[a1]; i < myRowStart[a1 + 1]; i++)
+      if (myPartners[i] > a1 && myPartners[i] - a1 >= myFastDeltaMax)
+        highDeltas[PairInt(a1, myPartners[i] - a1)] = myClasses[i];
+
+  myRowStart.clear();
+  myPartners.clear();
+  myClasses.clear();
+  myModified.clear();
+}
+
+ExclusionRow ExclusionTable::getRow(int atom1, int from) const {
+  if (myRowStart.empty() && !myTable.empty())
+    THROW("ExclusionTable rows used before optimize()");
+  if (myPartners.empty())
+    return ExclusionRow();
+
+  const int *begin = &myPartners[0] + myRowStart[atom1];
+  const int *end = &myPartners[0] + myRowStart[atom1 + 1];
+  const int *i = lower_bound(begin, end, from);
+  return ExclusionRow(i, end, &myClasses[0] + (i - &myPartners[0]));
+}
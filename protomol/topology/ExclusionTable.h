@@ -36,13 +36,42 @@ namespace ProtoMol {
     ExclusionClass excl;
   };
 
+  //________________________________________ ExclusionRow
+  /**
+   * Sorted exclusions of one atom with all its partners, used to merge the
+   * exclusions into loops over increasing atom2 in linear time. The loops
+   * of a cell pair visit the atoms of a cell in increasing order.
+   */
+  struct ExclusionRow {
+    ExclusionRow() : partner(0), end(0), excl(0) {}
+    ExclusionRow(const int *p, const int *e, const ExclusionClass *c) :
+      partner(p), end(e), excl(c) {}
+
+    /// Exclusion to atom2, atom2 must not decrease between calls
+    ExclusionClass next(int atom2) {
+      while (partner != end && *partner < atom2) {
+        partner++;
+        excl++;
+      }
+      return (partner != end && *partner == atom2) ? *excl : EXCLUSION_NONE;
+    }
+
+    const int *partner;
+    const int *end;
+    const ExclusionClass *excl;
+  };
+
   //________________________________________ ExclusionTable
   /**
    * Defines the table of exclusions. ExclusionTable assumes that
    * most exclusions have a difference (delta) of the indices's of the two atoms
    * less than Constant::FASTDELTAMAX, it keeps also track of the maximum
    * difference. If the distance is less than Constant::FASTDELTAMAX a simple
-   * array look-up table is used, otherwise a map will be used.
+   * array look-up table is used, otherwise the exclusions are searched in
+   * compressed rows (CSR) holding the sorted partners of each atom. The rows
+   * are built by optimize(), before a map is used. optimize() also collects
+   * the modified pairs, which the pair loops leave out and evaluate from
+   * their own list.
    */
   class ExclusionTable {
   public:
@@ -85,20 +114,49 @@ namespace ProtoMol {
     bool empty() const {return myTable.empty();}
 
     const std::vector<ExclusionPair> &getTable() const {return myTable;}
+    /**
+     * Restores a table saved from getTable() together with the class
+     * check() reports for each pair, which is the last one added and may
+     * differ from the one kept in the table. The pairs are unique, so the
+     * duplicate search of add() is skipped. Call resize() before.
+     */
+    void restore(const std::vector<ExclusionPair> &table,
+                 const std::vector<ExclusionClass> &classes);
 
     /// Clean up temporaries and optimize space, to be called after the
     /// exclusion table is build
     void optimize();
 
+    /**
+     * Exclusions of atom1 with partners >= from, in increasing order, on
+     * both sides of atom1. Requires optimize(), which is called by all
+     * topology builders.
+     */
+    ExclusionRow getRow(int atom1, int from = 0) const;
+
+    /// Pairs (a1 < a2) of class EXCLUSION_MODIFIED, sorted, by optimize()
+    const std::vector<PairInt> &getModified() const {return myModified;}
+
     /// Maximal distance between two excluded atom pair
     int getMaxDelta() const {return myMaxDelta;}
     //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
     // My data members
     //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  private:
+    void set(int atom1, int atom2, ExclusionClass type);
+    /// Lookup for delta >= myFastDeltaMax
+    ExclusionClass checkHigh(int atom1, int atom2) const;
+    /// Moves the high deltas of the rows back to the map
+    void expand();
+
   private:
     ExclusionClass *lowDeltas;
     char *anyExclsForThisDelta;
     std::map<PairInt, ExclusionClass> highDeltas;
+    std::vector<int> myRowStart;
+    std::vector<int> myPartners;
+    std::vector<ExclusionClass> myClasses;
+    std::vector<PairInt> myModified;
     int myMaxDelta;
     std::vector<ExclusionPair> myTable;
     std::set<ExclusionPair> mySet;
@@ -120,14 +178,8 @@ namespace ProtoMol {
     if (delta > myMaxDelta) return EXCLUSION_NONE;
     if (delta < myFastDeltaMax)
       return lowDeltas[atom1 * myFastDeltaMax + delta];
-    else {
-      if (anyExclsForThisDelta[delta] < 1) return EXCLUSION_NONE;
-      std::map<PairInt, ExclusionClass>::const_iterator i = highDeltas.find(
-        PairInt(atom1, delta));
-      if (i == highDeltas.end())
-        return EXCLUSION_NONE;
-      return i->second;
-    }
+    if (anyExclsForThisDelta[delta] < 1) return EXCLUSION_NONE;
+    return checkHigh(atom1, atom2);
   }
 }
 #endif /* EXCLUSION_H */
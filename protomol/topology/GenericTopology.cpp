@@ -15,7 +15,7 @@ GenericTopology::GenericTopology() :
   min(Vector3D(Constant::MAXREAL, Constant::MAXREAL, Constant::MAXREAL)),
   max(Vector3D(-Constant::MINREAL, -Constant::MINREAL, -Constant ::MINREAL)),
   implicitSolvent(NONE), doSCPISM(0), forceFieldFlag(CHARMM), 
-  minimalMolecularDistances(false), doGBSAOpenMM(0), obcType(0),
+  minimalMolecularDistances(false), mixedPrecision(false), doGBSAOpenMM(0), obcType(0),
   dielecOffset(0), alphaObc(0), betaObc(0), gammaObc(0) {}
 
 GenericTopology::GenericTopology(Real c, const ExclusionType &e) :
@@ -23,9 +23,41 @@ GenericTopology::GenericTopology(Real c, const ExclusionType &e) :
   min(Vector3D(Constant::MAXREAL, Constant::MAXREAL, Constant::MAXREAL)),
   max(Vector3D(-Constant::MINREAL, -Constant::MINREAL, -Constant::MINREAL)),
   implicitSolvent(NONE), doSCPISM(0), forceFieldFlag(CHARMM), 
-  minimalMolecularDistances(false), doGBSAOpenMM(0), obcType(0),
+  minimalMolecularDistances(false), mixedPrecision(false), doGBSAOpenMM(0), obcType(0),
   dielecOffset(0), alphaObc(0), betaObc(0), gammaObc(0) {}
 
+void GenericTopology::updateAtomArrays() {
+  const unsigned int n = atoms.size();
+
+  atomTypeIndex.resize(n);
+  atomCharge.resize(n);
+  singleCharge.resize(n);
+  atomMolecule.resize(n);
+  cellListNext.assign(n, -1);
+
+  for (unsigned int i = 0; i < n; i++) {
+    atomTypeIndex[i] = atoms[i].type;
+    atomCharge[i] = atoms[i].scaledCharge;
+    singleCharge[i] = static_cast<float>(atoms[i].scaledCharge);
+    atomMolecule[i] = atoms[i].molecule;
+  }
+}
+
+void GenericTopology::updateSinglePrecision(const Vector3DBlock *positions)
+  const {
+  const unsigned int n = positions->size();
+
+  singleX.resize(n);
+  singleY.resize(n);
+  singleZ.resize(n);
+
+  for (unsigned int i = 0; i < n; i++) {
+    singleX[i] = static_cast<float>((*positions)[i].c[0]);
+    singleY[i] = static_cast<float>((*positions)[i].c[1]);
+    singleZ[i] = static_cast<float>((*positions)[i].c[2]);
+  }
+}
+
 GenericTopology *GenericTopology::make(const vector<Value> &values) const {
   assertParameters(values);
 
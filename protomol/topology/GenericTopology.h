@@ -87,10 +87,16 @@ namespace ProtoMol {
     virtual Real getVolume(const Vector3DBlock &positions) const = 0;
     /// Volume by boundary conditions
     virtual Real getVolume() const = 0;
+    /// True if the boundary conditions have a rectangular cell or none
+    virtual bool isOrthogonal() const = 0;
     /// rescales the volume of the system cell/minimal image
     virtual void rescaleVolume(Real fac) = 0;
     /// Tags the cell list as out of date
     virtual void uncacheCellList() = 0;
+    /// Requested edge length of the cells of the cell list
+    virtual Real getCellSize() const = 0;
+    /// Changes the cell size, the cell list is rebuilt at the next update
+    virtual void setCellSize(Real cellSize) = 0;
     /// Sets default parameters basaed on particle positions for cell manager
     /// and bounary conditions
     virtual std::vector<Parameter> getDefaults(const Vector3DBlock &positions)
@@ -103,6 +109,9 @@ namespace ProtoMol {
     /// returns the bounding box of the boundary conditions
     virtual void getBoundaryConditionsBox(Vector3D &min,
                                           Vector3D &max) const = 0;
+    /// returns the basis vectors of the periodic cell, zero in vacuum
+    virtual void getCellBasisVectors(Vector3D &e1, Vector3D &e2,
+                                     Vector3D &e3) const = 0;
 
     /// Perform a minimal-image subtraction.
     virtual Vector3D minimalDifference(const Vector3D &c1,
@@ -131,6 +140,14 @@ namespace ProtoMol {
 
     static const std::string &getKeyword() {return keyword;}
 
+    /// Copies the fields of atoms read by the pair loops to the packed
+    /// arrays, to be called after atoms is built
+    void updateAtomArrays();
+
+    /// Copies the positions to singleX, singleY and singleZ, called once
+    /// per evaluation by the pair loops running in single precision
+    void updateSinglePrecision(const Vector3DBlock *positions) const;
+
     //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
     // From class Makable
     //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -141,6 +158,19 @@ namespace ProtoMol {
     //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
   public:
     std::vector<Atom>     atoms;
+
+    /// Packed copies of Atom::type, Atom::scaledCharge and Atom::molecule,
+    /// such that the pair loops do not load the rest of the Atom record
+    std::vector<int>  atomTypeIndex;
+    std::vector<Real> atomCharge;
+    std::vector<int>  atomMolecule;
+    /// The index of the next atom in the cell list of each atom, or -1
+    mutable std::vector<int> cellListNext;
+    /// Single precision copies of atomCharge and of the positions, read by
+    /// the pair loops if mixedPrecision is set
+    std::vector<float> singleCharge;
+    mutable std::vector<float> singleX, singleY, singleZ;
+
     std::vector<AtomType> atomTypes;
     std::vector<Bond>     bonds;
     std::vector<Angle>    angles;
@@ -201,6 +231,10 @@ namespace ProtoMol {
     /// conditions
     bool minimalMolecularDistances;
 
+    /// if the NonbondedCutoff and NonbondedSimpleFull pair loops run their
+    /// single precision kernel, see MixedPrecision
+    bool mixedPrecision;
+
     //Parameters for GBSA with OpenMM
     int doGBSAOpenMM;
     int obcType;
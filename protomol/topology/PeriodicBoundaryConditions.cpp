@@ -66,12 +66,33 @@ void PeriodicBoundaryConditions::set(const Vector3D &e1, const Vector3D &e2,
   myMax.c[1] = max(a.c[1], b.c[1]);
   myMax.c[2] = max(a.c[2], b.c[2]);
 
-  myDX = power<2>(e1.c[0] * 0.5);
-  myDY = power<2>(e2.c[1] * 0.5);
-  myDZ = power<2>(e3.c[2] * 0.5);
+  if (myOrthogonal)
+    myWidth = Vector3D(fabs(e1.c[0]), fabs(e2.c[1]), fabs(e3.c[2]));
+  else
+    myWidth = Vector3D(1.0 / myE1r.norm(), 1.0 / myE2r.norm(),
+                       1.0 / myE3r.norm());
+  myDX = power<2>(myWidth.c[0] * 0.5);
+  myDY = power<2>(myWidth.c[1] * 0.5);
+  myDZ = power<2>(myWidth.c[2] * 0.5);
   myD = min(myDX, min(myDY, myDZ));
   myH = myMax - myMin;
   myH2 = myH * 0.5;
+
+  // Skewed boxes, e.g., truncated octahedra or rhombic dodecahedra, are
+  // expected in reduced form where the shortest lattice vector is one of
+  // the 26 neighboring images
+  int n = 0;
+  for (int k = -1; k <= 1; k++)
+    for (int l = -1; l <= 1; l++)
+      for (int m = -1; m <= 1; m++)
+        if (k != 0 || l != 0 || m != 0)
+          myImages[n++] = e1 * k + e2 * l + e3 * m;
+  if (!myOrthogonal) {
+    myD = myImages[0].normSquared();
+    for (int i = 1; i < 26; i++)
+      myD = min(myD, myImages[i].normSquared());
+    myD *= 0.25;
+  }
   report << debug(2) <<
   "[PeriodicBoundaryConditions] maximal safe distance=" << myD << endr;
 }
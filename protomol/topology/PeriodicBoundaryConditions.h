@@ -6,6 +6,7 @@
 
 #include <protomol/config/Parameter.h>
 #include <protomol/type/Vector3DBlock.h>
+#include <protomol/base/FastMath.h>
 
 namespace ProtoMol {
   //________________________________________ PeriodicBoundaryConditions
@@ -60,11 +61,9 @@ namespace ProtoMol {
             diff.c[2] -= myE3.c[2] * rint(myE3r.c[2] * diff.c[2]);
           }
         }
-      } else
-        // ... really difficult!
-        diff -=
-          Vector3D(myE1 * rint(myE1r.dot(diff)) + myE2 * rint(myE2r.dot(
-                diff)) + myE3 * rint(myE3r.dot(diff)));
+      } else if (diff.normSquared() > myD)
+        // ... skewed box, short distances need no wrapping either
+        minimalSkewedDifference(diff);
       return diff;
     }
 
@@ -100,15 +99,39 @@ namespace ProtoMol {
           }
         }
       } else {
-        // ... really difficult!
-        diff -=
-          Vector3D(myE1 * rint(myE1r.dot(diff)) + myE2 * rint(myE2r.dot(
-                diff)) + myE3 * rint(myE3r.dot(diff)));
+        // ... skewed box, short distances need no wrapping either
         distSquared = diff.normSquared();
+        if (distSquared > myD)
+          distSquared = minimalSkewedDifference(diff);
       }
       return diff;
     }
 
+    /// Minimal-image of a single precision difference, returns the squared
+    /// distance
+    float minimalDifference(float &dx, float &dy, float &dz) const {
+      float distSquared = dx * dx + dy * dy + dz * dz;
+      if (distSquared <= myD)
+        return distSquared;
+
+      if (myOrthogonal) {
+        dx -= static_cast<float>(myE1.c[0]) *
+          rintf(static_cast<float>(myE1r.c[0]) * dx);
+        dy -= static_cast<float>(myE2.c[1]) *
+          rintf(static_cast<float>(myE2r.c[1]) * dy);
+        dz -= static_cast<float>(myE3.c[2]) *
+          rintf(static_cast<float>(myE3r.c[2]) * dz);
+        return dx * dx + dy * dy + dz * dz;
+      }
+
+      Vector3D diff(dx, dy, dz);
+      distSquared = static_cast<float>(minimalSkewedDifference(diff));
+      dx = static_cast<float>(diff.c[0]);
+      dy = static_cast<float>(diff.c[1]);
+      dz = static_cast<float>(diff.c[2]);
+      return distSquared;
+    }
+
     /// Find the position in the basis/original cell/image.
     Vector3D minimalPosition(const Vector3D &c) const {
       Vector3D diff(c);
@@ -146,6 +169,23 @@ namespace ProtoMol {
           - myE3 * rint(myE3r.dot(diff)));
     }
 
+    /**
+     * Find the position in the skewed basis of the original cell/image: the
+     * fractional coordinates wrapped into [0,1) and scaled by the distances
+     * between opposite faces. Used to sort atoms into the cells of
+     * non-orthogonal boxes.
+     */
+    Vector3D basisPosition(const Vector3D &c) const {
+      Vector3D diff(c);
+      diff -= myOrigin;
+      Real f1 = myE1r.dot(diff) + 0.5;
+      Real f2 = myE2r.dot(diff) + 0.5;
+      Real f3 = myE3r.dot(diff) + 0.5;
+      return Vector3D((f1 - floor(f1)) * myWidth.c[0],
+                      (f2 - floor(f2)) * myWidth.c[1],
+                      (f3 - floor(f3)) * myWidth.c[2]);
+    }
+
     /// Find the lattice vector difference between two positions
     Vector3D minimalTranslationDifference(const Vector3D &c1,
                                           const Vector3D &c2) const {
@@ -202,6 +242,8 @@ namespace ProtoMol {
     const Vector3D &getMin() const {return myMin;}
     /// maximal corner of the bounding box of the minimal image/cell
     const Vector3D &getMax() const {return myMax;}
+    /// distances between the opposite faces of the minimal image/cell
+    const Vector3D &getWidth() const {return myWidth;}
     Real getVolume()         const {return myV;};
     bool isOrthogonal()      const {return myOrthogonal;};
 
@@ -220,6 +262,34 @@ namespace ProtoMol {
     /// Returns possible default values for the parameters based on the
     /// positions
     std::vector<Parameter> getDefaults(const Vector3DBlock &positions) const;
+  private:
+    /// Minimal-image of diff for skewed boxes, returns the squared distance.
+    /// Wraps the fractional coordinates, if the result is longer than the
+    /// safe distance the parallelepiped may differ from the Wigner-Seitz
+    /// cell there and the neighboring images are tried as well.
+    Real minimalSkewedDifference(Vector3D &diff) const {
+      Real n1 = fastRint(myE1r.dot(diff));
+      Real n2 = fastRint(myE2r.dot(diff));
+      Real n3 = fastRint(myE3r.dot(diff));
+      diff.c[0] -= n1 * myE1.c[0] + n2 * myE2.c[0] + n3 * myE3.c[0];
+      diff.c[1] -= n1 * myE1.c[1] + n2 * myE2.c[1] + n3 * myE3.c[1];
+      diff.c[2] -= n1 * myE1.c[2] + n2 * myE2.c[2] + n3 * myE3.c[2];
+      Real distSquared = diff.normSquared();
+      if (distSquared > myD) {
+        int k = -1;
+        for (int i = 0; i < 26; i++) {
+          Real d = (diff + myImages[i]).normSquared();
+          if (d < distSquared) {
+            distSquared = d;
+            k = i;
+          }
+        }
+        if (k >= 0)
+          diff += myImages[k];
+      }
+      return distSquared;
+    }
+
     //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
     // My data members
     //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -239,10 +309,15 @@ namespace ProtoMol {
     Real myDX;
     Real myDY;
     Real myDZ;
-    /// maximal distance between two positions where plain subtraction if safe
+    /// maximal distance between two positions where plain subtraction if safe,
+    /// half the shortest lattice vector
     Real myD;  
     Vector3D myH;
     Vector3D myH2;
+    /// distances between the opposite faces
+    Vector3D myWidth;
+    /// lattice vectors to the 26 neighboring images
+    Vector3D myImages[26];
 
     Real myV;
     bool myOrthogonal;
@@ -43,6 +43,9 @@ namespace ProtoMol {
       return Vector3D(boundaryConditions.minimalPosition(c));
     }
     virtual Real getVolume() const {return boundaryConditions.getVolume();}
+    virtual bool isOrthogonal() const {
+      return boundaryConditions.isOrthogonal();
+    }
 
     virtual Real getVolume(const Vector3DBlock &positions) const {
       Real v = boundaryConditions.getVolume();
@@ -99,6 +102,13 @@ namespace ProtoMol {
       maxbb = boundaryConditions.getMax();
     }
 
+    virtual void getCellBasisVectors(Vector3D &e1, Vector3D &e2,
+                                     Vector3D &e3) const {
+      e1 = boundaryConditions.e1();
+      e2 = boundaryConditions.e2();
+      e3 = boundaryConditions.e3();
+    }
+
     /**
      * checks whether the plain distances between all atoms on each molecule are
      * the same as with applying the boundary conditions. If true, there is no 
@@ -36,6 +36,15 @@ namespace ProtoMol {
 				cellLists.uncache();
 			}
 
+			virtual Real getCellSize() const {
+				return cellManager.getCellSize();
+			}
+
+			virtual void setCellSize( Real cellSize ) {
+				cellManager.setCellSize( cellSize );
+				cellLists.uncache();
+			}
+
 			//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 			// New methods of class Topology
 			//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -43,7 +52,13 @@ namespace ProtoMol {
 			/// invokes an update of the cell list, if necessary
 			void updateCellLists( const Vector3DBlock *positions ) const {
 				if( !cellLists.valid ) {
-					if( this->boundaryConditions.PERIODIC ) {
+					// Skewed boxes are divided into cells along their basis
+					const bool skewed = !this->boundaryConditions.isOrthogonal();
+
+					if( skewed ) {
+						this->min = Vector3D( 0.0, 0.0, 0.0 );
+						this->max = this->boundaryConditions.getWidth();
+					} else if( this->boundaryConditions.PERIODIC ) {
 						this->min = this->boundaryConditions.getMin();
 						this->max = this->boundaryConditions.getMax();
 					} else {
@@ -64,19 +79,27 @@ namespace ProtoMol {
 					CubicCellManager::CellListStructure::iterator myCellList;
 					CubicCellManager::CellListStructure::iterator end = cellLists.end();
 
+					this->cellListNext.resize( this->atoms.size() );
+
 					for( int i = ( int )this->atoms.size() - 1; i >= 0; i-- ) {
-						myCell =
-							cellManager.findCell( delta +
-												  this->boundaryConditions.minimalPosition( ( *positions )[i] ) );
+						if( skewed ) {
+							myCell =
+								cellLists.periodicCell( cellManager.findCell(
+															this->boundaryConditions.basisPosition( ( *positions )[i] ) ) );
+						} else {
+							myCell =
+								cellManager.findCell( delta +
+													  this->boundaryConditions.minimalPosition( ( *positions )[i] ) );
+						}
 
 						myCellList = cellLists.find( myCell );
 						if( myCellList == end ) {
 							// This atom is the first on its cell list, so make a new list for
 							// it.
-							this->atoms[i].cellListNext = -1;
+							this->cellListNext[i] = -1;
 							cellLists[myCell] = i;
 						} else {
-							this->atoms[i].cellListNext = myCellList->second;
+							this->cellListNext[i] = myCellList->second;
 							myCellList->second = i;
 						}
 					}
@@ -0,0 +1,490 @@
+#include <protomol/topology/TopologyCache.h>
+
+#include <protomol/topology/GenericTopology.h>
+#include <protomol/io/MappedFile.h>
+#include <protomol/base/Report.h>
+#include <protomol/base/StringUtilities.h>
+
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+using namespace std;
+using namespace ProtoMol::Report;
+using namespace ProtoMol;
+
+//____TopologyCache
+
+const unsigned int TopologyCache::VERSION = 1;
+
+namespace {
+  typedef TopologyCache::uint64 uint64;
+
+  const char MAGIC[8] = {'P', 'M', 'T', 'O', 'P', 'O', '\0', '\0'};
+  const unsigned int BYTE_ORDER_MARK = 0x01020304;
+
+  // magic, version, sizeof(Real), byte order, atoms, key, file size
+  const size_t HEADER_SIZE = 8 + 4 * 4 + 8 + 8;
+  const size_t SIZE_OFFSET = HEADER_SIZE - 8;
+
+  // 64 bit FNV-1a, the constants from their 32 bit halves
+  const uint64 FNV_OFFSET = static_cast<uint64>(0xcbf29ce4UL) << 32 |
+    0x84222325UL;
+  const uint64 FNV_PRIME = static_cast<uint64>(0x100UL) << 32 | 0x1b3UL;
+
+  // A new file next to filename that only this process writes, such that
+  // runs building the same cache at once never share one
+  string temporaryName(const string &filename) {
+#ifdef _WIN32
+    return filename + "." + toString(_getpid()) + ".tmp";
+#else
+    const string pattern = filename + ".XXXXXX";
+    vector<char> name(pattern.begin(), pattern.end());
+    name.push_back('\0');
+
+    const int fd = mkstemp(&name[0]);
+    if (fd < 0) return "";
+    fchmod(fd, 0644);
+    close(fd);
+
+    return &name[0];
+#endif
+  }
+
+  // Native binary output, the cache is only read by the same build
+  class Sink {
+  public:
+    explicit Sink(ostream &out) : out(out) {}
+
+    template<typename T>
+    void put(const T &value) {
+      out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    void put(const string &str) {
+      put(static_cast<uint64>(str.size()));
+      out.write(str.data(), str.size());
+    }
+
+    // Only for plain data
+    template<typename T>
+    void putArray(const vector<T> &v) {
+      put(static_cast<uint64>(v.size()));
+      if (!v.empty())
+        out.write(reinterpret_cast<const char *>(&v[0]), v.size() * sizeof(T));
+    }
+
+  private:
+    ostream &out;
+  };
+
+  // Bounds checked input from the mapping, fails sticky
+  class Source {
+  public:
+    Source(const char *begin, const char *end) :
+      pos(begin), end(end), ok(true) {}
+
+    bool good() const {return ok;}
+
+    template<typename T>
+    void get(T &value) {
+      if (!ok || static_cast<size_t>(end - pos) < sizeof(T)) {
+        ok = false;
+        return;
+      }
+      memcpy(&value, pos, sizeof(T));
+      pos += sizeof(T);
+    }
+
+    void get(string &str) {
+      uint64 n = 0;
+      get(n);
+      if (!ok || n > static_cast<uint64>(end - pos)) {
+        ok = false;
+        return;
+      }
+      str.assign(pos, n);
+      pos += n;
+    }
+
+    template<typename T>
+    void getArray(vector<T> &v) {
+      uint64 n = 0;
+      get(n);
+      if (!ok || n > static_cast<uint64>(end - pos) / sizeof(T)) {
+        ok = false;
+        return;
+      }
+      v.resize(n);
+      if (n) memcpy(&v[0], pos, n * sizeof(T));
+      pos += n * sizeof(T);
+    }
+
+    // Count of a non-plain array, at least one byte per element
+    bool getCount(unsigned int &n) {
+      uint64 count = 0;
+      get(count);
+      ok = ok && count <= static_cast<uint64>(end - pos);
+      n = static_cast<unsigned int>(count);
+      return ok;
+    }
+
+  private:
+    const char *pos;
+    const char *end;
+    bool ok;
+  };
+
+  void putTorsions(Sink &out, const vector<Torsion> &torsions) {
+    out.put(static_cast<uint64>(torsions.size()));
+    for (unsigned int i = 0; i < torsions.size(); i++) {
+      const Torsion &t = torsions[i];
+      out.put(t.atom1);
+      out.put(t.atom2);
+      out.put(t.atom3);
+      out.put(t.atom4);
+      out.put(t.multiplicity);
+      out.putArray(t.forceConstant);
+      out.putArray(t.phaseShift);
+      out.putArray(t.periodicity);
+      out.put(t.iSGmodifierIndex);
+      out.putArray(t.DeltaK);
+      out.putArray(t.DeltaPhase);
+    }
+  }
+
+  void getTorsions(Source &in, vector<Torsion> &torsions) {
+    unsigned int n = 0;
+    if (!in.getCount(n)) return;
+    torsions.resize(n);
+    for (unsigned int i = 0; i < n && in.good(); i++) {
+      Torsion &t = torsions[i];
+      in.get(t.atom1);
+      in.get(t.atom2);
+      in.get(t.atom3);
+      in.get(t.atom4);
+      in.get(t.multiplicity);
+      in.getArray(t.forceConstant);
+      in.getArray(t.phaseShift);
+      in.getArray(t.periodicity);
+      in.get(t.iSGmodifierIndex);
+      in.getArray(t.DeltaK);
+      in.getArray(t.DeltaPhase);
+    }
+  }
+
+  void putVector3D(Sink &out, const Vector3D &v) {
+    out.put(v.c[0]);
+    out.put(v.c[1]);
+    out.put(v.c[2]);
+  }
+
+  void getVector3D(Source &in, Vector3D &v) {
+    in.get(v.c[0]);
+    in.get(v.c[1]);
+    in.get(v.c[2]);
+  }
+}
+
+TopologyCache::TopologyCache() :
+  myKey(0), myEnabled(false), myValid(false), myNumAtoms(0) {}
+
+TopologyCache::uint64 TopologyCache::hash(const char *data, size_t size,
+                                          uint64 hash) {
+  const unsigned char *p = reinterpret_cast<const unsigned char *>(data);
+  for (size_t i = 0; i < size; i++) {
+    hash ^= p[i];
+    hash *= FNV_PRIME;
+  }
+
+  return hash;
+}
+
+bool TopologyCache::open(const string &filename, const vector<string> &files,
+                         const string &options) {
+  myFilename = filename;
+  myEnabled = myValid = false;
+  myNumAtoms = 0;
+
+  // Inputs, in order, then the options
+  uint64 key = FNV_OFFSET;
+  for (unsigned int i = 0; i < files.size(); i++) {
+    MappedFile in(files[i]);
+    if (!in.is_open()) return false;
+    in.adviseSequential();
+
+    const uint64 size = in.size();
+    key = hash(reinterpret_cast<const char *>(&size), sizeof(size), key);
+    key = hash(in.begin(), in.size(), key);
+  }
+  myKey = hash(options.data(), options.size(), key);
+  myEnabled = true;
+
+  // Header of an existing cache
+  MappedFile cache(filename);
+  if (!cache.is_open() || cache.size() < HEADER_SIZE) return true;
+
+  Source in(cache.begin(), cache.begin() + HEADER_SIZE);
+  char magic[8];
+  unsigned int version = 0, realSize = 0, byteOrder = 0;
+  uint64 cacheKey = 0, size = 0;
+  in.get(magic);
+  in.get(version);
+  in.get(realSize);
+  in.get(byteOrder);
+  in.get(myNumAtoms);
+  in.get(cacheKey);
+  in.get(size);
+
+  myValid = in.good() && memcmp(magic, MAGIC, 8) == 0 &&
+    version == VERSION && realSize == sizeof(Real) &&
+    byteOrder == BYTE_ORDER_MARK && cacheKey == myKey && size == cache.size();
+
+  if (!myValid) {
+    myNumAtoms = 0;
+    report << debug(1) << "[TopologyCache::open] Cache '" << filename
+           << "' is stale, it will be rebuilt." << endr;
+  }
+
+  return true;
+}
+
+bool TopologyCache::read(GenericTopology *topo) const {
+  MappedFile cache(myFilename);
+  if (!myValid || !cache.is_open() || cache.size() < HEADER_SIZE) return false;
+  cache.adviseSequential();
+
+  Source in(cache.begin() + HEADER_SIZE, cache.end());
+
+  // Scalars, the exclusion type comes from the configuration and is part
+  // of the key, a mismatch means the cache does not belong to this run
+  int exclude = 0;
+  in.get(exclude);
+  in.get(topo->degreesOfFreedom);
+  if (!in.good() || exclude != static_cast<int>(topo->exclude.getEnum()))
+    return false;
+
+  // Atoms
+  unsigned int n = 0;
+  if (!in.getCount(n) || n != myNumAtoms) return false;
+  topo->atoms.clear();
+  topo->atoms.resize(n);
+  for (unsigned int i = 0; i < n && in.good(); i++) {
+    Atom &atom = topo->atoms[i];
+    in.get(atom.type);
+    in.get(atom.scaledCharge);
+    in.get(atom.scaledMass);
+    in.get(atom.hvyAtom);
+    in.get(atom.atomNum);
+    in.get(atom.molecule);
+    in.get(atom.residue_seq);
+    in.getArray(atom.mybonds);
+    in.get(atom.name);
+    in.get(atom.residue_name);
+  }
+
+  // Atom types
+  if (!in.getCount(n)) return false;
+  topo->atomTypes.clear();
+  topo->atomTypes.resize(n);
+  for (unsigned int i = 0; i < n && in.good(); i++) {
+    AtomType &type = topo->atomTypes[i];
+    in.get(type.name);
+    in.get(type.mass);
+    in.get(type.charge);
+    in.get(type.symbolName);
+    in.get(type.vdwR);
+    in.get(type.sigma);
+    in.get(type.sigma14);
+    in.get(type.epsilon);
+    in.get(type.epsilon14);
+  }
+
+  // Bonded terms
+  in.getArray(topo->bonds);
+  in.getArray(topo->angles);
+  getTorsions(in, topo->dihedrals);
+  getTorsions(in, topo->impropers);
+  in.getArray(topo->rb_dihedrals);
+
+  // Lennard-Jones table, upper triangle
+  unsigned int types = 0;
+  in.get(types);
+  if (!in.good() || types != topo->atomTypes.size()) return false;
+  topo->lennardJonesParameters.resize(types);
+  for (unsigned int i = 0; i < types && in.good(); i++)
+    for (unsigned int j = i; j < types; j++) {
+      LennardJonesParameters params;
+      in.get(params);
+      topo->lennardJonesParameters.set(i, j, params);
+    }
+
+  // Molecules
+  if (!in.getCount(n)) return false;
+  topo->molecules.clear();
+  topo->molecules.resize(n);
+  for (unsigned int i = 0; i < n && in.good(); i++) {
+    Molecule &mol = topo->molecules[i];
+    in.get(mol.mass);
+    getVector3D(in, mol.position);
+    getVector3D(in, mol.momentum);
+    in.getArray(mol.atoms);
+    in.getArray(mol.pairs);
+    in.get(mol.water);
+    in.get(mol.name);
+    in.get(mol.type);
+    in.get(mol.newtype);
+    in.get(mol.lambda);
+    in.getArray(mol.bondList);
+    in.getArray(mol.angleList);
+    in.getArray(mol.dihedralList);
+    in.getArray(mol.improperList);
+  }
+
+  topo->updateAtomArrays();
+
+  // Exclusions
+  vector<ExclusionPair> table;
+  vector<ExclusionClass> classes;
+  in.getArray(table);
+  in.getArray(classes);
+  if (!in.good() || table.size() != classes.size()) return false;
+  for (unsigned int i = 0; i < table.size(); i++)
+    if (table[i].a1 < 0 || table[i].a2 < table[i].a1 ||
+        table[i].a2 >= static_cast<int>(myNumAtoms))
+      return false;
+
+  topo->exclusions.resize(topo->atoms.size());
+  if (topo->exclude != ExclusionType::NONE) {
+    topo->exclusions.restore(table, classes);
+    topo->exclusions.optimize();
+  }
+
+  return in.good();
+}
+
+bool TopologyCache::write(const GenericTopology *topo) const {
+  if (!myEnabled) return false;
+
+  const string tmp = temporaryName(myFilename);
+  ofstream file(tmp.c_str(), ios::out | ios::binary | ios::trunc);
+  if (tmp.empty() || !file) {
+    report << warning << "Can not write topology cache '" << myFilename
+           << "'." << endr;
+    return false;
+  }
+
+  Sink out(file);
+
+  // Header, the size is patched at the end
+  out.put(MAGIC);
+  out.put(VERSION);
+  out.put(static_cast<unsigned int>(sizeof(Real)));
+  out.put(BYTE_ORDER_MARK);
+  out.put(static_cast<unsigned int>(topo->atoms.size()));
+  out.put(myKey);
+  out.put(static_cast<uint64>(0));
+
+  // Scalars
+  out.put(static_cast<int>(topo->exclude.getEnum()));
+  out.put(topo->degreesOfFreedom);
+
+  // Atoms
+  out.put(static_cast<uint64>(topo->atoms.size()));
+  for (unsigned int i = 0; i < topo->atoms.size(); i++) {
+    const Atom &atom = topo->atoms[i];
+    out.put(atom.type);
+    out.put(atom.scaledCharge);
+    out.put(atom.scaledMass);
+    out.put(atom.hvyAtom);
+    out.put(atom.atomNum);
+    out.put(atom.molecule);
+    out.put(atom.residue_seq);
+    out.putArray(atom.mybonds);
+    out.put(atom.name);
+    out.put(atom.residue_name);
+  }
+
+  // Atom types
+  out.put(static_cast<uint64>(topo->atomTypes.size()));
+  for (unsigned int i = 0; i < topo->atomTypes.size(); i++) {
+    const AtomType &type = topo->atomTypes[i];
+    out.put(type.name);
+    out.put(type.mass);
+    out.put(type.charge);
+    out.put(type.symbolName);
+    out.put(type.vdwR);
+    out.put(type.sigma);
+    out.put(type.sigma14);
+    out.put(type.epsilon);
+    out.put(type.epsilon14);
+  }
+
+  // Bonded terms
+  out.putArray(topo->bonds);
+  out.putArray(topo->angles);
+  putTorsions(out, topo->dihedrals);
+  putTorsions(out, topo->impropers);
+  out.putArray(topo->rb_dihedrals);
+
+  // Lennard-Jones table, upper triangle
+  const unsigned int types = topo->lennardJonesParameters.size();
+  out.put(types);
+  for (unsigned int i = 0; i < types; i++)
+    for (unsigned int j = i; j < types; j++)
+      out.put(topo->lennardJonesParameters(i, j));
+
+  // Molecules
+  out.put(static_cast<uint64>(topo->molecules.size()));
+  for (unsigned int i = 0; i < topo->molecules.size(); i++) {
+    const Molecule &mol = topo->molecules[i];
+    out.put(mol.mass);
+    putVector3D(out, mol.position);
+    putVector3D(out, mol.momentum);
+    out.putArray(mol.atoms);
+    out.putArray(mol.pairs);
+    out.put(mol.water);
+    out.put(mol.name);
+    out.put(mol.type);
+    out.put(mol.newtype);
+    out.put(mol.lambda);
+    out.putArray(mol.bondList);
+    out.putArray(mol.angleList);
+    out.putArray(mol.dihedralList);
+    out.putArray(mol.improperList);
+  }
+
+  // Exclusions, with the class currently in effect for each pair
+  const vector<ExclusionPair> &table = topo->exclusions.getTable();
+  vector<ExclusionClass> classes(table.size());
+  for (unsigned int i = 0; i < table.size(); i++)
+    classes[i] = topo->exclusions.check(table[i].a1, table[i].a2);
+  out.putArray(table);
+  out.putArray(classes);
+
+  const uint64 size = static_cast<uint64>(file.tellp());
+  file.seekp(SIZE_OFFSET);
+  out.put(size);
+  file.close();
+
+  if (file.fail() || rename(tmp.c_str(), myFilename.c_str()) != 0) {
+    remove(tmp.c_str());
+    report << warning << "Can not write topology cache '" << myFilename
+           << "'." << endr;
+    return false;
+  }
+
+  report << plain << "Topology cache '" << myFilename << "' written ("
+         << size << " bytes)." << endr;
+
+  return true;
+}
@@ -0,0 +1,82 @@
+/*  -*- c++ -*-  */
+#ifndef TOPOLOGYCACHE_H
+#define TOPOLOGYCACHE_H
+
+#include <protomol/type/TypeSelection.h>
+
+#include <string>
+#include <vector>
+
+namespace ProtoMol {
+  class GenericTopology;
+
+  //____TopologyCache
+
+  /**
+   * Binary cache of a topology built by buildTopology(): atoms, atom types,
+   * bonded terms, exclusions, Lennard-Jones table and molecules.
+   *
+   * The cache is keyed on a hash of the input files and of the options
+   * that change the built topology. A later run with the same key maps the
+   * cache and restores the topology without parsing the PSF/PAR files or
+   * resolving any parameters. The file is versioned and records the size
+   * of Real and the byte order, caches from other builds are rebuilt.
+   *
+   * Per atom SCPISM and GBSA parameters are not cached.
+   */
+  class TopologyCache {
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // Typedef & const
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    typedef TypeSelection::UInt<8>::type uint64;
+
+    static const unsigned int VERSION;
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // Constructors, destructors (both default here), assignment
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    TopologyCache();
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // New methods of class TopologyCache
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  public:
+    /**
+     * Enables the cache filename for the given input files and options
+     * and checks if it holds a matching topology. False if an input file
+     * can not be read.
+     */
+    bool open(const std::string &filename,
+              const std::vector<std::string> &files,
+              const std::string &options);
+
+    bool isEnabled() const {return myEnabled;}
+    /// True if open() found a cache with the same key
+    bool isValid() const {return myValid;}
+    const std::string &getFilename() const {return myFilename;}
+    uint64 getKey() const {return myKey;}
+    unsigned int getNumAtoms() const {return myNumAtoms;}
+
+    /// Restores the topology, false if the cache is corrupt
+    bool read(GenericTopology *topo) const;
+    /// Saves the topology, written to a temporary file and renamed, such
+    /// that concurrent runs never see a partial cache
+    bool write(const GenericTopology *topo) const;
+
+    /// FNV-1a hash of data continuing from hash
+    static uint64 hash(const char *data, size_t size, uint64 hash);
+
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    // My data members
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  private:
+    std::string myFilename;
+    uint64 myKey;
+    bool myEnabled;
+    bool myValid;
+    unsigned int myNumAtoms;
+  };
+}
+#endif /* TOPOLOGYCACHE_H */
@@ -410,13 +410,21 @@ namespace ProtoMol {
     if (velocities->empty())
       return Vector3D(0.0, 0.0, 0.0);
 
-    Vector3D momentum = linearMomentumSolute(velocities, topo);
-
-    // Count number of solute atoms
-    int soluteAtoms = 0;
-    for (unsigned int i = 0; i < topo->atoms.size(); i++)
-      if (topo->molecules[topo->atoms[i].molecule].water == false)
+    // Momentum as linearMomentumSolute() and number of solute atoms in
+    // one sweep
+    Vector3D momentum((*velocities)[0] * topo->atoms[0].scaledMass);
+    Vector3D tempC(0.0, 0.0, 0.0);
+    int soluteAtoms =
+      topo->molecules[topo->atoms[0].molecule].water == false ? 1 : 0;
+    for (unsigned int i = 1; i < topo->atoms.size(); i++)
+      if (topo->molecules[topo->atoms[i].molecule].water == false) {
         soluteAtoms += 1;
+        Vector3D tempX((*velocities)[i] * topo->atoms[i].scaledMass);
+        Vector3D tempY(tempX - tempC);
+        Vector3D tempT(momentum + tempY);
+        tempC = (tempT - momentum) - tempY;
+        momentum = tempT;
+      }
 
     Vector3D avgMomentum = momentum / soluteAtoms;
     for (unsigned int i = 0; i < topo->atoms.size(); i++)
@@ -572,17 +580,36 @@ namespace ProtoMol {
     // Center of mass
     Vector3D center = centerOfMass(positions, topo);
 
-    // Angular momentum
-    Vector3D momentum = angularMomentumSolute(positions,
-      velocities,
-      topo,
-      center);
+    // Angular momentum as angularMomentumSolute() and inertia moment as
+    // inertiaMomentumSolute() in one sweep
+    Vector3D momentum(((*positions)[0] - center).cross(
+                        (*velocities)[0]) * topo->atoms[0].scaledMass);
+    Vector3D tempC(0.0, 0.0, 0.0);
+    Matrix3By3 inertia;
+    inertia.zeroMatrix();
+    for (unsigned int i = 0; i < topo->atoms.size(); i++)
+      if (topo->molecules[topo->atoms[i].molecule].water == false) {
+        Vector3D r((*positions)[i] - center);
+        if (i > 0) {
+          Vector3D tempX(r.cross((*velocities)[i]) *
+                         topo->atoms[i].scaledMass);
+          Vector3D tempY(tempX - tempC);
+          Vector3D tempT(momentum + tempY);
+          tempC = (tempT - momentum) - tempY;
+          momentum = tempT;
+        }
+
+        Real x = r.c[0];
+        Real y = r.c[1];
+        Real z = r.c[2];
+        inertia += Matrix3By3(y * y + z * z, -x * y, -x * z,
+          -x * y, x * x + z * z, -y * z,
+          -x * z, -y * z, x * x + y * y) * topo->atoms[i].scaledMass;
+      }
+
     if (momentum.normSquared() == 0)
       return Vector3D(0.0, 0.0, 0.0);
 
-    // Inertia moment
-    Matrix3By3 inertia = inertiaMomentumSolute(positions, topo, center);
-
     if (!inertia.invert())
       return Vector3D(0.0, 0.0, 0.0);
     // Remove angular momentum
@@ -18,6 +18,12 @@ Vector3D VacuumBoundaryConditions::getMax() const {
     Constant::REAL_INFINITY);
 }
 
+Vector3D VacuumBoundaryConditions::getWidth() const {
+  return Vector3D(Constant::REAL_INFINITY,
+    Constant::REAL_INFINITY,
+    Constant::REAL_INFINITY);
+}
+
 Real VacuumBoundaryConditions::getVolume() const {
   return Constant::REAL_INFINITY;
 }
@@ -36,8 +36,17 @@ namespace ProtoMol {
       distSquared = diff.normSquared();
       return diff;
     }
+
+    /// Minimal-image of a single precision difference, returns the squared
+    /// distance
+    float minimalDifference(float &dx, float &dy, float &dz) const {
+      return dx * dx + dy * dy + dz * dz;
+    }
+
     /// Find the position in the basis/original cell/image.
     Vector3D minimalPosition(const Vector3D &c) const {return c;}
+    /// Find the position in the skewed basis of the original cell/image.
+    Vector3D basisPosition(const Vector3D &c) const {return c;}
     /// Find the lattice vector difference between two positions
     Vector3D minimalTranslationDifference(const Vector3D &,
                                           const Vector3D &) const {
@@ -67,6 +76,8 @@ namespace ProtoMol {
     Vector3D getMin()    const;
     /// maximal corner of the bounding box of the minimal image/cell
     Vector3D getMax()    const;
+    /// distances between the opposite faces of the minimal image/cell
+    Vector3D getWidth()  const;
     Real getVolume()     const;
     bool isOrthogonal()  const {return true;};
 
@@ -140,34 +140,13 @@ namespace ProtoMol
 
     BlockMatrix om( RowStart, bm.ColumnStart, Rows, bm.Columns );
 
-	if( Lapack::isEnabled() ){
-		char *transA = ( char * )"N"; char *transB = ( char * )"N";
-		int m = Rows; int n = bm.Columns; int k = kh - kl;
-		int lda = Rows; int ldb = bm.Rows; int ldc = om.Rows;
-		double alpha = 1.0; double beta = 0.0;
+	char *transA = ( char * )"N"; char *transB = ( char * )"N";
+	int m = Rows; int n = bm.Columns; int k = kh - kl;
+	int lda = Rows; int ldb = bm.Rows; int ldc = om.Rows;
+	double alpha = 1.0; double beta = 0.0;
 
-		Lapack::dgemm( transA, transB, &m, &n, &k, &alpha, ( double * )&MyArray[( kl-ColumnStart )*Rows], &lda, ( double * )&bm.MyArray[kl - bm.RowStart],
+	Lapack::dgemm( transA, transB, &m, &n, &k, &alpha, ( double * )&MyArray[( kl-ColumnStart )*Rows], &lda, ( double * )&bm.MyArray[kl - bm.RowStart],
              &ldb, &beta, &om.MyArray[( RowStart - om.RowStart ) + ( bm.ColumnStart - om.ColumnStart ) * om.Rows], &ldc );
-	}else{
-		const unsigned int rowLength = RowStart + Rows;
-		const unsigned int otherColumnLength = bm.ColumnStart + bm.Columns;
-
-		for ( unsigned int i = RowStart; i < rowLength; ++i ) {
-		  const int iThisRowStart  = i - RowStart;
-		  const int iOtherRowStart = i - om.RowStart;
-
-		  for ( unsigned int j = bm.ColumnStart; j < otherColumnLength; ++j ) {
-			Real tempf = 0.0;
-
-			for ( unsigned int k = kl; k < kh; ++k ) {
-			  tempf += MyArray[ iThisRowStart + ( k - ColumnStart ) * Rows] *
-					   bm.MyArray[( k - bm.RowStart ) + ( j - bm.ColumnStart ) * bm.Rows];
-			}
-
-			om.MyArray[ iOtherRowStart + ( j - om.ColumnStart ) * om.Rows] = tempf; //.at( changed to [] for efficiency
-		  }
-		}
-	}
 
     return om;
   }
@@ -182,34 +161,13 @@ namespace ProtoMol
          om.RowStart + om.Rows < RowStart + Rows || om.ColumnStart + om.Columns < bm.ColumnStart + bm.Columns )
       Report::report << Report::error << "[BlockMatrix::product] Target Block Matrix too small." << Report::endr;
 
-	if( Lapack::isEnabled() ){
-		char *transA = ( char * )"N"; char *transB = ( char * )"N";
-		int m = Rows; int n = bm.Columns; int k = kh - kl;
-		int lda = Rows; int ldb = bm.Rows; int ldc = om.Rows;
-		double alpha = 1.0; double beta = 0.0;
+	char *transA = ( char * )"N"; char *transB = ( char * )"N";
+	int m = Rows; int n = bm.Columns; int k = kh - kl;
+	int lda = Rows; int ldb = bm.Rows; int ldc = om.Rows;
+	double alpha = 1.0; double beta = 0.0;
 
-		Lapack::dgemm( transA, transB, &m, &n, &k, &alpha, ( double * )&MyArray[( kl-ColumnStart )*Rows], &lda, ( double * )&bm.MyArray[kl - bm.RowStart],
+	Lapack::dgemm( transA, transB, &m, &n, &k, &alpha, ( double * )&MyArray[( kl-ColumnStart )*Rows], &lda, ( double * )&bm.MyArray[kl - bm.RowStart],
              &ldb, &beta, &om.MyArray[( RowStart - om.RowStart ) + ( bm.ColumnStart - om.ColumnStart ) * om.Rows], &ldc );
-	}else{
-		const unsigned int rowLength = RowStart + Rows;
-		const unsigned int otherColumnLength = bm.ColumnStart + bm.Columns;
-
-		for ( unsigned int i = RowStart; i < rowLength; ++i ) {
-		  const int iThisRowStart  = i - RowStart;
-		  const int iOtherRowStart = i - om.RowStart;
-
-		  for ( unsigned int j = bm.ColumnStart; j < otherColumnLength; ++j ) {
-			Real tempf = 0.0;
-
-			for ( unsigned int k = kl; k < kh; ++k ) {
-			  tempf += MyArray[ iThisRowStart + ( k - ColumnStart ) * Rows] *
-					   bm.MyArray[( k - bm.RowStart ) + ( j - bm.ColumnStart ) * bm.Rows];
-			}
-
-			om.MyArray[ iOtherRowStart + ( j - om.ColumnStart ) * om.Rows] = tempf; //.at( changed to [] for efficiency
-		  }
-		}
-	}
   }
 
   // Multiply 'this' with 'bm', put result in double array 'om': TEST A, B, C
@@ -224,34 +182,13 @@ namespace ProtoMol
          om_RowStart + om_Rows < RowStart + Rows || om_ColumnStart + om_Columns < bm.ColumnStart + bm.Columns )
       Report::report << Report::error << "[BlockMatrix::product] Target Block Matrix too small." << Report::endr;
 
-	if( Lapack::isEnabled() ){
-		char *transA = ( char * )"N"; char *transB = ( char * )"N";
-		int m = Rows; int n = bm.Columns; int k = kh - kl;
-		int lda = Rows; int ldb = bm.Rows; int ldc = om_Rows;
-		double alpha = 1.0; double beta = 0.0;
+	char *transA = ( char * )"N"; char *transB = ( char * )"N";
+	int m = Rows; int n = bm.Columns; int k = kh - kl;
+	int lda = Rows; int ldb = bm.Rows; int ldc = om_Rows;
+	double alpha = 1.0; double beta = 0.0;
 
-		Lapack::dgemm( transA, transB, &m, &n, &k, &alpha, ( double * )&MyArray[( kl-ColumnStart )*Rows], &lda, ( double * )&bm.MyArray[kl - bm.RowStart],
+	Lapack::dgemm( transA, transB, &m, &n, &k, &alpha, ( double * )&MyArray[( kl-ColumnStart )*Rows], &lda, ( double * )&bm.MyArray[kl - bm.RowStart],
              &ldb, &beta, &om_MyArray[( RowStart - om_RowStart ) + ( bm.ColumnStart - om_ColumnStart ) * om_Rows], &ldc );
-	}else{
-		const unsigned int rowLength = RowStart + Rows;
-		const unsigned int otherColumnLength = bm.ColumnStart + bm.Columns;
-
-		for ( unsigned int i = RowStart; i < rowLength; ++i ) {
-		  const int iThisRowStart  = i - RowStart;
-		  const int iOtherRowStart = i - om_RowStart;
-
-		  for ( unsigned int j = bm.ColumnStart; j < otherColumnLength; ++j ) {
-			Real tempf = 0.0;
-
-			for ( unsigned int k = kl; k < kh; ++k ) {
-			  tempf += MyArray[ iThisRowStart + ( k - ColumnStart ) * Rows] *
-					   bm.MyArray[( k - bm.RowStart ) + ( j - bm.ColumnStart ) * bm.Rows];
-			}
-
-			om_MyArray[ iOtherRowStart + ( j - om_ColumnStart ) * om_Rows] = tempf; //.at( changed to [] for efficiency
-		  }
-		}
-	}
   }
 
   // Multiply 'this' with 'bm', sum result in 'om': TEST A, B, C
@@ -264,34 +201,13 @@ namespace ProtoMol
          om.RowStart + om.Rows < RowStart + Rows || om.ColumnStart + om.Columns < bm.ColumnStart + bm.Columns )
       Report::report << Report::error << "[BlockMatrix::product] Target Block Matrix too small." << Report::endr;
 
-	if( Lapack::isEnabled() ){
-		char *transA = ( char * )"N"; char *transB = ( char * )"N";
-		int m = Rows; int n = bm.Columns; int k = kh - kl;
-		int lda = Rows; int ldb = bm.Rows; int ldc = om.Rows;
-		double alpha = 1.0; double beta = 1.0;
+	char *transA = ( char * )"N"; char *transB = ( char * )"N";
+	int m = Rows; int n = bm.Columns; int k = kh - kl;
+	int lda = Rows; int ldb = bm.Rows; int ldc = om.Rows;
+	double alpha = 1.0; double beta = 1.0;
 
-		Lapack::dgemm( transA, transB, &m, &n, &k, &alpha, ( double * )&MyArray[( kl-ColumnStart )*Rows], &lda, ( double * )&bm.MyArray[kl - bm.RowStart],
+	Lapack::dgemm( transA, transB, &m, &n, &k, &alpha, ( double * )&MyArray[( kl-ColumnStart )*Rows], &lda, ( double * )&bm.MyArray[kl - bm.RowStart],
              &ldb, &beta, &om.MyArray[( RowStart - om.RowStart ) + ( bm.ColumnStart - om.ColumnStart ) * om.Rows], &ldc );
-	}else{
-		const unsigned int rowLength = RowStart + Rows;
-		const unsigned int otherColumnLength = bm.ColumnStart + bm.Columns;
-
-		for ( unsigned int i = RowStart; i < rowLength; ++i ) {
-		  const int iThisRowStart  = i - RowStart;
-		  const int iOtherRowStart = i - om.RowStart;
-
-		  for ( unsigned int j = bm.ColumnStart; j < otherColumnLength; ++j ) {
-			Real tempf = 0.0;
-
-			for ( unsigned int k = kl; k < kh; ++k ) {
-			  tempf += MyArray[ iThisRowStart + ( k - ColumnStart ) * Rows] *
-					   bm.MyArray[( k - bm.RowStart ) + ( j - bm.ColumnStart ) * bm.Rows];
-			}
-
-			om.MyArray[ iOtherRowStart + ( j - om.ColumnStart ) * om.Rows] += tempf; //.at( changed to [] for efficiency
-		  }
-		}
-	}
   }
 
   // Multiply transpose of 'this' with 'bm', put result in 'om': TEST A, B, C
@@ -304,32 +220,13 @@ namespace ProtoMol
          om.RowStart + om.Rows < ColumnStart + Columns || om.ColumnStart + om.Columns < bm.ColumnStart + bm.Columns )
       Report::report << Report::error << "[BlockMatrix::transposeProduct] Target Block Matrix too small." << Report::endr;
 
-	if( Lapack::isEnabled() ){
-		char *transA = ( char * )"T"; char *transB = ( char * )"N";
-		int m = Columns; int n = bm.Columns; int k = kh - kl;//
-		int lda = Rows; int ldb = bm.Rows; int ldc = om.Rows;//
-		double alpha = 1.0; double beta = 0.0;
-
-		Lapack::dgemm( transA, transB, &m, &n, &k, &alpha, ( double * )&MyArray[( kl-RowStart )], &lda, ( double * )&bm.MyArray[kl - bm.RowStart],
-				 &ldb, &beta, &om.MyArray[( ColumnStart - om.RowStart ) + ( bm.ColumnStart - om.ColumnStart ) * om.Rows], &ldc );
-	}else{
-		const unsigned int columnLength = ColumnStart + Columns;
-		const unsigned int otherColumnLength = bm.ColumnStart + bm.Columns;
-
-		for ( unsigned int i = ColumnStart; i < columnLength; ++i ) {
-		  const int iColumnStart = i - ColumnStart;
-		  const int iRowStart    = i - om.RowStart;
-
-		  for ( unsigned int j = bm.ColumnStart; j < otherColumnLength; ++j ) {
-			Real tempf = 0.0;
-			for ( unsigned int k = kl; k < kh; ++k ) {
-			  tempf += MyArray[ iColumnStart * Rows + ( k - RowStart ) ] *
-					   bm.MyArray[( k - bm.RowStart ) + ( j - bm.ColumnStart ) * bm.Rows];
-			}
-			om.MyArray.at( iRowStart + ( j - om.ColumnStart ) * om.Rows ) = tempf; //.at( changed to [] for efficiency
-		  }
-		}
-	}
+	char *transA = ( char * )"T"; char *transB = ( char * )"N";
+	int m = Columns; int n = bm.Columns; int k = kh - kl;//
+	int lda = Rows; int ldb = bm.Rows; int ldc = om.Rows;//
+	double alpha = 1.0; double beta = 0.0;
+
+	Lapack::dgemm( transA, transB, &m, &n, &k, &alpha, ( double * )&MyArray[( kl-RowStart )], &lda, ( double * )&bm.MyArray[kl - bm.RowStart],
+			 &ldb, &beta, &om.MyArray[( ColumnStart - om.RowStart ) + ( bm.ColumnStart - om.ColumnStart ) * om.Rows], &ldc );
   }
 
   // Multiply transpose of 'this' with 'bm', return result: TEST C
@@ -340,34 +237,13 @@ namespace ProtoMol
 
     BlockMatrix om( ColumnStart, bm.ColumnStart, Columns, bm.Columns );
 
-	if( Lapack::isEnabled() ){
-		char *transA = ( char * )"T"; char *transB = ( char * )"N";
-		int m = Columns; int n = bm.Columns; int k = kh - kl;
-		int lda = Rows; int ldb = bm.Rows; int ldc = om.Rows;
-		double alpha = 1.0; double beta = 0.0;
-
-		Lapack::dgemm( transA, transB, &m, &n, &k, &alpha, ( double * )&MyArray[( kl-RowStart )], &lda, ( double * )&bm.MyArray[kl - bm.RowStart],
-				 &ldb, &beta, &om.MyArray[( RowStart - om.RowStart ) + ( bm.ColumnStart - om.ColumnStart ) * om.Rows], &ldc );
-	}else{
-		const unsigned int columnLength = ColumnStart + Columns;
-		const unsigned int otherColumnLength = bm.ColumnStart + bm.Columns;
-
-		for ( unsigned int i = ColumnStart; i < columnLength; ++i ) {
-		  const int iColumnStart = i - ColumnStart;
-		  const int iRowStart    = i - om.RowStart;
-
-		  for ( unsigned int j = bm.ColumnStart; j < otherColumnLength; ++j ) {
-			Real tempf = 0.0;
-
-			for ( unsigned int k = kl; k < kh; ++k ) {
-			  tempf += MyArray[iColumnStart * Rows + ( k - RowStart ) ] *
-					   bm.MyArray[( k - bm.RowStart ) + ( j - bm.ColumnStart ) * bm.Rows];
-			}
-
-			om.MyArray[iRowStart + ( j - om.ColumnStart ) * om.Rows] = tempf;
-		  }
-		}
-	}
+	char *transA = ( char * )"T"; char *transB = ( char * )"N";
+	int m = Columns; int n = bm.Columns; int k = kh - kl;
+	int lda = Rows; int ldb = bm.Rows; int ldc = om.Rows;
+	double alpha = 1.0; double beta = 0.0;
+
+	Lapack::dgemm( transA, transB, &m, &n, &k, &alpha, ( double * )&MyArray[( kl-RowStart )], &lda, ( double * )&bm.MyArray[kl - bm.RowStart],
+			 &ldb, &beta, &om.MyArray[( RowStart - om.RowStart ) + ( bm.ColumnStart - om.ColumnStart ) * om.Rows], &ldc );
 
     return om;
   }
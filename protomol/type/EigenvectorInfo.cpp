@@ -9,7 +9,7 @@ EigenvectorInfo::EigenvectorInfo() : myEigenvectorLength( 0 ), myNumEigenvectors
 	myNumUsedEigenvectors( 0 ),
 	myEigenvectors( 0 ), myOrigCEigval( 0.0 ), myNewCEigval( 0.0 ), myOrigTimestep( 0.0 ),
 	reDiagonalize( false ), havePositionsChanged( false ), OpenMMMinimize( false ), RediagonalizationCount( 0 ),
-	mySingleEigs( 0 ), myEigVecChanged( true ), myMinimumLimit( 0.5 ), currentMode( -1 ), metropolisPE( 0.0 ) {
+	mySingleEigs( 0 ), myEigVecChanged( true ), mySingleEigsChanged( true ), myMinimumLimit( 0.5 ), currentMode( -1 ), metropolisPE( 0.0 ) {
 
 }
 
@@ -17,7 +17,7 @@ EigenvectorInfo::EigenvectorInfo( unsigned int n, unsigned int m ) : myEigenvect
 	myNumEigenvectors( m ), myNumUsedEigenvectors( 0 ),
 	myMaxEigenvalue( 0.0 ), myEigenvectors( new double[n *m * 3] ),
 	myOrigCEigval( 0.0 ), myNewCEigval( 0.0 ), myOrigTimestep( 0.0 ), reDiagonalize( false ),
-	havePositionsChanged( false ), OpenMMMinimize( false ), RediagonalizationCount( 0 ), mySingleEigs( 0 ), myEigVecChanged( true ), myMinimumLimit( 0.5 ),
+	havePositionsChanged( false ), OpenMMMinimize( false ), RediagonalizationCount( 0 ), mySingleEigs( 0 ), myEigVecChanged( true ), mySingleEigsChanged( true ), myMinimumLimit( 0.5 ),
 	currentMode( -1 ), metropolisPE( 0.0 ) {}
 
 EigenvectorInfo::~EigenvectorInfo() {
@@ -60,12 +60,12 @@ float* EigenvectorInfo::getFloatEigPointer() {
 	}
 
 	//update values if double array updated
-	if( myEigVecChanged ) {
+	if( mySingleEigsChanged ) {
 		for( unsigned int i = 0; i < arrayLen; i++ ) {
 			mySingleEigs[i] = ( float )myEigenvectors[i];
 		}
 
-		myEigVecChanged = false;
+		mySingleEigsChanged = false;
 	}
 
 	return mySingleEigs;
@@ -49,6 +49,8 @@ namespace ProtoMol {
 		//OpenMM single precision interface
 		float *mySingleEigs;
 		bool myEigVecChanged;
+		//single precision copy outdated, kept apart from the OpenMM flag
+		bool mySingleEigsChanged;
 
 		double myMinimumLimit;
 
@@ -27,6 +27,16 @@ namespace ProtoMol {
     template<class A, unsigned int size> struct SelectTypeCheck {
       typedef typename SelectTypeCheckHelper<sizeof(A) == size, A>::type type;
     };
+
+    // 64 bit unsigned integer without naming long long, which C++98 does
+    // not have, unsigned long where the compiler does not tell
+#if defined(_MSC_VER)
+    typedef unsigned __int64 UInt64;
+#elif defined(__UINT64_TYPE__)
+    typedef __UINT64_TYPE__ UInt64;
+#else
+    typedef unsigned long UInt64;
+#endif
   }
 
   /**
@@ -36,6 +46,7 @@ namespace ProtoMol {
    *
    * Usage:@n
    * typedef TypeSelection::Int<4>::type int32;@n
+   * typedef TypeSelection::UInt<8>::type uint64;@n
    * typedef TypeSelection::Float<4>::type float32;@n
    */
   namespace TypeSelection {
@@ -52,6 +63,19 @@ namespace ProtoMol {
       SelectTypeCheck<typename ST3::type, size>::type type;
     };
 
+    /**
+     * Select the right type among unsigned short, int, long or the 64 bit
+     * unsigned integer of the compiler according the given sizeof.
+     */
+    template<unsigned int size> struct UInt {
+      typedef Private::SelectType<size, unsigned int, unsigned short> ST1;
+      typedef Private::SelectType<size, unsigned long, Private::UInt64> ST2;
+      typedef Private::
+      SelectType<size, typename ST1::type, typename ST2::type> ST3;
+      typedef typename Private::
+      SelectTypeCheck<typename ST3::type, size>::type type;
+    };
+
     /**
      * Select the right type among float or double according the given sizeof.
      */
@@ -2,6 +2,7 @@
 
 import sys
 import math
+import re
 import logging
 
 def absDiff(one, two, ignoreSign=False):
@@ -9,6 +10,22 @@ def absDiff(one, two, ignoreSign=False):
         (one, two) = (math.fabs(one), math.fabs(two))
     return max(one, two) - min(one, two)
 
+def toFloat(element):
+    # energies may be written as hexadecimal floats
+    try:
+        return float(element)
+    except ValueError:
+        return float.fromhex(element)
+
+def rounding(element):
+    # half a unit in the last digit of a decimal, an expected value read
+    # back from fewer digits is not more accurate than that
+    match = re.match(r'^[-+]?\d*\.(\d+)(?:[eE]([-+]?\d+))?$', element)
+    if not match:
+        return 0.0
+    exponent = int(match.group(2) or 0) - len(match.group(1))
+    return 0.5 * math.pow(10, exponent)
+
 def compare(fExpected, fNew, epsilon, scalar=1.0, ignoreSign=False):
     fone = open(fExpected, 'r')
     ftwo = open(fNew, 'r')
@@ -45,12 +62,12 @@ def compare(fExpected, fNew, epsilon, scalar=1.0, ignoreSign=False):
                 except ValueError:
                     pass
                 try:
-                    feone = float(elementsone[j]) * scalar
-                    fetwo = float(elementstwo[j])
+                    feone = toFloat(elementsone[j]) * scalar
+                    fetwo = toFloat(elementstwo[j])
 
                     fediff = absDiff(feone, fetwo, ignoreSign)
 
-                    if fediff > epsilon:
+                    if fediff > max(epsilon, rounding(elementsone[j]) * scalar):
                         diffs = diffs + 1
                         logging.debug('Line %d, Element %d Differs' % (i, j))
                         logging.debug('Expected: %f, Actual: %f, Difference: %f' % (feone, fetwo, fediff))
@@ -0,0 +1,65 @@
+#!/usr/bin/python
+
+import logging
+from struct import unpack
+
+XTC_MAGIC = 1995
+
+def compare_xtc(fExpected, fNew, epsilon, scalar=1.0):
+    expected = XTCReader(fExpected).read_frames()
+    actual = XTCReader(fNew).read_frames()
+
+    if len(expected) != len(actual):
+        logging.debug("Frame Count Differs. Should be %d but is %d" % (len(expected), len(actual)))
+        return False
+
+    diffs = 0
+    for frame in xrange(0, len(expected)):
+        e = expected[frame]
+        a = actual[frame]
+
+        for key in ['natoms', 'step']:
+            if e[key] != a[key]:
+                diffs = diffs + 1
+                logging.debug('Frame %d %s Differs. Should be %d but is %d' % (frame, key, e[key], a[key]))
+
+        for i in xrange(0, 10):
+            if abs(e['floats'][i] * scalar - a['floats'][i]) > epsilon:
+                diffs = diffs + 1
+                logging.debug('Frame %d, Time or Box Element %d Differs' % (frame, i))
+                logging.debug('Expected: %f, Actual: %f' % (e['floats'][i], a['floats'][i]))
+
+        # The compressed coordinates are integers at the precision of the
+        # file, they are compared byte for byte
+        if e['coordinates'] != a['coordinates']:
+            diffs = diffs + 1
+            logging.debug('Frame %d Coordinates Differ' % frame)
+
+    return diffs == 0
+
+class XTCReader(object):
+    def __init__(self, flname):
+        self.flname = flname
+
+    def read_frames(self):
+        fl = open(self.flname, 'rb')
+        data = fl.read()
+        fl.close()
+
+        frames = []
+        at = 0
+        while at < len(data):
+            (magic, natoms, step) = unpack('>iii', data[at:at + 12])
+            assert magic == XTC_MAGIC, "Invalid XTC magic number %d" % magic
+            # time and the box
+            floats = unpack('>10f', data[at + 12:at + 52])
+            start = at + 52
+            if natoms <= 9:
+                at = start + 4 + 12 * natoms
+            else:
+                # natoms, precision, minint, maxint, smallidx, byte count
+                count = unpack('>i', data[start + 36:start + 40])[0]
+                at = start + 40 + (count + 3) / 4 * 4
+            frames.append({'natoms': natoms, 'step': step, 'floats': floats,
+                           'coordinates': data[start:at]})
+        return frames
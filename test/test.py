@@ -7,6 +7,7 @@ import shlex
 import subprocess
 import comparator
 import compare_dcd
+import compare_xtc
 import argparse
 
 import logging
@@ -51,6 +52,7 @@ def run_test(protomol_path, conf_file, pwd, parallel):
     conf_param_overrides = parse_params(conf_file)
     epsilon = conf_param_overrides.get('epsilon', DEFAULT_EPSILON)
     scaling_factor = conf_param_overrides.get('scaling_factor', DEFAULT_SCALINGFACTOR)
+    runs = conf_param_overrides.get('runs', 1)
 
     base = os.path.splitext(os.path.basename(conf_file))[0]
     if not parallel:
@@ -66,12 +68,15 @@ def run_test(protomol_path, conf_file, pwd, parallel):
     cmd.append(protomol_path)
     cmd.append(conf_file)
 
-    p = subprocess.Popen(cmd, stdout=subprocess.PIPE, stderr=subprocess.PIPE)
-    (stdout, stderr) = p.communicate()
-    if p.returncode > 0:
-        s = 'Not able to execute Protomol!\n'
-        s += 'cmd: ' + str(cmd) + '\n'
-        logging.critical(s)
+    # Later runs see the files left by the earlier ones, e.g. a cache,
+    # the outputs of the last run are compared
+    for run in xrange(runs):
+        p = subprocess.Popen(cmd, stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+        (stdout, stderr) = p.communicate()
+        if p.returncode > 0:
+            s = 'Not able to execute Protomol!\n'
+            s += 'cmd: ' + str(cmd) + '\n'
+            logging.critical(s)
     expects = []
     outputs = glob.glob('tests/output/' + base + '.*')
     outputtemp = []
@@ -87,7 +92,7 @@ def run_test(protomol_path, conf_file, pwd, parallel):
         tests += 1
         ftype = os.path.splitext(os.path.basename(outputs[i]))[1]
 
-        if ftype in ['.header', '.xtc']:
+        if ftype == '.header':
             continue
 
         ignoreSign = False
@@ -108,6 +113,16 @@ def run_test(protomol_path, conf_file, pwd, parallel):
                 failedtests.append('Comparison of ' + expects[i] + ' and ' + outputs[i])
                 if args.errorfailure:
                     sys.exit(1)
+        elif ftype == ".xtc":
+            if compare_xtc.compare_xtc(expects[i], outputs[i], epsilon, scaling_factor):
+                logging.info('\t\tPassed')
+                testspassed += 1
+            else:
+                logging.warning('\t\tFailed')
+                testsfailed += 1
+                failedtests.append('Comparison of ' + expects[i] + ' and ' + outputs[i])
+                if args.errorfailure:
+                    sys.exit(1)
         else:
             if comparator.compare(expects[i], outputs[i], epsilon, scaling_factor, ignoreSign):
                 logging.info('\t\tPassed')
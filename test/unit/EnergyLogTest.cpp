@@ -0,0 +1,233 @@
+#include <protomol/io/EnergyLogReader.h>
+#include <protomol/io/EnergyLogWriter.h>
+#include <protomol/base/ModuleManager.h>
+#include <protomol/base/SystemUtilities.h>
+#include <protomol/parallel/Parallel.h>
+#include <protomol/ProtoMolApp.h>
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <cmath>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+using namespace std;
+using namespace ProtoMol;
+
+extern void moduleInitFunction(ModuleManager *);
+
+//____ Energy log written, read back and converted against allEnergiesFile
+
+namespace {
+  bool check(const char *name, Real value, Real bound) {
+    cout << name << ": " << value << " (bound " << bound << ")" << endl;
+    return value <= bound;
+  }
+
+  // Rows of numbers of a text file, hexadecimal floats included, without
+  // the lines starting with a name
+  vector<vector<double> > readText(const string &filename) {
+    vector<vector<double> > rows;
+    ifstream in(filename.c_str());
+    string line;
+    while (getline(in, line)) {
+      istringstream words(line);
+      string word;
+      vector<double> row;
+      while (words >> word) {
+        char *end;
+        row.push_back(strtod(word.c_str(), &end));
+        if (*end) break;
+      }
+      if (words.eof() && !row.empty()) rows.push_back(row);
+    }
+    return rows;
+  }
+
+  // All rows of a log with steps in [first, last], the step first
+  vector<vector<double> > readLog(const string &filename, long first,
+                                  long last, unsigned int &blocks) {
+    vector<vector<double> > rows;
+    EnergyLogReader reader(filename);
+    blocks = 0;
+    while (reader.read(first, last)) {
+      blocks++;
+      for (unsigned int i = 0; i < reader.getRows(); i++) {
+        rows.push_back(vector<double>());
+        for (unsigned int j = 0; j < reader.getColumns().size(); j++)
+          rows.back().push_back(reader.getValue(i, j));
+      }
+    }
+    return rows;
+  }
+
+  // Number of values of b differing from those of a, the columns of b
+  // from offset on and the first column of a within tolerance
+  unsigned int differences(const vector<vector<double> > &a,
+                           const vector<vector<double> > &b,
+                           unsigned int offset, double tolerance) {
+    if (a.size() != b.size()) return max(a.size(), b.size());
+
+    unsigned int count = 0;
+    for (unsigned int i = 0; i < a.size(); i++) {
+      if (a[i].size() + offset != b[i].size()) {
+        count++;
+        continue;
+      }
+      for (unsigned int j = 0; j < a[i].size(); j++)
+        if (j ? a[i][j] != b[i][j + offset] :
+            fabs(a[i][j] - b[i][j + offset]) > tolerance)
+          count++;
+    }
+    return count;
+  }
+
+  // Rows written with the writer, 11 steps in blocks of 4, 4 and 3
+  bool writer(const string &directory) {
+    const string filename = directory + "/rows.log";
+    vector<string> columns;
+    columns.push_back("A");
+    columns.push_back("B");
+
+    vector<vector<double> > rows;
+    {
+      EnergyLogWriter log(filename, 4);
+      log.writeHeader(columns);
+      vector<Real> values(2);
+      for (long step = 10; step <= 20; step++) {
+        values[0] = 1.0 / step;
+        values[1] = -exp((Real)step);
+        log.write(step, values);
+
+        rows.push_back(vector<double>(1, step));
+        rows.back().insert(rows.back().end(), values.begin(), values.end());
+      }
+    }
+
+    EnergyLogReader reader(filename);
+    bool ok = check("header", !reader.readHeader() ||
+                    reader.getColumns().size() != 3 ||
+                    reader.getColumns()[0] != "Step" ||
+                    reader.getColumns()[2] != "B" ||
+                    reader.getBlockRows() != 4, 0);
+
+    unsigned int blocks;
+    const vector<vector<double> > all = readLog(filename, -1000, 1000, blocks);
+    ok &= check("rows read back", differences(rows, all, 0, 0), 0);
+    ok &= check("blocks", fabs(blocks - 3.0), 0);
+
+    // Steps 15 to 17 are in the second block only, the others are skipped
+    const vector<vector<double> > some = readLog(filename, 15, 17, blocks);
+    ok &= check("range blocks", fabs(blocks - 1.0), 0);
+    ok &= check("range rows",
+                differences(vector<vector<double> >(rows.begin() + 4,
+                                                    rows.begin() + 8),
+                            some, 0, 0), 0);
+
+    unlink(filename.c_str());
+    return ok;
+  }
+
+  // A run writing both allEnergiesFile and energyLogFile, the log read
+  // and converted to text has the same values
+  bool run(const string &directory, const string &tests,
+           const string &converter) {
+    const string conf = directory + "/run.conf";
+    const string energies = directory + "/run.energy";
+    const string log = directory + "/run.log";
+    const string text = directory + "/run.txt";
+    {
+      ofstream out(conf.c_str());
+      out << "firststep 0\nnumsteps 50\noutputfreq 5\nrandomtype 1\n"
+          << "exclude scaled1-4\nshake true\nseed 1234\n"
+          << "posfile " << tests << "/data/alan_const.pdb\n"
+          << "psffile " << tests << "/data/alan.psf\n"
+          << "parfile " << tests << "/data/par_all27_prot_lipid.inp\n"
+          << "temperature 310\n"
+          << "allenergiesfile " << energies << "\n"
+          << "energyLogFile " << log << "\nenergyLogFileBlockRows 3\n"
+          << "boundaryConditions vacuum\ncellManager Cubic\ncellsize 5\n"
+          << "Integrator {\n level 0 Leapfrog {\n  timestep 1\n"
+          << "  force Improper\n  force Dihedral\n  force Bond\n"
+          << "  force Angle\n  force LennardJones Coulomb\n"
+          << "   -algorithm NonbondedSimpleFull\n }\n}\n";
+    }
+
+    {
+      ModuleManager modManager;
+      moduleInitFunction(&modManager);
+      ProtoMolApp app(&modManager);
+      app.configure(conf);
+      app.build();
+      while (app.step()) continue;
+      app.finalize();
+    }
+
+    const vector<vector<double> > expected = readText(energies);
+    unsigned int blocks;
+    const vector<vector<double> > rows = readLog(log, -1, 1000, blocks);
+
+    // The times of allEnergiesFile have two decimals
+    bool ok = check("steps written", fabs(expected.size() - 11.0), 0);
+    ok &= check("log blocks", fabs(blocks - 4.0), 0);
+    ok &= check("log against allEnergiesFile",
+                differences(expected, rows, 1, 0.005), 0);
+    for (unsigned int i = 0; i < rows.size(); i++)
+      ok &= rows[i][0] == 5 * i;
+
+    const int status =
+      system((converter + " " + log + " > " + text).c_str());
+    ok &= check("converter status", fabs((Real)status), 0);
+    ok &= check("converted against the log",
+                differences(rows, readText(text), 0, 0), 0);
+
+    // Only the rows of steps 12 to 31
+    system((converter + " " + log + " 12 31 > " + text).c_str());
+    ok &= check("converted range",
+                differences(vector<vector<double> >(rows.begin() + 3,
+                                                    rows.begin() + 7),
+                            readText(text), 0, 0), 0);
+
+    unlink(conf.c_str());
+    unlink(energies.c_str());
+    unlink((energies + ".header").c_str());
+    unlink(log.c_str());
+    unlink(text.c_str());
+    return ok;
+  }
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    cerr << "Usage: " << argv[0] << " <regression test directory>" << endl;
+    return 1;
+  }
+
+  // The converter is built next to the test
+  const string tests = argv[1];
+  const string converter =
+    SystemUtilities::dirname(getCanonicalPath(argv[0])) +
+    "/EnergyLog";
+
+  char directory[] = "/tmp/EnergyLogTestXXXXXX";
+  if (!mkdtemp(directory)) {
+    cerr << "Can not create a directory in /tmp" << endl;
+    return 1;
+  }
+
+  Parallel::init(argc, argv);
+
+  bool ok = writer(directory);
+  ok &= run(directory, getCanonicalPath(tests), converter);
+
+  rmdir(directory);
+
+  cout << (ok ? "Passed" : "Failed") << endl;
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,110 @@
+#include <protomol/base/FastMath.h>
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+
+using namespace std;
+using namespace ProtoMol;
+
+//____ Maximal errors of FastMath against libm over the ranges it states
+
+namespace {
+  const Real ULP = 2.220446049250313e-16;
+  const unsigned int SAMPLES = 1000000;
+
+  // Relative error in units of the last place of the libm value
+  Real ulps(Real value, Real exact) {
+    return exact == 0 ? fabs(value) : fabs(value - exact) / fabs(exact) / ULP;
+  }
+
+  bool check(const char *name, Real error, Real bound) {
+    cout << name << ": " << error << " (bound " << bound << ")" << endl;
+    return error <= bound;
+  }
+
+  // Samples in [a, b], ends included
+  vector<Real> samples(Real a, Real b) {
+    vector<Real> x(SAMPLES);
+    for (unsigned int i = 0; i < SAMPLES; i++)
+      x[i] = a + (b - a) * i / (SAMPLES - 1);
+    return x;
+  }
+}
+
+int main() {
+  bool ok = true;
+  Real error;
+
+  // exp
+  vector<Real> x = samples(-708.0, 709.78);
+  vector<Real> y(SAMPLES), z(SAMPLES);
+
+  error = 0;
+  for (unsigned int i = 0; i < SAMPLES; i++)
+    error = max(error, ulps(fastExp(x[i]), exp(x[i])));
+  ok &= check("fastExp ulp", error, 1);
+
+  fastExp(SAMPLES, &x[0], &y[0]);
+  error = 0;
+  for (unsigned int i = 0; i < SAMPLES; i++)
+    error = max(error, ulps(y[i], exp(x[i])));
+  ok &= check("fastExp lanes ulp", error, 2);
+
+  Real outside[] = {-800.0, 800.0};
+  fastExp(2, outside, &y[0]);
+  ok &= check("fastExp lanes outside", (y[0] != 0) + !(y[1] > 1e308), 0);
+
+  // erfc and exp(-x^2), the table covers all x >= 0
+  x = samples(0.0, 6.0);
+  Real erfcError = 0, expError = 0;
+  for (unsigned int i = 0; i < SAMPLES; i++) {
+    Real e;
+    erfcError = max(erfcError, ulps(fastErfcExp(x[i], e), erfc(x[i])));
+    expError = max(expError, ulps(e, exp(-x[i] * x[i])));
+  }
+  ok &= check("fastErfcExp erfc ulp", erfcError, 20);
+  ok &= check("fastErfcExp exp ulp", expError, 1);
+
+  fastErfcExp(SAMPLES, &x[0], &y[0], &z[0]);
+  erfcError = expError = 0;
+  for (unsigned int i = 0; i < SAMPLES; i++) {
+    erfcError = max(erfcError, ulps(y[i], erfc(x[i])));
+    expError = max(expError, ulps(z[i], exp(-x[i] * x[i])));
+  }
+  ok &= check("fastErfcExp lanes erfc ulp", erfcError, 20);
+  ok &= check("fastErfcExp lanes exp ulp", expError, 2);
+
+  x = samples(6.0, 26.0);
+  fastErfcExp(SAMPLES, &x[0], &y[0], &z[0]);
+  erfcError = 0;
+  for (unsigned int i = 0; i < SAMPLES; i++)
+    erfcError = max(erfcError, ulps(y[i], erfc(x[i])) * ULP);
+  ok &= check("fastErfcExp lanes erfc relative up to 26", erfcError, 1e-13);
+
+  // log, over a wide range and near 1
+  Real logError = 0;
+  for (unsigned int k = 0; k < 2; k++) {
+    x = (k == 0 ? samples(1e-300, 1e300) : samples(0.5, 2.0));
+    if (k == 0)
+      for (unsigned int i = 0; i < SAMPLES; i++)
+        x[i] = pow(10.0, -300.0 + 600.0 * i / (SAMPLES - 1));
+    fastLog(SAMPLES, &x[0], &y[0]);
+    for (unsigned int i = 0; i < SAMPLES; i++)
+      if (x[i] != 1.0)
+        logError = max(logError, ulps(y[i], log(x[i])));
+  }
+  ok &= check("fastLog lanes ulp", logError, 2);
+
+  // 1 / sqrt
+  x = samples(1e-6, 1e6);
+  fastRsqrt(SAMPLES, &x[0], &y[0]);
+  error = 0;
+  for (unsigned int i = 0; i < SAMPLES; i++)
+    error = max(error, ulps(y[i], 1.0 / sqrt(x[i])));
+  ok &= check("fastRsqrt lanes ulp", error, 1);
+
+  cout << (ok ? "Passed" : "Failed") << endl;
+
+  return ok ? 0 : 1;
+}
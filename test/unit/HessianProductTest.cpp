@@ -0,0 +1,112 @@
+#include <protomol/integrator/hessian/HessianProduct.h>
+#include <protomol/integrator/Integrator.h>
+#include <protomol/base/ModuleManager.h>
+#include <protomol/base/MathUtilities.h>
+#include <protomol/parallel/Parallel.h>
+#include <protomol/ProtoMolApp.h>
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+
+using namespace std;
+using namespace ProtoMol;
+
+extern void moduleInitFunction(ModuleManager *);
+
+//____ Hessian products against the stored Hessian of Hessian::evaluate
+
+namespace {
+  const int COLS = 5;
+
+  bool check(const char *name, Real value, Real bound) {
+    cout << name << ": " << value << " (bound " << bound << ")" << endl;
+    return value <= bound;
+  }
+
+  // Largest difference of the products of both Hessians and of their
+  // diagonal blocks, relative to the largest entry of the product
+  bool compare(ProtoMolApp &app, bool mrw, int threads) {
+    ForceGroup *forces = app.integrator->getForceGroup();
+    const int dim = 3 * app.positions.size();
+
+    Hessian hessian;
+    hessian.findForces(forces);
+    hessian.initialData(dim);
+    hessian.clear();
+    hessian.evaluate(&app.positions, app.topology, mrw);
+
+    // Only the upper triangle is complete, as for the full diagonalization
+    const double *h = hessian.hessM;
+    vector<double> full(dim * dim);
+    for (int j = 0; j < dim; j++)
+      for (int i = 0; i < dim; i++)
+        full[j * dim + i] = i <= j ? h[j * dim + i] : h[i * dim + j];
+
+    vector<double> V(dim * COLS), Y(dim * COLS), reference(dim * COLS, 0.0);
+    for (unsigned int i = 0; i < V.size(); i++) V[i] = randomNumber() - 0.5;
+    for (int c = 0; c < COLS; c++)
+      for (int j = 0; j < dim; j++)
+        for (int i = 0; i < dim; i++)
+          reference[c * dim + i] += full[j * dim + i] * V[c * dim + j];
+
+    HessianProduct product(threads);
+    product.findForces(forces);
+    product.prepare(&app.positions, app.topology, mrw);
+    product.product(&V[0], &Y[0], COLS);
+
+    Real error = 0, size = 0;
+    for (unsigned int i = 0; i < Y.size(); i++) {
+      error = max(error, fabs(Y[i] - reference[i]));
+      size = max(size, fabs(reference[i]));
+    }
+
+    vector<double> blocks(3 * dim);
+    product.diagonalBlocks(&blocks[0]);
+    Real blockError = 0, blockSize = 0;
+    for (int a = 0; a < dim / 3; a++)
+      for (int k = 0; k < 3; k++)
+        for (int l = 0; l < 3; l++) {
+          const Real entry = full[(3 * a + l) * dim + 3 * a + k];
+          blockError = max(blockError, fabs(blocks[9 * a + 3 * k + l] - entry));
+          blockSize = max(blockSize, fabs(entry));
+        }
+
+    cout << (mrw ? "mass weighted, " : "") << threads << " threads" << endl;
+    bool ok = check("product", error / size, 1e-13);
+    ok &= check("diagonal blocks", blockError / blockSize, 1e-13);
+    return ok;
+  }
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    cerr << "Usage: " << argv[0] << " <regression test directory>" << endl;
+    return 1;
+  }
+
+  Parallel::init(argc, argv);
+  ModuleManager modManager;
+  moduleInitFunction(&modManager);
+  ProtoMolApp app(&modManager);
+
+  // The ww domain in vacuum, the LJ and Coulomb pairs of a 20A cutoff are
+  // found from a grid of cells
+  vector<string> args;
+  args.push_back("ProtoMol");
+  args.push_back(string(argv[1]) + "/wwdomain_CHARMM_VACUUM_HESSIAN.conf");
+  args.push_back("--output");
+  args.push_back("false");
+  app.configure(args);
+  app.build();
+
+  bool ok = true;
+  ok &= compare(app, false, 1);
+  ok &= compare(app, true, 1);
+  ok &= compare(app, true, 4);
+
+  cout << (ok ? "Passed" : "Failed") << endl;
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,228 @@
+#include <protomol/base/LapackBuiltin.h>
+#include <protomol/base/Lapack.h>
+#include <protomol/base/MathUtilities.h>
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+
+using namespace std;
+using namespace ProtoMol;
+
+//____ Built-in BLAS/LAPACK routines on known results, and against the
+//____ library when ProtoMol is built with one
+
+namespace {
+  bool check(const char *name, Real value, Real bound) {
+    cout << name << ": " << value << " (bound " << bound << ")" << endl;
+    return value <= bound;
+  }
+
+  vector<double> randomMatrix(int rows, int cols) {
+    vector<double> a(rows * cols);
+    for (unsigned int i = 0; i < a.size(); i++) a[i] = randomNumber() - 0.5;
+    return a;
+  }
+
+  vector<double> randomSymmetric(int n) {
+    vector<double> a = randomMatrix(n, n);
+    for (int j = 0; j < n; j++)
+      for (int i = 0; i < j; i++) a[j * n + i] = a[i * n + j];
+    return a;
+  }
+
+  Real maxDifference(const vector<double> &a, const vector<double> &b,
+                     unsigned int size) {
+    Real d = 0;
+    for (unsigned int i = 0; i < size; i++) d = max(d, fabs(a[i] - b[i]));
+    return d;
+  }
+
+  // Largest difference of the columns up to sign
+  Real maxVectorDifference(const vector<double> &a, const vector<double> &b,
+                           int n, int cols) {
+    Real d = 0;
+    for (int j = 0; j < cols; j++) {
+      const Real s = a[j * n] * b[j * n] < 0 ? -1 : 1;
+      for (int i = 0; i < n; i++)
+        d = max(d, fabs(a[j * n + i] - s * b[j * n + i]));
+    }
+    return d;
+  }
+
+  // C = alpha op(A) op(B) + beta C by the definition
+  void naiveDgemm(char transA, char transB, int m, int n, int k,
+                  double alpha, const vector<double> &A, int lda,
+                  const vector<double> &B, int ldb, double beta,
+                  vector<double> &C, int ldc) {
+    for (int j = 0; j < n; j++)
+      for (int i = 0; i < m; i++) {
+        double sum = 0;
+        for (int l = 0; l < k; l++)
+          sum += (transA == 'N' ? A[l * lda + i] : A[i * lda + l]) *
+            (transB == 'N' ? B[j * ldb + l] : B[l * ldb + j]);
+        C[j * ldc + i] = alpha * sum + beta * C[j * ldc + i];
+      }
+  }
+
+  // Eigenpairs by the built-in or the library dsyevr, range 'A', 'I' or
+  // 'V', the number found is returned
+  int dsyevr(bool builtin, char range, vector<double> a, int n, double vl,
+             double vu, int il, int iu, vector<double> &w,
+             vector<double> &z) {
+    char jobz = 'V', uplo = 'U';
+    int lda = n, ldz = n, m = 0, info = 0;
+    int lwork = 26 * n, liwork = 10 * n;
+    double abstol = 0;
+    vector<double> work(lwork);
+    vector<int> isuppz(2 * n), iwork(liwork);
+    w.assign(n, 0.0);
+    z.assign(n * n, 0.0);
+    (builtin ? LapackBuiltin::dsyevr : Lapack::dsyevr)
+      (&jobz, &range, &uplo, &n, &a[0], &lda, &vl, &vu, &il, &iu, &abstol, &m,
+       &w[0], &z[0], &ldz, &isuppz[0], &work[0], &lwork, &iwork[0], &liwork,
+       &info);
+    return info ? -1 : m;
+  }
+}
+
+int main() {
+  bool ok = true;
+
+  // The second difference matrix, eigenvalues 2 - 2 cos(k pi / (n + 1))
+  const int n = 50;
+  vector<double> t(n * n, 0.0);
+  vector<double> exact(n);
+  for (int i = 0; i < n; i++) {
+    t[i * n + i] = 2;
+    if (i > 0) t[i * n + i - 1] = t[(i - 1) * n + i] = -1;
+    exact[i] = 2 - 2 * cos((i + 1) * M_PI / (n + 1));
+  }
+
+  vector<double> w, z;
+  ok &= check("dsyevr A found", fabs(dsyevr(true, 'A', t, n, 0, 0, 0, 0, w,
+                                            z) - n), 0);
+  ok &= check("dsyevr A values", maxDifference(w, exact, n), 1e-13);
+
+  // A V = V diag(w) and V^T V = I
+  Real residual = 0, orthogonality = 0;
+  for (int j = 0; j < n; j++) {
+    for (int i = 0; i < n; i++) {
+      double av = 0, vv = 0;
+      for (int k = 0; k < n; k++) {
+        av += t[k * n + i] * z[j * n + k];
+        vv += z[i * n + k] * z[j * n + k];
+      }
+      residual = max(residual, fabs(av - w[j] * z[j * n + i]));
+      orthogonality = max(orthogonality, fabs(vv - (i == j ? 1 : 0)));
+    }
+  }
+  ok &= check("dsyevr A residual", residual, 1e-13);
+  ok &= check("dsyevr A orthogonality", orthogonality, 1e-13);
+
+  // Values 5 to 10, and 21 to 30 by the midpoints between values
+  ok &= check("dsyevr I found", fabs(dsyevr(true, 'I', t, n, 0, 0, 5, 10, w,
+                                            z) - 6), 0);
+  ok &= check("dsyevr I values",
+              maxDifference(w, vector<double>(exact.begin() + 4,
+                                              exact.end()), 6), 1e-13);
+  ok &= check("dsyevr V found",
+              fabs(dsyevr(true, 'V', t, n, (exact[19] + exact[20]) / 2,
+                          (exact[29] + exact[30]) / 2, 0, 0, w, z) - 10), 0);
+  ok &= check("dsyevr V values",
+              maxDifference(w, vector<double>(exact.begin() + 20,
+                                              exact.end()), 10), 1e-13);
+
+  // dsyev overwrites the matrix with the vectors
+  {
+    char jobz = 'V', uplo = 'U';
+    int lda = n, lwork = -1, info = 0;
+    vector<double> a(t), values(n);
+    double size;
+    LapackBuiltin::dsyev(&jobz, &uplo, (int *)&n, &a[0], &lda, &values[0],
+                         &size, &lwork, &info);
+    lwork = (int)size;
+    vector<double> work(lwork);
+    LapackBuiltin::dsyev(&jobz, &uplo, (int *)&n, &a[0], &lda, &values[0],
+                         &work[0], &lwork, &info);
+    dsyevr(true, 'A', t, n, 0, 0, 0, 0, w, z);
+    ok &= check("dsyev info", fabs((Real)info), 0);
+    ok &= check("dsyev values", maxDifference(values, exact, n), 1e-13);
+    ok &= check("dsyev vectors", maxVectorDifference(a, z, n, n), 1e-12);
+  }
+
+  // dgemm and dgemv by the definition, all transposes, with leading
+  // dimensions larger than the rows
+  {
+    const int m = 37, k = 29, cols = 23, ld = 41;
+    const char trans[] = {'N', 'T'};
+    double alpha = 0.7, beta = -1.3;
+    Real error = 0;
+    for (int a = 0; a < 2; a++)
+      for (int b = 0; b < 2; b++) {
+        char ta = trans[a], tb = trans[b];
+        vector<double> A = randomMatrix(ld, max(m, k));
+        vector<double> B = randomMatrix(ld, max(k, cols));
+        vector<double> C = randomMatrix(ld, cols), reference(C);
+        int mm = m, nn = cols, kk = k, lda = ld, ldb = ld, ldc = ld;
+        LapackBuiltin::dgemm(&ta, &tb, &mm, &nn, &kk, &alpha, &A[0], &lda,
+                             &B[0], &ldb, &beta, &C[0], &ldc);
+        naiveDgemm(ta, tb, m, cols, k, alpha, A, ld, B, ld, beta, reference,
+                   ld);
+        error = max(error, maxDifference(C, reference, C.size()));
+      }
+    ok &= check("dgemm", error, 1e-13);
+
+    error = 0;
+    for (int a = 0; a < 2; a++) {
+      char ta = trans[a];
+      vector<double> A = randomMatrix(ld, k);
+      vector<double> x = randomMatrix(max(m, k), 1);
+      vector<double> y = randomMatrix(max(m, k), 1), reference(y);
+      int mm = m, nn = k, lda = ld, inc = 1;
+      LapackBuiltin::dgemv(&ta, &mm, &nn, &alpha, &A[0], &lda, &x[0], &inc,
+                           &beta, &y[0], &inc);
+      naiveDgemm(ta, 'N', ta == 'N' ? m : k, 1, ta == 'N' ? k : m, alpha, A,
+                 ld, x, max(m, k), beta, reference, max(m, k));
+      error = max(error, maxDifference(y, reference, y.size()));
+    }
+    ok &= check("dgemv", error, 1e-13);
+  }
+
+  // Against the library
+  if (Lapack::isEnabled()) {
+    const int size = 300;
+    vector<double> a = randomSymmetric(size);
+    vector<double> wl, zl;
+    dsyevr(true, 'A', a, size, 0, 0, 0, 0, w, z);
+    dsyevr(false, 'A', a, size, 0, 0, 0, 0, wl, zl);
+    ok &= check("library dsyevr values", maxDifference(w, wl, size), 1e-12);
+    ok &= check("library dsyevr vectors",
+                maxVectorDifference(z, zl, size, size), 1e-11);
+
+    char ta = 'T', tb = 'N';
+    int m = 150, nn = 130, k = size, lda = size;
+    double alpha = 1.0, beta = 0.0;
+    vector<double> A = randomMatrix(size, m), B = randomMatrix(size, nn);
+    vector<double> C(m * nn), reference(m * nn);
+    LapackBuiltin::dgemm(&ta, &tb, &m, &nn, &k, &alpha, &A[0], &lda, &B[0],
+                         &lda, &beta, &C[0], &m);
+    Lapack::dgemm(&ta, &tb, &m, &nn, &k, &alpha, &A[0], &lda, &B[0], &lda,
+                  &beta, &reference[0], &m);
+    ok &= check("library dgemm", maxDifference(C, reference, C.size()),
+                1e-13);
+
+    vector<double> x = randomMatrix(size, 1), y(m), yl(m);
+    int inc = 1;
+    LapackBuiltin::dgemv(&ta, &k, &m, &alpha, &A[0], &lda, &x[0], &inc,
+                         &beta, &y[0], &inc);
+    Lapack::dgemv(&ta, &k, &m, &alpha, &A[0], &lda, &x[0], &inc, &beta,
+                  &yl[0], &inc);
+    ok &= check("library dgemv", maxDifference(y, yl, m), 1e-13);
+  } else
+    cout << "Built without LAPACK, no library comparison" << endl;
+
+  cout << (ok ? "Passed" : "Failed") << endl;
+
+  return ok ? 0 : 1;
+}
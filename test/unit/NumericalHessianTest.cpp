@@ -0,0 +1,138 @@
+#include <protomol/integrator/hessian/NumericalHessian.h>
+#include <protomol/integrator/StandardIntegrator.h>
+#include <protomol/base/ModuleManager.h>
+#include <protomol/base/SystemUtilities.h>
+#include <protomol/parallel/Parallel.h>
+#include <protomol/topology/GenericTopology.h>
+#include <protomol/ProtoMolApp.h>
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <cmath>
+
+#include <stdlib.h>
+#include <unistd.h>
+
+using namespace std;
+using namespace ProtoMol;
+
+extern void moduleInitFunction(ModuleManager *);
+
+//____ Finite difference Hessians of NumericalHessian against the analytic
+//____ one of Hessian::evaluate
+
+namespace {
+  bool check(const char *name, Real value, Real bound) {
+    cout << name << ": " << value << " (bound " << bound << ")" << endl;
+    return value <= bound;
+  }
+
+  // Largest difference of the upper triangles, the only complete part of
+  // the analytic Hessian, relative to its largest entry
+  Real difference(const Hessian &a, const Hessian &b, int dim) {
+    Real error = 0, size = 0;
+    for (int j = 0; j < dim; j++)
+      for (int i = 0; i <= j; i++) {
+        error = max(error, fabs(a.hessM[j * dim + i] - b.hessM[j * dim + i]));
+        size = max(size, fabs(a.hessM[j * dim + i]));
+      }
+    return error / size;
+  }
+
+  bool compare(ProtoMolApp &app, bool mrw) {
+    StandardIntegrator *integrator =
+      dynamic_cast<StandardIntegrator *>(app.integrator);
+    const int dim = 3 * app.positions.size();
+
+    Hessian analytic;
+    analytic.findForces(integrator->getForceGroup());
+    analytic.initialData(dim);
+    analytic.clear();
+    analytic.evaluate(&app.positions, app.topology, mrw);
+
+    NumericalHessian numerical;
+    numerical.initialize(integrator, &app);
+    Hessian hessian;
+    hessian.initialData(dim);
+
+    const Vector3DBlock forces = *integrator->getForces();
+    const Vector3DBlock positions = app.positions;
+    const Real time = app.topology->time;
+
+    cout << (mrw ? "mass weighted" : "not mass weighted") << endl;
+    numerical.evaluate(&hessian, 1e-6, 1, mrw);
+    bool ok = check("forward", difference(analytic, hessian, dim), 1e-5);
+    numerical.evaluate(&hessian, 1e-4, 2, mrw);
+    ok &= check("central", difference(analytic, hessian, dim), 1e-7);
+    numerical.evaluate(&hessian, 1e-3, 4, mrw);
+    ok &= check("five point", difference(analytic, hessian, dim), 1e-10);
+
+    // The state of the integrator is left as it was
+    Real moved = 0, changed = 0;
+    for (unsigned int i = 0; i < positions.size(); i++) {
+      moved = max(moved, (app.positions[i] - positions[i]).norm());
+      changed = max(changed, ((*integrator->getForces())[i] -
+                              forces[i]).norm());
+    }
+    ok &= check("positions restored", moved, 0);
+    ok &= check("forces restored", changed, 0);
+    ok &= check("time restored", fabs(app.topology->time - time), 0);
+    return ok;
+  }
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    cerr << "Usage: " << argv[0] << " <regression test directory>" << endl;
+    return 1;
+  }
+
+  char directory[] = "/tmp/NumericalHessianTestXXXXXX";
+  if (!mkdtemp(directory)) {
+    cerr << "Can not create a directory in /tmp" << endl;
+    return 1;
+  }
+
+  // Alanine in vacuum with the terms whose analytic Hessians are exact,
+  // those of the dihedrals and impropers are approximate
+  const string tests = getCanonicalPath(argv[1]);
+  const string conf = string(directory) + "/alanine.conf";
+  {
+    ofstream out(conf.c_str());
+    out << "firststep 0\nnumsteps 1\nrandomtype 1\n"
+        << "exclude scaled1-4\nseed 1234\n"
+        << "posfile " << tests << "/data/alan.pdb\n"
+        << "psffile " << tests << "/data/alan.psf\n"
+        << "parfile " << tests << "/data/par_all27_prot_lipid.inp\n"
+        << "temperature 300\n"
+        << "boundaryConditions vacuum\ncellManager Cubic\ncellsize 5\n"
+        << "Integrator {\n level 0 Leapfrog {\n  timestep 1\n"
+        << "  force Bond\n  force Angle\n  force LennardJones Coulomb\n"
+        << "   -algorithm NonbondedSimpleFull\n }\n}\n";
+  }
+
+  Parallel::init(argc, argv);
+  ModuleManager modManager;
+  moduleInitFunction(&modManager);
+  ProtoMolApp app(&modManager);
+
+  vector<string> args;
+  args.push_back("ProtoMol");
+  args.push_back(conf);
+  args.push_back("--output");
+  args.push_back("false");
+  app.configure(args);
+  app.build();
+
+  bool ok = compare(app, false);
+  ok &= compare(app, true);
+
+  unlink(conf.c_str());
+  rmdir(directory);
+
+  cout << (ok ? "Passed" : "Failed") << endl;
+
+  return ok ? 0 : 1;
+}
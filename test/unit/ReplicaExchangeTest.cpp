@@ -0,0 +1,88 @@
+#include <protomol/parallel/ReplicaExchange.h>
+#include <protomol/type/Vector3DBlock.h>
+#include <protomol/base/PMConstants.h>
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+
+using namespace std;
+using namespace ProtoMol;
+
+//____ Metropolis exchanges and velocity rescaling of ReplicaExchange
+
+namespace {
+  bool check(const char *name, Real value, Real expected, Real bound) {
+    cout << name << ": " << value << " (expected " << expected << " +- "
+         << bound << ")" << endl;
+    return fabs(value - expected) <= bound;
+  }
+
+  // Acceptance of exchanging 300K and 310K when the replica at 300K has
+  // the energy u0 and the one at 310K u1, over the attempts of exchanges
+  Real acceptance(Real u0, Real u1, unsigned int exchanges,
+                  unsigned int seed) {
+    vector<Real> temperatures(2);
+    temperatures[0] = 300;
+    temperatures[1] = 310;
+    ReplicaExchange exchange(temperatures, 1, seed);
+
+    vector<Real> energies(2);
+    for (unsigned int i = 0; i < exchanges; i++) {
+      for (int r = 0; r < 2; r++)
+        energies[r] = (exchange.getIndex(r) == 0 ? u0 : u1);
+      exchange.exchange(energies);
+    }
+
+    return exchange.getAcceptance(0);
+  }
+}
+
+int main() {
+  bool ok = true;
+
+  // (1/kT0 - 1/kT1) (U0 - U1)
+  const Real beta = (1.0 / 300 - 1.0 / 310) / Constant::BOLTZMANN;
+  ok &= check("logAcceptance", ReplicaExchange::logAcceptance(300, 310, -5, 2),
+              -7 * beta, 1e-12);
+
+  // Always accepted if the colder replica has the higher energy
+  ok &= check("acceptance downhill", acceptance(1, 0, 1000, 1234), 1, 0);
+
+  // exp(delta) = 0.25, 10000 attempts on the even exchanges, 3 sigma
+  const Real u = log(0.25) / beta;
+  const Real sigma = sqrt(0.25 * 0.75 / 10000);
+  ok &= check("acceptance 0.25", acceptance(u, 0, 20000, 1234), 0.25,
+              3 * sigma);
+  ok &= check("acceptance 0.25 other seed", acceptance(u, 0, 20000, 4321),
+              0.25, 3 * sigma);
+
+  // The same seed takes the same decisions, as on all group masters
+  ok &= check("same seed", acceptance(u, 0, 2000, 99),
+              acceptance(u, 0, 2000, 99), 0);
+
+  // Equal temperatures always exchange
+  vector<Real> temperatures(2, 300);
+  ReplicaExchange equal(temperatures, 1, 1);
+  vector<Real> energies(2);
+  energies[0] = -3;
+  energies[1] = 4;
+  equal.exchange(energies);
+  ok &= check("equal temperatures", equal.getIndex(0), 1, 0);
+
+  // Rescaling to a temperature scales the kinetic energy by the ratio
+  Vector3DBlock velocities(10);
+  for (unsigned int i = 0; i < velocities.size(); i++)
+    velocities[i] = Vector3D(0.1 * i, -0.2 + 0.03 * i, 0.5 - 0.07 * i);
+  Real before = 0, after = 0;
+  for (unsigned int i = 0; i < velocities.size(); i++)
+    before += velocities[i].normSquared();
+  ReplicaExchange::rescale(&velocities, 300, 345);
+  for (unsigned int i = 0; i < velocities.size(); i++)
+    after += velocities[i].normSquared();
+  ok &= check("rescale", after / before, 345.0 / 300, 1e-14);
+
+  cout << (ok ? "Passed" : "Failed") << endl;
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,178 @@
+#include <protomol/output/StreamServer.h>
+#include <protomol/base/Exception.h>
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+
+#ifdef HAVE_EPOLL
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#endif
+
+using namespace std;
+using namespace ProtoMol;
+
+//____ A client of StreamServer reading the float, key and delta frames
+
+#ifdef HAVE_EPOLL
+namespace {
+  const int ATOMS = 5;
+  const int PORT = 52731;
+
+  bool check(const char *name, double value, double bound) {
+    cout << name << ": " << value << " (bound " << bound << ")" << endl;
+    return value <= bound;
+  }
+
+  bool receive(int fd, void *data, size_t length) {
+    char *c = (char *)data;
+    while (length > 0) {
+      ssize_t n = recv(fd, c, length, 0);
+      if (n <= 0) return false;
+      c += n;
+      length -= n;
+    }
+    return true;
+  }
+
+  int32_t varint(const vector<unsigned char> &in, unsigned int &i) {
+    uint32_t v = 0;
+    for (int shift = 0; i < in.size(); shift += 7) {
+      const unsigned char b = in[i++];
+      v |= (uint32_t)(b & 0x7f) << shift;
+      if (!(b & 0x80)) break;
+    }
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+  }
+
+  // The frame published for step, atom i at (i + step / 7, -i, 0.1 i)
+  void fill(StreamServer &server, long step) {
+    FAH_XYZ *xyz = server.frame();
+    for (int i = 0; i < ATOMS; i++) {
+      xyz[i].x = i + step / 7.0;
+      xyz[i].y = -i;
+      xyz[i].z = 0.1 * i;
+    }
+    server.publish(step, 0.5 * step, -10, 300);
+  }
+
+  // Largest difference of the frame read to the one published for step,
+  // quantized against the client's last values
+  double readFrame(int fd, long step, uint32_t type, float precision,
+                   vector<int32_t> &last) {
+    STREAM_FRAME header;
+    vector<unsigned char> data;
+    if (!receive(fd, &header, sizeof(header)) || header.magic != STREAM_MAGIC ||
+        header.type != type || header.step != step)
+      return HUGE_VAL;
+    data.resize(header.length);
+    if (header.length && !receive(fd, &data[0], header.length))
+      return HUGE_VAL;
+
+    vector<float> xyz(3 * ATOMS);
+    if (type == StreamServer::STREAM_FULL) {
+      if (data.size() != xyz.size() * sizeof(float)) return HUGE_VAL;
+      memcpy(&xyz[0], &data[0], data.size());
+    } else {
+      unsigned int at = 0;
+      for (int i = 0; i < 3 * ATOMS; i++) {
+        if (type == StreamServer::STREAM_KEY)
+          memcpy(&last[i], &data[4 * i], sizeof(int32_t));
+        else last[i] += varint(data, at);
+        xyz[i] = last[i] * precision;
+      }
+    }
+
+    double error = 0;
+    for (int i = 0; i < ATOMS; i++) {
+      error = max(error, fabs(xyz[3 * i] - (i + step / 7.0)));
+      error = max(error, fabs(xyz[3 * i + 1] + (double)i));
+      error = max(error, fabs(xyz[3 * i + 2] - 0.1 * i));
+    }
+    return error;
+  }
+
+  // Connects and reads the info, atoms and bonds, -1 on failure
+  int connectClient(StreamServer &server) {
+    int fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(PORT);
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) return -1;
+
+    STREAM_INFO info;
+    vector<FAH_ATOM> atoms(ATOMS);
+    FAH_BOND bond;
+    if (!receive(fd, &info, sizeof(info)) || info.magic != STREAM_MAGIC ||
+        info.atom_count != ATOMS || info.bond_count != 1 ||
+        !receive(fd, &atoms[0], sizeof(FAH_ATOM) * ATOMS) ||
+        !receive(fd, &bond, sizeof(bond)) || bond.a != 1 || bond.b != 3)
+      return -1;
+
+    // Frames are only published once the server has taken the client
+    for (int i = 0; i < 1000 && !server.wanted(); i++) usleep(1000);
+    return fd;
+  }
+
+  bool stream(float precision) {
+    StreamServer server("test", ATOMS, 1, PORT, precision, 2, 4);
+    server.bonds[0].a = 1;
+    server.bonds[0].b = 3;
+    server.startServer();
+
+    const int fd = connectClient(server);
+    bool ok = check("connected", fd < 0, 0);
+    if (fd < 0) return false;
+
+    // Key frames every second frame with a precision, each read before the
+    // next is published
+    const uint32_t full = StreamServer::STREAM_FULL;
+    const uint32_t key = StreamServer::STREAM_KEY;
+    const uint32_t delta = StreamServer::STREAM_DELTA;
+    const uint32_t types[3] = {precision > 0 ? key : full,
+                               precision > 0 ? delta : full,
+                               precision > 0 ? key : full};
+    const double bound = precision > 0 ? 0.5 * precision + 1e-6 : 1e-6;
+    vector<int32_t> last(3 * ATOMS);
+    for (long step = 1; step <= 3; step++) {
+      fill(server, step);
+      ok &= check(precision > 0 ? "quantized frame" : "float frame",
+                  readFrame(fd, step, types[step - 1], precision, last), bound);
+    }
+
+    close(fd);
+    server.stopServer();
+    ok &= check("frames sent", fabs((double)server.getSent() - 3), 0);
+    return ok;
+  }
+}
+
+int main() {
+  bool ok = true;
+
+  try {
+    ok &= stream(0);
+    ok &= stream(0.01);
+  } catch (const Exception &e) {
+    cout << e.getMessage() << endl;
+    ok = false;
+  }
+
+  cout << (ok ? "Passed" : "Failed") << endl;
+
+  return ok ? 0 : 1;
+}
+#else
+int main() {
+  cout << "Built without epoll, no stream server" << endl;
+  cout << "Passed" << endl;
+
+  return 0;
+}
+#endif
@@ -0,0 +1,93 @@
+#include <protomol/analysis/Superposition.h>
+#include <protomol/base/MathUtilities.h>
+
+#include <iostream>
+#include <cmath>
+
+using namespace std;
+using namespace ProtoMol;
+
+//____ QCP superposition of rotated copies with a known rotation and RMSD
+
+namespace {
+  bool check(const char *name, Real value, Real bound) {
+    cout << name << ": " << value << " (bound " << bound << ")" << endl;
+    return value <= bound;
+  }
+
+  Real maxDifference(const Matrix3By3 &a, const Matrix3By3 &b) {
+    Real d = 0;
+    for (unsigned int i = 0; i < 3; i++)
+      for (unsigned int j = 0; j < 3; j++)
+        d = max(d, fabs(a(i, j) - b(i, j)));
+    return d;
+  }
+
+  // RMSD of rotation * positions to reference
+  Real rmsd(const Vector3DBlock &reference, const Vector3DBlock &positions,
+            const Matrix3By3 &rotation) {
+    Real sum = 0;
+    for (unsigned int i = 0; i < reference.size(); i++)
+      sum += (rotation * positions[i] - reference[i]).normSquared();
+    return sqrt(sum / reference.size());
+  }
+
+  Vector3DBlock rotated(const Matrix3By3 &rotation, const Vector3DBlock &x,
+                        Real scale) {
+    Vector3DBlock y(x.size());
+    for (unsigned int i = 0; i < x.size(); i++)
+      y[i] = rotation * (x[i] * scale);
+    return y;
+  }
+}
+
+int main() {
+  bool ok = true;
+
+  Matrix3By3 R;
+  R.rotate(Vector3D(1, 2, 3).normalized(), 1.1);
+  const Matrix3By3 inverse = R.transposed();
+  Matrix3By3 rotation;
+
+  // Rotated copy, RMSD 0 and the rotation undone
+  Vector3DBlock reference(20);
+  for (unsigned int i = 0; i < reference.size(); i++)
+    reference[i] = Vector3D(randomNumber(), randomNumber(), randomNumber()) *
+      10.0;
+  centerPositions(reference);
+
+  const Vector3DBlock positions = rotated(R, reference, 1.0);
+  ok &= check("copy RMSD", qcpSuperpose(reference, positions, &rotation),
+              1e-6);
+  ok &= check("copy rotation", maxDifference(rotation, inverse), 1e-10);
+  ok &= check("copy superposed", rmsd(reference, positions, rotation), 1e-10);
+
+  // Unit vectors along the axes scaled by 1.5 and rotated, RMSD 0.5
+  Vector3DBlock axes(6, Vector3D(0, 0, 0));
+  for (unsigned int i = 0; i < 6; i++) axes[i].c[i / 2] = i % 2 ? -1 : 1;
+
+  const Vector3DBlock scaled = rotated(R, axes, 1.5);
+  ok &= check("scaled RMSD",
+              fabs(qcpSuperpose(axes, scaled, &rotation) - 0.5), 1e-10);
+  ok &= check("scaled rotation", maxDifference(rotation, inverse), 1e-10);
+
+  // Perturbed copy, the RMSD returned is the one of the rotation returned
+  // and not above the one of the rotation applied
+  Vector3DBlock perturbed = reference;
+  for (unsigned int i = 0; i < perturbed.size(); i++)
+    perturbed[i] += Vector3D(randomNumber(), randomNumber(), randomNumber()) -
+      Vector3D(0.5, 0.5, 0.5);
+  centerPositions(perturbed);
+  perturbed = rotated(R, perturbed, 1.0);
+
+  const Real value = qcpSuperpose(reference, perturbed, &rotation);
+  ok &= check("perturbed RMSD of the rotation",
+              fabs(value - rmsd(reference, perturbed, rotation)), 1e-10);
+  ok &= check("perturbed RMSD against the applied rotation",
+              value - rmsd(reference, perturbed, inverse), 0);
+  ok &= check("perturbed rotation", maxDifference(rotation, inverse), 0.05);
+
+  cout << (ok ? "Passed" : "Failed") << endl;
+
+  return ok ? 0 : 1;
+}
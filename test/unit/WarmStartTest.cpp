@@ -0,0 +1,147 @@
+#include <protomol/integrator/hessian/BlockHessianDiagonalize.h>
+#include <protomol/base/MathUtilities.h>
+#include <protomol/base/Lapack.h>
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+
+using namespace std;
+using namespace ProtoMol;
+
+//____ Warm started eigenvectors against the full diagonalization
+
+namespace {
+  const int ATOMS = 40;
+  const int DIM = 3 * ATOMS;
+  const int P = 8;
+  const int MODES = 6;
+
+  bool check(const char *name, Real value, Real bound) {
+    cout << name << ": " << value << " (bound " << bound << ")" << endl;
+    return value <= bound;
+  }
+
+  class DenseProduct : public BlockHessianDiagonalize::Product {
+  public:
+    DenseProduct(vector<double> &h) : hessM(h) {}
+
+    virtual void product(double *V, double *Y, int cols) {
+      char transA = 'N';
+      int m = DIM, n = cols, k = DIM;
+      double alpha = 1.0, beta = 0.0;
+      Lapack::dgemm(&transA, &transA, &m, &n, &k, &alpha, &hessM[0], &m, V,
+                    &k, &beta, Y, &m);
+    }
+
+  private:
+    vector<double> &hessM;
+  };
+
+  // Q diag(values) Q^T with a random orthonormal Q, column major
+  vector<double> hessian(const vector<double> &values) {
+    vector<double> q(DIM * DIM);
+    for (int j = 0; j < DIM; j++) {
+      double *c = &q[j * DIM];
+      for (int i = 0; i < DIM; i++) c[i] = randomNumber() - 0.5;
+      for (int k = 0; k < j; k++) {
+        const double *v = &q[k * DIM];
+        double dot = 0;
+        for (int i = 0; i < DIM; i++) dot += v[i] * c[i];
+        for (int i = 0; i < DIM; i++) c[i] -= dot * v[i];
+      }
+      double norm = 0;
+      for (int i = 0; i < DIM; i++) norm += c[i] * c[i];
+      for (int i = 0; i < DIM; i++) c[i] /= sqrt(norm);
+    }
+
+    vector<double> h(DIM * DIM, 0.0);
+    for (int j = 0; j < DIM; j++)
+      for (int i = 0; i < DIM; i++)
+        for (int k = 0; k < DIM; k++)
+          h[j * DIM + i] += q[k * DIM + i] * values[k] * q[k * DIM + j];
+    return h;
+  }
+
+  // All vectors and values as the full diagonalization orders them
+  void diagonalize(BlockHessianDiagonalize &diag, vector<double> h,
+                   vector<double> &vectors, vector<double> &values) {
+    vectors.resize(DIM * DIM);
+    int found;
+    diag.diagHessian(&vectors[0], diag.eigVal, &h[0], DIM, found);
+    for (int i = 0; i < DIM; i++) diag.eigIndx[i] = i;
+    diag.absSort(&vectors[0], diag.eigVal, diag.eigIndx, DIM);
+    values.assign(diag.eigVal, diag.eigVal + DIM);
+  }
+
+  vector<double> atomBlocks(const vector<double> &h) {
+    vector<double> blocks(9 * ATOMS);
+    for (int a = 0; a < ATOMS; a++)
+      for (int k = 0; k < 3; k++)
+        for (int l = 0; l < 3; l++)
+          blocks[9 * a + k * 3 + l] = h[(3 * a + l) * DIM + 3 * a + k];
+    return blocks;
+  }
+}
+
+int main() {
+  bool ok = true;
+
+  BlockHessianDiagonalize diag;
+  diag.initialize(DIM);
+
+  // A few small negative values and a wide spread, as a mass weighted
+  // Hessian away from a minimum
+  vector<double> values(DIM);
+  for (int i = 0; i < DIM; i++)
+    values[i] = i < 2 ? -0.1 * (i + 1) : 0.05 * (i - 1) * (i - 1) * (i - 1);
+
+  // Last vectors from h, the new Hessian slightly moved
+  vector<double> h = hessian(values);
+  vector<double> last, lastValues;
+  diagonalize(diag, h, last, lastValues);
+
+  vector<double> moved(h);
+  for (int j = 0; j < DIM; j++)
+    for (int i = 0; i <= j; i++)
+      moved[j * DIM + i] = moved[i * DIM + j] +=
+        (i == j ? 2e-3 : 1e-3) * (randomNumber() - 0.5);
+
+  vector<double> full, fullValues;
+  diagonalize(diag, moved, full, fullValues);
+
+  DenseProduct product(moved);
+  const vector<double> blocks = atomBlocks(moved);
+  Real residual;
+
+  // Not converged within no iteration, the vectors are left alone
+  vector<double> vectors(last);
+  ok &= check("unconverged accepted",
+              diag.warmStart(product, &blocks[0], &vectors[0], DIM, P, MODES,
+                             0, 1e-8, residual), 0);
+  ok &= check("unconverged vectors changed", vectors != last, 0);
+
+  // Converged, the modes as those of the full diagonalization
+  ok &= check("converged rejected",
+              !diag.warmStart(product, &blocks[0], &vectors[0], DIM, P,
+                              MODES, 20, 1e-8, residual), 0);
+  ok &= check("residual", residual, 1e-8);
+
+  Real valueError = 0, vectorError = 0;
+  for (int j = 0; j < MODES; j++) {
+    valueError = max(valueError, fabs(diag.eigVal[j] - fullValues[j]));
+
+    // Same vector up to sign
+    double dot = 0;
+    for (int i = 0; i < DIM; i++)
+      dot += vectors[j * DIM + i] * full[j * DIM + i];
+    vectorError = max(vectorError, 1 - fabs(dot));
+  }
+  // Both are accurate to round-off of the largest value, about 8e4
+  ok &= check("eigenvalues", valueError, 1e-10);
+  ok &= check("eigenvectors", vectorError, 1e-12);
+
+  cout << (ok ? "Passed" : "Failed") << endl;
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,101 @@
+#include <protomol/io/XTCCoordinateCodec.h>
+#include <protomol/base/Exception.h>
+
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdlib>
+
+using namespace std;
+using namespace ProtoMol;
+
+//____ The XTC frame of libxdrf decoded and encoded again, and every
+//____ truncation of its bit stream rejected
+
+namespace {
+  typedef XTCCoordinateCodec::float4 float4;
+
+  // Magic, atoms, step, time and the box before the coordinates
+  const unsigned int FRAME_HEADER = 52;
+
+  bool check(const char *name, double value, double bound) {
+    cout << name << ": " << value << " (bound " << bound << ")" << endl;
+    return value <= bound;
+  }
+
+  // Coordinates of the PDB in nm
+  vector<float4> readPDB(const string &filename) {
+    vector<float4> x;
+    ifstream in(filename.c_str());
+    string line;
+    while (getline(in, line))
+      if (line.compare(0, 4, "ATOM") == 0)
+        for (unsigned int k = 0; k < 3; k++)
+          x.push_back(atof(line.substr(30 + 8 * k, 8).c_str()) / 10);
+    return x;
+  }
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    cerr << "Usage: " << argv[0] << " <regression test directory>" << endl;
+    return 1;
+  }
+
+  const string tests = argv[1];
+  ifstream file((tests + "/data/water_423.xtc").c_str(), ios::binary);
+  const vector<char> frame((istreambuf_iterator<char>(file)),
+                           istreambuf_iterator<char>());
+  const vector<float4> expected = readPDB(tests + "/data/water_423.pos.pdb");
+  const unsigned int natoms = expected.size() / 3;
+
+  bool ok = check("frame read", frame.size() <= FRAME_HEADER || !natoms, 0);
+  if (!ok) {
+    cout << "Failed" << endl;
+    return 1;
+  }
+
+  // Decoded to the precision of the file
+  XTCCoordinateCodec codec;
+  const char *payload = &frame[FRAME_HEADER];
+  const unsigned int size = frame.size() - FRAME_HEADER;
+  vector<float4> x(3 * natoms);
+  float4 precision = 0;
+  unsigned int used = 0;
+  ok &= check("decoded", !codec.decompress(payload, size, natoms, &x[0],
+                                           precision, used), 0);
+  ok &= check("bytes used", fabs((double)used - size), 0);
+
+  double error = 0;
+  for (unsigned int i = 0; i < x.size(); i++)
+    error = max(error, fabs((double)x[i] - expected[i]));
+  ok &= check("coordinates", error, 0.5 / precision + 1e-6);
+
+  // Encoded again, the bytes of libxdrf
+  vector<char> out;
+  codec.compress(&x[0], natoms, precision, out);
+  ok &= check("encoded", out != vector<char>(payload, payload + size), 0);
+
+  // The byte count cut short, the reader must stop at the end of the bytes
+  const unsigned int numBytes = XTCCoordinateCodec::getInt(payload + 36);
+  vector<char> cut(payload, payload + size);
+  unsigned int accepted = 0;
+  for (unsigned int n = 0; n < numBytes; n++) {
+    vector<char> in(cut.begin(), cut.begin() + 40 + n);
+    for (unsigned int k = 0; k < 4; k++)
+      in[36 + k] = static_cast<char>(n >> (24 - 8 * k));
+    in.resize(40 + ((n + 3) / 4) * 4, 0);
+    try {
+      if (codec.decompress(&in[0], in.size(), natoms, &x[0], precision, used))
+        accepted++;
+    } catch (const Exception &) {}
+  }
+  ok &= check("truncated streams accepted", accepted, 0);
+
+  cout << (ok ? "Passed" : "Failed") << endl;
+
+  return ok ? 0 : 1;
+}